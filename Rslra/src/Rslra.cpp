@@ -52,6 +52,16 @@ static void getRSLRAMethodOption( OptimizationOptions *popt, SEXP OPTS ) {
   } 
 }
 
+static void getRSLRAChkptFileOption( OptimizationOptions *popt, SEXP OPTS ) {
+  SEXP str_val_sexp;
+
+  if (TYPEOF((str_val_sexp = getListElement(OPTS, CHKPT_FILE_STR))) == STRSXP) {
+    strncpy(popt->chkpt_file, CHAR(STRING_ELT(str_val_sexp, 0)), 
+            SLRA_CHKPT_FILE_LEN - 1);
+    popt->chkpt_file[SLRA_CHKPT_FILE_LEN - 1] = 0;
+  } 
+}
+
 gsl_vector SEXP2vec( SEXP p ) {
   gsl_vector res = { 0, 0, 0, 0, 0 };
   if (p != R_NilValue) {
@@ -69,36 +79,184 @@ gsl_matrix SEXP2mat( SEXP A ) {
   return res;
 }
 
+static void getRSLRAOptions( OptimizationOptions &opt, SEXP _opt ) {
+  getRSLRADispOption(_opt);
+  getRSLRAMethodOption(&opt, _opt);
+  getRSLRAOption(opt, _opt, maxiter, asInteger);
+  getRSLRAOption(opt, _opt, epsabs, asReal);
+  getRSLRAOption(opt, _opt, epsrel, asReal);
+  getRSLRAOption(opt, _opt, epsgrad, asReal);
+  getRSLRAOption(opt, _opt, epsx, asReal);
+  getRSLRAOption(opt, _opt, step, asReal);
+  getRSLRAOption(opt, _opt, tol, asReal);
+  getRSLRAOption(opt, _opt, epscov, asReal);
+  getRSLRAOption(opt, _opt, cov_diag, asInteger);
+  getRSLRAOption(opt, _opt, reggamma, asReal);
+  getRSLRAOption(opt, _opt, tol_m, asReal);
+  getRSLRAOption(opt, _opt, ls_correction, asReal);
+  getRSLRAOption(opt, _opt, xi_maxabs, asReal);
+  getRSLRAOption(opt, _opt, sketch_size, asInteger);
+  getRSLRAOption(opt, _opt, sample_init, asInteger);
+  getRSLRAOption(opt, _opt, sample_growth, asReal);
+  getRSLRAOption(opt, _opt, maxx, asReal);
+  getRSLRAOption(opt, _opt, maxtime, asReal);
+  getRSLRAChkptFileOption(&opt, _opt);
+  getRSLRAOption(opt, _opt, chkpt_iter, asInteger);
+  getRSLRAOption(opt, _opt, chkpt_time, asReal);
+  getRSLRAOption(opt, _opt, resume, asInteger);
+}
+
 #define STR_MAX_LEN 200
 
+/* Asynchronous optimization: the SLRA object is kept in an external pointer */
+static void slraObjectFinalizer( SEXP ptr ) {
+  SLRAObject *obj = (SLRAObject *)R_ExternalPtrAddr(ptr);
+  
+  if (obj != NULL) {
+    delete obj; /* Cancels the optimization and waits for the worker */
+    R_ClearExternalPtr(ptr);
+  }
+}
+
+static AsyncOptimization *getRSLRAAsync( SEXP ptr ) {
+  SLRAObject *obj = NULL;
+  
+  if (TYPEOF(ptr) == EXTPTRSXP && R_ExternalPtrTag(ptr) == install("SLRA object")) {
+    obj = (SLRAObject *)R_ExternalPtrAddr(ptr);
+  }
+  if (obj == NULL || obj->getAsync() == NULL) {
+    error("pointer provided is not an SLRA optimization");
+  }
+  return obj->getAsync();
+}
+
+/* Complex p: solved by SLRAObject for the realified structure */
+static SEXP call_slra_complex( SEXP _p, SEXP _s, SEXP _r, SEXP _opt, 
+                               int compute_ph, int compute_Rh ) {
+  char str_buf[STR_MAX_LEN];
+  double r = *INTEGER(_r);
+  size_t np = LENGTH(_p), k, a, b, m = 0, d = 0;
+  gsl_vector vec_ml = SEXP2vec(getListElement(_s, ML_STR)), 
+      vec_nk = SEXP2vec(getListElement(_s, NK_STR)),
+      vec_wk = SEXP2vec(getListElement(_s, WK_STR)),
+      vec_r = gsl_vector_view_array(&r, 1).vector;
+  OptimizationOptions opt;
+  getRSLRAOptions(opt, _opt);
+  SEXP _r_ini = getListElement(_opt, RINI_STR);
+  SEXP _p_out = R_NilValue, _r_out = R_NilValue;
+  gsl_vector *p_re = gsl_vector_alloc(np), *p_im = gsl_vector_alloc(np), 
+             *p_out = NULL;
+  gsl_matrix *Rt_re = NULL, *Rt_im = NULL, *rini = NULL, *r_out = NULL;
+  SLRAObject *obj = NULL;
+  int was_error = 0;
+
+  for (k = 0; k < np; k++) {
+    gsl_vector_set(p_re, k, COMPLEX(_p)[k].r);
+    gsl_vector_set(p_im, k, COMPLEX(_p)[k].i);
+  }
+  if (compute_ph) {
+    PROTECT(_p_out = allocVector(CPLXSXP, np));
+  }
+  try {
+    obj = new SLRAObject(*p_re, *p_im, vec_ml, vec_nk, vec_wk, vec_r);
+    m = obj->getF()->getNrow() / 2;
+    d = obj->getF()->getD() / 2;
+    if (compute_Rh) {
+      PROTECT(_r_out = allocMatrix(CPLXSXP, d, m));
+    }
+    Rt_re = gsl_matrix_alloc(m, d);
+    Rt_im = gsl_matrix_alloc(m, d);
+    if (_r_ini != R_NilValue) { /* R(b, a) = Rini[b + d * a] */
+      if (TYPEOF(_r_ini) != CPLXSXP || LENGTH(_r_ini) != m * d) {
+        throw new Exception("Incorrect Rini\n");   
+      }
+      for (a = 0; a < m; a++) {
+        for (b = 0; b < d; b++) {
+          gsl_matrix_set(Rt_re, a, b, COMPLEX(_r_ini)[b + d * a].r);
+          gsl_matrix_set(Rt_im, a, b, COMPLEX(_r_ini)[b + d * a].i);
+        }
+      }
+      rini = gsl_matrix_alloc(2 * m, 2 * d);
+      obj->realifyRt(Rt_re, Rt_im, rini);
+    }
+    p_out = gsl_vector_alloc(2 * np);
+    r_out = gsl_matrix_alloc(2 * m, 2 * d);
+    obj->optimize(&opt, rini, NULL, p_out, r_out, NULL);
+
+    obj->complexifyP(p_out, p_re, p_im);
+    for (k = 0; k < np && compute_ph; k++) {
+      COMPLEX(_p_out)[k].r = gsl_vector_get(p_re, k);
+      COMPLEX(_p_out)[k].i = gsl_vector_get(p_im, k);
+    }
+    obj->complexifyRt(r_out, Rt_re, Rt_im);
+    for (a = 0; a < m && compute_Rh; a++) {
+      for (b = 0; b < d; b++) {
+        COMPLEX(_r_out)[b + d * a].r = gsl_matrix_get(Rt_re, a, b);
+        COMPLEX(_r_out)[b + d * a].i = gsl_matrix_get(Rt_im, a, b);
+      }
+    }
+  } catch (Exception *e) {
+    strncpy(str_buf, e->getMessage(), STR_MAX_LEN - 1);
+    str_buf[STR_MAX_LEN - 1] = 0;
+    was_error = 1;
+    delete e;
+  }   
+  
+  if (obj != NULL) {
+    delete obj;
+  }
+  gsl_vector_free(p_re);
+  gsl_vector_free(p_im);
+  gsl_vector_free_ifnull(p_out);
+  gsl_matrix_free_ifnull(Rt_re);
+  gsl_matrix_free_ifnull(Rt_im);
+  gsl_matrix_free_ifnull(rini);
+  gsl_matrix_free_ifnull(r_out);
+  if (was_error) {
+    UNPROTECT(compute_ph + (compute_Rh && _r_out != R_NilValue));
+    error(str_buf);
+  }
+
+  SEXP _res, _info;
+  PROTECT(_info = list4(ScalarInteger(opt.iter), ScalarReal(opt.time), 
+                        ScalarReal(opt.fmin), _r_out));
+  {
+    const char *names[] = { ITER_STR, TIME_STR, FMIN_STR, RH_STR };
+    for (int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+      SET_TAG(nthcdr(_info, i), install(names[i]));
+    }  
+  }                        
+  PROTECT(_res = list2(_p_out, _info));
+  SET_TAG(_res, install(PH_STR));
+  SET_TAG(CDR(_res), install(INFO_STR));
+  UNPROTECT(2 + compute_ph + compute_Rh);
+  return _res;
+}
+
 extern "C" {
 
 SEXP call_slra( SEXP _p, SEXP _s, SEXP _r, SEXP _opt, 
                 SEXP _compute_ph, SEXP _compute_Rh ) {
   char str_buf[STR_MAX_LEN];
+
+  if (TYPEOF(_p) == CPLXSXP) {
+    return call_slra_complex(_p, _s, _r, _opt, !!(*INTEGER(_compute_ph)),
+                             !!(*INTEGER(_compute_Rh)));
+  }
+  
   
   /* Required parameters */
   gsl_vector vec_ml = SEXP2vec(getListElement(_s, ML_STR)), 
       p_in = SEXP2vec(_p), vec_nk = SEXP2vec(getListElement(_s, NK_STR)),
-      vec_wk = SEXP2vec(getListElement(_s, WK_STR));
+      vec_wk = SEXP2vec(getListElement(_s, WK_STR)),
+      vec_tk = SEXP2vec(getListElement(_s, TOEPLITZ_STR));
   gsl_matrix phi = SEXP2mat(getListElement(_s, PERM_STR));
   int np = compute_np(&vec_ml, &vec_nk);
   int r = *INTEGER(_r), compute_ph = !!(*INTEGER(_compute_ph)),
       compute_Rh = !!(*INTEGER(_compute_Rh)), compute_vh = 1;
   /* Optional parameters */
   OptimizationOptions opt;
-  getRSLRADispOption(_opt);
-  getRSLRAMethodOption(&opt, _opt);
-  getRSLRAOption(opt, _opt, maxiter, asInteger);
-  getRSLRAOption(opt, _opt, epsabs, asReal);
-  getRSLRAOption(opt, _opt, epsrel, asReal);
-  getRSLRAOption(opt, _opt, epsgrad, asReal);
-  getRSLRAOption(opt, _opt, epsx, asReal);
-  getRSLRAOption(opt, _opt, step, asReal);
-  getRSLRAOption(opt, _opt, tol, asReal);
-  getRSLRAOption(opt, _opt, reggamma, asReal);
-  getRSLRAOption(opt, _opt, ls_correction, asReal);
-  getRSLRAOption(opt, _opt, maxx, asReal);
+  getRSLRAOptions(opt, _opt);
   SEXP _r_ini = getListElement(_opt, RINI_STR);
 
   /* Create output values */  
@@ -109,7 +267,8 @@ SEXP call_slra( SEXP _p, SEXP _s, SEXP _r, SEXP _opt,
   int was_error = 0;
   try {
     /* Create output info */
-    myStruct = createMosaicStructure(&vec_ml, &vec_nk, vecChkNIL(vec_wk));  
+    myStruct = createMosaicStructure(&vec_ml, &vec_nk, vecChkNIL(vec_wk),
+                                     NULL, vecChkNIL(vec_tk));  
     int m = phi.size2;
     if (compute_ph) {
       PROTECT(_p_out = allocVector(REALSXP, np));
@@ -118,7 +277,8 @@ SEXP call_slra( SEXP _p, SEXP _s, SEXP _r, SEXP _opt,
       PROTECT(_r_out = allocMatrix(REALSXP, (m-r), m));
     }
     if (compute_vh) {
-      PROTECT(_v_out = allocMatrix(REALSXP, (m-r)*r, (m-r)*r));
+      PROTECT(_v_out = allocMatrix(REALSXP, (m-r)*r, 
+                                   opt.cov_diag ? 1 : (m-r)*r));
     }    
     gsl_matrix rini = SEXP2mat(_r_ini), r_out = SEXP2mat(_r_out),
                v_out = SEXP2mat(_v_out);
@@ -171,6 +331,110 @@ SEXP call_slra( SEXP _p, SEXP _s, SEXP _r, SEXP _opt,
   return _res;
 }
 
+SEXP slra_start( SEXP _p, SEXP _s, SEXP _r, SEXP _opt ) {
+  char str_buf[STR_MAX_LEN];
+  double r = *INTEGER(_r);
+  gsl_vector vec_ml = SEXP2vec(getListElement(_s, ML_STR)), 
+      p_in = SEXP2vec(_p), vec_nk = SEXP2vec(getListElement(_s, NK_STR)),
+      vec_wk = SEXP2vec(getListElement(_s, WK_STR)), 
+      vec_tk = SEXP2vec(getListElement(_s, TOEPLITZ_STR)), 
+      vec_r = gsl_vector_view_array(&r, 1).vector;
+  gsl_matrix phi = SEXP2mat(getListElement(_s, PERM_STR));
+  OptimizationOptions opt;
+  SLRAObject *obj = NULL;
+  int was_error = 0;
+
+  getRSLRAOptions(opt, _opt);
+  try {
+    gsl_matrix rini = SEXP2mat(getListElement(_opt, RINI_STR));
+    obj = new SLRAObject(p_in, vec_ml, vec_nk, phi, vec_wk, vec_r, false,
+                         vecChkNIL(vec_tk));
+    obj->optimizeAsync(&opt, matChkNIL(rini), NULL);
+  } catch (Exception *e) {
+    strncpy(str_buf, e->getMessage(), STR_MAX_LEN - 1);
+    str_buf[STR_MAX_LEN - 1] = 0;
+    was_error = 1;
+    delete e;
+    if (obj != NULL) {
+      delete obj;
+    }
+  }
+  if (was_error) {
+    error(str_buf);
+  }
+
+  SEXP _ptr = R_MakeExternalPtr(obj, install("SLRA object"), R_NilValue);
+  PROTECT(_ptr);
+  R_RegisterCFinalizerEx(_ptr, slraObjectFinalizer, TRUE);
+  UNPROTECT(1);
+  return _ptr;
+}
+
+SEXP slra_poll( SEXP _ptr ) {
+  AsyncProgress progress;
+  SEXP _res;
+
+  getRSLRAAsync(_ptr)->poll(&progress);
+  PROTECT(_res = list5(ScalarLogical(progress.running), 
+                       ScalarInteger(progress.iter), ScalarReal(progress.fmin),
+                       ScalarReal(progress.gradNorm), ScalarReal(progress.time)));
+  {
+    const char *names[] = { RUNNING_STR, ITER_STR, FMIN_STR, GRADNORM_STR, 
+                            TIME_STR };
+    for (int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+      SET_TAG(nthcdr(_res, i), install(names[i]));
+    }  
+  }
+  UNPROTECT(1);
+  return _res;
+}
+
+SEXP slra_cancel( SEXP _ptr ) {
+  getRSLRAAsync(_ptr)->cancel();
+  return R_NilValue;
+}
+
+SEXP slra_result( SEXP _ptr ) {
+  char str_buf[STR_MAX_LEN];
+  AsyncOptimization *async = getRSLRAAsync(_ptr);
+  SLRAObject *obj = (SLRAObject *)R_ExternalPtrAddr(_ptr);
+  size_t m = obj->getF()->getNrow(), d = obj->getF()->getD();
+  OptimizationOptions opt;
+  SEXP _p_out, _r_out, _res, _info;
+  int was_error = 0;
+
+  PROTECT(_p_out = allocVector(REALSXP, obj->getF()->getNp()));
+  PROTECT(_r_out = allocMatrix(REALSXP, d, m));
+  gsl_vector p_out = SEXP2vec(_p_out);
+  gsl_matrix r_out = SEXP2mat(_r_out);
+  try {
+    async->getResult(&opt, &p_out, &r_out);
+  } catch (Exception *e) {
+    strncpy(str_buf, e->getMessage(), STR_MAX_LEN - 1);
+    str_buf[STR_MAX_LEN - 1] = 0;
+    was_error = 1;
+    delete e;
+  }
+  if (was_error) {
+    UNPROTECT(2);
+    error(str_buf);
+  }
+
+  PROTECT(_info = list4(ScalarInteger(opt.iter), ScalarReal(opt.time), 
+                        ScalarReal(opt.fmin), _r_out));
+  {
+    const char *names[] = { ITER_STR, TIME_STR, FMIN_STR, RH_STR };
+    for (int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+      SET_TAG(nthcdr(_info, i), install(names[i]));
+    }  
+  }                        
+  PROTECT(_res = list2(_p_out, _info));
+  SET_TAG(_res, install(PH_STR));
+  SET_TAG(CDR(_res), install(INFO_STR));
+  UNPROTECT(4);
+  return _res;
+}
+
 }
 
 /* typedef struct  {
@@ -3,13 +3,8 @@ function [ph, info] = gcd_nls_complex(p, w, d, opt)
     opt = struct();
   end
  
-  p = reshape(p, 1, length(p));
-  pext = [cellfun(@real, p, 'UniformOutput', false); ... 
-          cellfun(@imag, p, 'UniformOutput', false)];
   p = reshape(p, length(p), 1);
-  pext = reshape(pext, 2 * length(p), 1);     
-      
-  bfp = cell2mat(pext);
+  bfp = cell2mat(p);
   bfn = cellfun(@length, p) - 1;
   bfell = bfn - d;
   if (~isfield(opt, 'hini') || isempty(opt.hini) )
@@ -18,25 +13,18 @@ function [ph, info] = gcd_nls_complex(p, w, d, opt)
     end    
     opt.hini = lsdivmult(p, d, opt.gini);
   end    
+  opt.Rini = opt.hini(:)';
   
-  At = kron(eye(d+1), [1 0]);
-  Bt= kron(eye(d+1), [0 1]);
-  
-  opt.psi = [At Bt; -Bt At];
-  opt.Rini = [real(opt.hini(:).') imag(opt.hini(:).')] * opt.psi * sqrt(0.5);
-  opt.Rini = reshape(opt.Rini, 2, 2*(d+1));
-  
-  s = struct('m', [d+1 d+1], 'n', bfn-d+1);
+  % complex p is handled by the C++ solver (realified structure)
+  s = struct('m', d+1, 'n', bfn-d+1);
   s.gcd = 1;
     if isempty(w) 
-      [ph, info] = slra(bfp, s, sum(s.m)-2, opt);
+      [ph, info] = slra(bfp, s, sum(s.m)-1, opt);
     else
       bfw = cell2mat(w);
       s.w = 1./bfw;
-      [ph, info] = slra(bfw.*bfp, s, sum(s.m)-2, opt);
+      [ph, info] = slra(bfw.*bfp, s, sum(s.m)-1, opt);
     end 
-  ph = mat2cell(ph, 2*(bfn+1), [1]);
-  split_complex = @(x) x(1:length(x)/2) + 1i * x(length(x)/2+1:end) ;
-  ph = cellfun(split_complex, ph, 'UniformOutput', false);
-  info.hh = split_complex(info.Rh(1,:).');
-end
\ No newline at end of file
+  ph = mat2cell(ph, bfn+1, [1]);
+  info.hh = info.Rh';
+end
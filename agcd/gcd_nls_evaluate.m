@@ -6,13 +6,8 @@ function [f] = gcd_nls_evaluate(p, h_array)
   s = struct('m', d+1, 'n', bfn-d+1);
   s.gcd = 1;
   
-  f = zeros(1, size(h_array,2));
-  
   obj =  slra_mex_obj('new', bfp, s, d);
-
-  for i=1:length(f) 
-    f(i) = slra_mex_obj('func', obj, h_array(:,i)');
-  end    
+  f = slra_mex_obj('func', obj, h_array');
   slra_mex_obj('delete', obj);
 end
 
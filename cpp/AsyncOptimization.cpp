@@ -0,0 +1,154 @@
+#include <string.h>
+#include "slra.h"
+
+AsyncOptimization::AsyncOptimization( VarproFunction *F, NLSVarpro *optFun,
+    gsl_vector *x, const OptimizationOptions *opt ) : myF(F),
+    myOptFun(optFun), myX(x), myOpt(*opt), myCancel(false), myJoined(false),
+    myFailed(false) {
+  bool started;
+  
+  myError[0] = 0;
+  myProgress.running = true;
+  myProgress.iter = 0;
+  myProgress.fmin = GSL_POSINF;
+  myProgress.gradNorm = 0;
+  myProgress.time = 0;
+
+  myTimer.start();
+#ifdef WIN32
+  InitializeCriticalSection(&myMutex);
+  started = ((myThread = CreateThread(NULL, 0, threadFunc, this, 0, NULL)) 
+             != NULL);
+#else
+  pthread_mutex_init(&myMutex, NULL);
+  started = (pthread_create(&myThread, NULL, threadFunc, this) == 0);
+#endif
+  if (!started) {
+    myJoined = true;
+    myProgress.running = false;
+    myFailed = true;
+    strcpy(myError, "Cannot create a worker thread.\n");
+  }
+}
+
+AsyncOptimization::~AsyncOptimization() {
+  cancel();
+  wait();
+#ifdef WIN32
+  DeleteCriticalSection(&myMutex);
+#else
+  pthread_mutex_destroy(&myMutex);
+#endif
+  delete myOptFun;
+  delete myF;
+  gsl_vector_free(myX);
+}
+
+void AsyncOptimization::lock() {
+#ifdef WIN32
+  EnterCriticalSection(&myMutex);
+#else
+  pthread_mutex_lock(&myMutex);
+#endif
+}
+
+void AsyncOptimization::unlock() {
+#ifdef WIN32
+  LeaveCriticalSection(&myMutex);
+#else
+  pthread_mutex_unlock(&myMutex);
+#endif
+}
+
+#ifdef WIN32
+DWORD WINAPI AsyncOptimization::threadFunc( LPVOID param ) {
+  ((AsyncOptimization *)param)->run();
+  return 0;
+}
+#else
+void *AsyncOptimization::threadFunc( void *param ) {
+  ((AsyncOptimization *)param)->run();
+  return NULL;
+}
+#endif
+
+void AsyncOptimization::run() {
+  /* The worker should not print (the level of the other threads is kept) */
+  Log::setThreadMaxLevel(Log::LOG_LEVEL_OFF);
+  try {
+    SLRAObject::runOptimization(&myOpt, myOptFun, myX, NULL, this);
+  } catch (Exception *e) {
+    lock();
+    myFailed = true;
+    strncpy(myError, e->getMessage(), SLRA_ASYNC_ERR_LEN - 1);
+    myError[SLRA_ASYNC_ERR_LEN - 1] = 0;
+    unlock();
+    delete e;
+  }
+  lock();
+  myProgress.running = false;
+  myOpt.time = myTimer.getElapsedTime();
+  unlock();
+}
+
+void AsyncOptimization::reportIteration( int no, const gsl_vector * /* x */,
+                                         double fmin, const gsl_vector *grad ) {
+  lock();
+  myProgress.iter = no;
+  myProgress.fmin = fmin;
+  myProgress.gradNorm = (grad != NULL ? gsl_blas_dnrm2(grad) : 0);
+  unlock();
+}
+
+bool AsyncOptimization::stopRequested() {
+  bool stop;
+  lock();
+  stop = myCancel;
+  unlock();
+  return stop || (myOpt.maxtime > 0 && myTimer.getElapsedTime() > myOpt.maxtime);
+}
+
+void AsyncOptimization::poll( AsyncProgress *progress ) {
+  lock();
+  *progress = myProgress;
+  progress->time = (myProgress.running ? myTimer.getElapsedTime() : myOpt.time);
+  unlock();
+}
+
+void AsyncOptimization::cancel() {
+  lock();
+  myCancel = true;
+  unlock();
+}
+
+void AsyncOptimization::wait() {
+  if (!myJoined) {
+#ifdef WIN32
+    WaitForSingleObject(myThread, INFINITE);
+    CloseHandle(myThread);
+#else
+    pthread_join(myThread, NULL);
+#endif
+    myJoined = true;
+  }
+}
+
+void AsyncOptimization::getResult( OptimizationOptions *opt, gsl_vector *p_out,
+                                   gsl_matrix *r_out ) {
+  wait();
+  if (myFailed) {
+    throw new Exception("%s", myError);
+  }
+  opt->fmin = myOpt.fmin;
+  opt->iter = myOpt.iter;
+  opt->time = myOpt.time;
+  opt->method = myOpt.method;
+  opt->avoid_xi = myOpt.avoid_xi;
+  if (p_out != NULL) {
+    myOptFun->computePhat(p_out, myX);
+  }
+  if (r_out != NULL) {
+    myOptFun->x2RTheta(r_out, myX);
+    myOptFun->normalizeRTheta(r_out);
+  }
+}
@@ -0,0 +1,90 @@
+#ifdef WIN32   // Windows system specific
+#include <windows.h>
+#else          // Unix based system specific
+#include <pthread.h>
+#endif
+#include "Timer.h"
+
+/** Maximal length of the error message of the worker thread */
+#define SLRA_ASYNC_ERR_LEN 200
+
+/** Progress of an asynchronous optimization, see AsyncOptimization::poll() */
+struct AsyncProgress {
+  bool running;    ///< true until the worker thread finishes
+  size_t iter;     ///< last reported iteration
+  double fmin;     ///< cost function value at the last iteration
+  double gradNorm; ///< norm of the gradient at the last iteration (0 if unknown)
+  double time;     ///< wall-clock time since the start
+};
+
+/** Optimization running on a worker thread.
+ * Created by SLRAObject::optimizeAsync(). The worker owns a copy of
+ * the options and its own VarproFunction (sharing the structure and the data
+ * with the SLRAObject). The SLRAObject should not be used for other
+ * computations until the job is finished (see wait()).
+ *
+ * The object is also the IterationLogger of the optimization method:
+ * the last reported iteration is available through poll(), and
+ * the cancellation requested by cancel() or the expiration of opt.maxtime
+ * stop the method before its next evaluation of the cost function (at the
+ * end of the current iteration for the GSL methods), with the last
+ * accepted (and the best, since all the methods are descent methods) 
+ * iterate as the result.
+ *
+ * The worker does not print: the display is turned off for the worker
+ * thread only (see Log::setThreadMaxLevel()), so that the level of
+ * the other threads and of the other jobs is not changed.
+ */
+class AsyncOptimization : public IterationLogger {
+  VarproFunction *myF;
+  NLSVarpro *myOptFun;
+  gsl_vector *myX;
+  OptimizationOptions myOpt;
+  Timer myTimer;
+  AsyncProgress myProgress;
+  bool myCancel;
+  bool myJoined;
+  bool myFailed;
+  char myError[SLRA_ASYNC_ERR_LEN];
+#ifdef WIN32
+  HANDLE myThread;
+  CRITICAL_SECTION myMutex;
+  static DWORD WINAPI threadFunc( LPVOID param );
+#else
+  pthread_t myThread;
+  pthread_mutex_t myMutex;
+  static void *threadFunc( void *param );
+#endif
+
+  void lock();
+  void unlock();
+  void run();
+public:
+  /** Starts the optimization on a worker thread.
+   * The object takes ownership of F, optFun and x.
+   * @param [in] F       VarproFunction used only by the worker
+   * @param [in] optFun  NLS function based on F
+   * @param [in] x       initial approximation
+   * @param [in] opt     optimization options (copied)
+   */
+  AsyncOptimization( VarproFunction *F, NLSVarpro *optFun, gsl_vector *x,
+                     const OptimizationOptions *opt );
+  /** Cancels the optimization and waits for the worker */
+  virtual ~AsyncOptimization();
+
+  virtual void reportIteration( int no, const gsl_vector *x, double fmin,
+                                const gsl_vector *grad );
+  virtual bool stopRequested();
+
+  /** Returns the progress of the optimization (does not block) */
+  void poll( AsyncProgress *progress );
+  /** Requests the optimization to stop (does not block) */
+  void cancel();
+  /** Waits until the worker thread finishes */
+  void wait();
+  /** Waits for the worker and returns the results
+   * (opt->fmin, opt->iter, opt->time, \f$\widehat{p}\f$, \f$R\f$).
+   * If the optimization failed, the exception is rethrown. */
+  void getResult( OptimizationOptions *opt, gsl_vector *p_out,
+                  gsl_matrix *r_out );
+};
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <string.h>
+#include "slra.h"
+
+/* Signature and version of the checkpoint file */
+static const char chkptSignature[8] = { 'S', 'L', 'R', 'A', 'C', 'H', 'K', 0 };
+#define SLRA_CHKPT_VERSION 3
+
+/* Positions in the header of the checkpoint file */
+enum {
+  CHK_VERSION = 0, CHK_METHOD, CHK_SUBMETHOD, CHK_LM_SOLVER, CHK_LBFGS_MEM,
+  CHK_LS_CORRECTION, CHK_AVOID_XI, CHK_XI_MAXABS, CHK_EPSABS, CHK_EPSREL,
+  CHK_EPSGRAD, CHK_EPSX, CHK_MAXX, CHK_STEP, CHK_TOL, CHK_REGGAMMA, CHK_TOL_M,
+  CHK_ITER, CHK_FMIN, CHK_TIME, CHK_NVAR, CHK_NSQ, CHK_NPARAM, CHK_NEXTRA, CHK_AUX,
+  CHK_HEADER_SIZE = CHK_AUX + SLRA_CHKPT_NAUX
+};
+
+Checkpoint::Checkpoint( const OptimizationOptions *opt ) :
+    myEveryIter(opt->chkpt_iter), myEveryTime(opt->chkpt_time),
+    myLastIter(0), myLastTime(0), myPriorTime(0), myIsLoaded(false),
+    myNvar(0), myNsq(0), myX(NULL), myParam(NULL), myExtra(NULL) {
+  myFileName = new char[strlen(opt->chkpt_file) + 1];
+  strcpy(myFileName, opt->chkpt_file);
+  for (size_t i = 0; i < SLRA_CHKPT_NAUX; i++) {
+    aux[i] = 0;
+  }
+  myStartClock = clock();
+  myTimer.start();
+}
+
+Checkpoint::~Checkpoint() {
+  gsl_vector_free_ifnull(myX);
+  gsl_vector_free_ifnull(myParam);
+  gsl_vector_free_ifnull(myExtra);
+  delete [] myFileName;
+}
+
+gsl_vector *Checkpoint::resizeVector( gsl_vector *v, size_t size ) {
+  if (v != NULL && v->size == size) {
+    return v;
+  }
+  gsl_vector_free_ifnull(v);
+  return (size > 0 ? gsl_vector_alloc(size) : NULL);
+}
+
+gsl_vector *Checkpoint::getExtra( size_t size ) {
+  return (myExtra = resizeVector(myExtra, size));
+}
+
+static bool readVector( FILE *file, gsl_vector *v ) {
+  return v == NULL || fread(v->data, sizeof(double), v->size, file) == v->size;
+}
+
+static bool writeVector( FILE *file, const gsl_vector *v ) {
+  return v == NULL || fwrite(v->data, sizeof(double), v->size, file) == v->size;
+}
+
+bool Checkpoint::load( OptimizationOptions *opt ) {
+  FILE *file = fopen(myFileName, "rb");
+  char sig[sizeof(chkptSignature)];
+  double h[CHK_HEADER_SIZE];
+  bool ok;
+
+  if (file == NULL) {
+    return false;
+  }
+  ok = (fread(sig, 1, sizeof(sig), file) == sizeof(sig)) &&
+       !memcmp(sig, chkptSignature, sizeof(sig)) &&
+       (fread(h, sizeof(double), CHK_HEADER_SIZE, file) == CHK_HEADER_SIZE) &&
+       (h[CHK_VERSION] == SLRA_CHKPT_VERSION);
+  if (ok) {
+    myX = resizeVector(myX, h[CHK_NVAR]);
+    myParam = resizeVector(myParam, h[CHK_NPARAM]);
+    myExtra = resizeVector(myExtra, h[CHK_NEXTRA]);
+    ok = readVector(file, myX) && readVector(file, myParam) &&
+         readVector(file, myExtra);
+  }
+  fclose(file);
+  if (!ok) {
+    throw new Exception("Checkpoint file %s is corrupted.\n", myFileName);
+  }
+
+  opt->method = h[CHK_METHOD];
+  opt->submethod = h[CHK_SUBMETHOD];
+  opt->lm_solver = h[CHK_LM_SOLVER];
+  opt->lbfgs_mem = h[CHK_LBFGS_MEM];
+  opt->ls_correction = h[CHK_LS_CORRECTION];
+  opt->avoid_xi = h[CHK_AVOID_XI];
+  opt->xi_maxabs = h[CHK_XI_MAXABS];
+  opt->epsabs = h[CHK_EPSABS];
+  opt->epsrel = h[CHK_EPSREL];
+  opt->epsgrad = h[CHK_EPSGRAD];
+  opt->epsx = h[CHK_EPSX];
+  opt->maxx = h[CHK_MAXX];
+  opt->step = h[CHK_STEP];
+  opt->tol = h[CHK_TOL];
+  opt->reggamma = h[CHK_REGGAMMA];
+  opt->tol_m = h[CHK_TOL_M];
+  opt->fmin = h[CHK_FMIN];
+  myLastIter = h[CHK_ITER];
+  myPriorTime = h[CHK_TIME];
+  myNvar = h[CHK_NVAR];
+  myNsq = h[CHK_NSQ];
+  for (size_t i = 0; i < SLRA_CHKPT_NAUX; i++) {
+    aux[i] = h[CHK_AUX + i];
+  }
+  myIsLoaded = true;
+
+  return true;
+}
+
+void Checkpoint::restore( NLSFunction *F, gsl_vector *x ) {
+  size_t nparam = (myParam != NULL ? myParam->size : 0);
+
+  if (!myIsLoaded) {
+    throw new Exception("Checkpoint is not loaded.\n");
+  }
+  if (myNvar != F->getNvar() || myNsq != F->getNsq() ||
+      myNvar != x->size || nparam != F->getParamStateSize()) {
+    throw new Exception("Checkpoint file %s does not match the problem.\n",
+                        myFileName);
+  }
+  if (myParam != NULL) {
+    F->setParamState(myParam);
+  }
+  gsl_vector_memcpy(x, myX);
+}
+
+bool Checkpoint::isDue( size_t iter ) {
+  return (myEveryIter > 0 && iter >= myLastIter + myEveryIter) ||
+         (myEveryTime > 0 && myTimer.getElapsedTime() - myLastTime >= myEveryTime);
+}
+
+void Checkpoint::save( const OptimizationOptions *opt, NLSFunction *F,
+                       const gsl_vector *x ) {
+  double h[CHK_HEADER_SIZE];
+  char *tmpName = new char[strlen(myFileName) + 5];
+  FILE *file;
+  bool ok;
+
+  myX = resizeVector(myX, x->size);
+  gsl_vector_memcpy(myX, x);
+  myParam = resizeVector(myParam, F->getParamStateSize());
+  if (myParam != NULL) {
+    F->getParamState(myParam);
+  }
+  myLastIter = opt->iter;
+  myLastTime = myTimer.getElapsedTime();
+
+  h[CHK_VERSION] = SLRA_CHKPT_VERSION;
+  h[CHK_METHOD] = opt->method;
+  h[CHK_SUBMETHOD] = opt->submethod;
+  h[CHK_LM_SOLVER] = opt->lm_solver;
+  h[CHK_LBFGS_MEM] = opt->lbfgs_mem;
+  h[CHK_LS_CORRECTION] = opt->ls_correction;
+  h[CHK_AVOID_XI] = opt->avoid_xi;
+  h[CHK_XI_MAXABS] = opt->xi_maxabs;
+  h[CHK_EPSABS] = opt->epsabs;
+  h[CHK_EPSREL] = opt->epsrel;
+  h[CHK_EPSGRAD] = opt->epsgrad;
+  h[CHK_EPSX] = opt->epsx;
+  h[CHK_MAXX] = opt->maxx;
+  h[CHK_STEP] = opt->step;
+  h[CHK_TOL] = opt->tol;
+  h[CHK_REGGAMMA] = opt->reggamma;
+  h[CHK_TOL_M] = opt->tol_m;
+  h[CHK_ITER] = opt->iter;
+  h[CHK_FMIN] = opt->fmin;
+  h[CHK_TIME] = myPriorTime + 
+                (double) (clock() - myStartClock) / (double) CLOCKS_PER_SEC;
+  h[CHK_NVAR] = F->getNvar();
+  h[CHK_NSQ] = F->getNsq();
+  h[CHK_NPARAM] = (myParam != NULL ? myParam->size : 0);
+  h[CHK_NEXTRA] = (myExtra != NULL ? myExtra->size : 0);
+  for (size_t i = 0; i < SLRA_CHKPT_NAUX; i++) {
+    h[CHK_AUX + i] = aux[i];
+  }
+
+  /* Write to a temporary file, then replace the checkpoint */
+  sprintf(tmpName, "%s.tmp", myFileName);
+  ok = ((file = fopen(tmpName, "wb")) != NULL);
+  if (ok) {
+    ok = (fwrite(chkptSignature, 1, sizeof(chkptSignature), file) ==
+              sizeof(chkptSignature)) &&
+         (fwrite(h, sizeof(double), CHK_HEADER_SIZE, file) == CHK_HEADER_SIZE) &&
+         writeVector(file, myX) && writeVector(file, myParam) &&
+         writeVector(file, myExtra);
+    ok = (fclose(file) == 0) && ok;
+  }
+  if (ok && rename(tmpName, myFileName) != 0) {
+    /* rename() does not replace an existing file on Windows */
+    remove(myFileName);
+    ok = (rename(tmpName, myFileName) == 0);
+  }
+  delete [] tmpName;
+  if (!ok) {
+    throw new Exception("Cannot write checkpoint file %s.\n", myFileName);
+  }
+  Log::lprintf(Log::LOG_LEVEL_ITER, "Checkpoint saved at iteration %d.\n",
+               (int)opt->iter);
+}
@@ -0,0 +1,78 @@
+#include <time.h>
+#include "Timer.h"
+
+class OptimizationOptions;
+
+/** Number of method-specific scalars stored in a checkpoint */
+#define SLRA_CHKPT_NAUX 4
+
+/** Checkpoint of a running optimization method.
+ * The state of the method at the end of an iteration (\f$x\f$, the state
+ * of the parametrization, the iteration count, the cost function value,
+ * method-specific quantities and the options that determine
+ * the iterations) is saved to a binary file every opt.chkpt_iter iterations
+ * and/or every opt.chkpt_time seconds. The file is first written under
+ * a temporary name and then renamed, so that a job killed during
+ * the write keeps the previous checkpoint.
+ *
+ * If opt.resume is set, SLRAObject::optimize() loads the checkpoint and
+ * the method continues from the saved iteration. For SLRA_OPT_METHOD_LMPINV,
+ * SLRA_OPT_METHOD_GRASS and SLRA_OPT_METHOD_LBFGS the resumed iterations
+ * coincide with the uninterrupted ones. The internal state of
+ * the GSL solvers is not accessible, therefore for the GSL methods
+ * the solver is restarted from the saved point.
+ *
+ * The missing values (see Structure::isMissing()) are not stored: their
+ * imputed values are a function of \f$R\f$ and of the saved options
+ * (opt.reggamma, opt.tol_m), and are recomputed at the first evaluation.
+ *
+ * The file is in the native byte order: an 8-byte signature followed
+ * by an array of doubles.
+ */
+class Checkpoint {
+  char *myFileName;
+  size_t myEveryIter;
+  double myEveryTime;
+  size_t myLastIter;
+  double myLastTime;
+  double myPriorTime;
+  clock_t myStartClock;
+  Timer myTimer;
+  bool myIsLoaded;
+  size_t myNvar, myNsq;
+  gsl_vector *myX;
+  gsl_vector *myParam;
+  gsl_vector *myExtra;
+
+  static gsl_vector *resizeVector( gsl_vector *v, size_t size );
+public:
+  /** Method-specific scalars (e.g., the damping parameter of LM) */
+  double aux[SLRA_CHKPT_NAUX];
+
+  /** Creates a checkpoint with the file name and frequency given in opt */
+  Checkpoint( const OptimizationOptions *opt );
+  virtual ~Checkpoint();
+
+  /** Reads the checkpoint file and restores in opt the options
+   * that determine the iterations (method, tolerances, ...).
+   * @return false if the file does not exist */
+  bool load( OptimizationOptions *opt );
+  /** Returns true if the state was loaded from the file */
+  bool isLoaded() const { return myIsLoaded; }
+  /** Restores the loaded state of the parametrization of F and the point x */
+  void restore( NLSFunction *F, gsl_vector *x );
+  /** Returns the saved iteration count */
+  size_t getIter() const { return myLastIter; }
+  /** Returns the time spent before the loaded checkpoint was saved */
+  double getPriorTime() const { return myPriorTime; }
+  /** Returns the method-specific vector, reallocated if its size differs */
+  gsl_vector *getExtra( size_t size );
+  /** Returns the loaded method-specific vector (NULL if absent) */
+  const gsl_vector *getExtra() const { return myExtra; }
+
+  /** Checks whether the checkpoint should be saved after the iteration */
+  bool isDue( size_t iter );
+  /** Saves the state at the end of the iteration opt->iter */
+  void save( const OptimizationOptions *opt, NLSFunction *F,
+             const gsl_vector *x );
+};
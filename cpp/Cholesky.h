@@ -32,4 +32,41 @@ public:
    * @param[in,out] yr vector \f$y_r \in \mathbb{R}^{P}\f$, where \f${P} \le nd\f$
    */
   virtual void multInvGammaVector( gsl_vector * y_r ) = 0;                
+
+  /** Computes the Cholesky factor and \f$f = \|\mathrm{L}_{\Gamma}^{-\top} y_r\|^2\f$
+   * with an early abort.
+   * The partial sum of squares grows monotonically during the forward 
+   * substitution, so an implementation may stop the factorization and 
+   * the substitution as soon as the partial sum exceeds `bound`. 
+   * The default implementation computes everything.
+   * @param[in] Rt        the matrix \f$R^{\top} \in \mathbb{R}^{m \times d}\f$.
+   * @param[in] reg       a regularization parameter \f$\gamma\f$
+   *                      (see calcGammaCholesky()).
+   * @param[in,out] yr    vector \f$y_r \in \mathbb{R}^{nd}\f$, on exit
+   *                      \f$\mathrm{L}_{\Gamma}^{-\top} y_r\f$
+   * @param[in]  bound    threshold on \f$f\f$
+   * @param[out] f        \f$f\f$, or a partial sum \f$> \mathrm{bound}\f$
+   * @return `true` if \f$f \le \mathrm{bound}\f$. If `false` is returned, 
+   * the stored factor and \f$y_r\f$ may be incomplete.
+   */
+  virtual bool calcGammaCholeskyBounded( const gsl_matrix *Rt, double reg,
+                                         gsl_vector *yr, double bound, 
+                                         double *f ) {
+    calcGammaCholesky(Rt, reg);
+    multInvCholeskyVector(yr, 1);
+    gsl_blas_ddot(yr, yr, f);
+    return *f <= bound;
+  }
+
+  /** Computes \f$f = \|\mathrm{L}_{\Gamma}^{-\top} y_r\|^2\f$ for a 
+   * function-only evaluation. Implementations may assemble, factorize and
+   * forward-substitute in a single pass without storing the whole factor. 
+   * The default implementation calls calcGammaCholeskyBounded().
+   * The parameters are as in calcGammaCholeskyBounded(), but on exit
+   * the contents of `yr` and of the stored factor are undefined.
+   */
+  virtual bool calcFuncStreaming( const gsl_matrix *Rt, double reg,
+                                  gsl_vector *yr, double bound, double *f ) {
+    return calcGammaCholeskyBounded(Rt, reg, yr, bound, f);
+  }
 };
\ No newline at end of file
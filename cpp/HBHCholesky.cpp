@@ -0,0 +1,81 @@
+#include <memory.h>
+#include <cstdarg>
+#include "slra.h"
+
+HBHCholesky::HBHCholesky( const HBHLayeredBlWStructure *s, size_t d ) :
+    MuDependentCholesky(s, d), myHBHStruct(s),
+    myMu1(s->getMu1()), myMu2(s->getMu2()) {
+  myGammaD = new gsl_matrix*[myMu1 * (2 * myMu2 - 1)];
+  for (size_t k = 0; k < myMu1 * (2 * myMu2 - 1); k++) {
+    myGammaD[k] = gsl_matrix_alloc(d, d);
+  }
+}
+
+HBHCholesky::~HBHCholesky() {
+  for (size_t k = 0; k < myMu1 * (2 * myMu2 - 1); k++) {
+    gsl_matrix_free(myGammaD[k]);
+  }
+  delete [] myGammaD;
+}
+
+void HBHCholesky::computeGammaD( const gsl_matrix *Rt ) {
+  for (long d_1 = 0; d_1 < (long)myMu1; d_1++) {
+    for (long d_2 = 1 - (long)myMu2; d_2 < (long)myMu2; d_2++) {
+      myHBHStruct->AtVdB(myGammaD[d_1 * (2 * myMu2 - 1) + d_2 + myMu2 - 1],
+                         d_1, d_2, Rt, Rt);
+    }
+  }
+}
+
+const gsl_matrix *HBHCholesky::getGammaBlock( size_t i_1, size_t j_1 ) const {
+  size_t n2 = myHBHStruct->getN2();
+  long d_1 = j_1 / n2 - i_1 / n2, d_2 = (long)(j_1 % n2) - (long)(i_1 % n2);
+
+  if (d_1 >= (long)myMu1 || labs(d_2) >= (long)myMu2) {
+    return NULL;
+  }
+  return myGammaD[d_1 * (2 * myMu2 - 1) + d_2 + myMu2 - 1];
+}
+
+void HBHCholesky::computeGammaBlock( gsl_matrix *gam,
+                                     const gsl_matrix * /* Rt */,
+                                     size_t i_1, size_t j_1, double reg ) {
+  const gsl_matrix *gam_d = getGammaBlock(i_1, j_1);
+
+  if (gam_d == NULL) {
+    gsl_matrix_set_zero(gam);
+    return;
+  }
+  gsl_matrix_memcpy(gam, gam_d);
+  if (i_1 == j_1 && reg > 0) {
+    gsl_vector diag = gsl_matrix_diagonal(gam).vector;
+    gsl_vector_add_constant(&diag, reg);
+  }
+}
+
+void HBHCholesky::computeGammaUpperTrg( const gsl_matrix *Rt, double reg ) {
+  size_t d = getD(), n = getN(), mu = getMu(), r, s, i, j;
+
+  computeGammaD(Rt);
+  /* The element (s*d+i, r*d+j) of the upper triangle is stored in the
+   * column r*d+j of the DPBTRF band storage at the row s*d+i-r*d-j+d*mu-1 */
+  memset(myPackedCholesky, 0, myDN * myDMu * sizeof(double));
+  for (r = 0; r < n; r++) {
+    for (s = (r + 1 > mu ? r + 1 - mu : 0); s <= r; s++) {
+      const gsl_matrix *gam = getGammaBlock(s, r);
+      if (gam == NULL) {
+        continue;
+      }
+      for (j = 0; j < d; j++) {
+        double *col = myPackedCholesky + (r * d + j) * myDMu + myDMu - 1
+                      - (r - s) * d - j;
+        for (i = 0; i < (s < r ? d : j + 1); i++) {
+          col[i] = gsl_matrix_get(gam, i, j);
+        }
+        if (s == r && reg > 0) {
+          col[j] += reg;
+        }
+      }
+    }
+  }
+}
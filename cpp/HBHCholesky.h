@@ -0,0 +1,39 @@
+/** Implementation of Cholesky class for the HBHLayeredBlWStructure.
+ * A descendant of MuDependentCholesky. Since
+ * \f$\Gamma_{\#ij} = \Gamma_{\delta}\f$ depends only on
+ * \f$\delta = (j_1 - i_1, j_2 - i_2)\f$, only the
+ * \f$\mu_1 (2\mu_2 - 1)\f$ nonzero blocks \f$\Gamma_{\delta}\f$,
+ * \f$0 \le \delta_1 < \mu_1\f$, \f$|\delta_2| < \mu_2\f$, are computed,
+ * and the band of \f$\Gamma(R)\f$ is filled by copying them.
+ *
+ * The Cholesky factor of the block-banded matrix with banded blocks
+ * fills the whole outer band, so the factorization itself is the banded
+ * one (DPBTRF) with \f$\mu = (\mu_1-1)n_2 + \mu_2\f$.
+ */
+class HBHCholesky : public MuDependentCholesky {
+  const HBHLayeredBlWStructure *myHBHStruct;
+  size_t myMu1, myMu2;
+  gsl_matrix **myGammaD;      /* Gamma_delta */
+
+  /* Returns Gamma_{#ij}, i <= j, or NULL if it is zero */
+  const gsl_matrix *getGammaBlock( size_t i_1, size_t j_1 ) const;
+  /* Computes all the nonzero Gamma_delta */
+  void computeGammaD( const gsl_matrix *Rt );
+public:
+  /** Constructs the HBHCholesky object.
+   * @param[in] s     Pointer to the corresponding HBHLayeredBlWStructure.
+   * @param[in] d     number of rows \f$d\f$ of  the matrix \f$R\f$ */
+  HBHCholesky( const HBHLayeredBlWStructure *s, size_t d );
+  virtual ~HBHCholesky();
+
+protected:
+  /** Fills the band of \f$\Gamma(R)\f$ from \f$\Gamma_{\delta}\f$ */
+  virtual void computeGammaUpperTrg( const gsl_matrix *Rt, double reg = 0 );
+  /** Computes all \f$\Gamma_{\delta}\f$ */
+  virtual void prepareGammaBlocks( const gsl_matrix *Rt, double /* reg */ ) {
+    computeGammaD(Rt);
+  }
+  /** Copies \f$\Gamma_{\#ij} = \Gamma_{\delta}\f$ */
+  virtual void computeGammaBlock( gsl_matrix *gam, const gsl_matrix *Rt,
+                                  size_t i_1, size_t j_1, double reg );
+};
@@ -0,0 +1,94 @@
+#include <memory.h>
+extern "C" {
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_math.h>
+}
+#include "slra.h"
+
+HBHDGamma::HBHDGamma( const HBHLayeredBlWStructure *s, size_t d ) :
+    myStruct(s), myD(d), myMu1(s->getMu1()), myMu2(s->getMu2()) {
+  myVdR = gsl_matrix_alloc(myStruct->getM(), myD);
+  myN_d = gsl_matrix_alloc(myD, myD);
+  myRVdPhi = gsl_matrix_alloc((2 * myMu1 - 1) * (2 * myMu2 - 1), myD);
+  myEye = gsl_matrix_alloc(myStruct->getM(), myStruct->getM());
+  gsl_matrix_set_identity(myEye);
+}
+
+HBHDGamma::~HBHDGamma() {
+  gsl_matrix_free(myVdR);
+  gsl_matrix_free(myN_d);
+  gsl_matrix_free(myRVdPhi);
+  gsl_matrix_free(myEye);
+}
+
+void HBHDGamma::computeN( const gsl_matrix *Yt, long d_1, long d_2 ) {
+  size_t n2 = myStruct->getN2(), n1 = Yt->size1 / n2, cnt = n2 - labs(d_2);
+
+  gsl_matrix_set_zero(myN_d);
+  for (size_t j1 = 0; j1 + d_1 < n1; j1++) {
+    gsl_matrix YI = gsl_matrix_const_submatrix(Yt,
+        (j1 + d_1) * n2 + mymax(d_2, 0), 0, cnt, myD).matrix;
+    gsl_matrix YJ = gsl_matrix_const_submatrix(Yt,
+        j1 * n2 + mymax(-d_2, 0), 0, cnt, myD).matrix;
+    gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, &YI, &YJ, 1.0, myN_d);
+  }
+}
+
+void HBHDGamma::calcYtDgammaY( gsl_matrix *At, const gsl_matrix *Rt,
+                               const gsl_matrix *Yt ) {
+  gsl_matrix_set_zero(At);
+  for (long d_1 = 0; d_1 < (long)myMu1; d_1++) {
+    for (long d_2 = (d_1 > 0 ? 1 - (long)myMu2 : 0); d_2 < (long)myMu2; d_2++) {
+      computeN(Yt, d_1, d_2);
+      myStruct->VdB(myVdR, d_1, d_2, Rt);
+      gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 2.0, myVdR, myN_d, 1.0, At);
+      if (d_1 > 0 || d_2 > 0) {
+        myStruct->VdB(myVdR, -d_1, -d_2, Rt);
+        gsl_blas_dgemm(CblasNoTrans, CblasTrans, 2.0, myVdR, myN_d, 1.0, At);
+      }
+    }
+  }
+}
+
+void HBHDGamma::calcDijGammaYr( gsl_vector *z, const gsl_matrix *Rt,
+         size_t j_1, size_t i_1, const gsl_vector *y, const gsl_matrix *Phi ) {
+  gsl_vector e_j = gsl_matrix_const_row(Phi != NULL ? Phi : myEye, j_1).vector;
+  long n2 = myStruct->getN2(), n1 = y->size / myD / n2, k1, k2, d_1, d_2, t;
+
+  for (d_1 = 1 - (long)myMu1; d_1 < (long)myMu1; d_1++) {
+    for (d_2 = 1 - (long)myMu2; d_2 < (long)myMu2; d_2++) {
+      gsl_vector g = gsl_matrix_row(myRVdPhi, getDeltaInd(d_1, d_2)).vector;
+      myStruct->AtVdV(&g, d_1, d_2, Rt, &e_j);
+    }
+  }
+
+  /* z_k += y_{k+delta,i} R V_delta Phi_j^T,
+   * z_{k,i} += y_{k+delta}^T R V_{-delta} Phi_j^T */
+  gsl_vector_set_zero(z);
+  for (k1 = 0; k1 < n1; k1++) {
+    for (k2 = 0; k2 < n2; k2++) {
+      double *z_k = z->data + (k1 * n2 + k2) * myD * z->stride;
+      for (d_1 = mymax(1 - (long)myMu1, -k1);
+           d_1 < mymin((long)myMu1, n1 - k1); d_1++) {
+        for (d_2 = mymax(1 - (long)myMu2, -k2);
+             d_2 < mymin((long)myMu2, n2 - k2); d_2++) {
+          const double *y_l = y->data +
+                              ((k1 + d_1) * n2 + k2 + d_2) * myD * y->stride;
+          const double *g = gsl_matrix_const_ptr(myRVdPhi,
+                                getDeltaInd(d_1, d_2), 0);
+          const double *g_neg = gsl_matrix_const_ptr(myRVdPhi,
+                                    getDeltaInd(-d_1, -d_2), 0);
+          double y_li = y_l[i_1 * y->stride], s = 0;
+          for (t = 0; t < (long)myD; t++) {
+            z_k[t * z->stride] += y_li * g[t];
+            s += g_neg[t] * y_l[t * y->stride];
+          }
+          z_k[i_1 * z->stride] += s;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,37 @@
+/** Implementation of DGamma class for the HBHLayeredBlWStructure.
+ * HBHDGamma::calcYtDgammaY() groups the terms of
+ * MuDependentDGamma::calcYtDgammaY() by \f$\delta = i - j\f$, as in
+ * StationaryDGamma: \f$A^{\top} = 2 \sum_{\delta} \mathrm{V}_{\delta} R^{\top} N_{\delta}\f$,
+ * where \f$N_{\delta} = \sum_{j} y_{j+\delta} y_j^{\top}\f$ and the sum is over the
+ * \f$(2\mu_1-1)(2\mu_2-1)\f$ nonzero \f$\mathrm{V}_{\delta}\f$.
+ * Similarly, HBHDGamma::calcDijGammaYr() uses the precomputed vectors
+ * \f$R \mathrm{V}_{\delta} \Phi_{j,:}^{\top}\f$.
+ */
+class HBHDGamma : public DGamma {
+  const HBHLayeredBlWStructure *myStruct;
+  size_t myD, myMu1, myMu2;
+  gsl_matrix *myVdR;          /* V_delta R^T */
+  gsl_matrix *myN_d;          /* N_delta */
+  gsl_matrix *myRVdPhi;       /* R V_delta Phi_{j,:}^T for all delta (rows) */
+  gsl_matrix *myEye;
+
+  size_t getDeltaInd( long d_1, long d_2 ) const {
+    return (d_1 + myMu1 - 1) * (2 * myMu2 - 1) + d_2 + myMu2 - 1;
+  }
+  /* Computes N_delta for d_1 >= 0 */
+  void computeN( const gsl_matrix *Yt, long d_1, long d_2 );
+public:
+  /** Constructs a HBHDGamma object.
+   * @copydetails HBHCholesky::HBHCholesky */
+  HBHDGamma( const HBHLayeredBlWStructure *s, size_t d );
+  virtual ~HBHDGamma();
+
+  /** @name Implementing DGamma interface */
+  /**@{*/
+  virtual void calcYtDgammaY( gsl_matrix *At, const gsl_matrix *Rt,
+                              const gsl_matrix *Yt );
+  virtual void calcDijGammaYr( gsl_vector *z, const gsl_matrix *Rt,
+                   size_t j_1, size_t i_1, const gsl_vector *y,
+                   const gsl_matrix *Phi = NULL );
+  /**@}*/
+};
@@ -0,0 +1,191 @@
+#include <limits>
+#include <memory.h>
+#include <math.h>
+#include <cstdarg>
+#include "slra.h"
+
+HBHLayeredBlWStructure::HBHLayeredBlWStructure( const double *m1_vec,
+    const double *m2_vec, size_t q, size_t n1, size_t n2,
+    const double *w_vec ) : myQ(q), myN1(n1), myN2(n2), myLayers(NULL) {
+  if (myQ == 0 || myN1 == 0 || myN2 == 0) {
+    throw new Exception("Incorrect sizes of the 2-D structure\n");
+  }
+  double missing_inv_w = (w_vec != NULL) ? missingInvWeight(w_vec, q) : 1.0;
+  myLayers = new Layer[myQ];
+  myM = myNp = 0;
+  myMu1 = myMu2 = 1;
+  for (size_t l_1 = 0; l_1 < myQ; ++l_1) {
+    if (!(m1_vec[l_1] >= 1 && m2_vec[l_1] >= 1)) {
+      delete [] myLayers;
+      throw new Exception("Incorrect block size of the 2-D structure\n");
+    }
+    myLayers[l_1].m1 = m1_vec[l_1];
+    myLayers[l_1].m2 = m2_vec[l_1];
+    myLayers[l_1].missing = (w_vec != NULL && w_vec[l_1] == 0);
+    myLayers[l_1].inv_w = (w_vec == NULL) ? 1.0 : 
+        (myLayers[l_1].missing ? missing_inv_w : (1 / w_vec[l_1]));
+    myM += myLayers[l_1].m1 * myLayers[l_1].m2;
+    myNp += getLayerNp(l_1);
+    if (!isLayerExact(l_1)) {
+      myMu1 = mymax(myMu1, myLayers[l_1].m1);
+      myMu2 = mymax(myMu2, myLayers[l_1].m2);
+    }
+  }
+  myMu1 = mymin(myMu1, myN1);
+  myMu2 = mymin(myMu2, myN2);
+}
+
+HBHLayeredBlWStructure::~HBHLayeredBlWStructure() {
+  if (myLayers != NULL) {
+    delete [] myLayers;
+  }
+}
+
+void HBHLayeredBlWStructure::fillMatrixFromP( gsl_matrix* c,
+                                              const gsl_vector* p ) {
+  size_t l, a1, a2, j1, sum_np = 0, sum_m = 0;
+
+  for (l = 0; l < myQ; sum_np += getLayerNp(l),
+       sum_m += myLayers[l].m1 * myLayers[l].m2, ++l) {
+    size_t m1 = myLayers[l].m1, m2 = myLayers[l].m2, np2 = m2 + myN2 - 1;
+    for (a1 = 0; a1 < m1; a1++) {
+      for (a2 = 0; a2 < m2; a2++) {
+        for (j1 = 0; j1 < myN1; j1++) {
+          gsl_vector_const_view psub = gsl_vector_const_subvector(p,
+              sum_np + (a1 + j1) * np2 + a2, myN2);
+          gsl_matrix_view csub = gsl_matrix_submatrix(c, j1 * myN2,
+              sum_m + a1 * m2 + a2, myN2, 1);
+          gsl_vector_view ccol = gsl_matrix_column(&csub.matrix, 0);
+          gsl_vector_memcpy(&ccol.vector, &psub.vector);
+        }
+      }
+    }
+  }
+}
+
+void HBHLayeredBlWStructure::multByGtUnweighted( gsl_vector* p,
+          const gsl_matrix *Rt, const gsl_vector *y,
+          double alpha, double beta, bool skipFixedBlocks ) {
+  size_t l, a1, j1, j2, sum_np = 0, sum_m = 0, D = Rt->size2;
+  gsl_matrix Y = gsl_matrix_const_view_vector(y, getN(), D).matrix;
+
+  for (l = 0; l < myQ; sum_np += getLayerNp(l),
+       sum_m += myLayers[l].m1 * myLayers[l].m2, ++l) {
+    if (skipFixedBlocks && isLayerExact(l)) {
+      continue;
+    }
+    size_t m1 = myLayers[l].m1, m2 = myLayers[l].m2, np2 = m2 + myN2 - 1;
+    gsl_vector p_l = gsl_vector_subvector(p, sum_np, getLayerNp(l)).vector;
+    if (beta != 1) {
+      gsl_vector_scale(&p_l, beta);
+    }
+    for (a1 = 0; a1 < m1; a1++) {
+      gsl_matrix RtSub = gsl_matrix_const_submatrix(Rt, sum_m + a1 * m2, 0,
+                                                    m2, D).matrix;
+      for (j1 = 0; j1 < myN1; j1++) {
+        for (j2 = 0; j2 < myN2; j2++) {
+          gsl_vector psub = gsl_vector_subvector(&p_l,
+                                (a1 + j1) * np2 + j2, m2).vector;
+          gsl_vector Y_row = gsl_matrix_row(&Y, j1 * myN2 + j2).vector;
+          gsl_blas_dgemv(CblasNoTrans, alpha, &RtSub, &Y_row, 1.0, &psub);
+        }
+      }
+    }
+  }
+}
+
+void HBHLayeredBlWStructure::multByWInv( gsl_vector* p, long deg ) const {
+  size_t l, sum_np = 0;
+  gsl_vector psub;
+
+  if (deg == 0) {
+    return;
+  }
+  for (l = 0; l < myQ; sum_np += getLayerNp(l), ++l) {
+    psub = gsl_vector_subvector(p, sum_np, getLayerNp(l)).vector;
+    gsl_vector_scale(&psub, (deg == 2) ? myLayers[l].inv_w :
+                                         sqrt(myLayers[l].inv_w));
+  }
+}
+
+void HBHLayeredBlWStructure::VdB( gsl_matrix *X, long d_1, long d_2,
+                                  const gsl_matrix *B ) const {
+  size_t l, b1, sum_m = 0;
+
+  gsl_matrix_set_zero(X);
+  for (l = 0; l < myQ; sum_m += myLayers[l].m1 * myLayers[l].m2, ++l) {
+    long m1 = myLayers[l].m1, m2 = myLayers[l].m2;
+    if (isLayerExact(l) || labs(d_1) >= m1 || labs(d_2) >= m2) {
+      continue;
+    }
+    size_t cnt = m2 - labs(d_2);
+    for (b1 = mymax(-d_1, 0); (long)b1 < m1 - mymax(d_1, 0); b1++) {
+      gsl_matrix X_sub = gsl_matrix_submatrix(X,
+          sum_m + (b1 + d_1) * m2 + mymax(d_2, 0), 0, cnt, X->size2).matrix;
+      gsl_matrix B_sub = gsl_matrix_const_submatrix(B,
+          sum_m + b1 * m2 + mymax(-d_2, 0), 0, cnt, B->size2).matrix;
+      gsl_matrix_memcpy(&X_sub, &B_sub);
+      gsl_matrix_scale(&X_sub, myLayers[l].inv_w);
+    }
+  }
+}
+
+void HBHLayeredBlWStructure::AtVdB( gsl_matrix *X, long d_1, long d_2,
+         const gsl_matrix *A, const gsl_matrix *B, double beta ) const {
+  size_t l, b1, sum_m = 0;
+
+  gsl_matrix_scale(X, beta);
+  for (l = 0; l < myQ; sum_m += myLayers[l].m1 * myLayers[l].m2, ++l) {
+    long m1 = myLayers[l].m1, m2 = myLayers[l].m2;
+    if (isLayerExact(l) || labs(d_1) >= m1 || labs(d_2) >= m2) {
+      continue;
+    }
+    size_t cnt = m2 - labs(d_2);
+    for (b1 = mymax(-d_1, 0); (long)b1 < m1 - mymax(d_1, 0); b1++) {
+      gsl_matrix A_sub = gsl_matrix_const_submatrix(A,
+          sum_m + (b1 + d_1) * m2 + mymax(d_2, 0), 0, cnt, A->size2).matrix;
+      gsl_matrix B_sub = gsl_matrix_const_submatrix(B,
+          sum_m + b1 * m2 + mymax(-d_2, 0), 0, cnt, B->size2).matrix;
+      gsl_blas_dgemm(CblasTrans, CblasNoTrans, myLayers[l].inv_w,
+                     &A_sub, &B_sub, 1.0, X);
+    }
+  }
+}
+
+void HBHLayeredBlWStructure::AtVdV( gsl_vector *u, long d_1, long d_2,
+         const gsl_matrix *A, const gsl_vector *v, double beta ) const {
+  size_t l, b1, sum_m = 0;
+
+  gsl_vector_scale(u, beta);
+  for (l = 0; l < myQ; sum_m += myLayers[l].m1 * myLayers[l].m2, ++l) {
+    long m1 = myLayers[l].m1, m2 = myLayers[l].m2;
+    if (isLayerExact(l) || labs(d_1) >= m1 || labs(d_2) >= m2) {
+      continue;
+    }
+    size_t cnt = m2 - labs(d_2);
+    for (b1 = mymax(-d_1, 0); (long)b1 < m1 - mymax(d_1, 0); b1++) {
+      gsl_matrix A_sub = gsl_matrix_const_submatrix(A,
+          sum_m + (b1 + d_1) * m2 + mymax(d_2, 0), 0, cnt, A->size2).matrix;
+      gsl_vector v_sub = gsl_vector_const_subvector(v,
+          sum_m + b1 * m2 + mymax(-d_2, 0), cnt).vector;
+      gsl_blas_dgemv(CblasTrans, myLayers[l].inv_w, &A_sub, &v_sub, 1.0, u);
+    }
+  }
+}
+
+bool HBHLayeredBlWStructure::isMissing( size_t k ) const {
+  size_t l_1, sum_np = 0;
+
+  for (l_1 = 0; l_1 < myQ && sum_np + getLayerNp(l_1) <= k; ++l_1) {
+    sum_np += getLayerNp(l_1);
+  }
+  return l_1 < myQ && myLayers[l_1].missing;
+}
+
+Cholesky *HBHLayeredBlWStructure::createCholesky( size_t d ) const {
+  return new HBHCholesky(this, d);
+}
+
+DGamma *HBHLayeredBlWStructure::createDGamma( size_t d ) const {
+  return new HBHDGamma(this, d);
+}
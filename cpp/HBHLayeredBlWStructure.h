@@ -0,0 +1,121 @@
+/** Layered two-dimensional (Hankel-block-Hankel) structure with blockwise weights.
+ * Each layer is a block-Hankel matrix with Hankel blocks
+ * \f[
+ * \mathscr{H}^{(l)}(p^{(l)}) = \begin{bmatrix}
+ *   \mathscr{H}_{m^{(l)}_2,n_2}(p^{(l)}_1) & \cdots & \mathscr{H}_{m^{(l)}_2,n_2}(p^{(l)}_{n_1}) \\
+ *   \vdots & & \vdots \\
+ *   \mathscr{H}_{m^{(l)}_2,n_2}(p^{(l)}_{m^{(l)}_1}) & \cdots &
+ *   \mathscr{H}_{m^{(l)}_2,n_2}(p^{(l)}_{m^{(l)}_1+n_1-1})
+ * \end{bmatrix} \in \mathbb{R}^{m^{(l)}_1 m^{(l)}_2 \times n_1 n_2},
+ * \f]
+ * where \f$p^{(l)} = \mathrm{col}(p^{(l)}_1, \ldots, p^{(l)}_{m^{(l)}_1+n_1-1})\f$,
+ * \f$p^{(l)}_k \in \mathbb{R}^{m^{(l)}_2+n_2-1}\f$, i.e. \f$p^{(l)}\f$ is
+ * the vectorized \f$(m^{(l)}_2+n_2-1) \times (m^{(l)}_1+n_1-1)\f$ array
+ * (2-D signal). The layers are stacked as in HLayeredBlWStructure, and
+ * \f$\omega_l\f$ is the weight of the \f$l\f$-th layer.
+ *
+ * The column \f$j = j_1 n_2 + j_2\f$ of the matrix corresponds to the
+ * 2-D index \f$(j_1, j_2)\f$. The matrix \f$\mathrm{V}_{\#ij}\f$ depends
+ * only on \f$\delta = (j_1 - i_1, j_2 - i_2)\f$ (see VdB()), and is zero if
+ * \f$|\delta_1| \ge \mu_1\f$ or \f$|\delta_2| \ge \mu_2\f$, where
+ * \f$\mu_k = \max_l m^{(l)}_k\f$. Hence \f$\Gamma(R)\f$ is block-banded
+ * with \f$\mu_1\f$ block diagonals of \f$n_2 \times n_2\f$ blocks, which
+ * are themselves block-banded with \f$\mu_2\f$ block diagonals, and
+ * the structure is \f$\mu\f$-dependent with \f$\mu = (\mu_1-1)n_2 + \mu_2\f$.
+ */
+class HBHLayeredBlWStructure : public MuDependentStructure {
+  typedef struct {
+    size_t m1, m2;              /* Block sizes m^{(l)}_1, m^{(l)}_2 */
+    double inv_w;               /* Inverse of the weight */
+    bool missing;               /* Missing values (zero weight) */
+  } Layer;
+
+  size_t myQ, myN1, myN2, myM, myNp, myMu1, myMu2;
+  Layer *myLayers;
+public:
+  /** Constructs the HBHLayeredBlWStructure object.
+   * @param[in] m1_vec \f$\begin{bmatrix}m^{(1)}_1 & \cdots & m^{(q)}_1\end{bmatrix}\f$
+   * @param[in] m2_vec \f$\begin{bmatrix}m^{(1)}_2 & \cdots & m^{(q)}_2\end{bmatrix}\f$
+   * @param[in] q      number of layers \f$q\f$
+   * @param[in] n1     number of block columns \f$n_1\f$
+   * @param[in] n2     number of columns \f$n_2\f$ in a block
+   * @param[in] w_vec  vector of weights
+   * \f${\bf w} =\begin{bmatrix} \omega_1 & \cdots & \omega_q \end{bmatrix}^{\top}\f$.
+   * If `w_vec == NULL` then \f${\bf w}\f$ is set to be
+   * \f$\begin{bmatrix}1&\cdots&1\end{bmatrix}^{\top}\f$.
+   * A layer with \f$\omega_l = 0\f$ is missing (see Structure::isMissing()). */
+  HBHLayeredBlWStructure( const double *m1_vec, const double *m2_vec,
+                          size_t q, size_t n1, size_t n2,
+                          const double *w_vec = NULL );
+  virtual ~HBHLayeredBlWStructure();
+
+  /** @name Implementing Structure interface */
+  /**@{*/
+  virtual size_t getM() const { return myM; }
+  virtual size_t getN() const { return myN1 * myN2; }
+  virtual size_t getNp() const { return myNp; }
+  virtual Cholesky *createCholesky( size_t d ) const;
+  virtual DGamma *createDGamma( size_t d ) const;
+  virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p );
+  virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
+                                   const gsl_vector *y,
+                                   double alpha = -1, double beta = 1,
+                                   bool skipFixedBlocks = true );
+  virtual void multByWInv( gsl_vector* p, long deg = 2 ) const;
+  virtual bool isMissing( size_t k ) const;
+  /**@}*/
+
+  /** @name Implementing MuDependentStructure interface */
+  /**@{*/
+  virtual size_t getMu() const { return (myMu1 - 1) * myN2 + myMu2; }
+  virtual void VijB( gsl_matrix *X, long i_1, long j_1,
+                     const gsl_matrix *B ) const {
+    VdB(X, j_1 / (long)myN2 - i_1 / (long)myN2,
+           j_1 % (long)myN2 - i_1 % (long)myN2, B);
+  }
+  virtual void AtVijB( gsl_matrix *X, long i_1, long j_1,
+                      const gsl_matrix *A, const gsl_matrix *B,
+                      gsl_matrix * /* tmpVijB */, double beta = 0 ) const {
+    AtVdB(X, j_1 / (long)myN2 - i_1 / (long)myN2,
+             j_1 % (long)myN2 - i_1 % (long)myN2, A, B, beta);
+  }
+  virtual void AtVijV( gsl_vector *u, long i_1, long j_1,
+                      const gsl_matrix *A, const gsl_vector *v,
+                      gsl_vector * /* tmpVijV */, double beta = 0 ) const {
+    AtVdV(u, j_1 / (long)myN2 - i_1 / (long)myN2,
+             j_1 % (long)myN2 - i_1 % (long)myN2, A, v, beta);
+  }
+  /**@}*/
+
+  /** @name HBHLayeredBlWStructure-specific methods */
+  /**@{*/
+  /** Returns \f$X \leftarrow \mathrm{V}_{\delta} B\f$, where
+   * \f$\mathrm{V}_{\delta} = \mathrm{V}_{\#ij}\f$ for
+   * \f$\delta = (\delta_1, \delta_2) = (j_1 - i_1, j_2 - i_2)\f$. */
+  void VdB( gsl_matrix *X, long d_1, long d_2, const gsl_matrix *B ) const;
+  /** Updates \f$X \leftarrow \beta X + A^{\top} \mathrm{V}_{\delta} B\f$ */
+  void AtVdB( gsl_matrix *X, long d_1, long d_2, const gsl_matrix *A,
+              const gsl_matrix *B, double beta = 0 ) const;
+  /** Updates \f$u \leftarrow \beta u + A^{\top} \mathrm{V}_{\delta} v\f$ */
+  void AtVdV( gsl_vector *u, long d_1, long d_2, const gsl_matrix *A,
+              const gsl_vector *v, double beta = 0 ) const;
+
+  /** Returns \f$n_1\f$ */
+  size_t getN1() const { return myN1; }
+  /** Returns \f$n_2\f$ */
+  size_t getN2() const { return myN2; }
+  /** Returns \f$\mu_1\f$ (\f$\mathrm{V}_{\delta} = 0\f$ for \f$|\delta_1| \ge \mu_1\f$) */
+  size_t getMu1() const { return myMu1; }
+  /** Returns \f$\mu_2\f$ (\f$\mathrm{V}_{\delta} = 0\f$ for \f$|\delta_2| \ge \mu_2\f$) */
+  size_t getMu2() const { return myMu2; }
+  /** Returns \f$q\f$ */
+  size_t getQ() const { return myQ; }
+  /** Returns the number of parameters \f$(m^{(l)}_1+n_1-1)(m^{(l)}_2+n_2-1)\f$
+   * of the layer \f$l = l_1 + 1\f$ */
+  size_t getLayerNp( size_t l_1 ) const {
+    return (myLayers[l_1].m1 + myN1 - 1) * (myLayers[l_1].m2 + myN2 - 1);
+  }
+  /** Checks whether \f$\omega_{l}=\infty\f$ (layer is fixed) */
+  bool isLayerExact( size_t l_1 ) const { return myLayers[l_1].inv_w == 0.0; }
+  /**@}*/
+};
@@ -0,0 +1,180 @@
+#include "slra.h"
+
+HLayeredBandWStructure::HLayeredBandWStructure( const double *m_vec,
+    size_t q, size_t n, const gsl_matrix *bands ) :
+    myBase(m_vec, q, n, NULL), myVk(NULL), myFactor(NULL) {
+  size_t l, k;
+
+  if (bands == NULL || bands->size1 != q || bands->size2 < 1) {
+    throw new Exception("Incorrect band specification of the weights\n");
+  }
+  myBands = gsl_matrix_alloc(bands->size1, bands->size2);
+  gsl_matrix_memcpy(myBands, bands);
+  myLayerBw = new size_t[getQ()];
+  for (l = 0, myMu = 1; l < getQ(); l++) {
+    for (k = myLayerBw[l] = 0; k < myBands->size2 && k < getLayerNp(l); k++) {
+      if (gsl_matrix_get(myBands, l, k) != 0.0) {
+        myLayerBw[l] = k;
+      }
+    }
+    myMu = mymax(myMu, getLayerLag(l) + myLayerBw[l]);
+  }
+  myMu = mymin(myMu, getN());
+
+  try {
+    computeFactors();
+  } catch (Exception *e) {
+    gsl_matrix_free(myBands);
+    delete [] myLayerBw;
+    if (myFactor != NULL) {
+      delete [] myFactor;
+    }
+    throw;
+  }
+  computeVkParams();
+}
+
+HLayeredBandWStructure::~HLayeredBandWStructure() {
+  gsl_matrix_free(myBands);
+  delete [] myLayerBw;
+  delete [] myFactor;
+  if (myVk != NULL) {
+    for (size_t k = 0; k < myMu; k++) {
+      gsl_matrix_free(myVk[k]);
+    }
+    delete [] myVk;
+  }
+}
+
+void HLayeredBandWStructure::computeVkParams() {
+  size_t k, l, a, b, sum_nl;
+  long t;
+
+  myVk = new gsl_matrix*[myMu];
+  for (k = 0; k < myMu; k++) {
+    myVk[k] = gsl_matrix_calloc(getM(), getM());
+    for (sum_nl = 0, l = 0; l < getQ(); sum_nl += getLayerLag(l), ++l) {
+      /* (V_k)_{ab} = Cov(p_{i+a}, p_{i+k+b}) = c_{|a-b-k|} */
+      for (a = 0; a < getLayerLag(l); a++) {
+        for (b = 0; b < getLayerLag(l); b++) {
+          t = (long)a - (long)b - (long)k;
+          if (labs(t) <= (long)getLayerBandwidth(l)) {
+            gsl_matrix_set(myVk[k], sum_nl + a, sum_nl + b,
+                           getBandCoef(l, labs(t)));
+          }
+        }
+      }
+    }
+  }
+}
+
+void HLayeredBandWStructure::computeFactors() {
+  size_t l, s, t, kd, ldab, np, info = 0, size = 0;
+  double *ab;
+
+  for (l = 0; l < getQ(); l++) {
+    size += getLayerNp(l) * (getLayerBandwidth(l) + 1);
+  }
+  myFactor = new double[size];
+  for (l = 0, ab = myFactor; l < getQ(); ab += np * ldab, l++) {
+    np = getLayerNp(l);
+    kd = getLayerBandwidth(l);
+    ldab = kd + 1;
+    /* Upper banded storage: (W_l^{-1})_{st} = ab[t * ldab + kd + s - t] */
+    for (t = 0; t < np; t++) {
+      for (s = (t > kd ? t - kd : 0); s <= t; s++) {
+        ab[t * ldab + kd + s - t] = getBandCoef(l, t - s);
+      }
+    }
+    dpbtrf_("U", &np, &kd, ab, &ldab, &info);
+    if (info) {
+      throw new Exception("The banded inverse weight matrix of layer %d "
+                          "is not positive definite (DPBTRF info = %d).\n",
+                          l + 1, info);
+    }
+  }
+
+  /* VarproFunction treats the zero entries of W^{-1} 1 as fixed parameters */
+  gsl_vector *ones = gsl_vector_alloc(getNp());
+  gsl_vector_set_all(ones, 1);
+  multByWInv(ones, 2);
+  for (s = 0; s < getNp() && gsl_vector_get(ones, s) != 0.0; s++) {}
+  gsl_vector_free(ones);
+  if (s < getNp()) {
+    throw new Exception("Banded weights with zero row sums of the "
+                        "inverse weight matrix are not supported.\n");
+  }
+}
+
+void HLayeredBandWStructure::multByWInv( gsl_vector* p, long deg ) const {
+  size_t l, s, t, kd, ldab, np, sum_np = 0;
+  const double *ab = myFactor;
+  double sum;
+
+  if (deg == 0) {
+    return;
+  }
+  /* In place, without workspace (multistart shares the structure) */
+  for (l = 0; l < getQ(); sum_np += np, ab += np * ldab, ++l) {
+    np = getLayerNp(l);
+    kd = getLayerBandwidth(l);
+    ldab = kd + 1;
+    gsl_vector psub = gsl_vector_subvector(p, sum_np, np).vector;
+    /* p := U_l p, (U_l p)_s depends on p_t, t >= s */
+    for (s = 0; s < np; s++) {
+      for (t = s, sum = 0; t < np && t <= s + kd; t++) {
+        sum += ab[t * ldab + kd + s - t] * gsl_vector_get(&psub, t);
+      }
+      gsl_vector_set(&psub, s, sum);
+    }
+    if (deg != 2) {
+      continue;
+    }
+    /* p := U_l^T p, (U_l^T p)_s depends on p_t, t <= s */
+    for (s = np; s-- > 0; ) {
+      for (t = (s > kd ? s - kd : 0), sum = 0; t <= s; t++) {
+        sum += ab[s * ldab + kd + t - s] * gsl_vector_get(&psub, t);
+      }
+      gsl_vector_set(&psub, s, sum);
+    }
+  }
+}
+
+void HLayeredBandWStructure::VkB( gsl_matrix *X, long k,
+                                  const gsl_matrix *B ) const {
+  if ((size_t)labs(k) >= myMu) {
+    gsl_matrix_set_zero(X);
+    return;
+  }
+  gsl_blas_dgemm((k >= 0 ? CblasNoTrans : CblasTrans), CblasNoTrans, 1.0,
+                 myVk[labs(k)], B, 0.0, X);
+}
+
+void HLayeredBandWStructure::AtVkB( gsl_matrix *X, long k, const gsl_matrix *A,
+         const gsl_matrix *B, gsl_matrix *tmpVkB, double beta ) const {
+  VkB(tmpVkB, k, B);
+  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, A, tmpVkB, beta, X);
+}
+
+void HLayeredBandWStructure::AtVkV( gsl_vector *u, long k, const gsl_matrix *A,
+         const gsl_vector *v, gsl_vector *tmpVkV, double beta ) const {
+  if ((size_t)labs(k) >= myMu) {
+    gsl_vector_scale(u, beta);
+    return;
+  }
+  gsl_blas_dgemv((k >= 0 ? CblasNoTrans : CblasTrans), 1.0, myVk[labs(k)],
+                 v, 0.0, tmpVkV);
+  gsl_blas_dgemv(CblasTrans, 1.0, A, tmpVkV, beta, u);
+}
+
+Cholesky *HLayeredBandWStructure::createCholesky( size_t d ) const {
+#ifdef USE_SLICOT
+  return new StationaryCholeskySlicot(this, d);
+#else  /* USE_SLICOT */
+  return new StationaryCholesky(this, d);
+#endif /* USE_SLICOT */
+}
+
+DGamma *HLayeredBandWStructure::createDGamma( size_t d ) const {
+  return new StationaryDGamma(this, d);
+}
@@ -0,0 +1,98 @@
+/** Layered Hankel structure with banded inverse weight matrices.
+ * The layered Hankel structure \f$\mathscr{H}_{{\bf m}, n}\f$
+ * is defined in description of HLayeredBlWStructure.
+ *
+ * The weight matrix is \f$\mathrm{W} = \mathrm{blkdiag}(\mathrm{W}_1,\ldots,
+ * \mathrm{W}_q)\f$, where \f$\mathrm{W}_l^{-1}\f$ (the covariance of
+ * stationary MA-type noise in the \f$l\f$th layer) is the banded symmetric
+ * Toeplitz matrix
+ * \f$(\mathrm{W}_l^{-1})_{st} = c^{(l)}_{|s-t|}\f$ for \f$|s-t| \le b_l\f$,
+ * and \f$0\f$ otherwise. The cost function is \f$\|p-\widehat{p}\|^2_{\mathrm{W}}
+ * = (p-\widehat{p})^{\top} \mathrm{W} (p-\widehat{p})\f$.
+ *
+ * The pair (structure, weights) is stationary with
+ * \f$(\mathrm{V}_{k})_{(l,a),(l,b)} = c^{(l)}_{|a-b-k|}\f$, therefore
+ * \f$\Gamma(R)\f$ is block-banded with \f$\mu = \max_l (m_l + b_l)\f$,
+ * and StationaryCholesky and StationaryDGamma are used.
+ * multByWInv() uses the banded Cholesky factorization
+ * \f$\mathrm{W}_l^{-1} = \mathrm{U}_l^{\top} \mathrm{U}_l\f$, so that
+ * \f$\|\mathrm{U}_l g\|_2^2 = g^{\top} \mathrm{W}_l^{-1} g\f$.
+ * Fixed and missing values are not supported.
+ */
+class HLayeredBandWStructure : public StationaryStructure {
+  HLayeredBlWStructure myBase;
+  gsl_matrix *myBands;    /* Row l: c^{(l)}_0, ..., c^{(l)}_b */
+  size_t *myLayerBw;      /* b_l */
+  size_t myMu;
+  gsl_matrix **myVk;      /* V_0, ..., V_{mu-1} */
+  double *myFactor;       /* Upper banded factors U_l, LDAB = b_l + 1 */
+
+  void computeVkParams();
+  void computeFactors();
+public:
+  /** Constructs the HLayeredBandWStructure object.
+   * @param[in] m_vec \f${\bf m} = \begin{bmatrix}m_1 & \cdots & m_q\end{bmatrix}^{\top}\f$
+   * @param[in] q     number of blocks \f$q\f$
+   * @param[in] n     number of columns \f$n\f$
+   * @param[in] bands \f$q \times (b+1)\f$ matrix, the row \f$l\f$ of which
+   *                  is \f$(c^{(l)}_0, \ldots, c^{(l)}_b)\f$ (padded with
+   *                  zeros), \f$\mathrm{W}_l^{-1}\f$ should be positive
+   *                  definite. */
+  HLayeredBandWStructure( const double *m_vec, size_t q, size_t n,
+                          const gsl_matrix *bands );
+  virtual ~HLayeredBandWStructure();
+
+  /** @name Implementing Structure interface */
+  /**@{*/
+  virtual size_t getM() const { return myBase.getM(); }
+  virtual size_t getN() const { return myBase.getN(); }
+  virtual size_t getNp() const { return myBase.getNp(); }
+  virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p ) {
+    myBase.fillMatrixFromP(c, p);
+  }
+  virtual Cholesky *createCholesky( size_t d ) const;
+  virtual DGamma *createDGamma( size_t d ) const;
+  virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
+                                   const gsl_vector *y,
+                                   double alpha = -1, double beta = 1,
+                                   bool skipFixedBlocks = true ) {
+    myBase.multByGtUnweighted(p, Rt, y, alpha, beta, skipFixedBlocks);
+  }
+  /** For `deg == 1` computes \f$p^{(l)} \leftarrow \mathrm{U}_l p^{(l)}\f$,
+   * and for `deg == 2` \f$p^{(l)} \leftarrow \mathrm{U}_l^{\top}
+   * \mathrm{U}_l p^{(l)}\f$ */
+  virtual void multByWInv( gsl_vector* p, long deg = 2 ) const;
+  /**@}*/
+
+  /** @name Implementing StationaryStructure interface */
+  /**@{*/
+  virtual size_t getMu() const { return myMu; }
+  virtual void VkB( gsl_matrix *X, long k, const gsl_matrix *B ) const;
+  virtual void AtVkB( gsl_matrix *X, long k,
+                      const gsl_matrix *A, const gsl_matrix *B,
+                      gsl_matrix *tmpVkB, double beta = 0 ) const;
+  virtual void AtVkV( gsl_vector *u, long k,
+                      const gsl_matrix *A, const gsl_vector *v,
+                      gsl_vector *tmpVkV, double beta = 0 ) const;
+  /**@}*/
+
+  /** @name HLayeredBandWStructure-specific methods */
+  /**@{*/
+  /** @brief @copybrief HLayeredBlWStructure::getQ() */
+  size_t getQ() const { return myBase.getQ(); }
+  /** @brief @copybrief HLayeredBlWStructure::getLayerLag()
+   * @copydetails HLayeredBlWStructure::getLayerLag */
+  size_t getLayerLag( size_t l_1 ) const { return myBase.getLayerLag(l_1); }
+  /** @brief @copybrief HLayeredBlWStructure::getLayerNp()
+   * @copydetails HLayeredBlWStructure::getLayerLag */
+  size_t getLayerNp( size_t l_1 ) const { return myBase.getLayerNp(l_1); }
+  /** Returns the bandwidth \f$b_l\f$ of \f$\mathrm{W}_l^{-1}\f$
+   * @copydetails HLayeredBlWStructure::getLayerLag */
+  size_t getLayerBandwidth( size_t l_1 ) const { return myLayerBw[l_1]; }
+  /** Returns \f$c^{(l)}_k\f$, \f$0 \le k \le b_l\f$
+   * @copydetails HLayeredBlWStructure::getLayerLag */
+  double getBandCoef( size_t l_1, size_t k ) const {
+    return gsl_matrix_get(myBands, l_1, k);
+  }
+  /**@}*/
+};
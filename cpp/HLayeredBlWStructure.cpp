@@ -5,14 +5,14 @@
 
 HLayeredBlWStructure::HLayeredBlWStructure( const double *m_vec, 
     size_t q, size_t n, const double *w_vec  ) : myQ(q), myN(n), mySA(NULL)  {
+  double missing_inv_w = (w_vec != NULL) ? missingInvWeight(w_vec, q) : 1.0;
   mySA = new Layer[myQ];
  
   for (size_t l_1 = 0; l_1 < myQ; ++l_1) {
     mySA[l_1].blocks_in_row = m_vec[l_1];
-    if (w_vec != NULL && !(w_vec[l_1] > 0)) {
-      throw new Exception("This value of weight is not supported: %lf\n", w_vec[l_1]);
-    }
-    mySA[l_1].inv_w = (w_vec != NULL) ? (1 / w_vec[l_1]) : 1.0;
+    mySA[l_1].missing = (w_vec != NULL && w_vec[l_1] == 0);
+    mySA[l_1].inv_w = (w_vec == NULL) ? 1.0 : 
+        (mySA[l_1].missing ? missing_inv_w : (1 / w_vec[l_1]));
   }    
    
   computeStats(); 
@@ -112,6 +112,15 @@ void HLayeredBlWStructure::multByWInv( gsl_vector* p, long deg ) const {
   }
 }
 
+bool HLayeredBlWStructure::isMissing( size_t k ) const {
+  size_t l_1, sum_np = 0;
+
+  for (l_1 = 0; l_1 < getQ() && sum_np + getLayerNp(l_1) <= k; ++l_1) {
+    sum_np += getLayerNp(l_1);
+  }
+  return l_1 < getQ() && mySA[l_1].missing;
+}
+
 Cholesky *HLayeredBlWStructure::createCholesky( size_t d ) const {
 #ifdef USE_SLICOT 
   return new StationaryCholeskySlicot(this, d);
@@ -19,6 +19,7 @@ class HLayeredBlWStructure : public StationaryStructure {
   typedef struct {
     size_t blocks_in_row;       /* Number of blocks in a row of Ci */
     double inv_w;            /* Square root of inverse of the weight */
+    bool missing;            /* Missing values (zero weight) */
   } Layer;
 
   size_t myQ;	                /* number of layers */
@@ -40,7 +41,8 @@ public:
    * @param[in] w_vec vector of weights 
    * \f${\bf w} =\begin{bmatrix} \omega_1 & \cdots & \omega_q \end{bmatrix}^{\top}\f$.
    * If `w_vec == NULL` then \f${\bf w}\f$ is set to be
-   * \f$\begin{bmatrix}1&\cdots&1\end{bmatrix}^{\top}\f$. */
+   * \f$\begin{bmatrix}1&\cdots&1\end{bmatrix}^{\top}\f$.
+   * A layer with \f$\omega_l = 0\f$ is missing (see Structure::isMissing()). */
   HLayeredBlWStructure( const double *m_vec, size_t q, size_t n, 
                         const double *w_vec = NULL );
   virtual ~HLayeredBlWStructure();
@@ -57,6 +59,7 @@ public:
                                    double alpha = -1, double beta = 1,
                                    bool skipFixedBlocks = true ); 
   virtual void multByWInv( gsl_vector* p, long deg = 2 ) const;
+  virtual bool isMissing( size_t k ) const;
   /**@}*/
  
   /** @name Implementing StationaryStructure interface */
@@ -12,21 +12,39 @@ extern "C" {
 
 HLayeredElWStructure::HLayeredElWStructure( const double *m_vec, size_t q, size_t n, 
     const double *w_vec ) : myBase(m_vec, q, n, NULL) {
+  double missing_inv_w = missingInvWeight(w_vec, myBase.getNp());
+
   myInvWeights = gsl_vector_alloc(myBase.getNp());
   myInvSqrtWeights = gsl_vector_alloc(myBase.getNp());
-
+  myMissing = NULL;
   for (size_t l = 0; l < myInvWeights->size; l++) {
-    if (!(w_vec[l] > 0)) {
-      throw new Exception("Value of weight not supported: %lf\n", w_vec[l]);
+    if (w_vec[l] == 0) {
+      if (myMissing == NULL) {
+        myMissing = new bool[myInvWeights->size];
+        memset(myMissing, 0, myInvWeights->size * sizeof(bool));
+      }
+      myMissing[l] = true;
+      gsl_vector_set(myInvWeights, l, missing_inv_w);
+    } else {
+      gsl_vector_set(myInvWeights, l, (1 / w_vec[l]));
     }
-    gsl_vector_set(myInvWeights, l, (1 / w_vec[l]));
     gsl_vector_set(myInvSqrtWeights, l, sqrt(gsl_vector_get(myInvWeights, l)));
   }
+  myFree = new size_t[myInvWeights->size];
+  for (size_t l = myNFree = 0; l < myInvWeights->size; l++) {
+    if (gsl_vector_get(myInvWeights, l) != 0.0) {
+      myFree[myNFree++] = l;
+    }
+  }
 }
 
 HLayeredElWStructure::~HLayeredElWStructure() {
   gsl_vector_free(myInvWeights);
   gsl_vector_free(myInvSqrtWeights);
+  if (myMissing != NULL) {
+    delete [] myMissing;
+  }
+  delete [] myFree;
 }
 
 void HLayeredElWStructure::fillMatrixFromP( gsl_matrix* c, const gsl_vector* p ) {
@@ -36,7 +54,46 @@ void HLayeredElWStructure::fillMatrixFromP( gsl_matrix* c, const gsl_vector* p )
 void HLayeredElWStructure::multByGtUnweighted( gsl_vector* p, 
           const gsl_matrix *Rt, const gsl_vector *y, 
           double alpha, double beta, bool skipFixedBlocks ) {
-  myBase.multByGtUnweighted(p, Rt, y, alpha, beta, skipFixedBlocks);        
+  if (!skipFixedBlocks || myNFree == getNp()) {
+    myBase.multByGtUnweighted(p, Rt, y, alpha, beta, skipFixedBlocks);        
+    return;
+  }
+
+  size_t l, k, a, t, f = 0, f_end, sum_np = 0, sum_nl = 0, D = Rt->size2;
+  gsl_matrix Y = gsl_matrix_const_view_vector(y, getN(), D).matrix, RtSub;
+  gsl_vector Y_row, Rt_row, psub;
+  double res;
+
+  for (l = 0; l < getQ(); 
+       sum_np += getLayerNp(l), sum_nl += getLayerLag(l), ++l, f = f_end) {
+    for (f_end = f; f_end < myNFree && 
+                    myFree[f_end] < sum_np + getLayerNp(l); f_end++) {}
+    
+    if (f_end - f == getLayerNp(l)) {  /* No fixed parameters in the layer */
+      RtSub = gsl_matrix_const_submatrix(Rt, sum_nl, 0, getLayerLag(l), D).matrix; 
+      for (k = 0; k < getN(); k++) {
+        psub = gsl_vector_subvector(p, k + sum_np, getLayerLag(l)).vector;
+        Y_row = gsl_matrix_row(&Y, k).vector; 
+        gsl_blas_dgemv(CblasNoTrans, alpha, &RtSub, &Y_row, beta, &psub); 
+      }
+      continue;
+    }
+    /* (G^T y)_t = sum_{a + k = t} Rt_{a,:} Y_{k,:}, only for the free t */
+    for (; f < f_end; f++) {
+      t = myFree[f] - sum_np;
+      res = 0;
+      for (a = (t >= getN() ? t - getN() + 1 : 0); 
+           a < getLayerLag(l) && a <= t; a++) {
+        double tmp;
+        Rt_row = gsl_matrix_const_row(Rt, sum_nl + a).vector;
+        Y_row = gsl_matrix_const_row(&Y, t - a).vector;
+        gsl_blas_ddot(&Rt_row, &Y_row, &tmp);
+        res += tmp;
+      }
+      gsl_vector_set(p, myFree[f], beta * gsl_vector_get(p, myFree[f]) + 
+                                   alpha * res);
+    }
+  }
 }
 
 void HLayeredElWStructure::multByWInv( gsl_vector* p, long deg ) const {
@@ -92,6 +149,9 @@ void HLayeredElWStructure::AtVijB( gsl_matrix *X, long i_1, long j_1,
        ind_a += getLayerLag(l),
        ind_b += getLayerLag(l), ++l) {
     for (size_t k = 0; k + diff < getLayerLag(l); ++k) {
+      if (getInvWeight(sum_np + k) == 0.0) {
+        continue;
+      }
       const gsl_vector A_row = gsl_matrix_const_row(A, ind_a + k).vector;
       const gsl_vector B_row = gsl_matrix_const_row(B, ind_b + k).vector;
       gsl_blas_dger(getInvWeight(sum_np + k), &A_row, &B_row, X);
@@ -115,6 +175,9 @@ void HLayeredElWStructure::AtVijV( gsl_vector *u, long i_1, long j_1,
        ind_a += getLayerLag(l),
        ind_v += getLayerLag(l), ++l) {
     for (k = 0; k + diff < getLayerLag(l); ++k) {
+      if (getInvWeight(sum_np + k) == 0.0) {
+        continue;
+      }
       const gsl_vector A_row = gsl_matrix_const_row(A, ind_a + k).vector;
       gsl_blas_daxpy(getInvWeight(sum_np + k) * 
                      gsl_vector_get(V, ind_v + k), &A_row, u);
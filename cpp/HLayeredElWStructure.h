@@ -8,17 +8,25 @@
  *
  * The computations are based on the expression of \f$\mathrm{V}_{\#ij}\f$ 
  * as in \f$(\mathrm{V}_{\#ij}(\mathscr{H}_{{\bf m}, n}))\f$ 
+ *
+ * The fixed parameters (\f$w_k = \infty\f$) are skipped in the rank-1 
+ * updates of AtVijB(), AtVijV() and, if `skipFixedBlocks` is set, 
+ * in multByGtUnweighted(), which then uses the list of the free parameters.
  */
 class HLayeredElWStructure : public MuDependentStructure {
   HLayeredBlWStructure myBase;
   gsl_vector *myInvWeights;
   gsl_vector *myInvSqrtWeights;
+  bool *myMissing;        /* Missing values (NULL if there are none) */
+  size_t *myFree;         /* Indices of the free (not fixed) parameters */
+  size_t myNFree;         /* Number of the free parameters */
   void mulInvWij( gsl_matrix * res, long i_1 ) const;
 public:  
   /** Constructs WLayeredHStructure object.
    * @param m_vec \f${\bf m} = \begin{bmatrix}m_1 & \cdots & m_q\end{bmatrix}^{\top}\f$
    * @param w_vec vector of weights 
-   * \f${\bf w} =\begin{bmatrix} w_1 & \cdots & w_{n_p} \end{bmatrix}^{\top}\f$.
+   * \f${\bf w} =\begin{bmatrix} w_1 & \cdots & w_{n_p} \end{bmatrix}^{\top}\f$,
+   * \f$w_k = 0\f$ for the missing values (see Structure::isMissing()).
    */
   HLayeredElWStructure( const double *m_vec, size_t q, size_t n, 
                         const double *w_vec );
@@ -37,6 +45,9 @@ public:
                                    double alpha = -1, double beta = 1,
                                    bool skipFixedBlocks = true ); 
   virtual void multByWInv( gsl_vector* p, long deg = 2 ) const;
+  virtual bool isMissing( size_t k ) const {
+    return myMissing != NULL && myMissing[k];
+  }
   /**@}*/
   
   /** @name Implementing SDependentStructure interface */
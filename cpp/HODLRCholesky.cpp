@@ -0,0 +1,439 @@
+#include <memory.h>
+#include <math.h>
+#include "slra.h"
+
+HODLRCholesky::HODLRCholesky( const MuDependentStructure *s, size_t d,
+                              double tol, size_t leaf ) :
+    myStruct(s), myD(d), myDN(s->getN() * d), myLeaf(mymax(leaf, 1)),
+    myTol(tol), myNNodes(0), myWork(NULL), myWorkSize(0) {
+  if (!(tol > 0 && tol < 1)) {
+    throw new Exception("HODLRCholesky: incorrect tolerance %g.\n", tol);
+  }
+  myNodes = new Node[2 * s->getN()];
+  buildTree(0, s->getN());
+  myTempVijtRt = gsl_matrix_alloc(s->getM(), d);
+  myTempGammaij = gsl_matrix_alloc(d, d);
+}
+
+HODLRCholesky::~HODLRCholesky() {
+  freeFactor();
+  delete [] myNodes;
+  gsl_matrix_free(myTempVijtRt);
+  gsl_matrix_free(myTempGammaij);
+  if (myWork != NULL) {
+    delete [] myWork;
+  }
+}
+
+long HODLRCholesky::buildTree( size_t b0, size_t nb ) {
+  long k = myNNodes++;
+  Node *node = myNodes + k;
+
+  node->b0 = b0;
+  node->nb = nb;
+  node->L = node->P = node->Q = NULL;
+  node->left = node->right = -1;
+  if (nb > myLeaf) {
+    long left = buildTree(b0, nb / 2), right = buildTree(b0 + nb / 2, nb - nb / 2);
+    myNodes[k].left = left;
+    myNodes[k].right = right;
+  }
+  return k;
+}
+
+void HODLRCholesky::freeFactor() {
+  for (size_t k = 0; k < myNNodes; k++) {
+    gsl_matrix_free_ifnull(myNodes[k].L);
+    gsl_matrix_free_ifnull(myNodes[k].P);
+    gsl_matrix_free_ifnull(myNodes[k].Q);
+    myNodes[k].L = myNodes[k].P = myNodes[k].Q = NULL;
+  }
+}
+
+size_t HODLRCholesky::getMaxRank() const {
+  size_t r = 0;
+  for (size_t k = 0; k < myNNodes; k++) {
+    if (myNodes[k].Q != NULL) {
+      r = mymax(r, myNodes[k].Q->size2);
+    }
+  }
+  return r;
+}
+
+void HODLRCholesky::computeGammaBlock( const gsl_matrix *Rt,
+                                       size_t i_1, size_t j_1 ) {
+  size_t mu = myStruct->getMu();
+  if ((i_1 > j_1 ? i_1 - j_1 : j_1 - i_1) < mu) {
+    myStruct->AtVijB(myTempGammaij, i_1, j_1, Rt, Rt, myTempVijtRt);
+  } else {
+    gsl_matrix_set_zero(myTempGammaij);
+  }
+}
+
+/* Appends a column to the matrix *A with *k columns used */
+static void appendColumn( gsl_matrix **A, size_t k, const gsl_vector *v ) {
+  if (k == (*A)->size2) {
+    gsl_matrix *B = gsl_matrix_alloc((*A)->size1, 2 * k);
+    gsl_matrix_view B_sub = gsl_matrix_submatrix(B, 0, 0, (*A)->size1, k);
+    gsl_matrix_memcpy(&B_sub.matrix, *A);
+    gsl_matrix_free(*A);
+    *A = B;
+  }
+  gsl_matrix_set_col(*A, k, v);
+}
+
+void HODLRCholesky::residualRow( const Node &r, const Node &c,
+         const gsl_matrix *Rt, size_t i, const gsl_matrix *U, 
+         const gsl_matrix *V, size_t k, gsl_matrix *row_buf, long *row_blk,
+         gsl_vector *v ) {
+  size_t d = myD, mu = myStruct->getMu(), ib = r.b0 + i / d;
+
+  if (ib + mu <= c.b0 || c.b0 + c.nb + mu <= ib + 1) {
+    gsl_vector_set_zero(v);    /* The row is outside the band */
+    return;
+  }
+  if (*row_blk != (long)ib) {
+    for (size_t jb = 0; jb < c.nb; jb++) {
+      computeGammaBlock(Rt, ib, c.b0 + jb);
+      gsl_matrix_view dst = gsl_matrix_submatrix(row_buf, 0, jb * d, d, d);
+      gsl_matrix_memcpy(&dst.matrix, myTempGammaij);
+    }
+    *row_blk = ib;
+  }
+  gsl_vector_const_view row = gsl_matrix_const_row(row_buf, i % d);
+  gsl_vector_memcpy(v, &row.vector);
+  for (size_t l = 0; l < k; l++) {
+    gsl_vector_const_view V_l = gsl_matrix_const_column(V, l);
+    gsl_blas_daxpy(-gsl_matrix_get(U, i, l), &V_l.vector, v);
+  }
+}
+
+size_t HODLRCholesky::crossApprox( const Node &r, const Node &c,
+          const gsl_matrix *Rt, gsl_matrix **U, gsl_matrix **V ) {
+  size_t d = myD, n1 = c.nb * d, n2 = r.nb * d, k = 0, l, i, j;
+  size_t k0 = mymin(mymin(n1, n2), 8);
+  unsigned long seed = 1;
+  long row_blk = -1, col_blk = -1;
+  double norm2 = 0;
+  gsl_matrix *row_buf = gsl_matrix_alloc(d, n1), *col_buf = gsl_matrix_alloc(n2, d);
+  gsl_vector *u = gsl_vector_alloc(n2), *v = gsl_vector_alloc(n1);
+  bool *used = new bool[n2];
+
+  *U = gsl_matrix_alloc(n2, k0);
+  *V = gsl_matrix_alloc(n1, k0);
+  memset(used, 0, n2 * sizeof(bool));
+  for (i = 0; k < mymin(n1, n2); ) {
+    /* Residual of the row i */
+    used[i] = true;
+    residualRow(r, c, Rt, i, *U, *V, k, row_buf, &row_blk, v);
+    for (l = 1, j = 0; l < n1; l++) {
+      if (fabs(gsl_vector_get(v, l)) > fabs(gsl_vector_get(v, j))) {
+        j = l;
+      }
+    }
+    if (gsl_vector_get(v, j) == 0) {
+      /* Try the next unused row */
+      for (i = 0; i < n2 && used[i]; i++) ;
+      if (i == n2) {
+        break;
+      }
+      continue;
+    }
+    gsl_vector_scale(v, 1 / gsl_vector_get(v, j));
+
+    /* Residual of the column j */
+    if (col_blk != (long)(c.b0 + j / d)) {
+      col_blk = c.b0 + j / d;
+      for (size_t ib2 = 0; ib2 < r.nb; ib2++) {
+        computeGammaBlock(Rt, r.b0 + ib2, col_blk);
+        gsl_matrix_view dst = gsl_matrix_submatrix(col_buf, ib2 * d, 0, d, d);
+        gsl_matrix_memcpy(&dst.matrix, myTempGammaij);
+      }
+    }
+    gsl_vector_const_view col = gsl_matrix_const_column(col_buf, j % d);
+    gsl_vector_memcpy(u, &col.vector);
+    for (l = 0; l < k; l++) {
+      gsl_vector_const_view U_l = gsl_matrix_const_column(*U, l);
+      gsl_blas_daxpy(-gsl_matrix_get(*V, j, l), &U_l.vector, u);
+    }
+
+    /* Update of the estimate of the Frobenius norm of the approximation */
+    double nu = gsl_blas_dnrm2(u), nv = gsl_blas_dnrm2(v), su, sv;
+    for (l = 0; l < k; l++) {
+      gsl_vector_const_view U_l = gsl_matrix_const_column(*U, l);
+      gsl_vector_const_view V_l = gsl_matrix_const_column(*V, l);
+      gsl_blas_ddot(u, &U_l.vector, &su);
+      gsl_blas_ddot(v, &V_l.vector, &sv);
+      norm2 += 2 * su * sv;
+    }
+    norm2 += nu * nu * nv * nv;
+    appendColumn(U, k, u);
+    appendColumn(V, k, v);
+    k++;
+    if (nu * nv <= myTol * sqrt(fabs(norm2))) {
+      /* The criterion does not see the unexplored rows (e.g., of a sparse
+       * block), therefore some random rows are checked before stopping */
+      for (l = 0, i = n2; l < SLRA_HODLR_NCHECK && i == n2; l++) {
+        seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+        size_t i2 = seed % n2;
+        if (!used[i2]) {
+          residualRow(r, c, Rt, i2, *U, *V, k, row_buf, &row_blk, v);
+          if (gsl_blas_dnrm2(v) * sqrt((double)n2) > myTol * sqrt(fabs(norm2))) {
+            i = i2;
+          } else {
+            used[i2] = true;
+          }
+        }
+      }
+      if (i == n2) {
+        break;
+      }
+      continue;
+    }
+
+    /* The next row is the unused row with the largest element of u */
+    double u_max = -1;
+    for (l = 0, i = n2; l < n2; l++) {
+      if (!used[l] && fabs(gsl_vector_get(u, l)) > u_max) {
+        u_max = fabs(gsl_vector_get(u, l));
+        i = l;
+      }
+    }
+    if (i == n2) {
+      break;
+    }
+  }
+
+  gsl_matrix_free(row_buf);
+  gsl_matrix_free(col_buf);
+  gsl_vector_free(u);
+  gsl_vector_free(v);
+  delete [] used;
+  return k;
+}
+
+gsl_matrix *HODLRCholesky::compressUpdate( const gsl_matrix *Z ) const {
+  size_t q = Z->size2, lwork = 3 * q, info = 0, l, r;
+  gsl_matrix *H = gsl_matrix_alloc(q, q), *ZW;
+  gsl_vector *lambda = gsl_vector_alloc(q);
+  double *work = new double[lwork];
+
+  /* Z^T Z = W Lambda W^T, the eigenvectors are stored in the rows of H */
+  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, Z, Z, 0, H);
+  dsyev_("V", "U", &q, H->data, &H->tda, lambda->data, work, &lwork, &info);
+  delete [] work;
+  if (info) {
+    gsl_matrix_free(H);
+    gsl_vector_free(lambda);
+    throw new Exception("HODLRCholesky: DSYEV didn't converge.\n");
+  }
+  /* The eigenvalues are in the ascending order */
+  for (r = 0; r < q && gsl_vector_get(lambda, q - 1 - r) >
+                       mymax(myTol * myTol, q * GSL_DBL_EPSILON) *
+                       gsl_vector_get(lambda, q - 1); r++) ;
+  ZW = (r > 0 ? gsl_matrix_alloc(Z->size1, r) : NULL);
+  for (l = 0; l < r; l++) {
+    gsl_vector_view ZW_l = gsl_matrix_column(ZW, l);
+    gsl_vector_const_view W_l = gsl_matrix_const_row(H, q - 1 - l);
+    gsl_blas_dgemv(CblasNoTrans, 1, Z, &W_l.vector, 0, &ZW_l.vector);
+  }
+  gsl_matrix_free(H);
+  gsl_vector_free(lambda);
+  return ZW;
+}
+
+bool HODLRCholesky::factorNode( long k, const gsl_matrix *Rt, double reg,
+                                const gsl_matrix *Z ) {
+  Node *node = myNodes + k;
+  size_t d = myD, info = 0;
+
+  if (node->left < 0) { /* Dense Cholesky factorization of the leaf */
+    size_t n = node->nb * d;
+    node->L = gsl_matrix_alloc(n, n);
+    for (size_t i = 0; i < node->nb; i++) {
+      for (size_t j = 0; j <= i; j++) {
+        computeGammaBlock(Rt, node->b0 + i, node->b0 + j);
+        gsl_matrix_view dst = gsl_matrix_submatrix(node->L, i * d, j * d, d, d);
+        gsl_matrix_memcpy(&dst.matrix, myTempGammaij);
+      }
+    }
+    if (reg > 0) {
+      gsl_vector_view diag = gsl_matrix_diagonal(node->L);
+      gsl_vector_add_constant(&diag.vector, reg);
+    }
+    if (Z != NULL) {
+      gsl_blas_dsyrk(CblasLower, CblasNoTrans, -1.0, Z, 1.0, node->L);
+    }
+    /* Upper triangle in the column-major order is the lower in GSL */
+    dpotrf_("U", &n, node->L->data, &node->L->tda, &info);
+    return (info == 0);
+  }
+
+  const Node &left = myNodes[node->left], &right = myNodes[node->right];
+  size_t n1 = left.nb * d, n2 = right.nb * d, q = (Z != NULL ? Z->size2 : 0);
+  gsl_matrix *U = NULL, *V = NULL, *Z2 = NULL, *Z2_new = NULL;
+  gsl_matrix_const_view Z_1, Z_2;
+  if (Z != NULL) {
+    Z_1 = gsl_matrix_const_submatrix(Z, 0, 0, n1, q);
+    Z_2 = gsl_matrix_const_submatrix(Z, n1, 0, n2, q);
+  }
+  if (!factorNode(node->left, Rt, reg, (Z != NULL ? &Z_1.matrix : NULL))) {
+    return false;
+  }
+
+  /* Gamma_21 - Z_2 Z_1^T = [U -Z_2] [V Z_1]^T */
+  size_t rk = crossApprox(right, left, Rt, &U, &V), r = rk + q;
+  bool res;
+  if (r > 0) {
+    node->P = gsl_matrix_alloc(n2, r);
+    node->Q = gsl_matrix_alloc(n1, r);
+    for (size_t l = 0; l < r; l++) {
+      gsl_vector_view P_l = gsl_matrix_column(node->P, l);
+      gsl_vector_view Q_l = gsl_matrix_column(node->Q, l);
+      if (l < rk) {
+        gsl_matrix_get_col(&P_l.vector, U, l);
+        gsl_matrix_get_col(&Q_l.vector, V, l);
+      } else {
+        gsl_vector_const_view Z2_l = gsl_matrix_const_column(&Z_2.matrix, l - rk);
+        gsl_vector_const_view Z1_l = gsl_matrix_const_column(&Z_1.matrix, l - rk);
+        gsl_vector_memcpy(&P_l.vector, &Z2_l.vector);
+        gsl_vector_scale(&P_l.vector, -1);
+        gsl_vector_memcpy(&Q_l.vector, &Z1_l.vector);
+      }
+    }
+    solveNode(node->left, node->Q, 1);
+
+    /* Update of the Schur complement: [Z_2 P L], where Q^T Q = L L^T.
+     * L is taken from the LQ factorization Q^T = L Q_1 (forming Q^T Q 
+     * would square the condition number of Gamma_11) */
+    size_t c = mymin(r, n1), lwork = r, info_lq = 0;
+    gsl_matrix *QtL = gsl_matrix_alloc(n1, r);  /* Column-major Q^T */
+    double *tau = new double[c], *work = new double[lwork];
+    gsl_matrix_memcpy(QtL, node->Q);
+    dgelqf_(&r, &n1, QtL->data, &QtL->tda, tau, work, &lwork, &info_lq);
+    delete [] tau;
+    delete [] work;
+    gsl_matrix *Zs = gsl_matrix_alloc(n2, q + c);
+    for (size_t l = 0; l < q; l++) {
+      gsl_vector_view Zs_l = gsl_matrix_column(Zs, l);
+      gsl_vector_const_view Z2_l = gsl_matrix_const_column(&Z_2.matrix, l);
+      gsl_vector_memcpy(&Zs_l.vector, &Z2_l.vector);
+    }
+    /* L_{il} is the element (i,l) of the column-major r x n1 matrix */
+    for (size_t l = 0; l < c; l++) {
+      gsl_vector_view Zs_l = gsl_matrix_column(Zs, q + l);
+      gsl_vector_set_zero(&Zs_l.vector);
+      for (size_t i = l; i < r; i++) {
+        gsl_vector_const_view P_i = gsl_matrix_const_column(node->P, i);
+        gsl_blas_daxpy(QtL->data[i + l * QtL->tda], &P_i.vector, 
+                       &Zs_l.vector);
+      }
+    }
+    gsl_matrix_free(QtL);
+    if (info_lq) {
+      gsl_matrix_free(Zs);
+      gsl_matrix_free(U);
+      gsl_matrix_free(V);
+      throw new Exception("HODLRCholesky: DGELQF failed.\n");
+    }
+    Z2_new = compressUpdate(Zs);
+    gsl_matrix_free(Zs);
+  } else if (q > 0) {
+    Z2 = gsl_matrix_alloc(n2, q);
+    gsl_matrix_memcpy(Z2, &Z_2.matrix);
+    Z2_new = compressUpdate(Z2);
+    gsl_matrix_free(Z2);
+  }
+  gsl_matrix_free(U);
+  gsl_matrix_free(V);
+
+  res = factorNode(node->right, Rt, reg, Z2_new);
+  gsl_matrix_free_ifnull(Z2_new);
+  return res;
+}
+
+void HODLRCholesky::solveNode( long k, gsl_matrix *B, long trans ) {
+  const Node *node = myNodes + k;
+  size_t rows = B->size1;
+
+  if (rows == 0) {
+    return;
+  }
+  if (node->left < 0) {
+    gsl_matrix_const_view L = gsl_matrix_const_submatrix(node->L, 0, 0, rows, rows);
+    gsl_blas_dtrsm(CblasLeft, CblasLower, (trans ? CblasNoTrans : CblasTrans),
+                   CblasNonUnit, 1.0, &L.matrix, B);
+    return;
+  }
+
+  size_t n1 = myNodes[node->left].nb * myD;
+  gsl_matrix_view B_1 = gsl_matrix_submatrix(B, 0, 0, mymin(rows, n1), B->size2);
+  if (rows <= n1) {
+    solveNode(node->left, &B_1.matrix, trans);
+    return;
+  }
+  gsl_matrix_view B_2 = gsl_matrix_submatrix(B, n1, 0, rows - n1, B->size2);
+  gsl_matrix_view T;
+  gsl_matrix_const_view P;
+  if (node->Q != NULL) {
+    size_t r = node->Q->size2;
+    if (myWorkSize < r * B->size2) {
+      if (myWork != NULL) {
+        delete [] myWork;
+      }
+      myWork = new double[(myWorkSize = r * B->size2)];
+    }
+    T = gsl_matrix_view_array(myWork, r, B->size2);
+    P = gsl_matrix_const_submatrix(node->P, 0, 0, rows - n1, r);
+  }
+  if (trans) { /* Forward substitution */
+    solveNode(node->left, &B_1.matrix, trans);
+    if (node->Q != NULL) {
+      gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, node->Q, &B_1.matrix, 0, &T.matrix);
+      gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, -1, &P.matrix, &T.matrix,
+                     1, &B_2.matrix);
+    }
+    solveNode(node->right, &B_2.matrix, trans);
+  } else {     /* Back substitution */
+    solveNode(node->right, &B_2.matrix, trans);
+    if (node->Q != NULL) {
+      gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, &P.matrix, &B_2.matrix, 0, &T.matrix);
+      gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, -1, node->Q, &T.matrix,
+                     1, &B_1.matrix);
+    }
+    solveNode(node->left, &B_1.matrix, trans);
+  }
+}
+
+void HODLRCholesky::calcGammaCholesky( const gsl_matrix *Rt, double reg ) {
+  freeFactor();
+  if (factorNode(0, Rt, 0, NULL)) {
+    return;
+  }
+  freeFactor();
+  if (reg > 0) {
+    Log::lprintf(Log::LOG_LEVEL_NOTIFY, "Gamma is singular, "
+        "adding regularization, reg = %f.\n", reg);
+    if (factorNode(0, Rt, reg, NULL)) {
+      return;
+    }
+    freeFactor();
+  }
+  throw new Exception("Gamma is singular (HODLR factorization failed).\n");
+}
+
+void HODLRCholesky::multInvCholeskyVector( gsl_vector * y_r, long trans ) {
+  if (y_r->stride != 1) {
+    throw new Exception("Cannot multiply vectors with stride != 1\n");
+  }
+  if (y_r->size > myDN) {
+    throw new Exception("y_r->size > d * n\n");
+  }
+  gsl_matrix_view Y = gsl_matrix_view_vector(y_r, y_r->size, 1);
+  solveNode(0, &Y.matrix, trans);
+}
+
+void HODLRCholesky::multInvGammaVector( gsl_vector * y_r ) {
+  multInvCholeskyVector(y_r, 1);
+  multInvCholeskyVector(y_r, 0);
+}
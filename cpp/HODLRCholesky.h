@@ -0,0 +1,90 @@
+/** Default number of block columns in a leaf of HODLRCholesky */
+#define SLRA_HODLR_LEAF 32
+/** Number of random rows checked before stopping the cross approximation */
+#define SLRA_HODLR_NCHECK 10
+
+/** Hierarchical Cholesky factorization for MuDependentStructure with large \f$\mu\f$.
+ * The index set \f$1,\ldots,n\f$ of the blocks of \f$\Gamma(R)\f$ is split
+ * recursively into halves, down to leaves of at most SLRA_HODLR_LEAF
+ * blocks. The off-diagonal blocks of \f$\Gamma(R)\f$ at each level are
+ * approximated by low-rank matrices \f$UV^{\top}\f$ computed by partially
+ * pivoted adaptive cross approximation \cite bebendorf00, which requires
+ * only \f$O(k)\f$ block rows and columns (see MuDependentStructure::AtVijB()).
+ *
+ * The factor \f$\mathrm{L}_{\Gamma}^{\top} = G\f$ is a lower triangular matrix
+ * with the same hierarchical structure: for a node
+ * \f$\begin{bmatrix}\Gamma_{11} & \Gamma_{21}^{\top} \\ \Gamma_{21} & \Gamma_{22}\end{bmatrix}\f$
+ * \f[
+ * G = \begin{bmatrix} G_{11} & 0 \\ PQ^{\top} & G_{22} \end{bmatrix}, \quad
+ * Q = G_{11}^{-1} [V\; Z_1], \quad P = [U\; -Z_2],
+ * \f]
+ * where \f$G_{22}\f$ is the factor of the Schur complement
+ * \f$\Gamma_{22} - Z_2 Z_2^{\top} - PQ^{\top}QP^{\top}\f$, and
+ * \f$ZZ^{\top}\f$ is the (recompressed) low-rank update accumulated from
+ * the previous nodes. The leaves are factorized by DPOTRF.
+ * The solves with \f$G\f$ cost \f$O(ndk \log n)\f$ operations, where
+ * \f$k\f$ is the maximal rank.
+ *
+ * The factorization is exact up to the relative tolerance of the low-rank
+ * approximations, and \f$\mathrm{L}_{\Gamma}\f$ is triangular, so the
+ * solves with its leading submatrices are also available.
+ */
+class HODLRCholesky : public Cholesky {
+  typedef struct {
+    size_t b0, nb;            /* Blocks b0, ..., b0+nb-1 */
+    long left, right;         /* Children (-1 for a leaf) */
+    gsl_matrix *L;            /* Leaf: the lower triangular factor */
+    gsl_matrix *P, *Q;        /* Node: the lower left block PQ^T of G */
+  } Node;
+
+  const MuDependentStructure *myStruct;
+  size_t myD, myDN, myLeaf;
+  double myTol;
+  Node *myNodes;
+  size_t myNNodes;
+  gsl_matrix *myTempVijtRt;
+  gsl_matrix *myTempGammaij;
+  double *myWork;             /* Workspace for the solves */
+  size_t myWorkSize;
+
+  long buildTree( size_t b0, size_t nb );
+  void freeFactor();
+  void computeGammaBlock( const gsl_matrix *Rt, size_t i_1, size_t j_1 );
+  /* Computes the row i of Gamma(rows of r, columns of c) - U V^T, where
+   * U and V have k columns; the block row is cached in row_buf */
+  void residualRow( const Node &r, const Node &c, const gsl_matrix *Rt,
+                    size_t i, const gsl_matrix *U, const gsl_matrix *V,
+                    size_t k, gsl_matrix *row_buf, long *row_blk, 
+                    gsl_vector *v );
+  /* Computes U V^T ~ Gamma(rows of r, columns of c), returns the rank */
+  size_t crossApprox( const Node &r, const Node &c, const gsl_matrix *Rt,
+                      gsl_matrix **U, gsl_matrix **V );
+  /* Returns Z W with W such that Z W W^T Z^T ~ Z Z^T and Z W has
+   * the minimal number of columns (NULL if it is zero) */
+  gsl_matrix *compressUpdate( const gsl_matrix *Z ) const;
+  bool factorNode( long k, const gsl_matrix *Rt, double reg,
+                   const gsl_matrix *Z );
+  /* B <- L_Gamma^{-T} B = G^{-1} B (trans == 1) or 
+   * B <- L_Gamma^{-1} B = G^{-T} B (trans == 0) for the leading 
+   * B->size1 rows of the node */
+  void solveNode( long k, gsl_matrix *B, long trans );
+public:
+  /** Constructs the HODLRCholesky object.
+   * @param[in] s     Pointer to the corresponding MuDependentStructure.
+   * @param[in] d     number of rows \f$d\f$ of  the matrix \f$R\f$
+   * @param[in] tol   relative tolerance of the low-rank approximations
+   * @param[in] leaf  maximal number of blocks in a leaf */
+  HODLRCholesky( const MuDependentStructure *s, size_t d, double tol,
+                 size_t leaf = SLRA_HODLR_LEAF );
+  virtual ~HODLRCholesky();
+
+  /** @name Implementing Cholesky interface */
+  /**@{*/
+  virtual void calcGammaCholesky( const gsl_matrix *Rt, double reg = 0 );
+  virtual void multInvCholeskyVector( gsl_vector * y_r, long trans );
+  virtual void multInvGammaVector( gsl_vector * y_r );
+  /**@}*/
+
+  /** Returns the maximal rank of the off-diagonal blocks of the factor */
+  size_t getMaxRank() const;
+};
@@ -0,0 +1,70 @@
+#include "slra.h"
+
+KronOperator::KronOperator( const gsl_matrix *A, size_t d ) : myD(d) {
+  if (A->size1 < A->size2 || A->size2 == 0) {
+    throw new Exception("KronOperator: A should have full column rank.\n");
+  }
+  size_t minus1 = -1, info = 0;
+  double tmp;
+
+  myA = gsl_matrix_alloc(A->size1, A->size2);
+  gsl_matrix_memcpy(myA, A);
+  myQRt = gsl_matrix_alloc(A->size2, A->size1);
+  gsl_matrix_transpose_memcpy(myQRt, A);
+  myTau = new double[A->size2];
+  myTmpBt = gsl_matrix_alloc(myD, A->size1);
+
+  /* Determine optimal work */
+  dgeqrf_(&myA->size1, &myA->size2, myQRt->data, &myQRt->tda, myTau, 
+          &tmp, &minus1, &info);
+  myLwork = tmp;
+  dormqr_("L", "T", &myA->size1, &myD, &myA->size2, myQRt->data, &myQRt->tda,
+          myTau, myTmpBt->data, &myTmpBt->tda, &tmp, &minus1, &info);
+  myLwork = mymax(myLwork, (size_t)tmp);
+  myWork = new double[myLwork];
+
+  dgeqrf_(&myA->size1, &myA->size2, myQRt->data, &myQRt->tda, myTau, 
+          myWork, &myLwork, &info);
+}
+
+KronOperator::~KronOperator() {
+  gsl_matrix_free(myA);
+  gsl_matrix_free(myQRt);
+  gsl_matrix_free(myTmpBt);
+  delete [] myTau;
+  delete [] myWork;
+}
+
+void KronOperator::mult( const gsl_matrix *X, gsl_matrix *Y, long trans ) const {
+  gsl_blas_dgemm((trans ? CblasTrans : CblasNoTrans), CblasNoTrans, 1.0, 
+                 myA, X, 0.0, Y);
+}
+
+void KronOperator::lsSolve( const gsl_matrix *B, gsl_matrix *X ) {
+  size_t info = 0;
+
+  gsl_matrix_transpose_memcpy(myTmpBt, B);
+  dormqr_("L", "T", &myA->size1, &myD, &myA->size2, myQRt->data, &myQRt->tda,
+          myTau, myTmpBt->data, &myTmpBt->tda, myWork, &myLwork, &info);
+  dtrtrs_("U", "N", "N", &myA->size2, &myD, myQRt->data, &myQRt->tda,
+          myTmpBt->data, &myTmpBt->tda, &info);
+  if (info) {
+    throw new Exception("KronOperator: A is rank deficient.\n");
+  }
+  gsl_matrix sol = gsl_matrix_submatrix(myTmpBt, 0, 0, myD, myA->size2).matrix;
+  gsl_matrix_transpose_memcpy(X, &sol);
+}
+
+void KronOperator::mult( const gsl_vector *x, gsl_vector *y, long trans ) const {
+  gsl_matrix_const_view X = gsl_matrix_const_view_vector(x, 
+                                (trans ? myA->size1 : myA->size2), myD);
+  gsl_matrix_view Y = gsl_matrix_view_vector(y, 
+                          (trans ? myA->size2 : myA->size1), myD);
+  mult(&X.matrix, &Y.matrix, trans);
+}
+
+void KronOperator::lsSolve( const gsl_vector *b, gsl_vector *x ) {
+  gsl_matrix_const_view B = gsl_matrix_const_view_vector(b, myA->size1, myD);
+  gsl_matrix_view X = gsl_matrix_view_vector(x, myA->size2, myD);
+  lsSolve(&B.matrix, &X.matrix);
+}
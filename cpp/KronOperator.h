@@ -0,0 +1,45 @@
+/** Kronecker-structured linear operator.
+ * Represents \f$K = A \otimes I_d\f$ acting on row-major vectorized matrices,
+ * or, equivalently, \f$K = I_d \otimes A\f$ acting on column-major
+ * vectorized matrices. In both cases \f$K \mathrm{vec}(X) = \mathrm{vec}(AX)\f$,
+ * so the operator is applied to \f$X \in \mathbb{R}^{n \times d}\f$
+ * without forming \f$K\f$.
+ *
+ * The QR factorization of \f$A \in \mathbb{R}^{m \times n}\f$, \f$m \ge n\f$,
+ * is computed once in the constructor and reused by every call to lsSolve().
+ */
+class KronOperator {
+  gsl_matrix *myA;
+  gsl_matrix *myQRt;    /* QR factorization of A (column-major) */
+  double *myTau;
+  gsl_matrix *myTmpBt;  /* Workspace for the right-hand side (column-major) */
+  double *myWork;
+  size_t myLwork;
+  size_t myD;
+public:
+  /** Constructs the operator and factorizes \f$A\f$.
+   * @param[in] A   matrix \f$A \in \mathbb{R}^{m \times n}\f$, \f$m \ge n\f$
+   * @param[in] d   number of columns of \f$X\f$ (size of \f$I_d\f$) 
+   */
+  KronOperator( const gsl_matrix *A, size_t d );
+  virtual ~KronOperator();
+
+  const gsl_matrix *getA() const { return myA; }
+  size_t getD() const { return myD; }
+  size_t getSize1() const { return myA->size1 * myD; }
+  size_t getSize2() const { return myA->size2 * myD; }
+
+  /** Computes \f$Y \leftarrow A X\f$ (`trans == 0`) or 
+   * \f$Y \leftarrow A^{\top} X\f$ (`trans == 1`). */
+  void mult( const gsl_matrix *X, gsl_matrix *Y, long trans = 0 ) const;
+  /** Solves \f$\min_X \|A X - B\|_F\f$ for 
+   * \f$B \in \mathbb{R}^{m \times d}\f$, \f$X \in \mathbb{R}^{n \times d}\f$. */
+  void lsSolve( const gsl_matrix *B, gsl_matrix *X );
+  
+  /** @name Vectorized versions
+   * The vectors are row-major vectorizations of \f$X\f$ and \f$Y\f$. */
+  /**@{*/
+  void mult( const gsl_vector *x, gsl_vector *y, long trans = 0 ) const;
+  void lsSolve( const gsl_vector *b, gsl_vector *x );
+  /**@}*/
+};
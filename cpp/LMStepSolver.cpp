@@ -0,0 +1,438 @@
+#include "slra.h"
+
+/* Threshold for the numerical rank, relative to the largest singular value */
+#define LMSTEP_RANK_TOL(n) ((n) * DBL_EPSILON * 100)
+
+LMStepSolver *LMStepSolver::create( int type, size_t nsq, size_t nvar ) {
+  switch (type) {
+  case SLRA_OPT_LM_SOLVER_QR:
+    if (nsq >= nvar) {
+      return new LMStepSolverQR(nsq, nvar);
+    }
+    break;
+  case SLRA_OPT_LM_SOLVER_CHOL:
+    return new LMStepSolverChol(nsq, nvar);
+  }
+  return new LMStepSolverSVD(nsq, nvar);
+}
+
+/* Estimate of the largest eigenvalue of A^T A (if A is upper triangular) or
+ * of A (if A is symmetric with the upper triangle stored) by power iterations */
+static double estimateMaxEig( const gsl_matrix *A, bool triangular ) {
+  gsl_vector *v = gsl_vector_alloc(A->size1), *w = gsl_vector_alloc(A->size1);
+  double nrm = 0;
+
+  gsl_vector_set_all(v, 1 / sqrt((double)A->size1));
+  for (size_t i = 0; i < 10; i++) {
+    if (triangular) {
+      gsl_vector_memcpy(w, v);
+      gsl_blas_dtrmv(CblasUpper, CblasNoTrans, CblasNonUnit, A, w);
+      gsl_blas_dtrmv(CblasUpper, CblasTrans, CblasNonUnit, A, w);
+    } else {
+      gsl_blas_dsymv(CblasUpper, 1.0, A, v, 0.0, w);
+    }
+    nrm = gsl_blas_dnrm2(w);
+    if (nrm == 0) {
+      break;
+    }
+    gsl_vector_memcpy(v, w);
+    gsl_vector_scale(v, 1 / nrm);
+  }
+  gsl_vector_free(v);
+  gsl_vector_free(w);
+  return nrm;
+}
+
+/* Checks if the upper triangular T (J = Q T P^T) is rank deficient in the 
+ * sense of LMStepSolverSVD::computeCovFactor(), i.e., if 
+ * sigma_min(T) <= epscov sigma_max(T) */
+static bool isCovRankDeficient( const gsl_matrix *T, double epscov ) {
+  size_t n = T->size1, minus1 = -1, info = 0, i, j;
+  gsl_matrix *A = gsl_matrix_calloc(n, n);
+  gsl_vector *sig = gsl_vector_alloc(n), *work;
+  double tmp;
+  bool res;
+
+  for (i = 0; i < n; i++) {
+    for (j = i; j < n; j++) {
+      gsl_matrix_set(A, i, j, gsl_matrix_get(T, i, j));
+    }
+  }
+  dgesvd_("N", "N", &n, &n, A->data, &A->tda, sig->data, NULL, &n, 
+          NULL, &n, &tmp, &minus1, &info);
+  work = gsl_vector_alloc(tmp);
+  dgesvd_("N", "N", &n, &n, A->data, &A->tda, sig->data, NULL, &n, 
+          NULL, &n, work->data, &work->size, &info);
+  res = (info != 0 || !(gsl_vector_get(sig, n - 1) > 
+                        gsl_vector_get(sig, 0) * epscov));
+  gsl_matrix_free(A);
+  gsl_vector_free(sig);
+  gsl_vector_free(work);
+  return res;
+}
+
+LMStepSolverSVD::LMStepSolverSVD( size_t nsq, size_t nvar ) : myWork(NULL) {
+  myVt = gsl_matrix_alloc(nvar, nvar);
+  mySig = gsl_vector_alloc(mymin(nsq, nvar));
+  myUtf = gsl_vector_alloc(nvar);
+  gsl_vector_set_zero(myUtf);
+  myUtb = gsl_vector_alloc(nvar);
+}
+
+LMStepSolverSVD::~LMStepSolverSVD() {
+  gsl_matrix_free(myVt);
+  gsl_vector_free(mySig);
+  gsl_vector_free(myUtf);
+  gsl_vector_free(myUtb);
+  gsl_vector_free_ifnull(myWork);
+}
+
+void LMStepSolverSVD::factorize( gsl_matrix *jac, const gsl_vector *func ) {
+  size_t status_svd = 0, minus1 = -1;
+
+  if (myWork == NULL) { /* Determine optimal work */
+    double tmp;
+    dgesvd_("A", "O", &jac->size2, &jac->size1, jac->data, &jac->tda,
+        mySig->data, myVt->data, &myVt->size2, NULL, &jac->size1, &tmp,
+        &minus1, &status_svd);
+    myWork = gsl_vector_alloc(tmp);
+  }
+
+  /* After the call jac contains U */
+  dgesvd_("A", "O", &jac->size2, &jac->size1, jac->data, &jac->tda,
+      mySig->data, myVt->data, &myVt->size2, NULL, &jac->size1,
+      myWork->data, &myWork->size, &status_svd);
+
+  gsl_vector_view Utf = gsl_vector_subvector(myUtf, 0, mySig->size);
+  gsl_matrix_view U = gsl_matrix_submatrix(jac, 0, 0, jac->size1, mySig->size);
+  gsl_blas_dgemv(CblasTrans, -1.0, &U.matrix, func, 0.0, &Utf.vector);
+  gsl_vector_mul(&Utf.vector, mySig);
+}
+
+/* utf contains -Sigma U^T f = -V^T J^T f */
+void LMStepSolverSVD::stepFromUtf( double lambda, const gsl_vector *utf, 
+                                   gsl_vector *dx ) {
+  double threshold = gsl_vector_get(mySig, 0) * LMSTEP_RANK_TOL(myVt->size2);
+  size_t i;
+
+  gsl_vector_set_zero(dx);
+  for (i = 0; (i < mySig->size) && (gsl_vector_get(mySig, i) >= threshold); i++) {
+    gsl_vector VtRow = gsl_matrix_const_row(myVt, i).vector;
+    gsl_blas_daxpy(gsl_vector_get(utf, i) /
+        (gsl_vector_get(mySig, i) * gsl_vector_get(mySig, i) + lambda), &VtRow, dx);
+  }
+}
+
+bool LMStepSolverSVD::computeStep( double lambda, gsl_vector *dx ) {
+  stepFromUtf(lambda, myUtf, dx);
+  return true;
+}
+
+bool LMStepSolverSVD::computeStepRhs( double lambda, const gsl_vector *b, 
+                                      gsl_vector *dx ) {
+  gsl_blas_dgemv(CblasNoTrans, -1.0, myVt, b, 0.0, myUtb);
+  stepFromUtf(lambda, myUtb, dx);
+  return true;
+}
+
+/* W = V Sigma^{-1} */
+bool LMStepSolverSVD::computeCovFactor( double epscov, gsl_matrix *W ) {
+  double threshold = gsl_vector_get(mySig, 0) * epscov;
+  size_t i;
+
+  gsl_matrix_set_zero(W);
+  for (i = 0; (i < mySig->size) && (gsl_vector_get(mySig, i) > threshold); i++) {
+    gsl_vector VtRow = gsl_matrix_const_row(myVt, i).vector;
+    gsl_vector Wcol = gsl_matrix_column(W, i).vector;
+    gsl_blas_daxpy(1 / gsl_vector_get(mySig, i), &VtRow, &Wcol);
+  }
+  return true;
+}
+
+double LMStepSolverSVD::getSigmaMax2() const {
+  return gsl_vector_get(mySig, 0) * gsl_vector_get(mySig, 0);
+}
+
+double LMStepSolverSVD::getCond() const {
+  double smin = gsl_vector_get(mySig, mySig->size - 1);
+  return (smin > 0 ? gsl_vector_get(mySig, 0) / smin : GSL_POSINF);
+}
+
+
+LMStepSolverQR::LMStepSolverQR( size_t nsq, size_t nvar ) : mySigmaMax2(0) {
+  size_t minus1 = -1, info = 0, one = 1;
+  double tmp, tmp2;
+
+  myJt = gsl_matrix_alloc(nvar, nsq);
+  myR = gsl_matrix_alloc(nvar, nvar);
+  myS = gsl_matrix_alloc(nvar, nvar);
+  myQtf = gsl_vector_alloc(nsq);
+  myZ = gsl_vector_alloc(nvar);
+  myW = gsl_vector_alloc(nvar);
+  myTau = gsl_vector_alloc(nvar);
+  myQtb = gsl_vector_alloc(nvar);
+  myPerm = new size_t[nvar];
+
+  /* Determine optimal work */
+  dgeqp3_(&myJt->size2, &myJt->size1, myJt->data, &myJt->tda, myPerm,
+          myTau->data, &tmp, &minus1, &info);
+  dormqr_("L", "T", &myJt->size2, &one, &myJt->size1, myJt->data,
+          &myJt->tda, myTau->data, myQtf->data, &myQtf->size, &tmp2,
+          &minus1, &info);
+  myWork = gsl_vector_alloc(mymax(tmp, tmp2));
+}
+
+LMStepSolverQR::~LMStepSolverQR() {
+  gsl_matrix_free(myJt);
+  gsl_matrix_free(myR);
+  gsl_matrix_free(myS);
+  gsl_vector_free(myQtf);
+  gsl_vector_free(myZ);
+  gsl_vector_free(myW);
+  gsl_vector_free(myTau);
+  gsl_vector_free(myWork);
+  gsl_vector_free(myQtb);
+  delete [] myPerm;
+}
+
+void LMStepSolverQR::factorize( gsl_matrix *jac, const gsl_vector *func ) {
+  size_t info = 0, one = 1, i, j, n = myR->size1;
+
+  gsl_matrix_transpose_memcpy(myJt, jac);
+  for (j = 0; j < n; j++) {
+    myPerm[j] = 0; /* All columns are free */
+  }
+  dgeqp3_(&myJt->size2, &myJt->size1, myJt->data, &myJt->tda, myPerm,
+          myTau->data, myWork->data, &myWork->size, &info);
+  gsl_vector_memcpy(myQtf, func);
+  dormqr_("L", "T", &myJt->size2, &one, &myJt->size1, myJt->data,
+          &myJt->tda, myTau->data, myQtf->data, &myQtf->size,
+          myWork->data, &myWork->size, &info);
+  if (info != 0) {
+    throw new Exception("Error in the QR factorization of the Jacobian.\n");
+  }
+
+  gsl_matrix_set_zero(myR);
+  for (i = 0; i < n; i++) {
+    for (j = i; j < n; j++) {
+      gsl_matrix_set(myR, i, j, gsl_matrix_get(myJt, j, i));
+    }
+  }
+
+  mySigmaMax2 = estimateMaxEig(myR, true);
+}
+
+/* Number of the leading diagonal elements of S above the rank threshold */
+size_t LMStepSolverQR::getNsing( const gsl_matrix *S ) const {
+  size_t n = myR->size1, nsing;
+  double threshold = fabs(gsl_matrix_get(myR, 0, 0)) * LMSTEP_RANK_TOL(n);
+  
+  for (nsing = 0; nsing < n &&
+                  fabs(gsl_matrix_get(S, nsing, nsing)) > threshold; nsing++) {
+  }
+  return nsing;
+}
+
+/* qtf contains the first n elements of Q^T f */
+void LMStepSolverQR::stepFromQtf( double lambda, const gsl_vector *qtf,
+                                  gsl_vector *dx ) {
+  size_t n = myR->size1, i, j, k, nsing;
+  double sqrt_l = sqrt(lambda);
+  double s, c, t, qtbpj, *Sk;
+
+  gsl_matrix_memcpy(myS, myR);
+  gsl_vector_memcpy(myZ, qtf);
+
+  /* Eliminate the rows sqrt(lambda) e_j^T by Givens rotations */
+  for (j = 0; j < n && sqrt_l > 0; j++) {
+    gsl_vector_set_zero(myW);
+    gsl_vector_set(myW, j, sqrt_l);
+    qtbpj = 0;
+
+    for (k = j; k < n; k++) {
+      double wk = gsl_vector_get(myW, k), skk = gsl_matrix_get(myS, k, k);
+      if (wk == 0) {
+        continue;
+      }
+      if (fabs(skk) < fabs(wk)) {
+        t = skk / wk;
+        s = 0.5 / sqrt(0.25 + 0.25 * t * t);
+        c = s * t;
+      } else {
+        t = wk / skk;
+        c = 0.5 / sqrt(0.25 + 0.25 * t * t);
+        s = c * t;
+      }
+      gsl_matrix_set(myS, k, k, c * skk + s * wk);
+      t = c * gsl_vector_get(myZ, k) + s * qtbpj;
+      qtbpj = -s * gsl_vector_get(myZ, k) + c * qtbpj;
+      gsl_vector_set(myZ, k, t);
+
+      Sk = gsl_matrix_ptr(myS, k, 0);
+      for (i = k + 1; i < n; i++) {
+        t = c * Sk[i] + s * gsl_vector_get(myW, i);
+        gsl_vector_set(myW, i, -s * Sk[i] + c * gsl_vector_get(myW, i));
+        Sk[i] = t;
+      }
+    }
+  }
+
+  /* Back substitution with truncation of the singular part */
+  nsing = getNsing(myS);
+  for (j = nsing; j < n; j++) {
+    gsl_vector_set(myZ, j, 0);
+  }
+  for (j = nsing; j > 0; j--) {
+    Sk = gsl_matrix_ptr(myS, j - 1, 0);
+    t = gsl_vector_get(myZ, j - 1);
+    for (i = j; i < nsing; i++) {
+      t -= Sk[i] * gsl_vector_get(myZ, i);
+    }
+    gsl_vector_set(myZ, j - 1, t / Sk[j - 1]);
+  }
+
+  for (j = 0; j < n; j++) {
+    gsl_vector_set(dx, myPerm[j] - 1, -gsl_vector_get(myZ, j));
+  }
+}
+
+bool LMStepSolverQR::computeStep( double lambda, gsl_vector *dx ) {
+  gsl_vector_const_view qtf = gsl_vector_const_subvector(myQtf, 0, myR->size1);
+  stepFromQtf(lambda, &qtf.vector, dx);
+  return true;
+}
+
+bool LMStepSolverQR::computeStepRhs( double lambda, const gsl_vector *b, 
+                                     gsl_vector *dx ) {
+  size_t n = myR->size1, j, nsing = getNsing(myR);
+
+  /* Q^T f = R^{-T} P^T b (on the nonsingular part of R) */
+  for (j = 0; j < n; j++) {
+    gsl_vector_set(myQtb, j, gsl_vector_get(b, myPerm[j] - 1));
+  }
+  gsl_matrix_const_view R = gsl_matrix_const_submatrix(myR, 0, 0, nsing, nsing);
+  gsl_vector_view qtb = gsl_vector_subvector(myQtb, 0, nsing);
+  gsl_blas_dtrsv(CblasUpper, CblasTrans, CblasNonUnit, &R.matrix, &qtb.vector);
+  for (j = nsing; j < n; j++) {
+    gsl_vector_set(myQtb, j, 0);
+  }
+  stepFromQtf(lambda, myQtb, dx);
+  return true;
+}
+
+/* W = P R^{-1}. If J is rank deficient, the truncated inverse of R 
+ * is not the pseudoinverse of J, and the SVD should be used instead. */
+bool LMStepSolverQR::computeCovFactor( double epscov, gsl_matrix *W ) {
+  size_t n = myR->size1, j;
+
+  if (isCovRankDeficient(myR, epscov)) {
+    return false;
+  }
+  gsl_matrix_set_identity(myS);
+  gsl_blas_dtrsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, 1.0,
+                 myR, myS);
+  for (j = 0; j < n; j++) {
+    gsl_vector Srow = gsl_matrix_row(myS, j).vector;
+    gsl_matrix_set_row(W, myPerm[j] - 1, &Srow);
+  }
+  return true;
+}
+
+double LMStepSolverQR::getCond() const {
+  double rmin = fabs(gsl_matrix_get(myR, myR->size1 - 1, myR->size1 - 1));
+  return (rmin > 0 ? fabs(gsl_matrix_get(myR, 0, 0)) / rmin : GSL_POSINF);
+}
+
+
+LMStepSolverChol::LMStepSolverChol( size_t /* nsq */, size_t nvar ) :
+    mySigmaMax2(0), myCond(GSL_POSINF), myLambdaL(-1) {
+  myJtJ = gsl_matrix_alloc(nvar, nvar);
+  myL = gsl_matrix_alloc(nvar, nvar);
+  myJtf = gsl_vector_alloc(nvar);
+}
+
+LMStepSolverChol::~LMStepSolverChol() {
+  gsl_matrix_free(myJtJ);
+  gsl_matrix_free(myL);
+  gsl_vector_free(myJtf);
+}
+
+void LMStepSolverChol::factorize( gsl_matrix *jac, const gsl_vector *func ) {
+  size_t info = 0, i;
+  double lmin, lmax;
+
+  gsl_blas_dsyrk(CblasUpper, CblasTrans, 1.0, jac, 0.0, myJtJ);
+  gsl_blas_dgemv(CblasTrans, -1.0, jac, func, 0.0, myJtf);
+
+  mySigmaMax2 = estimateMaxEig(myJtJ, false);
+
+  /* Condition number estimate from the factor of J^T J */
+  gsl_matrix_memcpy(myL, myJtJ);
+  dpotrf_("L", &myL->size1, myL->data, &myL->tda, &info);
+  if (info != 0) {
+    myCond = GSL_POSINF;
+    myLambdaL = -1;
+  } else {
+    myLambdaL = 0;
+    lmin = lmax = fabs(gsl_matrix_get(myL, 0, 0));
+    for (i = 1; i < myL->size1; i++) {
+      lmin = mymin(lmin, fabs(gsl_matrix_get(myL, i, i)));
+      lmax = mymax(lmax, fabs(gsl_matrix_get(myL, i, i)));
+    }
+    myCond = lmax / lmin;
+  }
+}
+
+bool LMStepSolverChol::factorizeShifted( double lambda ) {
+  size_t info = 0;
+
+  if (lambda != myLambdaL) { /* Otherwise the factor is already computed */
+    gsl_matrix_memcpy(myL, myJtJ);
+    gsl_vector diag = gsl_matrix_diagonal(myL).vector;
+    gsl_vector_add_constant(&diag, lambda);
+    dpotrf_("L", &myL->size1, myL->data, &myL->tda, &info);
+    if (info != 0) {
+      myLambdaL = -1;
+      return false;
+    }
+    myLambdaL = lambda;
+  }
+  return true;
+}
+
+bool LMStepSolverChol::computeStep( double lambda, gsl_vector *dx ) {
+  size_t info = 0, one = 1;
+
+  if (!factorizeShifted(lambda)) {
+    return false;
+  }
+  gsl_vector_memcpy(dx, myJtf);
+  dpotrs_("L", &myL->size1, &one, myL->data, &myL->tda, dx->data,
+          &dx->size, &info);
+  return (info == 0);
+}
+
+bool LMStepSolverChol::computeStepRhs( double lambda, const gsl_vector *b, 
+                                       gsl_vector *dx ) {
+  size_t info = 0, one = 1;
+
+  if (!factorizeShifted(lambda)) {
+    return false;
+  }
+  gsl_vector_memcpy(dx, b);
+  gsl_vector_scale(dx, -1.0);
+  dpotrs_("L", &myL->size1, &one, myL->data, &myL->tda, dx->data,
+          &dx->size, &info);
+  return (info == 0);
+}
+
+/* W = U^{-1}, where J^T J = U^T U */
+bool LMStepSolverChol::computeCovFactor( double epscov, gsl_matrix *W ) {
+  if (!factorizeShifted(0) || isCovRankDeficient(myL, epscov)) {
+    return false;
+  }
+  gsl_matrix_set_identity(W);
+  gsl_blas_dtrsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, 1.0,
+                 myL, W);
+  return true;
+}
@@ -0,0 +1,143 @@
+/** @memberof OptimizationOptions
+ * @name Solvers for the Levenberg-Marquardt step (values of opt.lm_solver)
+ * @{ */
+#define SLRA_OPT_LM_SOLVER_AUTO 0 /**< choose by the shape and conditioning of \f$J\f$ */
+#define SLRA_OPT_LM_SOLVER_SVD  1 /**< SVD (pseudoinverse), see LMStepSolverSVD */
+#define SLRA_OPT_LM_SOLVER_QR   2 /**< pivoted QR, see LMStepSolverQR */
+#define SLRA_OPT_LM_SOLVER_CHOL 3 /**< normal equations, see LMStepSolverChol */
+/* @} */
+
+/** Abstract class for computing the Levenberg-Marquardt step.
+ * The step \f$\delta\f$ is the solution of
+ * \f$\min_{\delta} \|J\delta + f\|_2^2 + \lambda \|\delta\|_2^2\f$.
+ * The factorization of \f$J\f$ is computed once by factorize() and reused
+ * by computeStep() for all the values of \f$\lambda\f$ tried at one iteration.
+ */
+class LMStepSolver {
+public:
+  virtual ~LMStepSolver() {}
+
+  /** Factorizes the Jacobian.
+   * @param[in,out] jac   Jacobian \f$J\f$, may be overwritten
+   * @param[in]     func  residual vector \f$f\f$
+   */
+  virtual void factorize( gsl_matrix *jac, const gsl_vector *func ) = 0;
+  /** Computes the step for a given \f$\lambda\f$.
+   * @return false if the step can not be computed for this \f$\lambda\f$
+   */
+  virtual bool computeStep( double lambda, gsl_vector *dx ) = 0;
+  /** Computes the step for another right-hand side, i.e., the solution of
+   * \f$(J^{\top}J + \lambda I) \delta = -b\f$, where 
+   * \f$b = J^{\top} \tilde{f}\f$ for some \f$\tilde{f}\f$ 
+   * (the factorization of \f$J\f$ is reused).
+   * @return false if the step can not be computed for this \f$\lambda\f$
+   */
+  virtual bool computeStepRhs( double lambda, const gsl_vector *b, 
+                               gsl_vector *dx ) = 0;
+  /** Computes a factor \f$W\f$ of the covariance matrix
+   * \f$(J^{\top}J)^{\dagger} = W W^{\top}\f$ from the factorization.
+   * LMStepSolverSVD truncates the singular values below epscov times 
+   * the largest one. The other solvers compute \f$(J^{\top}J)^{-1}\f$ and
+   * fail if \f$J\f$ is rank deficient with respect to epscov (the 
+   * Jacobian is then not overwritten, and can be passed to the SVD).
+   * @param[in]  epscov  relative threshold
+   * @param[out] W       \f$n_{var} \times n_{var}\f$ matrix
+   * @return false if the factor can not be computed
+   */
+  virtual bool computeCovFactor( double epscov, gsl_matrix *W ) = 0;
+  /** Returns (an estimate of) \f$\sigma_{\max}^2(J)\f$ */
+  virtual double getSigmaMax2() const = 0;
+  /** Returns an estimate of the condition number of \f$J\f$ */
+  virtual double getCond() const = 0;
+
+  /** Creates a solver of the type SLRA_OPT_LM_SOLVER_xxx
+   * for \f$J \in \mathbb{R}^{nsq \times nvar}\f$.
+   * If the type is not applicable to the given sizes, SVD is used. */
+  static LMStepSolver *create( int type, size_t nsq, size_t nvar );
+};
+
+/** Step computation by the SVD \f$J = U \Sigma V^{\top}\f$.
+ * Singular values below the threshold are truncated, therefore
+ * the solver handles rank-deficient Jacobians (overparameterization).
+ * The cost of factorization is the highest among the solvers.
+ */
+class LMStepSolverSVD : public LMStepSolver {
+  gsl_matrix *myVt;
+  gsl_vector *mySig;
+  gsl_vector *myUtf;
+  gsl_vector *myUtb;
+  gsl_vector *myWork;
+
+  void stepFromUtf( double lambda, const gsl_vector *utf, gsl_vector *dx );
+public:
+  LMStepSolverSVD( size_t nsq, size_t nvar );
+  virtual ~LMStepSolverSVD();
+  virtual void factorize( gsl_matrix *jac, const gsl_vector *func );
+  virtual bool computeStep( double lambda, gsl_vector *dx );
+  virtual bool computeStepRhs( double lambda, const gsl_vector *b, 
+                               gsl_vector *dx );
+  virtual bool computeCovFactor( double epscov, gsl_matrix *W );
+  virtual double getSigmaMax2() const;
+  virtual double getCond() const;
+};
+
+/** Step computation by the QR factorization with column pivoting
+ * \f$JP = QR\f$ (dgeqp3).
+ * For each \f$\lambda\f$ the triangular factor of
+ * \f$\begin{bmatrix} R^{\top} & \sqrt{\lambda} I\end{bmatrix}^{\top}\f$
+ * is obtained from \f$R\f$ by Givens rotations in \f$O(n^3)\f$ flops,
+ * as in MINPACK. Requires \f$nsq \ge nvar\f$.
+ */
+class LMStepSolverQR : public LMStepSolver {
+  gsl_matrix *myJt;     /* Factorized J (column-major) */
+  gsl_matrix *myR;      /* Triangular factor (row-major) */
+  gsl_matrix *myS;      /* Workspace for updated triangular factor */
+  gsl_vector *myQtf;
+  gsl_vector *myZ;
+  gsl_vector *myW;
+  gsl_vector *myTau;
+  size_t *myPerm;
+  gsl_vector *myWork;
+  gsl_vector *myQtb;
+  double mySigmaMax2;
+
+  size_t getNsing( const gsl_matrix *S ) const;
+  void stepFromQtf( double lambda, const gsl_vector *qtf, gsl_vector *dx );
+public:
+  LMStepSolverQR( size_t nsq, size_t nvar );
+  virtual ~LMStepSolverQR();
+  virtual void factorize( gsl_matrix *jac, const gsl_vector *func );
+  virtual bool computeStep( double lambda, gsl_vector *dx );
+  virtual bool computeStepRhs( double lambda, const gsl_vector *b, 
+                               gsl_vector *dx );
+  virtual bool computeCovFactor( double epscov, gsl_matrix *W );
+  virtual double getSigmaMax2() const { return mySigmaMax2; }
+  virtual double getCond() const;
+};
+
+/** Step computation by the Cholesky factorization of the normal equations
+ * \f$(J^{\top}J + \lambda I) \delta = -J^{\top} f\f$.
+ * The matrix \f$J^{\top}J\f$ is computed once per Jacobian, and only
+ * the \f$n \times n\f$ Cholesky factorization is repeated for each
+ * \f$\lambda\f$. Suitable only for well-conditioned Jacobians.
+ */
+class LMStepSolverChol : public LMStepSolver {
+  gsl_matrix *myJtJ;
+  gsl_matrix *myL;
+  gsl_vector *myJtf;
+  double mySigmaMax2;
+  double myCond;
+  double myLambdaL;     /* lambda for which myL is computed (-1 if none) */
+
+  bool factorizeShifted( double lambda );
+public:
+  LMStepSolverChol( size_t nsq, size_t nvar );
+  virtual ~LMStepSolverChol();
+  virtual void factorize( gsl_matrix *jac, const gsl_vector *func );
+  virtual bool computeStep( double lambda, gsl_vector *dx );
+  virtual bool computeStepRhs( double lambda, const gsl_vector *b, 
+                               gsl_vector *dx );
+  virtual bool computeCovFactor( double epscov, gsl_matrix *W );
+  virtual double getSigmaMax2() const { return mySigmaMax2; }
+  virtual double getCond() const { return myCond; }
+};
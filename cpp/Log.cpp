@@ -5,27 +5,36 @@
 
 #include "slra.h"
 
+#ifdef _MSC_VER
+#define SLRA_THREAD_LOCAL __declspec(thread)
+#else
+#define SLRA_THREAD_LOCAL __thread
+#endif
+
+/* Level of the calling thread (-1 if the global level is used) */
+static SLRA_THREAD_LOCAL int threadMaxLevel = -1;
+
 void Log::lprintf( Level level, char *format, ... ) {
   va_list vl;
   va_start(vl, format);  
-  Log * log = getLog();
+  char msg[MSG_MAX];  /* Not a member: the workers may call lprintf */
 
-  if (level  <= log->myMaxLevel) { 
-    log->myMsg[MSG_MAX-1] = 0;
-    vsnprintf(log->myMsg, MSG_MAX-1, format, vl); 
+  if (level <= getMaxLevel()) { 
+    msg[MSG_MAX-1] = 0;
+    vsnprintf(msg, MSG_MAX-1, format, vl); 
   
-    PRINTF(log->myMsg);
+    PRINTF(msg);
   }
 }
 
 void Log::lprintf( char *format, ... ) {
   va_list vl;
   va_start(vl, format);  
-  Log * log = getLog();
+  char msg[MSG_MAX];
 
-  log->myMsg[MSG_MAX-1] = 0;
-  vsnprintf(log->myMsg, MSG_MAX-1, format, vl); 
-  PRINTF(log->myMsg);
+  msg[MSG_MAX-1] = 0;
+  vsnprintf(msg, MSG_MAX-1, format, vl); 
+  PRINTF(msg);
   FLUSH();
 }
 
@@ -53,9 +62,20 @@ void Log::str2DispLevel( const char *str )  {
 Log *Log::myLogInstance = NULL;
   
 Log::Level Log::getMaxLevel() {
+  if (threadMaxLevel >= 0) {
+    return (Level)threadMaxLevel;
+  }
   return getLog()->myMaxLevel;
 }
 
+void Log::setThreadMaxLevel( Level maxLevel ) {
+  threadMaxLevel = maxLevel;
+}
+
+void Log::resetThreadMaxLevel() {
+  threadMaxLevel = -1;
+}
+
 Log *Log::getLog() {
   if (myLogInstance == NULL) {
     myLogInstance = new Log;
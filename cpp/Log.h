@@ -14,13 +14,19 @@ public:
   /** Initialize disp field from string */
   static void str2DispLevel( const char *str );
   static void setMaxLevel( Level maxLevel );
+  /** Returns the maximal level for the calling thread: the level set by
+   * setThreadMaxLevel() if any, and the global one otherwise */
   static Level getMaxLevel();
+  /** Overrides the maximal level for the calling thread only 
+   * (used by the worker threads, which should not print) */
+  static void setThreadMaxLevel( Level maxLevel );
+  /** Removes the override of setThreadMaxLevel() */
+  static void resetThreadMaxLevel();
 
   static void deleteLog();
   
 private:
   static const size_t MSG_MAX = 200;
-  char myMsg[MSG_MAX];
   Level myMaxLevel;
 
   static Log *getLog();
@@ -7,16 +7,35 @@ MuDependentCholesky::MuDependentCholesky( const MuDependentStructure *s,
   myDMu =  myD * myStruct->getMu();  // 
   myDN = myStruct->getN() * myD;
   myDMu_1 = myD * myStruct->getMu() - 1;
-  /* Preallocate arrays */
-  myPackedCholesky = (double*)malloc(myDN * myDMu * sizeof(double));
+  /* Preallocate arrays (except the factor) */
+  myPackedCholesky = NULL;
   myTempVijtRt = gsl_matrix_alloc(myStruct->getM(), myD);
   myTempGammaij = gsl_matrix_alloc(myD, myD);
+  myTempCoupling = (myDMu_1 > 0 ? gsl_matrix_alloc(myDMu_1, myDMu_1) : NULL);
+  myTempYr = gsl_vector_alloc(myDN);
+  myStreamL = gsl_matrix_alloc(myDMu, myDMu);
+  myStreamY = gsl_vector_alloc(myDMu);
+}
+
+void MuDependentCholesky::allocPackedCholesky() {
+  if (myPackedCholesky == NULL) {
+    myPackedCholesky = (double*)malloc(myDN * myDMu * sizeof(double));
+    if (myPackedCholesky == NULL) {
+      throw new Exception("Cannot allocate the Cholesky factor of Gamma.\n");
+    }
+  }
 }
   
 MuDependentCholesky::~MuDependentCholesky() {
-  free(myPackedCholesky);
+  if (myPackedCholesky != NULL) {
+    free(myPackedCholesky);
+  }
   gsl_matrix_free(myTempVijtRt);
   gsl_matrix_free(myTempGammaij);
+  gsl_matrix_free_ifnull(myTempCoupling);
+  gsl_vector_free(myTempYr);
+  gsl_matrix_free(myStreamL);
+  gsl_vector_free(myStreamY);
 }
 
 void MuDependentCholesky::multInvCholeskyVector( gsl_vector * y_r, long trans ) {
@@ -45,6 +64,7 @@ void MuDependentCholesky::multInvGammaVector( gsl_vector * y_r ) {
 
 void MuDependentCholesky::calcGammaCholesky( const gsl_matrix *Rt, double reg ) {
   size_t info = 0;
+  allocPackedCholesky();
   computeGammaUpperTrg(Rt);
   dpbtrf_("U", &myDN, &myDMu_1, myPackedCholesky, &myDMu, &info);
   if (info && reg > 0) {
@@ -58,6 +78,162 @@ void MuDependentCholesky::calcGammaCholesky( const gsl_matrix *Rt, double reg )
   }
 }
 
+bool MuDependentCholesky::calcGammaCholeskyBounded( const gsl_matrix *Rt, 
+         double reg, gsl_vector *y_r, double bound, double *f ) {
+  if (y_r->stride != 1 || y_r->size != myDN) {
+    return Cholesky::calcGammaCholeskyBounded(Rt, reg, y_r, bound, f);
+  }
+  size_t kd = myDMu_1, ldab = myDMu, one = 1, info = 0, c0, c1, nc, w, r, s;
+  size_t chunk = myD * mymax(getMu(), 
+                     (getN() + SLRA_BOUNDED_NCHUNK - 1) / SLRA_BOUNDED_NCHUNK);
+  double sum;
+  
+  gsl_vector_memcpy(myTempYr, y_r);
+  allocPackedCholesky();
+  computeGammaUpperTrg(Rt);
+  for (c0 = 0, *f = 0; c0 < myDN; c0 = c1) {
+    c1 = mymin(c0 + chunk, myDN);
+    nc = c1 - c0;
+    dpbtrf_("U", &nc, &kd, myPackedCholesky + c0 * ldab, &ldab, &info);
+    if (info) { /* Regularize (or fail) as in calcGammaCholesky() */
+      gsl_vector_memcpy(y_r, myTempYr);
+      return Cholesky::calcGammaCholeskyBounded(Rt, reg, y_r, bound, f);
+    }
+    dtbtrs_("U", "T", "N", &nc, &kd, &one, myPackedCholesky + c0 * ldab, 
+            &ldab, y_r->data + c0, &nc, &info);
+    gsl_vector y_c = gsl_vector_subvector(y_r, c0, nc).vector;
+    gsl_blas_ddot(&y_c, &y_c, &sum);
+    if ((*f += sum) > bound) {
+      return false;
+    }
+    if (c1 == myDN || kd == 0) {
+      continue;
+    }
+    
+    /* The views below are transposed, since the band storage is 
+     * column-major, and the elements in the band are at stride kd. */
+    w = mymin(kd, myDN - c1);
+    gsl_matrix T = gsl_matrix_view_array_with_tda(myPackedCholesky + 
+                       (c1 - kd) * ldab + kd, kd, kd, kd).matrix;
+    gsl_matrix A12 = gsl_matrix_view_array_with_tda(myPackedCholesky + 
+                         c1 * ldab, w, kd, kd).matrix;
+    gsl_matrix A22 = gsl_matrix_view_array_with_tda(myPackedCholesky + 
+                         c1 * ldab + kd, w, w, kd).matrix;
+    gsl_matrix X = gsl_matrix_submatrix(myTempCoupling, 0, 0, w, kd).matrix;
+    /* X := L_12^T = Gamma_12^T L_11^{-1} (only the band part of Gamma_12) */
+    for (s = 0; s < w; s++) {
+      for (r = 0; r < kd; r++) {
+        gsl_matrix_set(&X, s, r, r >= s ? gsl_matrix_get(&A12, s, r) : 0);
+      }
+    }
+    gsl_blas_dtrsm(CblasRight, CblasLower, CblasTrans, CblasNonUnit, 1.0, 
+                   &T, &X);
+    for (s = 0; s < w; s++) {
+      for (r = s; r < kd; r++) {
+        gsl_matrix_set(&A12, s, r, gsl_matrix_get(&X, s, r));
+      }
+    }
+    /* Gamma_22 := Gamma_22 - L_12^T L_12, y_2 := y_2 - L_12^T y_1 */
+    gsl_blas_dsyrk(CblasLower, CblasNoTrans, -1.0, &X, 1.0, &A22);
+    gsl_vector y_1 = gsl_vector_subvector(y_r, c1 - kd, kd).vector;
+    gsl_vector y_2 = gsl_vector_subvector(y_r, c1, w).vector;
+    gsl_blas_dgemv(CblasNoTrans, -1.0, &X, &y_1, 1.0, &y_2);
+  }
+  
+  return true;
+}
+
+void MuDependentCholesky::computeGammaBlock( gsl_matrix *gam, 
+         const gsl_matrix *Rt, size_t i_1, size_t j_1, double reg ) {
+  myStruct->AtVijB(gam, i_1, j_1, Rt, Rt, myTempVijtRt);
+  if (i_1 == j_1 && reg > 0) {
+    gsl_vector diag = gsl_matrix_diagonal(gam).vector;
+    gsl_vector_add_constant(&diag, reg);
+  }
+}
+
+bool MuDependentCholesky::calcFuncStreaming( const gsl_matrix *Rt, double reg,
+         gsl_vector *y_r, double bound, double *f ) {
+  if (y_r->size > myDN) {
+    throw new Exception("y_r->size > d * n\n");
+  }
+  size_t d = myD, mu = getMu(), dmu = myDMu, n = y_r->size / d, 
+         i, k, t, a, a2, b, c, w, info = 0;
+  double reg_cur = 0, s, *L_i, *L_k, *z_i, *z_k;
+
+  while (1) {
+    prepareGammaBlocks(Rt, reg_cur);
+    for (i = 0, *f = 0; i < n && !info; i++) {
+      /* Block row i of L_Gamma (d x d*mu, row-major) and block i of 
+       * L_Gamma^{-T} y_r overwrite those of i - mu, not needed anymore */
+      L_i = myStreamL->data + (i % mu) * d * dmu;
+      z_i = myStreamY->data + (i % mu) * d;
+      for (t = 0; t < mu; t++) {
+        gsl_matrix G_it = gsl_matrix_view_array_with_tda(L_i + t * d, 
+                              d, d, dmu).matrix;
+        if (i + t < n) {
+          computeGammaBlock(&G_it, Rt, i, i + t, reg_cur);
+        } else {
+          gsl_matrix_set_zero(&G_it);
+        }
+      }
+      for (a = 0; a < d; a++) {
+        z_i[a] = gsl_vector_get(y_r, i * d + a);
+      }
+      /* Subtract L_ki^T [L_ki ... L_k,k+mu-1] and L_ki^T z_k 
+       * (only the upper triangle of the diagonal block is needed) */
+      for (k = (i + 1 > mu ? i + 1 - mu : 0); k < i; k++) {
+        L_k = myStreamL->data + (k % mu) * d * dmu + (i - k) * d;
+        z_k = myStreamY->data + (k % mu) * d;
+        w = dmu - (i - k) * d;
+        for (c = 0; c < d; c++) {
+          for (a = 0; a < d; a++) {
+            s = L_k[c * dmu + a];
+            for (b = a; b < w; b++) {
+              L_i[a * dmu + b] -= s * L_k[c * dmu + b];
+            }
+            z_i[a] -= s * z_k[c];
+          }
+        }
+      }
+      /* Eliminate within the block row: L_ii^T L_ii = G_ii, 
+       * L_ij = L_ii^{-T} G_ij, z_i = L_ii^{-T} z_i */
+      for (a = 0; a < d; a++) {
+        if (!((s = L_i[a * dmu + a]) > 0)) {
+          info = i * d + a + 1;
+          break;
+        }
+        L_i[a * dmu + a] = s = sqrt(s);
+        for (b = a + 1; b < dmu; b++) {
+          L_i[a * dmu + b] /= s;
+        }
+        z_i[a] /= s;
+        for (a2 = a + 1; a2 < d; a2++) {
+          s = L_i[a * dmu + a2];
+          for (b = a2; b < dmu; b++) {
+            L_i[a2 * dmu + b] -= s * L_i[a * dmu + b];
+          }
+          z_i[a2] -= s * z_i[a];
+        }
+        *f += z_i[a] * z_i[a];
+      }
+      if (*f > bound) {
+        return false;
+      }
+    }
+    if (!info) {
+      return true;
+    }
+    if (reg_cur > 0 || !(reg > 0)) {
+      throw new Exception("Gamma is singular (DPBTRF info = %d).\n", info); 
+    }
+    Log::lprintf(Log::LOG_LEVEL_NOTIFY, "Gamma is singular (DPBTRF info = %d), "
+        "adding regularization, reg = %f.\n", info, reg);
+    reg_cur = reg;
+    info = 0;
+  }
+}
+
 void MuDependentCholesky::computeGammaUpperTrg( const gsl_matrix *Rt, double reg ) {
   gsl_matrix gamma_ij;
   gsl_vector diag;
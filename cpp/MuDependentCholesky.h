@@ -1,3 +1,6 @@
+/** Number of chunks in MuDependentCholesky::calcGammaCholeskyBounded() */
+#define SLRA_BOUNDED_NCHUNK 16
+
 /** Implementation of Cholesky class for the MuDependentStructure.
  */
 class MuDependentCholesky : public Cholesky {
@@ -11,12 +14,35 @@ protected:
   size_t myDMu_1;                  /// \f$d(\mu-1)\f$    
   gsl_matrix *myTempVijtRt;        /// Temporary storage for \f$\mathrm{V}_{\#ij} R^{\top}\f$
   gsl_matrix *myTempGammaij;       /// Temporary storage for \f$\Gamma_{\#ij}\f$ 
+  gsl_matrix *myTempCoupling;      /// Temporary storage for a block of \f$\mathrm{L}_{\Gamma}\f$ between chunks
+  gsl_vector *myTempYr;            /// Copy of \f$y_r\f$ in calcGammaCholeskyBounded()
+  gsl_matrix *myStreamL;           /// Last \f$\mu\f$ block rows of \f$\mathrm{L}_{\Gamma}\f$ in calcFuncStreaming()
+  gsl_vector *myStreamY;           /// Last \f$\mu\f$ blocks of \f$\mathrm{L}_{\Gamma}^{-\top} y_r\f$ in calcFuncStreaming()
 
   /** The packed representation for $\f$\mathrm{L}_{\Gamma}\f$ 
    * and upper block-triangular part of \f$\Gamma(R)\f$.
-   * Stored in column-major order. */
+   * Stored in column-major order. Allocated at the first factorization. */
   double *myPackedCholesky;
 protected:  
+  /** Allocates MuDependentCholesky::myPackedCholesky if needed */
+  void allocPackedCholesky();
+
+  /** Prepares the computation of the blocks by computeGammaBlock(). 
+   * @param[in] Rt        the matrix \f$R^{\top} \in \mathbb{R}^{m \times d}\f$.
+   * @param[in] reg       a regularization parameter \f$\gamma\f$. */
+  virtual void prepareGammaBlocks( const gsl_matrix * /* Rt */,
+                                   double /* reg */ ) {}
+
+  /** Computes the block \f$\Gamma_{\#ij}\f$, \f$i \le j\f$, 
+   * with \f$\gamma I_d\f$ added if \f$i = j\f$.
+   * Should be called after prepareGammaBlocks() with the same \f$R\f$.
+   * @param[out] gam      the \f$d \times d\f$ block
+   * @param[in] Rt        the matrix \f$R^{\top} \in \mathbb{R}^{m \times d}\f$.
+   * @param[in] i_1       \f$0\f$-based block row index
+   * @param[in] j_1       \f$0\f$-based block column index
+   * @param[in] reg       a regularization parameter \f$\gamma\f$. */
+  virtual void computeGammaBlock( gsl_matrix *gam, const gsl_matrix *Rt,
+                                  size_t i_1, size_t j_1, double reg );
 
   /** The function computes the upper triangular part of \f$\Gamma(R)\f$
    * and puts it in MuDependentCholesky::myPackedCholesky.
@@ -43,6 +69,21 @@ public:
   virtual void calcGammaCholesky( const gsl_matrix *Rt, double reg = 0 );
   virtual void multInvCholeskyVector( gsl_vector * y_r, long trans );
   virtual void multInvGammaVector( gsl_vector * y_r );
+  /** Factorizes \f$\Gamma(R)\f$ and solves with \f$\mathrm{L}_{\Gamma}^{\top}\f$
+   * in SLRA_BOUNDED_NCHUNK chunks of at least \f$\mu\f$ block rows.
+   * Each chunk is factorized by DPBTRF, then the coupling block of 
+   * \f$\mathrm{L}_{\Gamma}\f$ with the next chunk is computed by a 
+   * triangular solve, and the next diagonal block is downdated. */
+  virtual bool calcGammaCholeskyBounded( const gsl_matrix *Rt, double reg,
+                                         gsl_vector *yr, double bound, 
+                                         double *f );
+  /** Computes the factor block row by block row, together with 
+   * the forward substitution, keeping only the last \f$\mu\f$ block rows
+   * of \f$\mathrm{L}_{\Gamma}\f$ (\f$O(\mu^2 d^2)\f$ memory). 
+   * The blocks of \f$\Gamma(R)\f$ are computed on the fly by 
+   * computeGammaBlock(), and the stored factor is not touched. */
+  virtual bool calcFuncStreaming( const gsl_matrix *Rt, double reg,
+                                  gsl_vector *yr, double bound, double *f );
   /**@}*/
 
   /** @name Wrappers for MuDependentStructure methods */
@@ -8,13 +8,19 @@ class MyIterationLogger : public IterationLogger {
   gsl_matrix *myRs;
   gsl_matrix *R;
   gsl_matrix *myInfo;
+  double myMaxTime;
 public:
-  MyIterationLogger( NLSVarpro *fun, gsl_matrix *Rs, gsl_matrix *info ) :
-    myFun(fun), myRs(Rs), myInfo(info) {
+  MyIterationLogger( NLSVarpro *fun, gsl_matrix *Rs, gsl_matrix *info,
+                     double maxtime = 0 ) :
+    myFun(fun), myRs(Rs), myInfo(info), myMaxTime(maxtime) {
     myTimer.start();
   }
   virtual void reportIteration( int no, const gsl_vector *x, double fmin, 
                                const gsl_vector *grad );
+  /** Stops the optimization when the time budget is exhausted */
+  virtual bool stopRequested() {
+    return myMaxTime > 0 && myTimer.getElapsedTime() > myMaxTime;
+  }
 };
 
 
@@ -18,6 +18,51 @@ public:
   /** Computes the vector \f$g\f$ and the Jacobian (or pseudo-jacobian) */
   virtual void computeFuncAndJac( const gsl_vector* x, gsl_vector *res, 
                                   gsl_matrix *jac ) = 0;
+  /** Computes \f$f\f$, possibly stopping early if \f$f > \mathrm{bound}\f$.
+   * Used for trial points that are rejected if \f$f\f$ does not decrease.
+   * @return `true` if \f$f \le \mathrm{bound}\f$, otherwise `*f` 
+   * is only a lower bound of \f$f\f$ */
+  virtual bool computeFuncBounded( const gsl_vector* x, double bound, 
+                                   double *f ) {
+    computeFuncAndGrad(x, f, NULL);
+    return *f <= bound;
+  }
+  /** Returns the number of blocks \f$N\f$ if \f$f\f$ is a sum of \f$N\f$ 
+   * terms that can be sampled by setBlockSample() (1 otherwise) */
+  virtual size_t getNBlocks() { return 1; }
+  /** Restricts computeFuncAndGrad() and computeFuncBounded() to a sample
+   * of the blocks, so that they return a scaled estimate of \f$f\f$ and 
+   * its gradient; the sample is removed if `blocks == NULL`.
+   * @param[in] blocks  increasing \f$0\f$-based indices of the blocks
+   * @param[in] n       number of the blocks in the sample */
+  virtual void setBlockSample( const size_t * /* blocks */, size_t /* n */ ) {}
+  /** Sets the size \f$s\f$ of a row sketch \f$S\f$ (see SparseSketch).
+   * If supported, computeFuncAndJac() returns \f$Sg\f$ and \f$SJ\f$,
+   * and getNsq() returns \f$s\f$, until the sketch is removed by 
+   * `setSketchSize(0)`; computeFuncAndGrad() is not affected.
+   * @return `false` if sketching is not supported */
+  virtual bool setSketchSize( size_t /* s */ ) { return false; }
+  /** Returns false if computeFuncAndJac() returns a pseudo-jacobian
+   * \f$\tilde{J}\f$, for which \f$\tilde{J}^{\top} g\f$ is the exact
+   * (half) gradient, but \f$\tilde{J}\delta\f$ is not the directional
+   * derivative of \f$g\f$ */
+  virtual bool isJacobianExact() { return true; }
+  /** Adapts the parametrization to the current point.
+   * Called by the optimization methods after an accepted step. If the 
+   * parametrization is changed, \f$x\f$ is re-expressed in the new 
+   * parametrization (\f$f(x)\f$ is unchanged), and the optimizer has to
+   * discard all the quantities computed at the old \f$x\f$.
+   * @param[in,out] x   current point
+   * @return `true` if the parametrization was changed
+   */
+  virtual bool updateParametrization( gsl_vector * /* x */ ) { return false; }
+  /** Returns the size of the internal state of an adaptive parametrization
+   * (saved in checkpoints together with \f$x\f$, see Checkpoint) */
+  virtual size_t getParamStateSize() { return 0; }
+  /** Stores the internal state of the parametrization in a vector */
+  virtual void getParamState( gsl_vector * /* state */ ) {}
+  /** Restores the internal state of the parametrization from a vector */
+  virtual void setParamState( const gsl_vector * /* state */ ) {}
 
   static double _f( const gsl_vector* x, void* params ) {
     double f;
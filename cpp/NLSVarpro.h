@@ -29,6 +29,9 @@ public:
     
     virtual void RTheta2x( const gsl_matrix *RTheta, gsl_vector *x ) = 0;
     virtual void x2RTheta( gsl_matrix *RTheta, const gsl_vector *x ) = 0;
+    /** Brings \f$R\f$ to the normalization of the initial parametrization
+     * (if the parametrization was adapted during the optimization). */
+    virtual void normalizeRTheta( gsl_matrix * /* RTheta */ ) {}
     
     /* To remove: */
   
@@ -39,6 +42,20 @@ public:
     gsl_matrix_free(Rtheta);
   }
   
+  virtual bool computeFuncBounded( const gsl_vector* x, double bound, 
+                                   double *f ) {
+    gsl_matrix *Rtheta = gsl_matrix_alloc(getM(), getD());
+    x2RTheta(Rtheta, x);
+    bool res = myFun.computeFuncBounded(Rtheta, bound, f);
+    gsl_matrix_free(Rtheta);
+    return res;
+  }
+  
+  virtual size_t getNBlocks() { return myFun.getNBlocks(); }
+  virtual void setBlockSample( const size_t *blocks, size_t n ) {
+    myFun.setBlockSample(blocks, n);
+  }
+  
   virtual void computePhat( gsl_vector* p, const gsl_vector* x ) {
     gsl_matrix *Rtheta = gsl_matrix_alloc(getM(), getD());
     x2RTheta(Rtheta, x);
@@ -1,37 +1,26 @@
 #include <memory.h>
 #include "slra.h"
 
-void a_kron_id( const gsl_matrix *A, size_t d,  gsl_matrix *IkronA ) {
-  gsl_matrix_set_zero(IkronA);
-  
-  for (size_t  i = 0; i < A->size1; i++) {
-    for (size_t  j = 0; j < A->size2; j++) {
-      
-      gsl_matrix subA = gsl_matrix_submatrix(IkronA, d * i, d * j, d, d).matrix;
-      gsl_vector diag = gsl_matrix_diagonal(&subA).vector;
-      gsl_vector_set_all(&diag, gsl_matrix_get(A, i, j));
-    }
-  }
-}
-
 NLSVarproPsiVecR::NLSVarproPsiVecR( VarproFunction &fun, const gsl_matrix *PsiT ) :
-      NLSVarpro(fun) {
+      NLSVarpro(fun), myPsiT(NULL), myPsiTOp(NULL) {
   if (PsiT == NULL) {
-    myPsiTBig = gsl_matrix_alloc(myFun.getNrow() * myFun.getD(), myFun.getNrow() * myFun.getD());
-    gsl_matrix_set_identity(myPsiTBig);
+    myNvar = myFun.getNrow() * myFun.getD();
     myNEssVar = (myFun.getNrow() - myFun.getD()) * myFun.getD();
   } else {
     if (PsiT->size1 < PsiT->size2) {
       throw new Exception("Incorrect sizes of Psi matrix.\n");
     }
 
+    myPsiT = gsl_matrix_alloc(PsiT->size1, PsiT->size2);
+    gsl_matrix_memcpy(myPsiT, PsiT);
     if (PsiT->size1 == myFun.getNrow()) {
-      myPsiTBig = gsl_matrix_alloc((PsiT->size1) * myFun.getD(), (PsiT->size2) * myFun.getD());
-      a_kron_id(PsiT, myFun.getD(), myPsiTBig);
+      /* R = Psi^T X, i.e. vec(R) = (Psi^T (x) I_d) vec(X) */
+      myPsiTOp = new KronOperator(myPsiT, myFun.getD());
+      myNvar = (PsiT->size2) * myFun.getD();
       myNEssVar = (PsiT->size2 - myFun.getD()) * myFun.getD();
     } else {
-      myPsiTBig = gsl_matrix_alloc(PsiT->size1, PsiT->size2);
-      gsl_matrix_memcpy(myPsiTBig, PsiT);
+      myPsiTOp = new KronOperator(myPsiT, 1);
+      myNvar = PsiT->size2;
       myNEssVar = PsiT->size2;
     }
   }
@@ -42,35 +31,28 @@ NLSVarproPsiVecR::NLSVarproPsiVecR( VarproFunction &fun, const gsl_matrix *PsiT
 
 NLSVarproPsiVecR::~NLSVarproPsiVecR() {
   gsl_vector_free(myTmpRVec);
-  gsl_matrix_free(myPsiTBig);
+  gsl_matrix_free_ifnull(myPsiT);
+  if (myPsiTOp != NULL) {
+    delete myPsiTOp;
+  }
 }
 
 void NLSVarproPsiVecR::RTheta2x( const gsl_matrix *RTheta, gsl_vector *x )
 {
   gsl_matrix_memcpy(&myTmpR, RTheta);
-  
-  gsl_matrix *At = gsl_matrix_alloc(myPsiTBig->size1, myPsiTBig->size2);
-  gsl_matrix_memcpy(At, myPsiTBig);
-  
-  size_t one = 1, lwork = -1, info;
-  double tmp;
-
-  dgels_("T", &At->size2, &At->size1, &one, At->data,
-         &At->size2, myTmpRVec->data, &At->size1, &tmp, &lwork, &info);
-  double *work = new double[lwork = tmp];
-  dgels_("T", &myPsiTBig->size2, &At->size1, &one, At->data,
-         &At->size2, myTmpRVec->data, &At->size1, work, &lwork, &info);
-  delete [] work;
-  
-  gsl_matrix_free(At);
-  gsl_vector sol_x = gsl_vector_subvector(myTmpRVec, 0, x->size).vector;
-  gsl_vector_memcpy(x, &sol_x);
+  if (myPsiTOp != NULL) {
+    myPsiTOp->lsSolve(myTmpRVec, x);
+  } else {
+    gsl_vector_memcpy(x, myTmpRVec);
+  }
 }
 
 void NLSVarproPsiVecR::x2RTheta( gsl_matrix *RTheta, const gsl_vector *x )
 {
-  gsl_blas_dgemv(CblasNoTrans, 1.0, myPsiTBig, x, 0.0, myTmpRVec);
+  if (myPsiTOp != NULL) {
+    myPsiTOp->mult(x, myTmpRVec);
+  } else {
+    gsl_vector_memcpy(myTmpRVec, x);
+  }
   gsl_matrix_memcpy(RTheta, &myTmpR);
 }
-
-
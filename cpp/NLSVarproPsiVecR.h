@@ -1,7 +1,9 @@
 class NLSVarproPsiVecR : public NLSVarpro {
 protected:
   size_t myNEssVar;
-  gsl_matrix *myPsiTBig;
+  size_t myNvar;
+  gsl_matrix *myPsiT;        /* Psi^T or Psi^T (x) I_d given explicitly */
+  KronOperator *myPsiTOp;    /* myPsiT (x) I_d, or myPsiT if d' = 1 */
   gsl_vector *myTmpRVec;
   gsl_matrix myTmpR;
 public:
@@ -9,7 +11,7 @@ public:
                     const gsl_matrix *PsiT );
   virtual ~NLSVarproPsiVecR();
   
-  virtual size_t getNvar() { return myPsiTBig->size2; }
+  virtual size_t getNvar() { return myNvar; }
   virtual size_t getNEssVar() { return myNEssVar; }
 
   virtual void RTheta2x( const gsl_matrix *RTheta, gsl_vector *x );
@@ -24,8 +26,10 @@ public:
     if (grad == NULL) {
       myFun.computeFuncAndGrad(&myTmpR, f, NULL, NULL);
     } else {
-      gsl_matrix gradV = gsl_matrix_view_vector(grad, 1, grad->size).matrix;
-      myFun.computeFuncAndGrad(&myTmpR, f, myPsiTBig, &gradV);
+      gsl_matrix gradV = gsl_matrix_view_vector(grad, grad->size / 
+          (myPsiTOp != NULL ? myPsiTOp->getD() : myFun.getD()),
+          (myPsiTOp != NULL ? myPsiTOp->getD() : myFun.getD())).matrix;
+      myFun.computeFuncAndGrad(&myTmpR, f, myPsiT, &gradV);
     }
   }
 };
@@ -34,23 +38,30 @@ class NLSVarproPsiVecRCholesky : public NLSVarproPsiVecR {
 public:
     NLSVarproPsiVecRCholesky( VarproFunction &fun, const gsl_matrix *PsiT ) :  NLSVarproPsiVecR(fun, PsiT) {}
     virtual ~NLSVarproPsiVecRCholesky() {}
-    virtual size_t getNsq() { return myFun.getN() * myFun.getD(); }
+    virtual size_t getNsq() {
+      return myFun.isGCD() ? getNvar() + 1 : myFun.getN() * myFun.getD();
+    }
     virtual void computeFuncAndJac( const gsl_vector* x, gsl_vector *res,
                                    gsl_matrix *jac ) {
       x2RTheta(&myTmpR, x);
-      myFun.computeFuncAndPseudoJacobianLs(&myTmpR, myPsiTBig, res, jac);
+      myFun.computeFuncAndPseudoJacobianLs(&myTmpR, myPsiT, res, jac);
     }
+    virtual bool isJacobianExact() { return false; }
 };
 
 class NLSVarproPsiVecRCorrection : public NLSVarproPsiVecR {
 public:
     NLSVarproPsiVecRCorrection( VarproFunction &fun, const gsl_matrix *PsiT ) : NLSVarproPsiVecR(fun, PsiT)  {}
     virtual ~NLSVarproPsiVecRCorrection() {}
-    virtual size_t getNsq() { return myFun.getNp(); }
+    virtual size_t getNsq() { return myFun.getNCorrection(); }
+    virtual bool setSketchSize( size_t s ) {
+      myFun.setCorrectionSketch(s);
+      return true;
+    }
     virtual void computeFuncAndJac( const gsl_vector* x, gsl_vector *res,
                                    gsl_matrix *jac ) {
       x2RTheta(&myTmpR, x);
-      myFun.computeCorrectionAndJacobian(&myTmpR, myPsiTBig, res, jac);
+      myFun.computeCorrectionAndJacobian(&myTmpR, myPsiT, res, jac);
     }
 };
 
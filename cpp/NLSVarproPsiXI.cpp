@@ -1,8 +1,9 @@
 #include <memory.h>
 #include "slra.h"
 
-NLSVarproPsiXI::NLSVarproPsiXI( VarproFunction &fun, gsl_matrix *Psi ) :
-    NLSVarpro(fun) {
+NLSVarproPsiXI::NLSVarproPsiXI( VarproFunction &fun, gsl_matrix *Psi,
+                                double maxAbsX ) :
+    NLSVarpro(fun), myMaxAbsX(maxAbsX), myIsSwitched(false) {
   if (Psi == NULL) {
     myPsi = gsl_matrix_alloc(myFun.getNrow(), myFun.getNrow());
     gsl_matrix_set_identity(myPsi);
@@ -13,6 +14,8 @@ NLSVarproPsiXI::NLSVarproPsiXI( VarproFunction &fun, gsl_matrix *Psi ) :
     }
     gsl_matrix_memcpy(myPsi, Psi); 
   }
+  myPsiOrig = gsl_matrix_alloc(myPsi->size1, myPsi->size2);
+  gsl_matrix_memcpy(myPsiOrig, myPsi);
   myPsiSubm = gsl_matrix_submatrix(myPsi, 0, 0, myFun.getNrow(), 
                   getRank()).matrix;
   myTmpR = gsl_matrix_alloc(myFun.getNrow(), myFun.getD());
@@ -23,6 +26,7 @@ NLSVarproPsiXI::~NLSVarproPsiXI()  {
   gsl_matrix_free(myTmpR);
   gsl_matrix_free(myTmpXId);
   gsl_matrix_free(myPsi);
+  gsl_matrix_free(myPsiOrig);
 }
 
 void NLSVarproPsiXI::computeFuncAndGrad( const gsl_vector* x, double* f, 
@@ -47,7 +51,7 @@ void NLSVarproPsiXI::X2XId( const gsl_matrix *x, gsl_matrix *XId ) {
   gsl_vector_set_all(&(diag = gsl_matrix_diagonal(&sm).vector), -1);
 }
 
-void NLSVarproPsiXI::PQ2XId( const gsl_matrix *R, gsl_matrix * x ) {
+size_t NLSVarproPsiXI::PQ2XId( const gsl_matrix *R, gsl_matrix * x ) {
   gsl_matrix *tR = gsl_matrix_alloc(R->size1, R->size2);
   gsl_matrix_memcpy(tR, R);
   size_t status = 0, s1_s2 = tR->size1 - tR->size2;
@@ -55,12 +59,77 @@ void NLSVarproPsiXI::PQ2XId( const gsl_matrix *R, gsl_matrix * x ) {
   gsl_matrix B = gsl_matrix_submatrix(tR, 0, 0, s1_s2, tR->size2).matrix;
   gsl_matrix A = gsl_matrix_submatrix(tR, s1_s2, 0, tR->size2, tR->size2).matrix;
   size_t *pivot = new size_t[A.size2];
-  /* TODO: Check for singularity of A */
   dgesv_(&A.size2, &B.size1, A.data, &A.tda, pivot, B.data, &B.tda, &status);  
   delete [] pivot;
   gsl_matrix_memcpy(x, &B);
   gsl_matrix_scale(x, -1.0);
   gsl_matrix_free(tR);
+  
+  return status;
+}
+
+static double maxAbs( const gsl_matrix *x ) {
+  double min, max;
+  gsl_matrix_minmax(x, &min, &max);
+  return mymax(max, -min);
+}
+
+bool NLSVarproPsiXI::switchPivots( gsl_matrix *XId ) {
+  size_t k = XId->size1, d = XId->size2, rank = k - d, i, j;
+  size_t minus1 = -1, lwork, info = 0;
+  double tmp;
+
+  /* QR with column pivoting of XId^T (XId is XId^T in column-major order) */
+  gsl_matrix *qr = gsl_matrix_alloc(k, d);
+  gsl_matrix_memcpy(qr, XId);
+  size_t *jpvt = new size_t[k];
+  double *tau = new double[d];
+  memset(jpvt, 0, k * sizeof(size_t));
+  dgeqp3_(&d, &k, qr->data, &qr->tda, jpvt, tau, &tmp, &minus1, &info);
+  double *work = new double[lwork = tmp];
+  dgeqp3_(&d, &k, qr->data, &qr->tda, jpvt, tau, work, &lwork, &info);
+  delete [] work;
+  delete [] tau;
+  gsl_matrix_free(qr);
+
+  /* New order: non-pivot rows (in the old order), then the pivot rows */
+  gsl_permutation *perm = gsl_permutation_alloc(k);
+  bool *isPivot = new bool[k], changed = false;
+  for (i = 0; i < k; i++) {
+    isPivot[i] = false;
+  }
+  for (i = 0; i < d; i++) {
+    isPivot[jpvt[i] - 1] = true;
+    perm->data[rank + i] = jpvt[i] - 1;
+    changed = changed || (jpvt[i] - 1 < rank);
+  }
+  for (i = 0, j = 0; i < k; i++) {
+    if (!isPivot[i]) {
+      perm->data[j++] = i;
+    }
+  }
+  delete [] isPivot;
+  delete [] jpvt;
+
+  if (changed) {
+    gsl_matrix *oldXId = gsl_matrix_alloc(k, d);
+    gsl_matrix *oldPsi = gsl_matrix_alloc(myPsi->size1, myPsi->size2);
+    gsl_matrix_memcpy(oldXId, XId);
+    gsl_matrix_memcpy(oldPsi, myPsi);
+    for (i = 0; i < k; i++) {
+      gsl_vector oldRow = gsl_matrix_row(oldXId, perm->data[i]).vector;
+      gsl_vector oldCol = gsl_matrix_column(oldPsi, perm->data[i]).vector;
+      gsl_matrix_set_row(XId, i, &oldRow);
+      gsl_matrix_set_col(myPsi, i, &oldCol);
+    }
+    gsl_matrix_free(oldXId);
+    gsl_matrix_free(oldPsi);
+    Log::lprintf(Log::LOG_LEVEL_ITER, "Switching pivot rows of [X; -I].\n");
+    myIsSwitched = true;
+  }
+  gsl_permutation_free(perm);
+  
+  return changed;
 }
 
 void NLSVarproPsiXI::RTheta2x( const gsl_matrix *RTheta, gsl_vector *x ) {
@@ -70,7 +139,58 @@ void NLSVarproPsiXI::RTheta2x( const gsl_matrix *RTheta, gsl_vector *x ) {
   } else {
     ls_solve(myPsi, RTheta, myTmpXId);
   }
+  size_t status = PQ2XId(myTmpXId, &x_mat);
+  if (status || (myMaxAbsX > 0 && maxAbs(&x_mat) > myMaxAbsX)) {
+    if (switchPivots(myTmpXId)) {
+      status = PQ2XId(myTmpXId, &x_mat);
+    }
+  }
+  if (status) {
+    throw new Exception("Initial approximation has rank deficiency.\n");
+  }
+}
+
+bool NLSVarproPsiXI::updateParametrization( gsl_vector *x ) {
+  gsl_matrix x_mat = x2xmat(x);
+  if (myMaxAbsX <= 0 || maxAbs(&x_mat) <= myMaxAbsX) {
+    return false;
+  }
+  X2XId(&x_mat, myTmpXId);
+  if (!switchPivots(myTmpXId)) {
+    return false;
+  }
   PQ2XId(myTmpXId, &x_mat);
+  return true;
+}
+void NLSVarproPsiXI::getParamState( gsl_vector *state ) {
+  size_t n = myPsi->size1 * myPsi->size2;
+  gsl_vector psi = gsl_vector_subvector(state, 0, n).vector;
+  gsl_matrix psi_mat = gsl_matrix_view_vector(&psi, myPsi->size1,
+                                              myPsi->size2).matrix;
+  gsl_matrix_memcpy(&psi_mat, myPsi);
+  gsl_vector_set(state, n, myIsSwitched ? 1 : 0);
+}
+
+void NLSVarproPsiXI::setParamState( const gsl_vector *state ) {
+  size_t n = myPsi->size1 * myPsi->size2;
+  gsl_vector_const_view psi = gsl_vector_const_subvector(state, 0, n);
+  gsl_matrix_const_view psi_mat = gsl_matrix_const_view_vector(&psi.vector,
+                                      myPsi->size1, myPsi->size2);
+  gsl_matrix_memcpy(myPsi, &psi_mat.matrix);
+  myIsSwitched = (gsl_vector_get(state, n) != 0);
+}
+
+void NLSVarproPsiXI::normalizeRTheta( gsl_matrix *RTheta ) {
+  if (!myIsSwitched) {
+    return;
+  }
+  gsl_matrix *x_mat = gsl_matrix_alloc(getRank(), myFun.getD());
+  ls_solve(myPsiOrig, RTheta, myTmpXId);
+  if (!PQ2XId(myTmpXId, x_mat) && maxAbs(x_mat) < 1 / DBL_EPSILON) {
+    X2XId(x_mat, myTmpXId);
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myPsiOrig, myTmpXId, 0, RTheta);
+  }
+  gsl_matrix_free(x_mat);
 }
 
 void NLSVarproPsiXI::x2RTheta( gsl_matrix *RTheta, const gsl_vector *x ) {
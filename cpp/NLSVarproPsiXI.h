@@ -1,11 +1,32 @@
+/** \f$[X;-I]\f$ parametrization \f$R^{\top} = \Psi^{\top} [X;-I]\f$.
+ * The rows of \f$[X;-I]\f$ fixed to \f$-I\f$ (pivot rows) can be adapted
+ * during the optimization: if \f$\max|X_{ij}|\f$ exceeds a threshold
+ * (opt.xi_maxabs, by default the adaptation is off), 
+ * a better conditioned set of pivot rows is selected by the QR factorization
+ * with column pivoting of \f$[X;-I]^{\top}\f$. The columns of the 
+ * stored \f$\Psi\f$ are permuted accordingly, so that the pivot rows
+ * are always the last \f$d\f$ rows. The pivot rows are also selected
+ * by RTheta2x() if the default pivot block of the initial approximation
+ * is singular.
+ */
 class NLSVarproPsiXI : public NLSVarpro {
 protected:
   gsl_matrix *myTmpR;  
   gsl_matrix *myPsi;
+  gsl_matrix *myPsiOrig; /* Psi before switching the pivot rows */
   gsl_matrix myPsiSubm;
   gsl_matrix *myTmpXId;
+  double myMaxAbsX;
+  bool myIsSwitched;
+
+  /** Selects the pivot rows of \f$[X;-I]\f$ by QR with column pivoting.
+   * @param[in,out] XId  basis matrix, rows are permuted if the pivots change
+   * @return `true` if the pivot rows (and \f$\Psi\f$) were changed
+   */
+  bool switchPivots( gsl_matrix *XId );
 public:
-  NLSVarproPsiXI( VarproFunction &fun, gsl_matrix *Psi );
+  /** @param[in] maxAbsX threshold on \f$\max|X_{ij}|\f$ (0 - no switching) */
+  NLSVarproPsiXI( VarproFunction &fun, gsl_matrix *Psi, double maxAbsX = 0 );
   virtual ~NLSVarproPsiXI();
   virtual size_t getNvar() { return getRank() * myFun.getD(); }
   virtual void computeFuncAndGrad( const gsl_vector* x, double* f, gsl_vector *grad );
@@ -14,33 +35,54 @@ public:
   
   virtual void RTheta2x( const gsl_matrix *RTheta, gsl_vector *x );
   virtual void x2RTheta( gsl_matrix *RTheta, const gsl_vector *x ); 
+  virtual bool updateParametrization( gsl_vector *x );
+  virtual void normalizeRTheta( gsl_matrix *RTheta );
+  /** The state is \f$\mathrm{vec}(\Psi)\f$ with the permuted columns,
+   * followed by the flag of switched pivots */
+  virtual size_t getParamStateSize() { return myPsi->size1 * myPsi->size2 + 1; }
+  virtual void getParamState( gsl_vector *state );
+  virtual void setParamState( const gsl_vector *state );
+
+  double getMaxAbsX() { return myMaxAbsX; }
+  void setMaxAbsX( double maxAbsX ) { myMaxAbsX = maxAbsX; }
 
   virtual gsl_matrix x2xmat( const gsl_vector *x ) {
     return gsl_matrix_const_view_vector(x, getRank(), myFun.getD()).matrix;
   }
   static void X2XId( const gsl_matrix *x, gsl_matrix *XId );
-  static void PQ2XId( const gsl_matrix *PQ, gsl_matrix * x );
+  /** Computes \f$X = -BA^{-1}\f$, where \f$PQ = [B;A]\f$.
+   * @return `0` on success, `> 0` if \f$A\f$ is singular */
+  static size_t PQ2XId( const gsl_matrix *PQ, gsl_matrix * x );
 };
 
 class NLSVarproPsiXICholesky : public NLSVarproPsiXI {
 public: 
-  NLSVarproPsiXICholesky( VarproFunction &fun, gsl_matrix *psi ) : 
-      NLSVarproPsiXI(fun, psi) {}
+  NLSVarproPsiXICholesky( VarproFunction &fun, gsl_matrix *psi,
+                          double maxAbsX = 0 ) : 
+      NLSVarproPsiXI(fun, psi, maxAbsX) {}
   virtual ~NLSVarproPsiXICholesky() {}
-  virtual size_t getNsq() { return myFun.getN() * myFun.getD(); }
+  virtual size_t getNsq() {
+    return myFun.isGCD() ? getNvar() + 1 : myFun.getN() * myFun.getD();
+  }
   virtual void computeFuncAndJac( const gsl_vector* x, gsl_vector *res, 
                                    gsl_matrix *jac ) {
     x2RTheta(myTmpR, x);
     myFun.computeFuncAndPseudoJacobianLs(myTmpR, &myPsiSubm, res, jac); 
   }   
+  virtual bool isJacobianExact() { return false; }
 };
 
 class NLSVarproPsiXICorrection : public NLSVarproPsiXI {
 public: 
-  NLSVarproPsiXICorrection( VarproFunction &fun, gsl_matrix *psi ) : 
-      NLSVarproPsiXI(fun, psi)  {}
+  NLSVarproPsiXICorrection( VarproFunction &fun, gsl_matrix *psi,
+                            double maxAbsX = 0 ) : 
+      NLSVarproPsiXI(fun, psi, maxAbsX)  {}
   virtual ~NLSVarproPsiXICorrection() {}
-  virtual size_t getNsq() { return myFun.getNp(); }
+  virtual size_t getNsq() { return myFun.getNCorrection(); }
+  virtual bool setSketchSize( size_t s ) {
+    myFun.setCorrectionSketch(s);
+    return true;
+  }
   virtual void computeFuncAndJac( const gsl_vector* x, gsl_vector *res, 
                                   gsl_matrix *jac ) {
     x2RTheta(myTmpR, x);
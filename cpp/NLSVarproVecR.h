@@ -35,19 +35,26 @@ class NLSVarproVecRCholesky : public NLSVarproVecR {
 public:
     NLSVarproVecRCholesky( VarproFunction &fun ) :  NLSVarproVecR(fun) {}
     virtual ~NLSVarproVecRCholesky() {}
-    virtual size_t getNsq() { return myFun.getN() * myFun.getD(); }
+    virtual size_t getNsq() {
+      return myFun.isGCD() ? getNvar() + 1 : myFun.getN() * myFun.getD();
+    }
     virtual void computeFuncAndJac( const gsl_vector* x, gsl_vector *res,
                                    gsl_matrix *jac ) {
         gsl_matrix tmpR = x2xmat(x);
         myFun.computeFuncAndPseudoJacobianLs(&tmpR, NULL, res, jac);
     }
+    virtual bool isJacobianExact() { return false; }
 };
 
 class NLSVarproVecRCorrection : public NLSVarproVecR {
 public:
     NLSVarproVecRCorrection( VarproFunction &fun ) : NLSVarproVecR(fun)  {}
     virtual ~NLSVarproVecRCorrection() {}
-    virtual size_t getNsq() { return myFun.getNp(); }
+    virtual size_t getNsq() { return myFun.getNCorrection(); }
+    virtual bool setSketchSize( size_t s ) {
+      myFun.setCorrectionSketch(s);
+      return true;
+    }
     virtual void computeFuncAndJac( const gsl_vector* x, gsl_vector *res,
                                    gsl_matrix *jac ) {
         gsl_matrix tmpR = x2xmat(x);
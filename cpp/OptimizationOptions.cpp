@@ -1,4 +1,5 @@
 #include <time.h>
+#include <string.h>
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_errno.h>
@@ -13,20 +14,33 @@ OptimizationOptions::OptimizationOptions() : disp(SLRA_DEF_disp),
     submethod(SLRA_DEF_submethod),  maxiter(SLRA_DEF_maxiter),
     epsabs(SLRA_DEF_epsabs), epsrel(SLRA_DEF_epsrel), 
     epsgrad(SLRA_DEF_epsgrad), epsx(SLRA_DEF_epsx), maxx(SLRA_DEF_maxx),
-    step(SLRA_DEF_step), tol(SLRA_DEF_tol), reggamma(SLRA_DEF_reggamma),
-    ls_correction(SLRA_DEF_ls_correction), avoid_xi(SLRA_DEF_avoid_xi) {
+    maxtime(SLRA_DEF_maxtime),
+    step(SLRA_DEF_step), tol(SLRA_DEF_tol), epscov(SLRA_DEF_epscov), 
+    cov_diag(SLRA_DEF_cov_diag), lbfgs_mem(SLRA_DEF_lbfgs_mem), 
+    lm_solver(SLRA_DEF_lm_solver), sketch_size(SLRA_DEF_sketch_size),
+    sample_init(SLRA_DEF_sample_init), sample_growth(SLRA_DEF_sample_growth),
+    reggamma(SLRA_DEF_reggamma), tol_m(SLRA_DEF_tol_m),
+    ls_correction(SLRA_DEF_ls_correction), avoid_xi(SLRA_DEF_avoid_xi),
+    xi_maxabs(SLRA_DEF_xi_maxabs),
+    chkpt_iter(SLRA_DEF_chkpt_iter), chkpt_time(SLRA_DEF_chkpt_time),
+    resume(SLRA_DEF_resume) {
+  chkpt_file[0] = 0;
 }
 
 void OptimizationOptions::str2Method( const char *str )  {
-  char meth_codes[] = "lqnp", 
-       sm_codes_lm[] = "ls", sm_codes_qn[] = "b2pf", sm_codes_nm[] = "n2r", sm_codes_lmpinv[] = "su";
-  char *submeth_codes[] = { sm_codes_lm, sm_codes_qn, sm_codes_nm, sm_codes_lmpinv };
+  char meth_codes[] = "lqnpgb", 
+       sm_codes_lm[] = "ls", sm_codes_qn[] = "b2pf", sm_codes_nm[] = "n2r", sm_codes_lmpinv[] = "sua",
+       sm_codes_grass[] = "t", sm_codes_lbfgs[] = "w";
+  char *submeth_codes[] = { sm_codes_lm, sm_codes_qn, sm_codes_nm, sm_codes_lmpinv,
+                            sm_codes_grass, sm_codes_lbfgs };
 
   size_t submeth_codes_max[] = { 
     sizeof(sm_codes_lm) / sizeof(sm_codes_lm[0]) - 1, 
     sizeof(sm_codes_qn) / sizeof(sm_codes_qn[0]) - 1, 
     sizeof(sm_codes_nm) / sizeof(sm_codes_nm[0]) - 1,
-    sizeof(sm_codes_lmpinv) / sizeof(sm_codes_lmpinv[0]) - 1
+    sizeof(sm_codes_lmpinv) / sizeof(sm_codes_lmpinv[0]) - 1,
+    sizeof(sm_codes_grass) / sizeof(sm_codes_grass[0]) - 1,
+    sizeof(sm_codes_lbfgs) / sizeof(sm_codes_lbfgs[0]) - 1
   };
   size_t meth_code_max = sizeof(submeth_codes_max) / sizeof(submeth_codes_max[0]);
   long i;
@@ -59,7 +73,7 @@ void OptimizationOptions::str2Method( const char *str )  {
 
 
 int OptimizationOptions::gslOptimize( NLSFunction *F, gsl_vector* x_vec, 
-        gsl_matrix *v, IterationLogger *itLog ) {
+        gsl_matrix *v, IterationLogger *itLog, Checkpoint *chk ) {
   const gsl_multifit_fdfsolver_type *Tlm[] =
     { gsl_multifit_fdfsolver_lmder, gsl_multifit_fdfsolver_lmsder };
   const gsl_multimin_fdfminimizer_type *Tqn[] = 
@@ -139,14 +153,15 @@ int OptimizationOptions::gslOptimize( NLSFunction *F, gsl_vector* x_vec,
   status = GSL_SUCCESS;  
   status_dx = GSL_CONTINUE;
   status_grad = GSL_CONTINUE;  
-  this->iter = 0;
+  /* When resuming, the solver is restarted from the saved point */
+  this->iter = (chk != NULL && chk->isLoaded() ? chk->getIter() : 0);
   
   switch (this->method) {
   case SLRA_OPT_METHOD_LM:
     gsl_blas_ddot(solverlm->f, solverlm->f, &this->fmin);
     gsl_multifit_gradient(solverlm->J, solverlm->f, g);
     gsl_vector_scale(g, 2);
-    {
+    if (Log::getMaxLevel() >= Log::LOG_LEVEL_NOTIFY) { /* Only a diagnostic */
       gsl_vector *g2 = gsl_vector_alloc(g->size);
       F->computeFuncAndGrad(x_vec, NULL, g2);
       gsl_vector_sub(g2, g);
@@ -159,13 +174,14 @@ int OptimizationOptions::gslOptimize( NLSFunction *F, gsl_vector* x_vec,
       gsl_vector_free(g2);
     }
     if (itLog != NULL) {
-      itLog->reportIteration(0, solverlm->x, this->fmin, g);
+      itLog->reportIteration(this->iter, solverlm->x, this->fmin, g);
     }
     break;
   case SLRA_OPT_METHOD_QN:
     this->fmin = gsl_multimin_fdfminimizer_minimum(solverqn);
     if (itLog != NULL) {
-      itLog->reportIteration(0, solverqn->x, this->fmin, solverqn->gradient);
+      itLog->reportIteration(this->iter, solverqn->x, this->fmin, 
+                             solverqn->gradient);
     }
     break;
   case SLRA_OPT_METHOD_NM:
@@ -179,7 +195,8 @@ int OptimizationOptions::gslOptimize( NLSFunction *F, gsl_vector* x_vec,
   while (status_dx == GSL_CONTINUE && 
 	 status_grad == GSL_CONTINUE &&
 	 status == GSL_SUCCESS &&
-	 this->iter < this->maxiter) {
+	 this->iter < this->maxiter &&
+	 !(itLog != NULL && itLog->stopRequested())) {
   	if (this->method == SLRA_OPT_METHOD_LM && this->maxx > 0) {
   	  if (gsl_vector_max(solverlm->x) > this->maxx || 
   	      gsl_vector_min(solverlm->x) < -this->maxx ){
@@ -231,10 +248,39 @@ int OptimizationOptions::gslOptimize( NLSFunction *F, gsl_vector* x_vec,
       }
       break;
     }
+    
+    /* Adapt the parametrization, restart the solver if it has changed */
+    switch (this->method) {
+    case SLRA_OPT_METHOD_LM:
+      gsl_vector_memcpy(x_vec, solverlm->x);
+      if (F->updateParametrization(x_vec)) {
+        gsl_multifit_fdfsolver_set(solverlm, &fdflm, x_vec);
+      }
+      break;
+    case SLRA_OPT_METHOD_QN:
+      gsl_vector_memcpy(x_vec, solverqn->x);
+      if (F->updateParametrization(x_vec)) {
+        gsl_multimin_fdfminimizer_set(solverqn, &fdfqn, x_vec, 
+                                      stepqn, this->tol); 
+      }
+      break;
+    case SLRA_OPT_METHOD_NM:
+      gsl_vector_memcpy(x_vec, solvernm->x);
+      if (F->updateParametrization(x_vec)) {
+        gsl_multimin_fminimizer_set(solvernm, &fnm, x_vec, stepnm);
+      }
+      break;
+    }
+    if (chk != NULL && chk->isDue(this->iter)) {
+      chk->save(this, F, x_vec);
+    }
   } 
   if (this->iter >= this->maxiter) {
     status = EITER;
   }
+  if (itLog != NULL && itLog->stopRequested()) {
+    status = ESTOP;
+  }
 
   switch (this->method) {
   case  SLRA_OPT_METHOD_LM:
@@ -262,6 +308,9 @@ int OptimizationOptions::gslOptimize( NLSFunction *F, gsl_vector* x_vec,
                   "the maximum number of iterations.\n" 
                   "The result could be far from optimal.\n");
       break;
+    case ESTOP: 
+      Log::lprintf("SLRA optimization stopped on request.\n");
+      break;
     case GSL_ETOLF:
       Log::lprintf("Lack of convergence: "
                   "progress in function value < machine EPS.\n");
@@ -320,34 +369,104 @@ static void normalizeJacobian( gsl_matrix *jac, gsl_vector *scaling ) {
   }
 }			   
 
-static void moveGN( const gsl_matrix *Vt, const gsl_vector *sig2,  const gsl_vector *ufuncsig,
-               double lambda2, gsl_vector * dx, int k, gsl_vector * scaling ) {
-  gsl_vector_set_zero(dx);
-  double threshold = gsl_vector_get(sig2, 0) * Vt->size2 * DBL_EPSILON * 100;
-  
-  size_t i;
-  
-  for (i = 0; (i<sig2->size) &&(gsl_vector_get(sig2, i) >= threshold); i++) {
-    gsl_vector VtRow = gsl_matrix_const_row(Vt, i).vector;
-    gsl_blas_daxpy(gsl_vector_get(ufuncsig, i) /
-                   (gsl_vector_get(sig2, i) * gsl_vector_get(sig2, i) + lambda2), &VtRow, dx);
-  }
-  
-/*  if (i >= k) {
-    PRINTF("Pseudoinverse threshold exceeded.\n");
-    PRINTF("Threshold: %g, i: %d, last: %g, next: %g\n",
-           threshold, i, gsl_vector_get(sig2, i-1), gsl_vector_get(sig2, i));
- }*/
- 
+/* Parameters of the geodesic acceleration, as recommended in \cite transtrum12 */
+#define LM_GEODESIC_H      0.1   /* finite difference step along the velocity */
+#define LM_GEODESIC_ALPHA  0.75  /* maximal ratio 2|a|/|v| */
 
-  
+/* Geodesic acceleration of the LM step v (in the scaled variables).
+ * The second directional derivative r_vv of the residual along v is 
+ * estimated by finite differences: with one extra residual evaluation
+ * (2/h)((r(x + hv) - r(x)) / h - Jv) if J is the exact Jacobian, and with 
+ * two evaluations (r(x + hv) - 2r(x) + r(x - hv)) / h^2 otherwise.
+ * The acceleration a solves the LM system with r replaced by r_vv, 
+ * i.e., the factorization of J is reused. 
+ * On success v is replaced by v + a/2; false is returned if 2|a|/|v| is 
+ * too large (the step should be rejected). */
+static bool lmGeodesicStep( NLSFunction *F, LMStepSolver *solver, double lambda,
+                const gsl_matrix *jac, const gsl_vector *func, 
+                const gsl_vector *x, const gsl_vector *scaling, gsl_vector *v,
+                gsl_vector *x_h, gsl_vector *r_h, gsl_vector *r_vv, 
+                gsl_vector *acc ) {
+  const double h = LM_GEODESIC_H;
+  double v_norm = gsl_blas_dnrm2(v);
+
+  if (v_norm == 0) {
+    return true;
+  }
+  /* x_h = x + h * scaling .* v */
+  gsl_vector_memcpy(x_h, v);
   if (scaling != NULL) {
-    gsl_vector_mul(dx, scaling);
+    gsl_vector_mul(x_h, scaling);
   }
-}			   
+  gsl_vector_scale(x_h, h);
+  gsl_vector_add(x_h, x);
+  F->computeFuncAndJac(x_h, r_vv, NULL);
+  gsl_vector_sub(r_vv, func);
+  if (F->isJacobianExact()) {
+    gsl_blas_dgemv(CblasNoTrans, -h, jac, v, 1.0, r_vv);
+    gsl_vector_scale(r_vv, 2 / (h * h));
+  } else {
+    /* x_h = x - h * scaling .* v */
+    gsl_vector_sub(x_h, x);
+    gsl_vector_scale(x_h, -1.0);
+    gsl_vector_add(x_h, x);
+    F->computeFuncAndJac(x_h, r_h, NULL);
+    gsl_vector_sub(r_h, func);
+    gsl_vector_add(r_vv, r_h);
+    gsl_vector_scale(r_vv, 1 / (h * h));
+  }
+  gsl_blas_dgemv(CblasTrans, 1.0, jac, r_vv, 0.0, x_h);
+  if (!solver->computeStepRhs(lambda, x_h, acc)) {
+    return false;
+  }
+  if (2 * gsl_blas_dnrm2(acc) > LM_GEODESIC_ALPHA * v_norm) {
+    return false;
+  }
+  gsl_blas_daxpy(0.5, acc, v);
+  return true;
+}
+
+/* Computes the residual, the Jacobian, the gradient and the cost function 
+ * at x. With a row sketch, the cost function and the gradient are computed
+ * exactly instead of from the sketched residual and Jacobian. */
+static void lmEvaluate( NLSFunction *F, const gsl_vector *x, int sketched,
+                        gsl_vector *func, gsl_matrix *jac, gsl_vector *g, 
+                        double *f ) {
+  F->computeFuncAndJac(x, func, jac);
+  if (sketched) {
+    F->computeFuncAndGrad(x, f, g);
+  } else {
+    gsl_multifit_gradient(jac, func, g);
+    gsl_vector_scale(g, 2);
+    gsl_blas_ddot(func, func, f);
+  }
+}
+
+/* Removes the row sketch of F and reallocates the residual, the Jacobian
+ * (with the workspace of the geodesic acceleration, if used) and 
+ * the step solver for the full number of squares */
+static void lmRemoveSketch( NLSFunction *F, int solver_type, 
+                LMStepSolver *&solver, gsl_matrix *&jac, gsl_vector *&func, 
+                gsl_matrix *&jac_g, gsl_vector *&r_h, gsl_vector *&r_vv ) {
+  F->setSketchSize(0);
+  gsl_matrix_free(jac);
+  gsl_vector_free(func);
+  jac = gsl_matrix_alloc(F->getNsq(), F->getNvar());
+  func = gsl_vector_alloc(F->getNsq());
+  if (jac_g != NULL) {
+    gsl_matrix_free(jac_g);
+    gsl_vector_free(r_h);
+    gsl_vector_free(r_vv);
+    jac_g = gsl_matrix_alloc(F->getNsq(), F->getNvar());
+    r_h = gsl_vector_alloc(F->getNsq());
+    r_vv = gsl_vector_alloc(F->getNsq());
+  }
+  delete solver;
+  solver = LMStepSolver::create(solver_type, jac->size1, jac->size2);
+}
 
 int OptimizationOptions::lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec, 
-        IterationLogger *itLog ) {
+        gsl_matrix *vfact, IterationLogger *itLog, Checkpoint *chk ) {
   int status, status_dx, status_grad, k;
   double g_norm, x_norm;
 
@@ -356,6 +475,19 @@ int OptimizationOptions::lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec,
   }
   int scaled = 1; //this->submethod;
   
+  /* Sketched LM: the steps are computed from the sketched residual and 
+   * Jacobian (sketch_size rows) until convergence, and then from the full
+   * ones. Used only if the sketch is smaller than the Jacobian, and 
+   * the sketched Jacobian is tall. */
+  int sketched = (this->sketch_size > F->getNvar() && 
+                  this->sketch_size < F->getNsq());
+  if (chk != NULL && chk->isLoaded() && chk->aux[3] == 0) {
+    sketched = 0;
+  }
+  if (sketched) {
+    sketched = F->setSketchSize(this->sketch_size);
+  }
+
   /* LM */
   gsl_matrix *jac = gsl_matrix_alloc(F->getNsq(), F->getNvar());
   gsl_vector *func = gsl_vector_alloc(F->getNsq());
@@ -364,42 +496,65 @@ int OptimizationOptions::lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec,
   gsl_vector *x_new = gsl_vector_alloc(F->getNvar());
   gsl_vector *dx = gsl_vector_alloc(F->getNvar());
   gsl_vector *scaling = scaled ? gsl_vector_alloc(F->getNvar()) : NULL;
+  
+  /* Geodesic acceleration: copy of the (scaled) Jacobian and workspace */
+  int geodesic = (this->submethod == SLRA_OPT_SUBMETHOD_LMPINV_GEODESIC);
+  gsl_matrix *jac_g = NULL;
+  gsl_vector *x_h = NULL, *r_h = NULL, *r_vv = NULL, *acc = NULL;
+  if (geodesic) {
+    jac_g = gsl_matrix_alloc(F->getNsq(), F->getNvar());
+    x_h = gsl_vector_alloc(F->getNvar());
+    r_h = gsl_vector_alloc(F->getNsq());
+    r_vv = gsl_vector_alloc(F->getNsq());
+    acc = gsl_vector_alloc(F->getNvar());
+  }
 
-  gsl_matrix *tempv = gsl_matrix_alloc(jac->size2, jac->size2);
-  gsl_vector *tempufuncsig = gsl_vector_alloc(jac->size2);
-  gsl_vector *templm = gsl_vector_alloc(jac->size2);
-  gsl_vector *sig = gsl_vector_alloc(mymin(jac->size1, jac->size2));
+  /* Step solver: in the automatic mode, use SVD if J is wide or rank 
+   * deficient by construction (the minimum-norm step is needed), otherwise 
+   * start with QR and switch to normal equations when J is well-conditioned */
+  int auto_solver = (this->lm_solver == SLRA_OPT_LM_SOLVER_AUTO);
+  int solver_type = this->lm_solver;
+  if (auto_solver) {
+    if (jac->size1 < jac->size2 || F->getNEssVar() < F->getNvar()) {
+      solver_type = SLRA_OPT_LM_SOLVER_SVD;
+      auto_solver = 0;
+    } else {
+      solver_type = SLRA_OPT_LM_SOLVER_QR;
+    }
+  }
 
   double lambda2 = 0, f_new;
   int start_lm = 1;
   
-  /* Determine optimal work */
-  size_t status_svd = 0, minus1 = -1;
-  double tmp;
-  dgesvd_("A", "O", &jac->size2, &jac->size1, jac->data, &jac->tda, sig->data,
-     tempv->data, &tempv->size2, NULL, &jac->size1, &tmp, &minus1, &status_svd);
-  gsl_vector *work_vec = gsl_vector_alloc(tmp);
-  
+  this->iter = 0;
+  if (chk != NULL && chk->isLoaded()) { /* Resume from the checkpoint */
+    this->iter = chk->getIter();
+    lambda2 = chk->aux[0];
+    start_lm = chk->aux[1];
+    if (auto_solver) {
+      solver_type = chk->aux[2];
+    }
+  }
+  LMStepSolver *solver = LMStepSolver::create(solver_type, 
+                             jac->size1, jac->size2);
+
   /* optimization loop */
   Log::lprintf(Log::LOG_LEVEL_FINAL, "SLRA optimization:\n");
     
   status = GSL_SUCCESS;  
   status_dx = GSL_CONTINUE;
   status_grad = GSL_CONTINUE;  
-  this->iter = 0;
   
   gsl_vector_memcpy(x_cur, x_vec);
   
-  F->computeFuncAndJac(x_cur, func, jac);
-  gsl_multifit_gradient(jac, func, g);
-  gsl_vector_scale(g, 2);
-  gsl_blas_ddot(func, func, &this->fmin);
+  lmEvaluate(F, x_cur, sketched, func, jac, g, &this->fmin);
   if (itLog != NULL) {
-    itLog->reportIteration(0, x_cur, this->fmin, g);
+    itLog->reportIteration(this->iter, x_cur, this->fmin, g);
   }
   
   
-  {
+  /* The gradient check costs an evaluation and only prints a diagnostic */
+  if (!sketched && Log::getMaxLevel() >= Log::LOG_LEVEL_NOTIFY) {
     gsl_vector *g2 = gsl_vector_alloc(g->size);
     F->computeFuncAndGrad(x_vec, NULL, g2);
     gsl_vector_sub(g2, g);
@@ -416,7 +571,8 @@ int OptimizationOptions::lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec,
   while (status_dx == GSL_CONTINUE &&
          status_grad == GSL_CONTINUE &&
          status == GSL_SUCCESS &&
-         this->iter < this->maxiter) {
+         this->iter < this->maxiter &&
+         !(itLog != NULL && itLog->stopRequested())) {
 	/* Check convergence criteria (except dx) */
     if (this->maxx > 0) {
   	  if (gsl_vector_max(x_cur) > this->maxx || gsl_vector_min(x_cur) < -this->maxx ){
@@ -430,23 +586,30 @@ int OptimizationOptions::lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec,
       normalizeJacobian(jac, scaling);
     }
 
-    
-    /* Compute the SVD */
-    dgesvd_("A", "O", &jac->size2, &jac->size1, jac->data, &jac->tda, sig->data,
-        tempv->data, &tempv->size2, NULL, &jac->size1, work_vec->data, 
-		&work_vec->size, &status_svd);
-
-    gsl_blas_dgemv(CblasTrans, -1.0, jac, func, 0.0, tempufuncsig);
-    gsl_vector_mul(tempufuncsig, sig);
+    if (geodesic) { /* The factorization may overwrite jac */
+      gsl_matrix_memcpy(jac_g, jac);
+    }
+    /* Factorize the Jacobian once for all trial values of lambda */
+    solver->factorize(jac, func);
+    int rejected = 0; /* A trial step of this iteration was rejected */
     while (1) {
-      moveGN(tempv, sig, tempufuncsig, lambda2, dx, F->getNEssVar(), scaling);
-      gsl_vector_memcpy(x_new, x_cur);
-      gsl_vector_add(x_new, dx);
-      F->computeFuncAndGrad(x_new, &f_new, NULL);
-	  
-	    if (f_new <= this->fmin + 1e-16) {
-        lambda2 = 0.4 * lambda2;
-	      break;
+      if (itLog != NULL && itLog->stopRequested()) {
+        status = ESTOP;
+        break;
+      }
+      if (solver->computeStep(lambda2, dx) && 
+          (!geodesic || lmGeodesicStep(F, solver, lambda2, jac_g, func, x_cur, 
+                            scaling, dx, x_h, r_h, r_vv, acc))) {
+        if (scaling != NULL) {
+          gsl_vector_mul(dx, scaling);
+        }
+        gsl_vector_memcpy(x_new, x_cur);
+        gsl_vector_add(x_new, dx);
+        /* Most trial points are rejected: stop the evaluation early */
+        if (F->computeFuncBounded(x_new, this->fmin + 1e-16, &f_new)) {
+          lambda2 = 0.4 * lambda2;
+	        break;
+	      }
 	    }
       
       if (lambda2 > 1e100) {
@@ -455,35 +618,82 @@ int OptimizationOptions::lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec,
       }
       
 	    /* Else: update lambda */
+      rejected = 1;
 	    if (start_lm) {
-        lambda2 = gsl_vector_get(sig, 0) * gsl_vector_get(sig, 0);
+        lambda2 = solver->getSigmaMax2();
 	      start_lm = 0;
       } else {
         lambda2 = 10 * lambda2;
         Log::lprintf(Log::LOG_LEVEL_ITER, "lambda: %f\n", lambda2);
       }
     }
-    /* check the dx convergence criteria */
-    if (this->epsabs != 0 || this->epsrel != 0) {
+    /* Choose the solver for the next iteration */
+    if (auto_solver) {
+      int new_type = solver_type;
+      if (solver_type == SLRA_OPT_LM_SOLVER_QR && solver->getCond() < 1e4) {
+        new_type = SLRA_OPT_LM_SOLVER_CHOL;
+      } else if (solver_type == SLRA_OPT_LM_SOLVER_CHOL && 
+                 !(solver->getCond() < 1e6)) {
+        new_type = SLRA_OPT_LM_SOLVER_QR;
+      }
+      if (new_type != solver_type) {
+        delete solver;
+        solver_type = new_type;
+        solver = LMStepSolver::create(solver_type, jac->size1, jac->size2);
+      }
+    }
+
+    if (status == ESTOP) { /* No step is accepted in this iteration */
+      this->iter--;
+      break;
+    }
+
+    /* check the dx convergence criteria. With the geodesic acceleration,
+     * a rejection of the acceleration may increase lambda up to 
+     * sigma_max^2, so that a short step does not indicate convergence. */
+    if ((this->epsabs != 0 || this->epsrel != 0) && !(geodesic && rejected)) {
       status_dx = gsl_multifit_test_delta(dx, x_cur, this->epsabs, this->epsrel);
     }     
     gsl_vector_memcpy(x_cur, x_new);
+    if (status == GSL_SUCCESS && itLog != NULL && itLog->stopRequested()) {
+      /* Keep the accepted point without evaluating the Jacobian */
+      this->fmin = f_new;
+      itLog->reportIteration(this->iter, x_cur, this->fmin, NULL);
+      break;
+    }
+    F->updateParametrization(x_cur);
 
-    F->computeFuncAndJac(x_cur, func, jac);
-    gsl_multifit_gradient(jac, func, g);
-    gsl_vector_scale(g, 2);
-    gsl_blas_ddot(func, func, &this->fmin);
+    lmEvaluate(F, x_cur, sketched, func, jac, g, &this->fmin);
 
     if (itLog != NULL) {
       itLog->reportIteration(this->iter, x_cur, this->fmin, g);
     }
     status_grad = gsl_multifit_test_gradient(g, this->epsgrad);
+    /* Near convergence, continue with the full residual and Jacobian */
+    if (sketched && (status_dx != GSL_CONTINUE || 
+                     status_grad != GSL_CONTINUE || status != GSL_SUCCESS)) {
+      sketched = 0;
+      lmRemoveSketch(F, solver_type, solver, jac, func, jac_g, r_h, r_vv);
+      lmEvaluate(F, x_cur, sketched, func, jac, g, &this->fmin);
+      status = GSL_SUCCESS;
+      status_dx = GSL_CONTINUE;
+      lambda2 = 0;
+      start_lm = 1;
+    }
+    if (chk != NULL && chk->isDue(this->iter)) {
+      chk->aux[0] = lambda2;
+      chk->aux[1] = start_lm;
+      chk->aux[2] = solver_type;
+      chk->aux[3] = sketched;
+      chk->save(this, F, x_cur);
+    }
   } 
   if (this->iter >= this->maxiter) {
     status = EITER;
   }
-
-  gsl_blas_ddot(func, func, &this->fmin);
+  if (itLog != NULL && itLog->stopRequested()) {
+    status = ESTOP;
+  }
   
   /* print exit information */  
   if (Log::getMaxLevel() >= Log::LOG_LEVEL_FINAL) { /* unless "off" */
@@ -493,6 +703,9 @@ int OptimizationOptions::lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec,
                   "the maximum number of iterations.\n" 
                   "The result could be far from optimal.\n");
       break;
+    case ESTOP: 
+      Log::lprintf("SLRA optimization stopped on request.\n");
+      break;
     case GSL_ETOLF:
       Log::lprintf("Lack of convergence: "
                   "progress in function value < machine EPS.\n");
@@ -527,7 +740,28 @@ int OptimizationOptions::lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec,
 
   gsl_vector_memcpy(x_vec, x_cur);
 
-  gsl_vector_free(work_vec);
+  /* Covariance factor from the Jacobian at the final point */
+  if (vfact != NULL) {
+    if (sketched) { /* Stopped before the switch to the full Jacobian */
+      sketched = 0;
+      lmRemoveSketch(F, solver_type, solver, jac, func, jac_g, r_h, r_vv);
+      F->computeFuncAndJac(x_cur, func, jac);
+    }
+    solver->factorize(jac, func);
+    if (!solver->computeCovFactor(this->epscov, vfact)) {
+      /* J is rank deficient: the Jacobian is not overwritten */
+      delete solver;
+      solver = LMStepSolver::create(SLRA_OPT_LM_SOLVER_SVD, jac->size1, 
+                                    jac->size2);
+      solver->factorize(jac, func);
+      solver->computeCovFactor(this->epscov, vfact);
+    }
+  }
+
+  if (sketched) {
+    F->setSketchSize(0);
+  }
+  delete solver;
   gsl_matrix_free(jac);
   gsl_vector_free(func);
   gsl_vector_free(g);
@@ -537,12 +771,687 @@ int OptimizationOptions::lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec,
     gsl_vector_free(scaling);
   }
   gsl_vector_free(dx);
-  gsl_matrix_free(tempv);
-  gsl_vector_free(tempufuncsig);
-  gsl_vector_free(templm);
-  gsl_vector_free(sig);
+  gsl_matrix_free_ifnull(jac_g);
+  gsl_vector_free_ifnull(x_h);
+  gsl_vector_free_ifnull(r_h);
+  gsl_vector_free_ifnull(r_vv);
+  gsl_vector_free_ifnull(acc);
+  
+  return GSL_SUCCESS; /* <- correct with status */
+}
+
+
+
+/* Orthonormalize the columns of X (k x d) in place: the row-major X is 
+ * the column-major X^T, therefore its LQ decomposition gives the QR of X */
+static void grassRetract( gsl_matrix *X, gsl_vector *tau, gsl_vector *work ) {
+  size_t info = 0;
+  
+  dgelqf_(&X->size2, &X->size1, X->data, &X->tda, tau->data, 
+          work->data, &work->size, &info);
+  dorglq_(&X->size2, &X->size1, &X->size2, X->data, &X->tda, tau->data, 
+          work->data, &work->size, &info);
+  if (info != 0) {
+    throw new Exception("Error in the retraction on the Grassmann manifold.\n");   
+  }
+}
+
+/* Project V on the tangent space at X: V := (I - X X^T) V */
+static void grassProject( const gsl_matrix *X, gsl_matrix *V, gsl_matrix *tmpdd ) {
+  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, X, V, 0.0, tmpdd);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, -1.0, X, tmpdd, 1.0, V);
+}
+
+/* Riemannian Hessian approximation: 
+ *   H[eta] = (I - X X^T) 2 J^T J eta - eta X^T grad_e,
+ * with the pseudo-Jacobian of F at X (O(nsq nvar) flops per product) */
+static void grassHessMulE( const gsl_matrix *X, const gsl_matrix *jac, 
+         const gsl_matrix *XtG, const gsl_vector *eta, gsl_vector *out, 
+         gsl_vector *tmpres, gsl_matrix *tmpdd ) {
+  gsl_matrix_const_view eta_mat = 
+      gsl_matrix_const_view_vector(eta, X->size1, X->size2);
+  gsl_matrix_view out_mat = gsl_matrix_view_vector(out, X->size1, X->size2);
+
+  gsl_blas_dgemv(CblasNoTrans, 1.0, jac, eta, 0.0, tmpres);
+  gsl_blas_dgemv(CblasTrans, 2.0, jac, tmpres, 0.0, out);
+  grassProject(X, &out_mat.matrix, tmpdd);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, -1.0, &eta_mat.matrix, XtG, 
+                 1.0, &out_mat.matrix);
+}
+
+int OptimizationOptions::grassOptimize( NLSFunction *F, gsl_vector* x_vec, 
+        size_t d, IterationLogger *itLog, Checkpoint *chk ) {
+  int status, status_dx, status_grad;
+  const double kappa = 0.1, theta = 1, rho_prime = 0.1;
+  size_t k = F->getNvar() / d, dim, j;
+
+  if (this->maxiter < 0 || this->maxiter > 5000) {
+    throw new Exception("opt.maxiter should be in [0;5000].\n");   
+  }
+  if (d == 0 || k * d != F->getNvar() || k <= d) {
+    throw new Exception("Incompatible dimensions for the Grassmann manifold.\n");   
+  }
+  dim = (k - d) * d;
+
+  gsl_matrix *jac = gsl_matrix_alloc(F->getNsq(), F->getNvar());
+  gsl_vector *func = gsl_vector_alloc(F->getNsq());
+  gsl_vector *g = gsl_vector_alloc(F->getNvar());
+  gsl_vector *x_cur = gsl_vector_alloc(F->getNvar());
+  gsl_vector *x_new = gsl_vector_alloc(F->getNvar());
+  gsl_vector *eta = gsl_vector_alloc(F->getNvar());
+  gsl_vector *Heta = gsl_vector_alloc(F->getNvar());
+  gsl_vector *r = gsl_vector_alloc(F->getNvar());
+  gsl_vector *delta = gsl_vector_alloc(F->getNvar());
+  gsl_vector *Hdelta = gsl_vector_alloc(F->getNvar());
+  gsl_vector *tmpres = gsl_vector_alloc(F->getNsq());
+  gsl_matrix *XtG = gsl_matrix_alloc(d, d);
+  gsl_matrix *tmpdd = gsl_matrix_alloc(d, d);
+  gsl_vector *tau = gsl_vector_alloc(d);
+  gsl_vector *work = gsl_vector_alloc(64 * k);
+  
+  gsl_matrix_view X = gsl_matrix_view_vector(x_cur, k, d);
+  gsl_matrix_view X_new = gsl_matrix_view_vector(x_new, k, d);
+  gsl_matrix_view G = gsl_matrix_view_vector(g, k, d);
+  gsl_matrix_view R = gsl_matrix_view_vector(r, k, d);
+  gsl_matrix_view Delta = gsl_matrix_view_vector(delta, k, d);
+
+  double Delta_bar = sqrt((double)d), Delta_tr = Delta_bar / 8, f_new;
+  
+  /* optimization loop */
+  Log::lprintf(Log::LOG_LEVEL_FINAL, "SLRA optimization:\n");
+    
+  status = GSL_SUCCESS;  
+  status_dx = GSL_CONTINUE;
+  status_grad = GSL_CONTINUE;  
+  this->iter = 0;
+  
+  gsl_vector_memcpy(x_cur, x_vec);
+  if (chk != NULL && chk->isLoaded()) { /* The saved X is orthonormal */
+    this->iter = chk->getIter();
+    Delta_tr = chk->aux[0];
+  } else {
+    grassRetract(&X.matrix, tau, work);
+  }
+  
+  F->computeFuncAndJac(x_cur, func, jac);
+  gsl_multifit_gradient(jac, func, g);
+  gsl_vector_scale(g, 2);
+  gsl_blas_ddot(func, func, &this->fmin);
+  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, &X.matrix, &G.matrix, 0.0, XtG);
+  grassProject(&X.matrix, &G.matrix, tmpdd);
+  if (itLog != NULL) {
+    itLog->reportIteration(this->iter, x_cur, this->fmin, g);
+  }
+  status_grad = gsl_multifit_test_gradient(g, this->epsgrad);
+  
+  while (status_grad == GSL_CONTINUE &&
+         status == GSL_SUCCESS &&
+         this->iter < this->maxiter &&
+         !(itLog != NULL && itLog->stopRequested())) {
+    this->iter++;
+
+    /* Solve the trust-region subproblem by truncated CG (Steihaug-Toint) */
+    double r_r, r_r_new, norm_r0, alpha, dHd, e_Pe = 0, e_Pd, d_Pd, 
+           e_Pe_new, tau_b, model;
+    int on_boundary = 0;
+    
+    gsl_vector_set_zero(eta);
+    gsl_vector_set_zero(Heta);
+    gsl_vector_memcpy(r, g);
+    gsl_vector_memcpy(delta, r);
+    gsl_vector_scale(delta, -1);
+    gsl_blas_ddot(r, r, &r_r);
+    norm_r0 = sqrt(r_r);
+    
+    for (j = 0; j < dim; j++) {
+      grassHessMulE(&X.matrix, jac, XtG, delta, Hdelta, tmpres, tmpdd);
+      gsl_blas_ddot(delta, Hdelta, &dHd);
+      gsl_blas_ddot(eta, delta, &e_Pd);
+      gsl_blas_ddot(delta, delta, &d_Pd);
+      alpha = r_r / dHd;
+      e_Pe_new = e_Pe + 2 * alpha * e_Pd + alpha * alpha * d_Pd;
+      
+      if (dHd <= 0 || e_Pe_new >= Delta_tr * Delta_tr) {
+        tau_b = (-e_Pd + sqrt(e_Pd * e_Pd + 
+                     d_Pd * (Delta_tr * Delta_tr - e_Pe))) / d_Pd;
+        gsl_blas_daxpy(tau_b, delta, eta);
+        gsl_blas_daxpy(tau_b, Hdelta, Heta);
+        on_boundary = 1;
+        break;
+      }
+      gsl_blas_daxpy(alpha, delta, eta);
+      gsl_blas_daxpy(alpha, Hdelta, Heta);
+      e_Pe = e_Pe_new;
+
+      gsl_blas_daxpy(alpha, Hdelta, r);
+      grassProject(&X.matrix, &R.matrix, tmpdd);
+      gsl_blas_ddot(r, r, &r_r_new);
+      if (sqrt(r_r_new) <= norm_r0 * mymin(pow(norm_r0, theta), kappa)) {
+        break;
+      }
+      gsl_vector_scale(delta, r_r_new / r_r);
+      gsl_vector_sub(delta, r);
+      grassProject(&X.matrix, &Delta.matrix, tmpdd);
+      r_r = r_r_new;
+    }
+    
+    /* Compare the actual and the predicted decrease */
+    gsl_blas_ddot(g, eta, &model);
+    gsl_blas_ddot(eta, Heta, &tau_b);
+    model = -(model + 0.5 * tau_b);
+    
+    gsl_vector_memcpy(x_new, x_cur);
+    gsl_vector_add(x_new, eta);
+    grassRetract(&X_new.matrix, tau, work);
+    /* If f_new > fmin, then rho < 0 and the step is rejected anyway */
+    F->computeFuncBounded(x_new, this->fmin, &f_new);
+    
+    double rho = (this->fmin - f_new) / model;
+    if (model <= 0 || !(rho >= 0.25)) {
+      Delta_tr = Delta_tr / 4;
+    } else if (rho > 0.75 && on_boundary) {
+      Delta_tr = mymin(2 * Delta_tr, Delta_bar);
+    }
+    Log::lprintf(Log::LOG_LEVEL_ITER, "rho: %f, Delta: %f\n", rho, Delta_tr);
+
+    if (model > 0 && rho > rho_prime) {
+      /* check the dx convergence criteria (reported together with the 
+       * gradient criterion, see SLRA_OPT_METHOD_GRASS) */
+      status_dx = GSL_CONTINUE;
+      if (this->epsabs != 0 || this->epsrel != 0) {
+        status_dx = gsl_multifit_test_delta(eta, x_cur, this->epsabs, this->epsrel);
+      }     
+      gsl_vector_memcpy(x_cur, x_new);
+      if (itLog != NULL && itLog->stopRequested()) {
+        /* Keep the accepted point without evaluating the Jacobian */
+        this->fmin = f_new;
+        itLog->reportIteration(this->iter, x_cur, this->fmin, NULL);
+        break;
+      }
+
+      F->computeFuncAndJac(x_cur, func, jac);
+      gsl_multifit_gradient(jac, func, g);
+      gsl_vector_scale(g, 2);
+      gsl_blas_ddot(func, func, &this->fmin);
+      gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, &X.matrix, &G.matrix, 
+                     0.0, XtG);
+      grassProject(&X.matrix, &G.matrix, tmpdd);
+    } else if (Delta_tr < DBL_EPSILON * Delta_bar) {
+      status = GSL_ENOPROG;
+    }
+
+    if (itLog != NULL) {
+      itLog->reportIteration(this->iter, x_cur, this->fmin, g);
+    }
+    status_grad = gsl_multifit_test_gradient(g, this->epsgrad);
+    if (chk != NULL && chk->isDue(this->iter)) {
+      chk->aux[0] = Delta_tr;
+      chk->save(this, F, x_cur);
+    }
+  } 
+  if (this->iter >= this->maxiter) {
+    status = EITER;
+  }
+  if (itLog != NULL && itLog->stopRequested()) {
+    status = ESTOP;
+  }
+
+  /* print exit information */  
+  if (Log::getMaxLevel() >= Log::LOG_LEVEL_FINAL) { /* unless "off" */
+    switch (status) {
+    case EITER: 
+      Log::lprintf("SLRA optimization terminated by reaching " 
+                  "the maximum number of iterations.\n" 
+                  "The result could be far from optimal.\n");
+      break;
+    case ESTOP: 
+      Log::lprintf("SLRA optimization stopped on request.\n");
+      break;
+    case GSL_ENOPROG:
+      Log::lprintf("Possible lack of convergence: no progress.\n");
+      break;
+    default:
+      if (status_dx != GSL_CONTINUE) {
+        Log::lprintf("Optimization terminated by reaching the convergence "
+                    "tolerance for both X and the gradient.\n"); 
+      } else {
+        Log::lprintf("Optimization terminated by reaching the convergence "
+	            "tolerance for the gradient.\n");
+      }
+    }
+  }
+
+  gsl_vector_memcpy(x_vec, x_cur);
+
+  gsl_matrix_free(jac);
+  gsl_vector_free(func);
+  gsl_vector_free(g);
+  gsl_vector_free(x_cur);
+  gsl_vector_free(x_new);
+  gsl_vector_free(eta);
+  gsl_vector_free(Heta);
+  gsl_vector_free(r);
+  gsl_vector_free(delta);
+  gsl_vector_free(Hdelta);
+  gsl_vector_free(tmpres);
+  gsl_matrix_free(XtG);
+  gsl_matrix_free(tmpdd);
+  gsl_vector_free(tau);
+  gsl_vector_free(work);
+  
+  return GSL_SUCCESS; /* <- correct with status */
+}
+
+/* Evaluate the cost function and the gradient at x + alpha p,
+ * return the directional derivative */
+static double lineSearchEval( NLSFunction *F, const gsl_vector *x, 
+                  const gsl_vector *p, double alpha, gsl_vector *x_new, 
+                  double *f_new, gsl_vector *g_new ) {
+  double dg;
+  
+  gsl_vector_memcpy(x_new, x);
+  gsl_blas_daxpy(alpha, p, x_new);
+  F->computeFuncAndGrad(x_new, f_new, g_new);
+  gsl_blas_ddot(g_new, p, &dg);
+  return dg;
+}
+
+/* Minimizer of the cubic interpolating f and f' at a and b, 
+ * safeguarded to lie in the middle part of the interval */
+static double cubicMinimizer( double a, double fa, double dga, 
+                              double b, double fb, double dgb ) {
+  double d1 = dga + dgb - 3 * (fa - fb) / (a - b), d2 = d1 * d1 - dga * dgb,
+         lo = mymin(a, b), hi = mymax(a, b), res;
+  
+  if (d2 < 0) {
+    return (a + b) / 2;
+  } 
+  d2 = (b > a ? 1 : -1) * sqrt(d2);
+  res = b - (b - a) * (dgb + d2 - d1) / (dgb - dga + 2 * d2);
+  if (!(res >= lo + 0.1 * (hi - lo) && res <= hi - 0.1 * (hi - lo))) {
+    return (a + b) / 2;
+  }
+  return res;
+}
+
+/* Line search for the strong Wolfe conditions 
+ * (Algorithms 3.5 and 3.6 in Nocedal & Wright).
+ * On success returns GSL_SUCCESS, and x_new, f_new, g_new, alpha 
+ * correspond to the accepted point. Returns ESTOP if itLog requests 
+ * to stop before an evaluation. */
+static int lineSearchWolfe( NLSFunction *F, const gsl_vector *x, double f0, 
+                  double dg0, const gsl_vector *p, double *alpha, 
+                  gsl_vector *x_new, double *f_new, gsl_vector *g_new,
+                  IterationLogger *itLog ) {
+  const double c1 = 1e-4, c2 = 0.9;
+  const size_t maxeval = 30;
+  double a_prev = 0, f_prev = f0, dg_prev = dg0, a = *alpha, f, dg,
+         a_lo, f_lo, dg_lo, a_hi, f_hi, dg_hi;
+  size_t i;
+  
+  /* Bracketing phase */
+  for (i = 0; ; i++) {
+    if (itLog != NULL && itLog->stopRequested()) {
+      return ESTOP;
+    }
+    dg = lineSearchEval(F, x, p, a, x_new, &f, g_new);
+    if (i >= maxeval) {
+      return GSL_ENOPROG;
+    }
+    if (f > f0 + c1 * a * dg0 || (i > 0 && f >= f_prev)) {
+      a_lo = a_prev; f_lo = f_prev; dg_lo = dg_prev;
+      a_hi = a; f_hi = f; dg_hi = dg;
+      break;
+    }
+    if (fabs(dg) <= -c2 * dg0) {
+      *alpha = a;
+      *f_new = f;
+      return GSL_SUCCESS;
+    }
+    if (dg >= 0) {
+      a_lo = a; f_lo = f; dg_lo = dg;
+      a_hi = a_prev; f_hi = f_prev; dg_hi = dg_prev;
+      break;
+    }
+    a_prev = a; f_prev = f; dg_prev = dg;
+    a = 2 * a;
+  }
+  
+  /* Zoom phase */
+  for (i = 0; i < maxeval; i++) {
+    if (itLog != NULL && itLog->stopRequested()) {
+      return ESTOP;
+    }
+    a = cubicMinimizer(a_lo, f_lo, dg_lo, a_hi, f_hi, dg_hi);
+    dg = lineSearchEval(F, x, p, a, x_new, &f, g_new);
+    if (f > f0 + c1 * a * dg0 || f >= f_lo) {
+      a_hi = a; f_hi = f; dg_hi = dg;
+    } else {
+      if (fabs(dg) <= -c2 * dg0) {
+        *alpha = a;
+        *f_new = f;
+        return GSL_SUCCESS;
+      }
+      if (dg * (a_hi - a_lo) >= 0) {
+        a_hi = a_lo; f_hi = f_lo; dg_hi = dg_lo;
+      }
+      a_lo = a; f_lo = f; dg_lo = dg;
+    }
+  }
+  
+  /* Accept the best point with sufficient decrease, if any */
+  if (a_lo > 0) {
+    lineSearchEval(F, x, p, a_lo, x_new, f_new, g_new);
+    *alpha = a_lo;
+    return GSL_SUCCESS;
+  }
+  return GSL_ENOPROG;
+}
+
+int OptimizationOptions::lbfgsOptimize( NLSFunction *F, gsl_vector* x_vec, 
+        IterationLogger *itLog, Checkpoint *chk ) {
+  int status, status_dx, status_grad;
+  size_t n = F->getNvar(), mem = this->lbfgs_mem, n_pairs = 0, newest = 0, 
+         i, l;
+
+  if (this->maxiter < 0 || this->maxiter > 5000) {
+    throw new Exception("opt.maxiter should be in [0;5000].\n");   
+  }
+  if (mem < 1) {
+    throw new Exception("opt.lbfgs_mem should be positive.\n");   
+  }
+
+  gsl_matrix *S = gsl_matrix_calloc(mem, n);
+  gsl_matrix *Y = gsl_matrix_calloc(mem, n);
+  gsl_vector *rho = gsl_vector_calloc(mem);
+  gsl_vector *a = gsl_vector_alloc(mem);
+  gsl_vector *g = gsl_vector_alloc(n);
+  gsl_vector *g_new = gsl_vector_alloc(n);
+  gsl_vector *x_cur = gsl_vector_alloc(n);
+  gsl_vector *x_new = gsl_vector_alloc(n);
+  gsl_vector *p = gsl_vector_alloc(n);
+  
+  double f_new, dg0, alpha, sy, yy, b;
+  
+  /* optimization loop */
+  Log::lprintf(Log::LOG_LEVEL_FINAL, "SLRA optimization:\n");
+    
+  status = GSL_SUCCESS;  
+  status_dx = GSL_CONTINUE;
+  status_grad = GSL_CONTINUE;  
+  this->iter = 0;
+  
+  if (chk != NULL && chk->isLoaded()) { /* Resume with the saved history */
+    const gsl_vector *hist = chk->getExtra();
+    if (hist == NULL || hist->size != (2 * n + 1) * mem) {
+      throw new Exception("Incompatible L-BFGS history in the checkpoint.\n");
+    }
+    gsl_matrix_const_view S_h = gsl_matrix_const_view_array(hist->data, mem, n);
+    gsl_matrix_const_view Y_h = gsl_matrix_const_view_array(hist->data + 
+                                                            mem * n, mem, n);
+    gsl_vector_const_view rho_h = gsl_vector_const_subvector(hist, 
+                                                             2 * mem * n, mem);
+    gsl_matrix_memcpy(S, &S_h.matrix);
+    gsl_matrix_memcpy(Y, &Y_h.matrix);
+    gsl_vector_memcpy(rho, &rho_h.vector);
+    this->iter = chk->getIter();
+    newest = chk->aux[0];
+    n_pairs = chk->aux[1];
+  }
+  gsl_vector_memcpy(x_cur, x_vec);
+  F->computeFuncAndGrad(x_cur, &this->fmin, g);
+  if (itLog != NULL) {
+    itLog->reportIteration(this->iter, x_cur, this->fmin, g);
+  }
+  status_grad = gsl_multifit_test_gradient(g, this->epsgrad);
+  
+  while (status_grad == GSL_CONTINUE &&
+         status == GSL_SUCCESS &&
+         this->iter < this->maxiter &&
+         !(itLog != NULL && itLog->stopRequested())) {
+    if (this->maxx > 0) {
+  	  if (gsl_vector_max(x_cur) > this->maxx || gsl_vector_min(x_cur) < -this->maxx ){
+  	    break;
+      }
+    }
+  
+    this->iter++;
+
+    /* Two-loop recursion: p = -H g */
+    gsl_vector_memcpy(p, g);
+    for (l = 0; l < n_pairs; l++) {
+      i = (newest + mem - l) % mem;
+      gsl_vector_const_view s_i = gsl_matrix_const_row(S, i);
+      gsl_vector_const_view y_i = gsl_matrix_const_row(Y, i);
+      gsl_blas_ddot(&s_i.vector, p, &b);
+      gsl_vector_set(a, i, gsl_vector_get(rho, i) * b);
+      gsl_blas_daxpy(-gsl_vector_get(a, i), &y_i.vector, p);
+    }
+    if (n_pairs > 0) {
+      gsl_vector_const_view y_n = gsl_matrix_const_row(Y, newest);
+      gsl_blas_ddot(&y_n.vector, &y_n.vector, &yy);
+      gsl_vector_scale(p, 1 / (gsl_vector_get(rho, newest) * yy));
+    }
+    for (l = n_pairs; l > 0; l--) {
+      i = (newest + mem + 1 - l) % mem;
+      gsl_vector_const_view s_i = gsl_matrix_const_row(S, i);
+      gsl_vector_const_view y_i = gsl_matrix_const_row(Y, i);
+      gsl_blas_ddot(&y_i.vector, p, &b);
+      gsl_blas_daxpy(gsl_vector_get(a, i) - gsl_vector_get(rho, i) * b, 
+                     &s_i.vector, p);
+    }
+    gsl_vector_scale(p, -1);
+    gsl_blas_ddot(g, p, &dg0);
+    if (!(dg0 < 0)) { /* Not a descent direction: restart */
+      n_pairs = 0;
+      gsl_vector_memcpy(p, g);
+      gsl_vector_scale(p, -1);
+      gsl_blas_ddot(g, p, &dg0);
+    }
+    alpha = (n_pairs > 0 ? 1 : 1 / gsl_blas_dnrm2(g));
+
+    status = lineSearchWolfe(F, x_cur, this->fmin, dg0, p, &alpha, 
+                             x_new, &f_new, g_new, itLog);
+    if (status == ESTOP) { /* Keep the last accepted iterate */
+      this->iter--;
+      break;
+    }
+    if (status != GSL_SUCCESS) {
+      if (n_pairs > 0) { /* Retry with the steepest descent */
+        n_pairs = 0;
+        status = GSL_SUCCESS;
+      }
+      continue;
+    }
+
+    /* Update the history: s = x_new - x, y = g_new - g */
+    gsl_vector_memcpy(p, x_new);
+    gsl_vector_sub(p, x_cur);
+    newest = (newest + 1) % mem;
+    gsl_vector_view s_n = gsl_matrix_row(S, newest);
+    gsl_vector_view y_n = gsl_matrix_row(Y, newest);
+    gsl_vector_memcpy(&s_n.vector, p);
+    gsl_vector_memcpy(&y_n.vector, g_new);
+    gsl_vector_sub(&y_n.vector, g);
+    gsl_blas_ddot(&s_n.vector, &y_n.vector, &sy);
+    if (sy > DBL_EPSILON * gsl_blas_dnrm2(&s_n.vector) * 
+             gsl_blas_dnrm2(&y_n.vector)) {
+      gsl_vector_set(rho, newest, 1 / sy);
+      n_pairs = mymin(n_pairs + 1, mem);
+    } else {
+      newest = (newest + mem - 1) % mem;
+    }
+
+    /* check the dx convergence criteria after a full step (reported 
+     * together with the gradient criterion, see SLRA_OPT_METHOD_LBFGS) */
+    status_dx = GSL_CONTINUE;
+    if ((this->epsabs != 0 || this->epsrel != 0) && alpha == 1) {
+      status_dx = gsl_multifit_test_delta(p, x_cur, this->epsabs, this->epsrel);
+    }     
+    gsl_vector_memcpy(x_cur, x_new);
+    gsl_vector_memcpy(g, g_new);
+    this->fmin = f_new;
+    if (F->updateParametrization(x_cur)) {
+      F->computeFuncAndGrad(x_cur, &this->fmin, g);
+      n_pairs = 0;
+    }
+
+    if (itLog != NULL) {
+      itLog->reportIteration(this->iter, x_cur, this->fmin, g);
+    }
+    status_grad = gsl_multifit_test_gradient(g, this->epsgrad);
+    if (chk != NULL && chk->isDue(this->iter)) {
+      gsl_vector *hist = chk->getExtra((2 * n + 1) * mem);
+      gsl_matrix_view S_h = gsl_matrix_view_array(hist->data, mem, n);
+      gsl_matrix_view Y_h = gsl_matrix_view_array(hist->data + mem * n, mem, n);
+      gsl_vector_view rho_h = gsl_vector_subvector(hist, 2 * mem * n, mem);
+      gsl_matrix_memcpy(&S_h.matrix, S);
+      gsl_matrix_memcpy(&Y_h.matrix, Y);
+      gsl_vector_memcpy(&rho_h.vector, rho);
+      chk->aux[0] = newest;
+      chk->aux[1] = n_pairs;
+      chk->save(this, F, x_cur);
+    }
+  } 
+  if (this->iter >= this->maxiter) {
+    status = EITER;
+  }
+  if (itLog != NULL && itLog->stopRequested()) {
+    status = ESTOP;
+  }
+
+  /* print exit information */  
+  if (Log::getMaxLevel() >= Log::LOG_LEVEL_FINAL) { /* unless "off" */
+    switch (status) {
+    case EITER: 
+      Log::lprintf("SLRA optimization terminated by reaching " 
+                  "the maximum number of iterations.\n" 
+                  "The result could be far from optimal.\n");
+      break;
+    case ESTOP: 
+      Log::lprintf("SLRA optimization stopped on request.\n");
+      break;
+    case GSL_ENOPROG:
+      Log::lprintf("SLRA optimization terminated by a failure of the line "
+                  "search along the steepest descent direction.\n"
+                  "The result could be far from optimal.\n");
+      break;
+    default:
+      if (status_grad == GSL_CONTINUE) {
+        Log::lprintf("SLRA optimization terminated by reaching opt.maxx.\n");
+      } else if (status_dx != GSL_CONTINUE) {
+        Log::lprintf("Optimization terminated by reaching the convergence "
+                    "tolerance for both X and the gradient.\n"); 
+      } else {
+        Log::lprintf("Optimization terminated by reaching the convergence "
+                    "tolerance for the gradient.\n");
+      }
+    }
+  }
+
+  gsl_vector_memcpy(x_vec, x_cur);
+
+  gsl_matrix_free(S);
+  gsl_matrix_free(Y);
+  gsl_vector_free(rho);
+  gsl_vector_free(a);
+  gsl_vector_free(g);
+  gsl_vector_free(g_new);
+  gsl_vector_free(x_cur);
+  gsl_vector_free(x_new);
+  gsl_vector_free(p);
   
   return GSL_SUCCESS; /* <- correct with status */
 }
 
+int OptimizationOptions::sampledOptimize( NLSFunction *F, gsl_vector* x_vec, 
+        IterationLogger *itLog ) {
+  size_t N = F->getNBlocks(), n = mymin(this->sample_init, N), 
+         it = 0, i, j, k;
+  
+  if (N <= 1 || n >= N) {
+    return GSL_SUCCESS;
+  }
+  if (!(this->sample_growth > 1)) {
+    throw new Exception("opt.sample_growth should be greater than 1.\n");   
+  }
+
+  size_t *perm = new size_t[N], *blocks = new size_t[N];
+  char *in_sample = new char[N];
+  gsl_vector *g = gsl_vector_alloc(F->getNvar());
+  gsl_vector *g_new = gsl_vector_alloc(F->getNvar());
+  gsl_vector *x_new = gsl_vector_alloc(F->getNvar());
+  gsl_vector *p = gsl_vector_alloc(F->getNvar());
+  unsigned long seed = 1;
+  double f, f_new, dg0, alpha = 0;
+
+  for (i = 0; i < N; i++) {
+    perm[i] = i;
+  }
+  Log::lprintf(Log::LOG_LEVEL_FINAL, 
+               "SLRA optimization on samples of the blocks:\n");
+  
+  try {
+    while (n < N && it < this->maxiter && 
+           !(itLog != NULL && itLog->stopRequested())) {
+      it++;
+      
+      /* Draw n blocks (partial Fisher-Yates shuffle), in increasing order */
+      memset(in_sample, 0, N);
+      for (i = 0; i < n; i++) {
+        seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+        j = i + seed % (N - i);
+        k = perm[i]; perm[i] = perm[j]; perm[j] = k;
+        in_sample[perm[i]] = 1;
+      }
+      for (i = 0, k = 0; i < N; i++) {
+        if (in_sample[i]) {
+          blocks[k++] = i;
+        }
+      }
+      F->setBlockSample(blocks, n);
 
+      /* Steepest descent step with the line search on the same sample */
+      F->computeFuncAndGrad(x_vec, &f, g);
+      if (gsl_multifit_test_gradient(g, this->epsgrad) != GSL_CONTINUE) {
+        break;
+      }
+      gsl_vector_memcpy(p, g);
+      gsl_vector_scale(p, -1);
+      gsl_blas_ddot(g, p, &dg0);
+      if (alpha <= 0) {
+        alpha = 1 / gsl_blas_dnrm2(g);
+      }
+      if (lineSearchWolfe(F, x_vec, f, dg0, p, &alpha, x_new, &f_new, 
+                          g_new, itLog) == GSL_SUCCESS) {
+        gsl_vector_memcpy(x_vec, x_new);
+        F->updateParametrization(x_vec);
+      } else {
+        alpha = 0;
+        f_new = f;
+      }
+      Log::lprintf(Log::LOG_LEVEL_ITER, "%3d: %d of %d blocks, "
+                   "f0 = %15.10e (estimate)\n", (int)it, (int)n, (int)N, f_new);
+
+      /* Grow the sample geometrically */
+      n = mymin(N, (size_t)ceil(n * this->sample_growth));
+    }
+    
+    throw (Exception *)NULL; /* Throw NULL exception to unify deallocation */
+  } catch (Exception *e) {
+    F->setBlockSample(NULL, 0);
+    delete [] perm;
+    delete [] blocks;
+    delete [] in_sample;
+    gsl_vector_free(g);
+    gsl_vector_free(g_new);
+    gsl_vector_free(x_new);
+    gsl_vector_free(p);
+
+    if (e != NULL) {
+      throw;
+    }
+  }
+  
+  return GSL_SUCCESS;
+}
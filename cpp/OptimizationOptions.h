@@ -1,5 +1,6 @@
 /* size of the work array for mb02gd */
 #define EITER 1 /* maximum number of iterations reached */
+#define ESTOP 2 /* optimization stopped by IterationLogger::stopRequested() */
 
 /** @memberof OptimizationOptions 
  * @name Output options
@@ -56,6 +57,13 @@
  * The method uses SVD for calculation of pseudoinverse and is able to handle
  * rank-deficient Jacobians (in the case of overparameterization).
  *
+ * The step is computed by the SVD (default), the pivoted QR factorization or 
+ * the normal equations, depending on opt.lm_solver (see LMStepSolver).
+ * The QR, normal equations and automatic solvers are cheaper for tall 
+ * Jacobians, but produce slightly different iterates.
+ * In all cases the Jacobian is factorized once per iteration, 
+ * and the factorization is reused for all the trial values of \f$\lambda\f$.
+ *
  * By default, the Jacobian is scaled (normalized), as suggested in \cite paduart10.
  * The unscaled version is available is the submethod 
  * SLRA_OPT_SUBMETHOD_LMPINV_UNSCALED is selected.
@@ -71,6 +79,65 @@
  * This is analogous to \ref SLRA_OPT_SUBMETHOD_LM_LMDER.
  */
 #define SLRA_OPT_SUBMETHOD_LMPINV_UNSCALED 1
+/**
+ * Geodesic acceleration \cite transtrum12: the LM step (velocity) \f$v\f$ 
+ * is corrected by \f$a/2\f$, where the acceleration \f$a\f$ is the LM step
+ * for the second directional derivative \f$r_{vv}\f$ of the residual 
+ * instead of the residual. The derivative is estimated by finite differences
+ * with one extra evaluation of the residual (two for pseudo-jacobians,
+ * see NLSFunction::isJacobianExact()) per trial \f$\lambda\f$,
+ * and \f$a\f$ is computed with the same factorization of the Jacobian.
+ * The step is rejected if \f$2\|a\|/\|v\| > 0.75\f$. 
+ * The Jacobian is scaled.
+ */
+#define SLRA_OPT_SUBMETHOD_LMPINV_GEODESIC 2
+/** Riemannian trust-region method on the Grassmann manifold.
+ *
+ * The cost function \f$f(R)\f$ depends only on the row space of \f$R\f$,
+ * therefore the parameter matrix \f$X \in \mathbb{R}^{k\times d}\f$
+ * (\f$R^{\top} = \Psi^{\top} X\f$) is kept orthonormal and the optimization
+ * is performed on the Grassmann manifold \f$Gr(k,d)\f$, as in \cite absil08.
+ * Each iteration solves the trust-region subproblem by the truncated
+ * conjugate gradient method, with the Riemannian gradient obtained by 
+ * projecting the Euclidean gradient on the tangent space and the Hessian 
+ * approximated by the Gauss-Newton matrix \f$2J^{\top}J\f$.
+ * The iterates are retracted back to the manifold by the QR decomposition.
+ * The pseudo-Jacobian \f$J\f$ (\f$nd \times kd\f$) is formed once per 
+ * accepted step, and each CG iteration multiplies by \f$J\f$ and 
+ * \f$J^{\top}\f$. VarproFunction::computeJtJmulE() is not used: it forms 
+ * the same dense pseudo-Jacobian internally, in the coordinates of \f$R\f$
+ * instead of \f$X\f$, and therefore saves neither memory nor flops.
+ * 
+ * The method stops by opt.epsgrad (or opt.maxiter): the Gauss-Newton 
+ * matrix is not preconditioned, and on badly scaled problems the 
+ * truncated CG steps can be short far from the minimum (e.g., test 8 in 
+ * test_c), so the displacement test (opt.epsabs, opt.epsrel) is reported 
+ * but does not terminate the iterations.
+ * 
+ * The method implies opt.avoid_xi and is not available if \f$\Psi\f$ 
+ * is not \f$m\times k\f$.
+ */
+#define SLRA_OPT_METHOD_GRASS 4
+#define SLRA_OPT_SUBMETHOD_GRASS_TR  0 /**< truncated CG trust region */
+/** Limited-memory BFGS method (own implementation).
+ *
+ * The method uses only the cost function and its gradient, the inverse 
+ * Hessian approximation is stored implicitly by opt.lbfgs_mem pairs of
+ * vectors, see Algorithm 7.5 in \cite nocedal06. 
+ * The step length satisfies the strong Wolfe conditions 
+ * (Algorithms 3.5--3.6 in \cite nocedal06), and the gradient at 
+ * the accepted point is obtained together with the cost function.
+ * Neither the Jacobian nor a dense Hessian is formed.
+ *
+ * The method stops by opt.epsgrad (or opt.maxiter): on badly scaled
+ * problems the quasi-Newton steps can be short far from the minimum,
+ * so the displacement test (opt.epsabs, opt.epsrel, evaluated after full 
+ * steps only) is reported but does not terminate the iterations.
+ * The convergence is linear and can be much slower than for 
+ * SLRA_OPT_METHOD_LM on ill-conditioned problems.
+ */
+#define SLRA_OPT_METHOD_LBFGS 5
+#define SLRA_OPT_SUBMETHOD_LBFGS_WOLFE 0 /**< strong Wolfe line search */
 
 /*@}*/
  
@@ -86,19 +153,39 @@
 #define SLRA_DEF_epsgrad  1e-5
 #define SLRA_DEF_epsx     1e-5
 #define SLRA_DEF_maxx     0
+#define SLRA_DEF_maxtime  0
 #define SLRA_DEF_step     0.001
 #define SLRA_DEF_tol      1e-6
 #define SLRA_DEF_epscov   1e-5
+#define SLRA_DEF_cov_diag 0
+#define SLRA_DEF_lbfgs_mem 10
+#define SLRA_DEF_lm_solver SLRA_OPT_LM_SOLVER_SVD
+#define SLRA_DEF_sketch_size 0
+#define SLRA_DEF_sample_init 0
+#define SLRA_DEF_sample_growth 1.2
 #define SLRA_DEF_reggamma 0.000
+#define SLRA_DEF_tol_m    1e-10
+#define SLRA_DEF_xi_maxabs 0
 #define SLRA_DEF_ls_correction 0
 #define SLRA_DEF_avoid_xi 0
+#define SLRA_DEF_chkpt_iter 10
+#define SLRA_DEF_chkpt_time 0
+#define SLRA_DEF_resume   0
 /* @} */
 
+/** Maximal length of the checkpoint file name */
+#define SLRA_CHKPT_FILE_LEN 1024
+
 
 class IterationLogger {
 public:
   virtual void reportIteration( int no, const gsl_vector *x, double fmin, 
                                    const gsl_vector *grad ) = 0;
+  /** Checked by the optimization methods before each iteration, and 
+   * by the LM (LMPINV), Grassmann and L-BFGS methods also before each 
+   * trial evaluation: if true is returned, the optimization is stopped 
+   * at the last accepted point. */
+  virtual bool stopRequested() { return false; }
 };
 
 /** Optimization options structure.
@@ -114,16 +201,62 @@ public:
    * @param [in,out] x_vec Vector containing initial approximation and returning
    *                       the minimum point 
    * @param [out]    v     Covariance matrix for x
+   * @param [in,out] chk   Checkpoint (no checkpoints if <tt>chk == NULL</tt>);
+   *                       if loaded, the iterations are resumed
    */
   int gslOptimize( NLSFunction *F, gsl_vector* x_vec, gsl_matrix *v,
-                   IterationLogger *itLog );
+                   IterationLogger *itLog, Checkpoint *chk = NULL );
 
   /** Main function that runs LM optimization (for the method SLRA_OPT_METHOD_LMPINV)
    * @param [in]     F     Nonlinear least squares function
    * @param [in,out] x_vec Vector containing initial approximation and returning
    *                       the minimum point 
+   * @param [out]    vfact Factor \f$W\f$ of the covariance matrix 
+   *                       \f$(J^{\top}J)^{\dagger} = WW^{\top}\f$ for x 
+   *                       at the minimum point, computed from the factorization
+   *                       of the last Jacobian (not computed if 
+   *                       <tt>vfact == NULL</tt>)
+   * @param [in,out] chk   Checkpoint (see gslOptimize())
    */
-  int lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec, IterationLogger *itLog );
+  int lmpinvOptimize( NLSFunction *F, gsl_vector* x_vec, gsl_matrix *vfact,
+                      IterationLogger *itLog, Checkpoint *chk = NULL );
+
+  /** Main function that runs Riemannian trust-region optimization
+   * (for the method SLRA_OPT_METHOD_GRASS)
+   * @param [in]     F     Nonlinear least squares function, invariant
+   *                       with respect to \f$X \mapsto XA\f$, \f$A\f$ nonsingular
+   * @param [in,out] x_vec Vector containing initial approximation 
+   *                       \f$\mathrm{vec}(X^{\top})\f$ and returning
+   *                       the minimum point (with orthonormal \f$X\f$)
+   * @param [in]     d     Number of columns of \f$X\f$
+   * @param [in,out] chk   Checkpoint (see gslOptimize())
+   */
+  int grassOptimize( NLSFunction *F, gsl_vector* x_vec, size_t d, 
+                     IterationLogger *itLog, Checkpoint *chk = NULL );
+
+  /** Main function that runs L-BFGS optimization (for the method SLRA_OPT_METHOD_LBFGS)
+   * @param [in]     F     Nonlinear least squares function
+   * @param [in,out] x_vec Vector containing initial approximation and returning
+   *                       the minimum point 
+   * @param [in,out] chk   Checkpoint (see gslOptimize())
+   */
+  int lbfgsOptimize( NLSFunction *F, gsl_vector* x_vec, IterationLogger *itLog,
+                     Checkpoint *chk = NULL );
+
+  /** Stochastic warm start on samples of the blocks of the data.
+   * If \f$f\f$ is a sum of \f$N\f$ independent terms (see 
+   * NLSFunction::getNBlocks(), e.g., the blocks of a StripedStructure),
+   * steepest descent steps with a line search are made on random 
+   * samples of the blocks, starting with sample_init blocks and growing 
+   * the sample by the factor sample_growth at each iteration
+   * \cite friedlander12. Stops when the sample reaches all the blocks,
+   * so that the optimization can be finished on the full data.
+   * @param [in]     F     Nonlinear least squares function
+   * @param [in,out] x_vec Vector containing initial approximation and returning
+   *                       the last point 
+   */
+  int sampledOptimize( NLSFunction *F, gsl_vector* x_vec, 
+                       IterationLogger *itLog );
 
   /** Initialize method and submethod fields from string 
    * @param [in]     str   a string consisting of one or two characters
@@ -135,6 +268,8 @@ public:
    * |   'q'  | \ref SLRA_OPT_METHOD_QN
    * |   'n'  | \ref SLRA_OPT_METHOD_NM
    * |   'p'  | \ref SLRA_OPT_METHOD_LMPINV
+   * |   'g'  | \ref SLRA_OPT_METHOD_GRASS
+   * |   'b'  | \ref SLRA_OPT_METHOD_LBFGS
    *
    * The second determines the value of opt.submethod:
    * | str[0] | str[1] | value of opt.submethod
@@ -150,6 +285,9 @@ public:
    * |   'n'  | 'r'    | \ref SLRA_OPT_SUBMETHOD_NM_SIMPLEX2_RAND
    * |   'p'  | 's'    | \ref SLRA_OPT_SUBMETHOD_LMPINV_SCALED
    * |   'p'  | 'u'    | \ref SLRA_OPT_SUBMETHOD_LMPINV_UNSCALED
+   * |   'p'  | 'a'    | \ref SLRA_OPT_SUBMETHOD_LMPINV_GEODESIC
+   * |   'g'  | 't'    | \ref SLRA_OPT_SUBMETHOD_GRASS_TR
+   * |   'b'  | 'w'    | \ref SLRA_OPT_SUBMETHOD_LBFGS_WOLFE
    * if the second letter is absent the first submethod is selected.
    */
   void str2Method( const char *str );
@@ -169,6 +307,8 @@ public:
   double epsgrad;///< epsabs in gsl_multimin_test_gradient or 'gsl_multifit_test_gradient'
   double epsx;   ///< epsabs in gsl_multimin_test_size  (used only in Nelder-Mead)
   double maxx;   ///< Maximum absolute value of the elements of the parameter vector
+  double maxtime;///< Wall-clock time budget in seconds (0 - unlimited), checked 
+                 ///< after each iteration; the last iterate is returned
   ///@}
   
   /** @name Method-specific parameters */  
@@ -176,13 +316,32 @@ public:
   double step;   ///< 'step_size' for fdfminimizer_set, fminimizer_set 
   double tol;    ///< 'tol' for fdfminimizer_set, fminimizer_set
   double epscov; ///< Eps for cutoff when computing covariance matrix
+  int cov_diag;  ///< Return only the diagonal of the covariance matrix (MEX, R)
+  size_t lbfgs_mem; ///< Number of correction pairs stored in L-BFGS
+  int lm_solver;    ///< Step solver in SLRA_OPT_METHOD_LMPINV, see SLRA_OPT_LM_SOLVER_xxx
+  size_t sketch_size; ///< Number of rows of the sketched Jacobian in 
+                      ///< SLRA_OPT_METHOD_LMPINV with ls_correction (0 - off)
+  size_t sample_init;   ///< Initial number of sampled blocks in sampledOptimize (0 - off)
+  double sample_growth; ///< Growth factor of the sample in sampledOptimize
   ///@}
   
   /** @name Advanced parameters */  
   ///@{
   double reggamma;   ///< regularization parameter for gamma, absolute 
+  double tol_m;      ///< relative tolerance of the rank in the elimination
+                     ///< of the missing values (see Structure::isMissing())
   int ls_correction; ///< Use correction computation in Levenberg-Marquardt 
   int avoid_xi;      ///< Avoid [X I] representation, and use own Levenberg-Marquardt
+  double xi_maxabs;  ///< Threshold on \f$\max|X_{ij}|\f$ for switching the pivot
+                     ///< rows of [X -I] (0 - off), see NLSVarproPsiXI
+  ///@}
+
+  /** @name Checkpointing (see Checkpoint) */  
+  ///@{
+  char chkpt_file[SLRA_CHKPT_FILE_LEN]; ///< Checkpoint file (none if empty)
+  size_t chkpt_iter; ///< Save the checkpoint every chkpt_iter iterations (0 - never)
+  double chkpt_time; ///< Save the checkpoint every chkpt_time seconds (0 - never)
+  int resume;        ///< Resume from the checkpoint file, if it exists
   ///@}
 
   /** @name Output info */  
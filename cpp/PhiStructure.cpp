@@ -1,13 +1,36 @@
+#include <memory.h>
 #include "slra.h"
 
 PhiStructure::PhiStructure( const gsl_matrix *PhiT, Structure *S  ) :
-  myPStruct(S) {
+  myPStruct(S), myPhiColPtr(NULL), myPhiRows(NULL), myPhiVals(NULL) {
   if (PhiT->size1 < PhiT->size2) {
     throw new Exception("PhiStructure::PhiStructure");
   }
   myPhiT = gsl_matrix_alloc(PhiT->size1, PhiT->size2);
   gsl_matrix_memcpy(myPhiT, PhiT);
-  myTempStMat = gsl_matrix_alloc(myPStruct->getN(), myPStruct->getM());
+
+  /* Use the sparse format for a permutation / selection or a sparse Phi */
+  size_t i, j, k, nnz = 0;
+  for (i = 0; i < myPhiT->size1; i++) {
+    for (j = 0; j < myPhiT->size2; j++) {
+      nnz += (gsl_matrix_get(myPhiT, i, j) != 0.0);
+    }
+  }
+  if (nnz <= myPhiT->size2 || 2 * nnz <= myPhiT->size1 * myPhiT->size2) {
+    myPhiColPtr = new size_t[myPhiT->size2 + 1];
+    myPhiRows = new size_t[nnz];
+    myPhiVals = new double[nnz];
+    for (j = 0, k = 0; j < myPhiT->size2; j++) {
+      myPhiColPtr[j] = k;
+      for (i = 0; i < myPhiT->size1; i++) {
+        if (gsl_matrix_get(myPhiT, i, j) != 0.0) {
+          myPhiRows[k] = i;
+          myPhiVals[k++] = gsl_matrix_get(myPhiT, i, j);
+        }
+      }
+    }
+    myPhiColPtr[myPhiT->size2] = k;
+  }
 }
 
 PhiStructure::~PhiStructure()  {
@@ -15,30 +38,132 @@ PhiStructure::~PhiStructure()  {
     delete myPStruct;
   }
   gsl_matrix_free(myPhiT);
-  gsl_matrix_free(myTempStMat);
+  if (myPhiColPtr != NULL) {
+    delete [] myPhiColPtr;
+    delete [] myPhiRows;
+    delete [] myPhiVals;
+  }
+}
+
+PhiStructure::PhiWorkspace::PhiWorkspace( const PhiStructure *s, size_t d ) {
+  myStMat = gsl_matrix_alloc(s->myPStruct->getN(), s->myPStruct->getM());
+  myPhiTRt = gsl_matrix_alloc(s->myPhiT->size1, d);
+  myParent = s->myPStruct->createWorkspace(d);
+}
+
+PhiStructure::PhiWorkspace::~PhiWorkspace() {
+  gsl_matrix_free(myStMat);
+  gsl_matrix_free(myPhiTRt);
+  if (myParent != NULL) {
+    delete myParent;
+  }
 }
 
 void PhiStructure::fillMatrixFromP( gsl_matrix* c, const gsl_vector* p )
 {
-  myPStruct->fillMatrixFromP(myTempStMat, p);
-  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myTempStMat, myPhiT, 0, c);
+  PhiWorkspace ws(this, 1);
+  fillMatrixFromP(c, p, &ws);
 }
 
-gsl_matrix *PhiStructure::createPhiTRt( const gsl_matrix *Rt ) const {
-  gsl_matrix *res = gsl_matrix_alloc(myPhiT->size1, Rt->size2);
-  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myPhiT, Rt, 0, res);
-  return res;
+void PhiStructure::fillMatrixFromP( gsl_matrix* c, const gsl_vector* p,
+                                    Workspace *ws ) {
+  PhiWorkspace *phiWs = (PhiWorkspace *)ws;
+  gsl_matrix *tempStMat = phiWs->myStMat;
+  myPStruct->fillMatrixFromP(tempStMat, p, phiWs->myParent);
+  if (myPhiColPtr == NULL) {
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, tempStMat, myPhiT, 0, c);
+  } else {
+    /* Column j of c is a combination of the columns of S' selected by Phi */
+    for (size_t j = 0; j < c->size2; j++) {
+      gsl_vector c_col = gsl_matrix_column(c, j).vector, st_col;
+      gsl_vector_set_zero(&c_col);
+      for (size_t k = myPhiColPtr[j]; k < myPhiColPtr[j + 1]; k++) {
+        st_col = gsl_matrix_column(tempStMat, myPhiRows[k]).vector;
+        gsl_blas_daxpy(myPhiVals[k], &st_col, &c_col);
+      }
+    }
+  }
+}
+
+void PhiStructure::multPhiT( gsl_matrix *PhiTB, const gsl_matrix *B ) const {
+  if (myPhiColPtr == NULL) {
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myPhiT, B, 0, PhiTB);
+    return;
+  }
+  gsl_matrix_set_zero(PhiTB);
+  for (size_t j = 0; j < B->size1; j++) {
+    gsl_vector B_row = gsl_matrix_const_row(B, j).vector, res_row;
+    for (size_t k = myPhiColPtr[j]; k < myPhiColPtr[j + 1]; k++) {
+      res_row = gsl_matrix_row(PhiTB, myPhiRows[k]).vector;
+      gsl_blas_daxpy(myPhiVals[k], &B_row, &res_row);
+    }
+  }
+}
+
+void PhiStructure::multPhi( gsl_matrix *PhiB, const gsl_matrix *B ) const {
+  if (myPhiColPtr == NULL) {
+    gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, myPhiT, B, 0, PhiB);
+    return;
+  }
+  gsl_matrix_set_zero(PhiB);
+  for (size_t j = 0; j < PhiB->size1; j++) {
+    gsl_vector res_row = gsl_matrix_row(PhiB, j).vector, B_row;
+    for (size_t k = myPhiColPtr[j]; k < myPhiColPtr[j + 1]; k++) {
+      B_row = gsl_matrix_const_row(B, myPhiRows[k]).vector;
+      gsl_blas_daxpy(myPhiVals[k], &B_row, &res_row);
+    }
+  }
 }
 
 void PhiStructure::multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
         const gsl_vector *y, double alpha, double beta, bool skipFixedBlocks ) {
-  gsl_matrix *PhiTRt = createPhiTRt(Rt);
-  myPStruct->multByGtUnweighted(p, PhiTRt, y, alpha, beta, skipFixedBlocks);
-  gsl_matrix_free(PhiTRt);
+  PhiWorkspace ws(this, Rt->size2);
+  multByGtUnweighted(p, Rt, y, alpha, beta, skipFixedBlocks, &ws);
+}
+
+void PhiStructure::multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
+        const gsl_vector *y, double alpha, double beta, bool skipFixedBlocks,
+        Workspace *ws ) {
+  PhiWorkspace *phiWs = (PhiWorkspace *)ws;
+  gsl_matrix PhiTRt = gsl_matrix_submatrix(phiWs->myPhiTRt, 0, 0, 
+                          phiWs->myPhiTRt->size1, Rt->size2).matrix;
+  multPhiT(&PhiTRt, Rt);
+  myPStruct->multByGtUnweighted(p, &PhiTRt, y, alpha, beta, skipFixedBlocks,
+                                phiWs->myParent);
+}
+
+PhiStructure::PhiTRtCache::PhiTRtCache( const PhiStructure *s, size_t d ) :
+    myStruct(s), myValid(false) {
+  myRt = gsl_matrix_alloc(s->getM(), d);
+  myPhiTRt = gsl_matrix_alloc(s->myPhiT->size1, d);
+}
+
+PhiStructure::PhiTRtCache::~PhiTRtCache() {
+  gsl_matrix_free(myRt);
+  gsl_matrix_free(myPhiTRt);
+}
+
+const gsl_matrix *PhiStructure::PhiTRtCache::get( const gsl_matrix *Rt ) {
+  if (myValid) {
+    size_t i;
+    for (i = 0; i < Rt->size1; i++) {
+      if (memcmp(gsl_matrix_const_ptr(Rt, i, 0), gsl_matrix_ptr(myRt, i, 0),
+                 Rt->size2 * sizeof(double))) {
+        break;
+      }
+    }
+    if (i == Rt->size1) {
+      return myPhiTRt;
+    }
+  }
+  gsl_matrix_memcpy(myRt, Rt);
+  myStruct->multPhiT(myPhiTRt, Rt);
+  myValid = true;
+  return myPhiTRt;
 }
 
 PhiStructure::PhiCholesky::PhiCholesky( const PhiStructure *s, size_t d ) :
-   myStruct(s), myParent(s->myPStruct->createCholesky(d)) {
+   myStruct(s), myParent(s->myPStruct->createCholesky(d)), myPhiTRt(s, d) {
 }
 
 PhiStructure::PhiCholesky::~PhiCholesky() {
@@ -48,9 +173,18 @@ PhiStructure::PhiCholesky::~PhiCholesky() {
 }
 
 void PhiStructure::PhiCholesky::calcGammaCholesky( const gsl_matrix *Rt, double reg ) {
-  gsl_matrix *PhiTRt = myStruct->createPhiTRt(Rt);
-  myParent->calcGammaCholesky(PhiTRt, reg);
-  gsl_matrix_free(PhiTRt);
+  myParent->calcGammaCholesky(myPhiTRt.get(Rt), reg);
+}
+
+bool PhiStructure::PhiCholesky::calcGammaCholeskyBounded( const gsl_matrix *Rt,
+         double reg, gsl_vector *yr, double bound, double *f ) {
+  return myParent->calcGammaCholeskyBounded(myPhiTRt.get(Rt), reg, yr,
+                                            bound, f);
+}
+
+bool PhiStructure::PhiCholesky::calcFuncStreaming( const gsl_matrix *Rt,
+         double reg, gsl_vector *yr, double bound, double *f ) {
+  return myParent->calcFuncStreaming(myPhiTRt.get(Rt), reg, yr, bound, f);
 }
 
 void PhiStructure::PhiCholesky::multInvCholeskyVector( gsl_vector * y_r, long trans ) {
@@ -62,9 +196,10 @@ void PhiStructure::PhiCholesky::multInvGammaVector( gsl_vector * y_r ) {
 }
 
 PhiStructure::PhiDGamma::PhiDGamma( const PhiStructure *s, size_t d ) :
-    myStruct(s), myParent(s->myPStruct->createDGamma(d)) {
+    myStruct(s), myParent(s->myPStruct->createDGamma(d)), myPhiTRt(s, d) {
   myPhi = gsl_matrix_alloc(myStruct->myPhiT->size2, myStruct->myPhiT->size1);
   gsl_matrix_transpose_memcpy(myPhi, myStruct->myPhiT);
+  myTempAt = gsl_matrix_alloc(myStruct->myPhiT->size1, d);
 }
 
 PhiStructure::PhiDGamma::~PhiDGamma() {
@@ -74,16 +209,13 @@ PhiStructure::PhiDGamma::~PhiDGamma() {
   if (myPhi != NULL) {
     gsl_matrix_free(myPhi);
   }
+  gsl_matrix_free(myTempAt);
 }
 
 void PhiStructure::PhiDGamma::calcYtDgammaY( gsl_matrix *At,
                            const gsl_matrix *Rt, const gsl_matrix *Yt ) {
-  gsl_matrix *PhiTRt = myStruct->createPhiTRt(Rt);
-  gsl_matrix *tempAt = gsl_matrix_alloc(PhiTRt->size1, PhiTRt->size2);
-  myParent->calcYtDgammaY(tempAt, PhiTRt, Yt);
-  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, myStruct->myPhiT, tempAt, 0, At);
-  gsl_matrix_free(PhiTRt);
-  gsl_matrix_free(tempAt);
+  myParent->calcYtDgammaY(myTempAt, myPhiTRt.get(Rt), Yt);
+  myStruct->multPhi(At, myTempAt);
 }
 
 void PhiStructure::PhiDGamma::calcDijGammaYr( gsl_vector *z,
@@ -92,10 +224,5 @@ void PhiStructure::PhiDGamma::calcDijGammaYr( gsl_vector *z,
   if (Phi != NULL) {
     throw new Exception("Does not support nested Phi multiplication...");
   }
-  gsl_matrix *PhiTRt = myStruct->createPhiTRt(Rt);
-  myParent->calcDijGammaYr(z, PhiTRt, j_1, i_1, y, myPhi);
-  gsl_matrix_free(PhiTRt);
+  myParent->calcDijGammaYr(z, myPhiTRt.get(Rt), j_1, i_1, y, myPhi);
 }
-
-
-
@@ -1,20 +1,57 @@
 /** Implementation Structure class for the structures of the form.
  * \f$\Phi \mathscr{S}'(p)\f$, there \f$\Phi\f$ is a full row rank matrix,
  * and \f$\mathscr{S}'(p)\f$ is a MuDependentStructure or StationaryStructure.
+ *
+ * If \f$\Phi\f$ is sparse (e.g., a permutation or a selection of rows), 
+ * it is stored in the compressed column format of \f$\Phi^{\top}\f$, 
+ * and the products with \f$\Phi\f$ are computed by gathering rows 
+ * and columns instead of dgemm.
  */
 class PhiStructure : public Structure {
+public:
+  /** Cache of \f$\Phi^{\top} R^{\top}\f$ for the last \f$R\f$ */
+  class PhiTRtCache {
+    const PhiStructure *myStruct;
+    gsl_matrix *myRt;
+    gsl_matrix *myPhiTRt;
+    bool myValid;
+  public:
+    /** Constructs the cache for \f$R \in \mathbb{R}^{d \times m}\f$ */
+    PhiTRtCache( const PhiStructure *s, size_t d );
+    virtual ~PhiTRtCache();
+    /** Returns \f$\Phi^{\top} R^{\top}\f$, which is recomputed only 
+     * if \f$R\f$ differs from \f$R\f$ of the previous call */
+    const gsl_matrix *get( const gsl_matrix *Rt );
+    /** Returns \f$d\f$ */
+    size_t getD() const { return myRt->size2; }
+  };
+
+  /** Workspace of fillMatrixFromP() and multByGtUnweighted() */
+  class PhiWorkspace : public Workspace {
+    friend class PhiStructure;
+    gsl_matrix *myStMat;          /* S'^T(p) */
+    gsl_matrix *myPhiTRt;         /* Phi^T R^T */
+    Workspace *myParent;          /* Workspace of S' */
+  public:
+    /** Constructs the workspace for \f$R \in \mathbb{R}^{d \times m}\f$ */
+    PhiWorkspace( const PhiStructure *s, size_t d );
+    virtual ~PhiWorkspace();
+  };
+
 private:
   Structure *myPStruct;
   gsl_matrix *myPhiT;
-  gsl_matrix *myTempStMat;
+  size_t *myPhiColPtr;    /* Phi^T in CSC format (NULL if Phi is dense) */
+  size_t *myPhiRows;
+  double *myPhiVals;
 
-  gsl_matrix *createPhiTRt( const gsl_matrix *Rt ) const;
 public:
   /** Clolesky class for PhiStructure */
   class PhiCholesky : public Cholesky {
     friend class PhiStructure;
     const PhiStructure *myStruct;
     Cholesky *myParent;
+    PhiTRtCache myPhiTRt;
     
   protected:
     /** Constructs a Cholesky object for PhiStructure.
@@ -26,6 +63,11 @@ public:
     virtual void calcGammaCholesky( const gsl_matrix *Rt, double reg );
     virtual void multInvCholeskyVector( gsl_vector * yr, long trans );
     virtual void multInvGammaVector( gsl_vector * yr );
+    virtual bool calcGammaCholeskyBounded( const gsl_matrix *Rt, double reg,
+                                           gsl_vector *yr, double bound, 
+                                           double *f );
+    virtual bool calcFuncStreaming( const gsl_matrix *Rt, double reg,
+                                    gsl_vector *yr, double bound, double *f );
   };
   
   class PhiDGamma : virtual public DGamma {
@@ -33,6 +75,8 @@ public:
     const PhiStructure *myStruct;
     DGamma *myParent;
     gsl_matrix *myPhi;
+    gsl_matrix *myTempAt;
+    PhiTRtCache myPhiTRt;
   protected:
     /** Constructs a Cholesky object for PhiStructure.
      * @param[in] s    Pointer to the corresponding PhiStructure.
@@ -65,13 +109,26 @@ public:
   virtual void multByWInv( gsl_vector* p, long deg = 2 ) const {
     myPStruct->multByWInv(p, deg);
   }
+  virtual bool isMissing( size_t k ) const { 
+    return myPStruct->isMissing(k); 
+  }
 
+  /** Allocates the workspace per call, see the overload with the workspace */
   virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p ) ;
- 
+  /** Allocates the workspace per call, see the overload with the workspace */
   virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
                                   const gsl_vector *y,
                                   double alpha = -1, double beta = 1,
                                   bool skipFixedBlocks = true );
+  virtual Workspace *createWorkspace( size_t d ) const {
+    return new PhiWorkspace(this, d);
+  }
+  virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p,
+                                Workspace *ws );
+  virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
+                                   const gsl_vector *y, double alpha,
+                                   double beta, bool skipFixedBlocks, 
+                                   Workspace *ws );
   
   virtual Cholesky *createCholesky( size_t d ) const {
     return new PhiCholesky(this, d);
@@ -85,5 +142,11 @@ public:
   /**@{*/
   /** Returns \f$\Phi^{\top}\f$ */
   const gsl_matrix *getPhiT() const { return myPhiT; }
+  /** Computes \f$\Phi^{\top} B\f$ */
+  void multPhiT( gsl_matrix *PhiTB, const gsl_matrix *B ) const;
+  /** Computes \f$\Phi B\f$ */
+  void multPhi( gsl_matrix *PhiB, const gsl_matrix *B ) const;
+  /** Returns true if \f$\Phi\f$ is stored in the sparse format */
+  bool isPhiSparse() const { return myPhiColPtr != NULL; }
   /**@}*/
 };
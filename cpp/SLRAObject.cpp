@@ -11,9 +11,36 @@ void SLRAObject::myErrorH( const char *reason, const char *F,
 }
 
 
+/* The Sylvester structure for the GCD problem with one layer and 
+ * positive finite blockwise weights (NULL for the other problems) */
+static Structure *createSylvesterStructure( gsl_vector *ml, gsl_vector *nk,
+                                            gsl_vector *wk ) {
+  if (ml->size != 1 || (wk != NULL && wk->size != 1 && wk->size != nk->size)) {
+    return NULL;
+  }
+  double *w_vec = NULL;
+  if (wk != NULL) {
+    w_vec = new double[nk->size];
+    for (size_t j = 0; j < nk->size; j++) {
+      w_vec[j] = gsl_vector_get(wk, (wk->size == 1 ? 0 : j));
+      if (!(w_vec[j] > 0 && w_vec[j] < GSL_POSINF)) {
+        delete [] w_vec;
+        return NULL;
+      }
+    }
+  }
+  Structure *res = new SylvesterStructure(gsl_vector_get(ml, 0), nk->data,
+                                          nk->size, w_vec);
+  if (w_vec != NULL) {
+    delete [] w_vec;
+  }
+  return res;
+}
+
 SLRAObject::SLRAObject( gsl_vector p_in, gsl_vector ml, gsl_vector nk,
                         gsl_matrix perm, gsl_vector wk, gsl_vector rvec,
-                        bool isgcd ) {
+                        bool isgcd, gsl_vector *tk, gsl_matrix *wband ) :
+    myCPsiT(NULL), myCMl(NULL), myCNk(NULL) {
   double tmp_n;
 
   if (old_gsl_err_h != SLRAObject::myErrorH) {
@@ -36,7 +63,20 @@ SLRAObject::SLRAObject( gsl_vector p_in, gsl_vector ml, gsl_vector nk,
     throw new Exception("Size of vector p exceeds structure requirements");   
   } 
 
-  myS = createMosaicStructure(&ml, &nk, vecChkNIL(wk), matChkNIL(perm));
+  /* The GCD mode applies W^{-1/2} to p, which needs a diagonal W */
+  if (isgcd && wband != NULL) {
+    throw new Exception("Banded weights are not supported in the GCD mode");   
+  }
+
+  myS = NULL;
+  if (isgcd && perm.data == NULL && tk == NULL && (rvec.size == 0 || 
+        gsl_vector_get(&rvec, 0) + 1 == gsl_vector_get(&ml, 0))) {
+    myS = createSylvesterStructure(&ml, &nk, vecChkNIL(wk));
+  }
+  if (myS == NULL) {
+    myS = createMosaicStructure(&ml, &nk, vecChkNIL(wk), matChkNIL(perm), tk,
+                                wband);
+  }
   size_t m = (perm.data == NULL ? myS->getM() : perm.size2);
   int r = (rvec.size == 0 ? m - 1 : gsl_vector_get(&rvec, 0));
   
@@ -45,10 +85,240 @@ SLRAObject::SLRAObject( gsl_vector p_in, gsl_vector ml, gsl_vector nk,
   }
     
   myF = new VarproFunction(vecChkNIL(p_in), myS, m-r, NULL, isgcd);
+  myAsync = NULL;
+  ++myObjCnt;
+}
+
+SLRAObject::SLRAObject( gsl_vector p_in, gsl_matrix tts, gsl_matrix s0,
+                        gsl_vector wk, gsl_vector rvec, double hodlr_tol ) :
+    myCPsiT(NULL), myCMl(NULL), myCNk(NULL) {
+  if (old_gsl_err_h != SLRAObject::myErrorH) {
+    old_gsl_err_h = gsl_set_error_handler(SLRAObject::myErrorH);
+  }
+
+  if (tts.data == NULL) {
+    throw new Exception("s.tts should be a nonempty matrix");   
+  }
+  if (wk.data != NULL && wk.size != p_in.size) {
+    throw new Exception("Size of s.w should be equal to the size of p");   
+  }
+
+  myS = new SparseAffineStructure(&tts, p_in.size, matChkNIL(s0), wk.data,
+                                  true, hodlr_tol);
+  size_t m = myS->getM();
+  int r = (rvec.size == 0 ? m - 1 : gsl_vector_get(&rvec, 0));
+  
+  if (r <= 0 || r >= m) {
+    delete myS;
+    throw new Exception("Incorrect rank\n");   
+  }
+    
+  myF = new VarproFunction(vecChkNIL(p_in), myS, m-r, NULL);
+  myAsync = NULL;
+  ++myObjCnt;
+}
+
+SLRAObject::SLRAObject( gsl_vector p_in, gsl_matrix m2d, gsl_vector n2d,
+                        gsl_vector wk, gsl_vector rvec ) :
+    myCPsiT(NULL), myCMl(NULL), myCNk(NULL) {
+  if (old_gsl_err_h != SLRAObject::myErrorH) {
+    old_gsl_err_h = gsl_set_error_handler(SLRAObject::myErrorH);
+  }
+
+  if (m2d.data == NULL || m2d.size2 != 2) {
+    throw new Exception("s.m2d should be a 2 x q matrix");   
+  }
+  if (n2d.size != 2) {
+    throw new Exception("s.n2d should be a vector of length 2");   
+  }
+  if (wk.data != NULL && wk.size != m2d.size1) {
+    throw new Exception("Size of s.w should be equal to the number of layers");   
+  }
+  double *m1_vec = new double[m2d.size1], *m2_vec = new double[m2d.size1];
+  for (size_t l = 0; l < m2d.size1; l++) {
+    m1_vec[l] = gsl_matrix_get(&m2d, l, 0);
+    m2_vec[l] = gsl_matrix_get(&m2d, l, 1);
+  }
+  try {
+    myS = new HBHLayeredBlWStructure(m1_vec, m2_vec, m2d.size1, 
+              gsl_vector_get(&n2d, 0), gsl_vector_get(&n2d, 1), wk.data);
+  } catch (Exception *e) {
+    delete [] m1_vec;
+    delete [] m2_vec;
+    throw e;
+  }
+  delete [] m1_vec;
+  delete [] m2_vec;
+
+  size_t m = myS->getM();
+  int r = (rvec.size == 0 ? m - 1 : gsl_vector_get(&rvec, 0));
+  if (p_in.size != myS->getNp()) {
+    delete myS;
+    throw new Exception("Size of vector p does not match the 2-D structure");   
+  }
+  if (r <= 0 || r >= m) {
+    delete myS;
+    throw new Exception("Incorrect rank\n");   
+  }
+    
+  myF = new VarproFunction(vecChkNIL(p_in), myS, m-r, NULL);
+  myAsync = NULL;
+  ++myObjCnt;
+}
+
+SLRAObject::SLRAObject( gsl_vector p_in, gsl_vector deg, size_t d,
+                        gsl_vector wk ) : 
+    myCPsiT(NULL), myCMl(NULL), myCNk(NULL) {
+  if (old_gsl_err_h != SLRAObject::myErrorH) {
+    old_gsl_err_h = gsl_set_error_handler(SLRAObject::myErrorH);
+  }
+
+  if (deg.size == 0) {
+    throw new Exception("The degrees of the polynomials should be given");   
+  }
+  if (wk.data != NULL && wk.size != deg.size) {
+    throw new Exception("Size of w should be equal to the number "
+                        "of polynomials");   
+  }
+  double *n_vec = new double[deg.size];
+  for (size_t j = 0; j < deg.size; j++) {
+    n_vec[j] = gsl_vector_get(&deg, j) - d + 1;
+  }
+  try {
+    myS = new SylvesterStructure(d + 1, n_vec, deg.size, wk.data);
+  } catch (Exception *e) {
+    delete [] n_vec;
+    throw e;
+  }
+  delete [] n_vec;
+
+  if (p_in.data != NULL && p_in.size != myS->getNp()) {
+    delete myS;
+    throw new Exception("Size of vector p does not match the degrees");   
+  }
+  gsl_vector *p = gsl_vector_calloc(myS->getNp());
+  if (p_in.data != NULL) {
+    gsl_vector_memcpy(p, &p_in);
+  }
+  try {
+    myF = new VarproFunction(p, myS, 1, NULL, true);
+  } catch (Exception *e) {
+    gsl_vector_free(p);
+    delete myS;
+    throw e;
+  }
+  gsl_vector_free(p);
+  myAsync = NULL;
+  ++myObjCnt;
+}
+
+SLRAObject::SLRAObject( gsl_vector p_re, gsl_vector p_im, gsl_vector ml,
+                        gsl_vector nk, gsl_vector wk, gsl_vector rvec,
+                        bool isgcd ) : 
+    myCPsiT(NULL), myCMl(NULL), myCNk(NULL) {
+  double tmp_n;
+  size_t l, j;
+
+  if (old_gsl_err_h != SLRAObject::myErrorH) {
+    old_gsl_err_h = gsl_set_error_handler(SLRAObject::myErrorH);
+  }
+
+  if (ml.size == 0) {
+    throw new Exception("s.m should be a nonempty vector");   
+  }
+  if (p_im.size != p_re.size) {
+    throw new Exception("Real and imaginary parts of p have different sizes");
+  }
+  if (nk.size == 0) {
+    tmp_n = compute_n(&ml, p_re.size);
+    nk = gsl_vector_view_array(&tmp_n, 1).vector;
+  }    
+  size_t np = compute_np(&ml, &nk), q = ml.size, N = nk.size;
+
+  if (p_re.size < np) {
+    throw new Exception("Size of vector p less than needed");   
+  } else if (p_re.size > np) {
+    throw new Exception("Size of vector p exceeds structure requirements");   
+  } 
+  if (wk.data != NULL && wk.size != q && wk.size != q * N && wk.size != np) {
+    throw new Exception("Incorrect weight specification\n");   
+  }
+  size_t m = 0;
+  for (l = 0; l < q; l++) {
+    m += gsl_vector_get(&ml, l);
+  }
+  int r = (rvec.size == 0 ? m - 1 : gsl_vector_get(&rvec, 0));
+  if (r <= 0 || r >= m) {
+    throw new Exception("Incorrect rank\n");   
+  }
+
+  myCMl = gsl_vector_alloc(q);
+  gsl_vector_memcpy(myCMl, &ml);
+  myCNk = gsl_vector_alloc(N);
+  gsl_vector_memcpy(myCNk, &nk);
+
+  /* Realified structure: the layers and the weights are repeated */
+  gsl_vector *ml2 = gsl_vector_alloc(2 * q), *p = gsl_vector_alloc(2 * np),
+             *wk2 = NULL;
+  for (l = 0; l < q; l++) {
+    gsl_vector_set(ml2, l, gsl_vector_get(&ml, l));
+    gsl_vector_set(ml2, q + l, gsl_vector_get(&ml, l));
+  }
+  realifyP(&p_re, &p_im, p);
+  if (wk.data != NULL) {
+    wk2 = gsl_vector_alloc(2 * wk.size);
+    if (wk.size != q && wk.size != q * N) { /* Elementwise weights */
+      realifyP(&wk, &wk, wk2);
+    } else {
+      for (j = 0; j < wk.size / q; j++) {
+        gsl_vector wk_j = gsl_vector_subvector(&wk, j * q, q).vector;
+        gsl_vector wk2_j = gsl_vector_subvector(wk2, 2 * j * q, q).vector;
+        gsl_vector_memcpy(&wk2_j, &wk_j);
+        wk2_j = gsl_vector_subvector(wk2, (2 * j + 1) * q, q).vector;
+        gsl_vector_memcpy(&wk2_j, &wk_j);
+      }
+    }
+  }
+
+  myS = NULL;
+  myF = NULL;
+  try {
+    myS = createMosaicStructure(ml2, &nk, wk2);
+    myF = new VarproFunction(p, myS, 2 * (m - r), NULL, isgcd);
+  } catch (Exception *e) {
+    if (myS != NULL) {
+      delete myS;
+    }
+    gsl_vector_free(ml2);
+    gsl_vector_free(p);
+    gsl_vector_free_ifnull(wk2);
+    gsl_vector_free(myCMl);
+    gsl_vector_free(myCNk);
+    throw e;
+  }
+  gsl_vector_free(ml2);
+  gsl_vector_free(p);
+  gsl_vector_free_ifnull(wk2);
+
+  /* vec(R^T) = Psi^T x, x = [vec(R_re^T); vec(R_im^T)] (row-major) */
+  size_t d = m - r, a, b, md = m * d;
+  myCPsiT = gsl_matrix_calloc(4 * md, 2 * md);
+  for (a = 0; a < m; a++) {
+    for (b = 0; b < d; b++) {
+      gsl_matrix_set(myCPsiT, a * 2 * d + b, a * d + b, 1);
+      gsl_matrix_set(myCPsiT, a * 2 * d + d + b, md + a * d + b, 1);
+      gsl_matrix_set(myCPsiT, (m + a) * 2 * d + b, md + a * d + b, -1);
+      gsl_matrix_set(myCPsiT, (m + a) * 2 * d + d + b, a * d + b, 1);
+    }
+  }
+  myAsync = NULL;
   ++myObjCnt;
 }
 
 SLRAObject::~SLRAObject() {
+  if (myAsync != NULL) { /* Cancels and waits for the worker */
+    delete myAsync;
+  }
   if (!(--myObjCnt)) {
     Log::deleteLog();
   }
@@ -59,74 +329,328 @@ SLRAObject::~SLRAObject() {
   
   delete myF;
   delete myS;
+  gsl_matrix_free_ifnull(myCPsiT);
+  gsl_vector_free_ifnull(myCMl);
+  gsl_vector_free_ifnull(myCNk);
+}
+
+void SLRAObject::realifyP( const gsl_vector *p_re, const gsl_vector *p_im, 
+                           gsl_vector *p ) {
+  size_t j, np_j, sum_np = 0;
+
+  for (j = 0; j < myCNk->size; sum_np += np_j, j++) {
+    gsl_vector nk_j = gsl_vector_subvector(myCNk, j, 1).vector;
+    np_j = compute_np(myCMl, &nk_j);
+    gsl_vector p_j = gsl_vector_subvector(p, 2 * sum_np, np_j).vector;
+    gsl_vector_const_view src = gsl_vector_const_subvector(p_re, sum_np, np_j);
+    gsl_vector_memcpy(&p_j, &src.vector);
+    p_j = gsl_vector_subvector(p, 2 * sum_np + np_j, np_j).vector;
+    src = gsl_vector_const_subvector(p_im, sum_np, np_j);
+    gsl_vector_memcpy(&p_j, &src.vector);
+  }
+}
+
+void SLRAObject::complexifyP( const gsl_vector *p, gsl_vector *p_re, 
+                              gsl_vector *p_im ) {
+  size_t j, np_j, sum_np = 0;
+
+  for (j = 0; j < myCNk->size; sum_np += np_j, j++) {
+    gsl_vector nk_j = gsl_vector_subvector(myCNk, j, 1).vector;
+    np_j = compute_np(myCMl, &nk_j);
+    gsl_vector_const_view p_j = gsl_vector_const_subvector(p, 2 * sum_np, np_j);
+    gsl_vector dst = gsl_vector_subvector(p_re, sum_np, np_j).vector;
+    gsl_vector_memcpy(&dst, &p_j.vector);
+    p_j = gsl_vector_const_subvector(p, 2 * sum_np + np_j, np_j);
+    dst = gsl_vector_subvector(p_im, sum_np, np_j).vector;
+    gsl_vector_memcpy(&dst, &p_j.vector);
+  }
+}
+
+void SLRAObject::realifyRt( const gsl_matrix *Rt_re, const gsl_matrix *Rt_im,
+                            gsl_matrix *Rt ) {
+  size_t m = Rt_re->size1, d = Rt_re->size2;
+  gsl_matrix sub = gsl_matrix_submatrix(Rt, 0, 0, m, d).matrix;
+
+  gsl_matrix_memcpy(&sub, Rt_re);
+  sub = gsl_matrix_submatrix(Rt, m, d, m, d).matrix;
+  gsl_matrix_memcpy(&sub, Rt_re);
+  sub = gsl_matrix_submatrix(Rt, 0, d, m, d).matrix;
+  gsl_matrix_memcpy(&sub, Rt_im);
+  sub = gsl_matrix_submatrix(Rt, m, 0, m, d).matrix;
+  gsl_matrix_memcpy(&sub, Rt_im);
+  gsl_matrix_scale(&sub, -1);
+}
+
+void SLRAObject::complexifyRt( const gsl_matrix *Rt, gsl_matrix *Rt_re, 
+                               gsl_matrix *Rt_im ) {
+  size_t m = Rt_re->size1, d = Rt_re->size2;
+  gsl_matrix_const_view sub = gsl_matrix_const_submatrix(Rt, 0, 0, m, d);
+  
+  gsl_matrix_memcpy(Rt_re, &sub.matrix);
+  sub = gsl_matrix_const_submatrix(Rt, 0, d, m, d);
+  gsl_matrix_memcpy(Rt_im, &sub.matrix);
+}
+
+void SLRAObject::computeDefaultRTheta( gsl_matrix *Rt ) {
+  if (myCPsiT == NULL) {
+    myF->computeDefaultRTheta(Rt);
+    return;
+  }
+
+  size_t m = myF->getNrow() / 2, d = myF->getD() / 2, n = myF->getN(), 
+         j, a, b, minus1 = -1, lwork, status = 0;
+  double tmp[2];
+  gsl_matrix *c = gsl_matrix_alloc(n, 2 * m);
+  double *A = new double[2 * m * n], *U = new double[2 * m * m], 
+         *s = new double[mymin(m, n)], *rwork = new double[5 * mymin(m, n)];
+
+  /* Column-major complex S(p), S(a, j) = c(j, a) + i c(j, m + a) */
+  myS->fillMatrixFromP(c, myF->getP());
+  for (j = 0; j < n; j++) {
+    for (a = 0; a < m; a++) {
+      A[2 * (a + m * j)] = gsl_matrix_get(c, j, a);
+      A[2 * (a + m * j) + 1] = gsl_matrix_get(c, j, m + a);
+    }
+  }
+  zgesvd_("A", "N", &m, &n, A, &m, s, U, &m, NULL, &n, tmp, &minus1, 
+          rwork, &status);
+  double *work = new double[2 * (lwork = tmp[0])];
+  zgesvd_("A", "N", &m, &n, A, &m, s, U, &m, NULL, &n, work, &lwork, 
+          rwork, &status);
+  delete [] work;
+  delete [] A;
+  delete [] s;
+  delete [] rwork;
+  gsl_matrix_free(c);
+  if (status) {
+    delete [] U;
+    throw new Exception("Error computing initial approximation: "
+                        "ZGESVD didn't converge\n");
+  }
+
+  /* R is the conjugate transpose of the last d left singular vectors */
+  gsl_matrix *Rt_re = gsl_matrix_alloc(m, d), *Rt_im = gsl_matrix_alloc(m, d);
+  for (a = 0; a < m; a++) {
+    for (b = 0; b < d; b++) {
+      gsl_matrix_set(Rt_re, a, b, U[2 * (a + m * (m - d + b))]);
+      gsl_matrix_set(Rt_im, a, b, -U[2 * (a + m * (m - d + b)) + 1]);
+    }
+  }
+  realifyRt(Rt_re, Rt_im, Rt);
+  gsl_matrix_free(Rt_re);
+  gsl_matrix_free(Rt_im);
+  delete [] U;
+}
+
+gsl_matrix *SLRAObject::complexPsi( gsl_matrix *Psi ) {
+  if (myCPsiT == NULL) {
+    return Psi;
+  }
+  if (Psi != NULL) {
+    throw new Exception("Psi is not supported for complex data.\n");
+  }
+  return myCPsiT;
+}
+
+void SLRAObject::computeDefaultx( NLSVarpro *optFun, gsl_vector *x ) {
+  if (myCPsiT == NULL) {
+    optFun->computeDefaultx(x);
+    return;
+  }
+  gsl_matrix *Rt = gsl_matrix_alloc(myF->getNrow(), myF->getD());
+  computeDefaultRTheta(Rt);
+  optFun->RTheta2x(Rt, x);
+  gsl_matrix_free(Rt);
+}
+
+NLSVarpro *SLRAObject::createNLSVarpro( VarproFunction &F, 
+                OptimizationOptions *opt, gsl_matrix *Psi ) {
+  if (Psi != NULL && Psi->size1 != F.getNrow()) {
+    if (opt->method == SLRA_OPT_METHOD_GRASS) {
+      throw new Exception("Psi should be m x k for the Grassmann method.\n");
+    }
+    opt->avoid_xi = 1;
+  }
+  if (opt->method == SLRA_OPT_METHOD_GRASS) { /* Only [R] parametrization */
+    opt->avoid_xi = 1;
+  }
+  if (opt->avoid_xi && opt->method != SLRA_OPT_METHOD_GRASS &&
+      opt->method != SLRA_OPT_METHOD_LBFGS) {
+    opt->method = SLRA_OPT_METHOD_LMPINV;
+  }
+    
+  if (opt->ls_correction) {
+    if (opt->avoid_xi) {
+      if (Psi != NULL) {
+        return new NLSVarproPsiVecRCorrection(F, Psi);
+      } else {
+        return new NLSVarproVecRCorrection(F);
+      }
+    } else {
+      return new NLSVarproPsiXICorrection(F, Psi, opt->xi_maxabs);
+    }
+  } else {
+    if (opt->avoid_xi) {
+      if (Psi != NULL) {
+        return new NLSVarproPsiVecRCholesky(F, Psi);
+      } else {
+        return new NLSVarproVecRCholesky(F);
+      }
+    } else {
+      return new NLSVarproPsiXICholesky(F, Psi, opt->xi_maxabs);
+    }
+  }
+}
+
+void SLRAObject::runOptimization( OptimizationOptions *opt, NLSVarpro *optFun, 
+                gsl_vector *x, gsl_matrix *v_out, IterationLogger *itLog, 
+                Checkpoint *chk ) {
+  if (opt->sample_init > 0 && !(chk != NULL && chk->isLoaded())) {
+    opt->sampledOptimize(optFun, x, itLog);
+  }
+  if (opt->method == SLRA_OPT_METHOD_LMPINV) {
+    opt->lmpinvOptimize(optFun, x, v_out, itLog, chk);
+  } else if (opt->method == SLRA_OPT_METHOD_GRASS) {
+    opt->grassOptimize(optFun, x, optFun->getD(), itLog, chk);
+  } else if (opt->method == SLRA_OPT_METHOD_LBFGS) {
+    opt->lbfgsOptimize(optFun, x, itLog, chk);
+  } else {
+    opt->gslOptimize(optFun, x, v_out, itLog, chk);
+  } 
+}
+
+/* Covariance of vec(X), where R^T = Psi^T [X; -I], from the covariance 
+ * (or its factor W) vx of x: v = T vx T^T (or T W W^T T^T), where T is 
+ * the Jacobian of the map x -> vec(X). The map x -> R is affine for all 
+ * the parametrizations, and the columns of T are computed from the 
+ * differences dR by dX = -(dB + X dA) A^{-1}, where Psi^{-1} R = [B; A]. 
+ * If v is a vector, only the diagonal is computed. 
+ * v is set to NaN if X is not defined (A is singular or Psi is not m x k). */
+static void computeXCovariance( NLSVarpro *optFun, const gsl_vector *x,
+                gsl_matrix *Psi, const gsl_matrix *vx, bool isFactor, 
+                gsl_matrix *v ) {
+  size_t m = optFun->getM(), d = optFun->getD(), 
+         k = (Psi != NULL ? Psi->size2 : m), nvar = x->size, i, j;
+  gsl_matrix *R = gsl_matrix_alloc(m, d), *dR = gsl_matrix_alloc(m, d), 
+             *Y = gsl_matrix_alloc(k, d), *dY = gsl_matrix_alloc(k, d),
+             *X = gsl_matrix_alloc(k - d, d), *dX = gsl_matrix_alloc(k - d, d),
+             *T = gsl_matrix_alloc((k - d) * d, nvar), 
+             *TV = gsl_matrix_alloc((k - d) * d, nvar);
+  gsl_vector *xi = gsl_vector_alloc(nvar);
+  bool singular = (Psi != NULL && Psi->size1 != m);
+
+  optFun->x2RTheta(R, x);
+  if (Psi != NULL && !singular) {
+    ls_solve(Psi, R, Y);
+  } else if (!singular) {
+    gsl_matrix_memcpy(Y, R);
+  }
+  gsl_matrix A = gsl_matrix_submatrix(Y, k - d, 0, d, d).matrix;
+  gsl_matrix dB = gsl_matrix_submatrix(dY, 0, 0, k - d, d).matrix;
+  gsl_matrix dA = gsl_matrix_submatrix(dY, k - d, 0, d, d).matrix;
+  singular = singular || (NLSVarproPsiXI::PQ2XId(Y, X) != 0);
+  for (i = 0; i < nvar && !singular; i++) {
+    gsl_vector_memcpy(xi, x);
+    (*gsl_vector_ptr(xi, i)) += 1;
+    optFun->x2RTheta(dR, xi);
+    gsl_matrix_sub(dR, R);
+    if (Psi != NULL) {
+      ls_solve(Psi, dR, dY);
+    } else {
+      gsl_matrix_memcpy(dY, dR);
+    }
+    /* dY := [dB + X dA; A], then dX = -(dB + X dA) A^{-1} */
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, X, &dA, 1.0, &dB);
+    gsl_matrix_memcpy(&dA, &A);
+    NLSVarproPsiXI::PQ2XId(dY, dX);
+    gsl_vector dXvec = gsl_vector_view_array(dX->data, dX->size1 * dX->size2).vector;
+    gsl_matrix_set_col(T, i, &dXvec);
+  }
+  
+  if (singular) {
+    gsl_matrix_set_all(v, GSL_NAN);
+  } else {
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1.0, T, vx, 0.0, TV);
+    if (v->size1 == 1 || v->size2 == 1) {
+      gsl_vector vdiag = gsl_vector_view_array(v->data, TV->size1).vector;
+      for (j = 0; j < TV->size1; j++) {
+        gsl_vector TVrow = gsl_matrix_row(TV, j).vector, 
+                   Trow = gsl_matrix_row(isFactor ? TV : T, j).vector;
+        gsl_blas_ddot(&TVrow, &Trow, gsl_vector_ptr(&vdiag, j));
+      }
+    } else {
+      gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, TV, isFactor ? TV : T, 
+                     0.0, v);
+    }
+  }
+
+  gsl_matrix_free(R);
+  gsl_matrix_free(dR);
+  gsl_matrix_free(Y);
+  gsl_matrix_free(dY);
+  gsl_matrix_free(X);
+  gsl_matrix_free(dX);
+  gsl_matrix_free(T);
+  gsl_matrix_free(TV);
+  gsl_vector_free(xi);
 }
 
 void SLRAObject::optimize( OptimizationOptions* opt, gsl_matrix *Rini,
            gsl_matrix *Psi, gsl_vector *p_out, gsl_matrix *r_out, 
            gsl_matrix *v_out, gsl_matrix *Rs, gsl_matrix *info ) { 
   NLSVarpro *optFun = NULL;
+  Checkpoint *chk = NULL;
   gsl_vector *x = NULL;
-  double old_reg = myF->getReggamma();
+  gsl_matrix *vx = NULL;
+  double old_reg = myF->getReggamma(), old_tol_m = myF->getMissingTol();
   
   try { 
     time_t t_b = clock();
 
-    myF->setReggamma(opt->reggamma);
-    if (Psi != NULL && Psi->size1 != myF->getNrow()) {
-      opt->avoid_xi = 1;
-    }
-    
-    if (myF->isGCD()) {
-      opt->ls_correction = 1;
-    }
-    if (opt->ls_correction) {
-      if (opt->avoid_xi) {
-        if (Psi != NULL) {
-          optFun = new NLSVarproPsiVecRCorrection(*myF, Psi);
-        } else {
-          optFun = new NLSVarproVecRCorrection(*myF);
-        }
-      } else {
-        optFun = new NLSVarproPsiXICorrection(*myF, Psi);
-      }
-    } else {
-      if (opt->avoid_xi) {
-        if (Psi != NULL) {
-          optFun = new NLSVarproPsiVecRCholesky(*myF, Psi);
-        } else {
-          optFun = new NLSVarproVecRCholesky(*myF);
-        }
-      } else {
-        optFun = new NLSVarproPsiXICholesky(*myF, Psi);
+    if (opt->chkpt_file[0] != 0) {
+      chk = new Checkpoint(opt);
+      if (opt->resume && chk->load(opt)) {
+        Log::lprintf(Log::LOG_LEVEL_NOTIFY, "Resuming from iteration %d.\n",
+                     (int)chk->getIter());
       }
     }
+    Psi = complexPsi(Psi);
+    myF->setReggamma(opt->reggamma);
+    myF->setMissingTol(opt->tol_m);
+    optFun = createNLSVarpro(*myF, opt, Psi);
     x = gsl_vector_alloc(optFun->getNvar());
 
-    MyIterationLogger itLog(optFun, Rs, info);
+    MyIterationLogger itLog(optFun, Rs, info, opt->maxtime);
 
-    if (Rini == NULL) {  
+    if (chk != NULL && chk->isLoaded()) {
+      chk->restore(optFun, x);
+    } else if (Rini == NULL) {  
       Log::lprintf(Log::LOG_LEVEL_ITER, 
            "R not given - computing initial approximation.\n");    
-      optFun->computeDefaultx(x);
+      computeDefaultx(optFun, x);
     } else {
       optFun->RTheta2x(Rini, x);
     }
-    if (opt->avoid_xi) {
-      opt->method = SLRA_OPT_METHOD_LMPINV;
+    if (v_out != NULL && (opt->method == SLRA_OPT_METHOD_LM ||
+                          opt->method == SLRA_OPT_METHOD_LMPINV)) {
+      vx = gsl_matrix_alloc(optFun->getNvar(), optFun->getNvar());
+    }
+    runOptimization(opt, optFun, x, vx, &itLog, chk);
+    if (vx != NULL) {
+      computeXCovariance(optFun, x, Psi, vx, 
+                         opt->method == SLRA_OPT_METHOD_LMPINV, v_out);
     }
-
-    if (opt->method == SLRA_OPT_METHOD_LMPINV) {
-      opt->lmpinvOptimize(optFun, x, &itLog);
-    } else {
-      opt->gslOptimize(optFun, x, v_out, &itLog);
-    } 
 
     if (p_out != NULL) {
       optFun->computePhat(p_out, x);
     }
     opt->time = (double) (clock() - t_b) / (double) CLOCKS_PER_SEC;
+    if (chk != NULL) {
+      opt->time += chk->getPriorTime();
+    }
     if (r_out != NULL) {
       optFun->x2RTheta(r_out, x);
+      optFun->normalizeRTheta(r_out);
     }
 
     throw (Exception *)NULL; /* Throw NULL exception to unify deallocation */
@@ -134,11 +658,245 @@ void SLRAObject::optimize( OptimizationOptions* opt, gsl_matrix *Rini,
     if (optFun != NULL)  {
       delete optFun;
     }
+    if (chk != NULL)  {
+      delete chk;
+    }
     gsl_vector_free_ifnull(x);
+    gsl_matrix_free_ifnull(vx);
     
     if (e != NULL) { /* Abnormal termination only if e is normal exception */
       throw;  
     }
     myF->setReggamma(old_reg);
+    myF->setMissingTol(old_tol_m);
+  }
+}
+double SLRAObject::optimizeGCD( OptimizationOptions *opt, const gsl_vector *p,
+                                gsl_vector *hini, gsl_vector *h, 
+                                gsl_vector *ph ) {
+  if (!myF->isGCD() || isComplex() || myF->getD() != 1) {
+    throw new Exception("The object is not constructed for a real GCD problem");
+  }
+  if (hini->size != myF->getNrow() || (h != NULL && h->size != hini->size)) {
+    throw new Exception("Incorrect size of h");
+  }
+  if (p != NULL) {
+    myF->setP(p);
+  }
+  gsl_matrix Rini = gsl_matrix_view_vector(hini, hini->size, 1).matrix, Rh;
+  if (h != NULL) {
+    Rh = gsl_matrix_view_vector(h, h->size, 1).matrix;
   }
-}
\ No newline at end of file
+  optimize(opt, &Rini, NULL, ph, (h != NULL ? &Rh : NULL), NULL);
+  return opt->fmin;
+}
+
+AsyncOptimization *SLRAObject::optimizeAsync( OptimizationOptions* opt, 
+                       gsl_matrix *Rini, gsl_matrix *Psi ) {
+  VarproFunction *F = NULL;
+  NLSVarpro *optFun = NULL;
+  gsl_vector *x = NULL;
+  OptimizationOptions opt_w = *opt;
+  
+  if (myAsync != NULL) {
+    AsyncProgress progress;
+    myAsync->poll(&progress);
+    if (progress.running) {
+      throw new Exception("An asynchronous optimization is already running.\n");
+    }
+    delete myAsync;
+    myAsync = NULL;
+  }
+  
+  try {
+    Psi = complexPsi(Psi);
+    F = new VarproFunction(myF->getP(), myS, myF->getD(), NULL, myF->isGCD());
+    F->setReggamma(opt->reggamma);
+    F->setMissingTol(opt->tol_m);
+    optFun = createNLSVarpro(*F, &opt_w, Psi);
+    x = gsl_vector_alloc(optFun->getNvar());
+    if (Rini == NULL) {  
+      computeDefaultx(optFun, x);
+    } else {
+      optFun->RTheta2x(Rini, x);
+    }
+  } catch (Exception *e) {
+    if (optFun != NULL) {
+      delete optFun;
+    }
+    if (F != NULL) {
+      delete F;
+    }
+    gsl_vector_free_ifnull(x);
+    throw;
+  }
+  return (myAsync = new AsyncOptimization(F, optFun, x, &opt_w));
+}
+
+/* State shared by the concurrent starts of SLRAObject::multiStart() */
+struct MultiStartState {
+  double best;   /* Best cost function value reached so far */
+  double prune;  /* Relative margin for pruning (disabled if <= 0) */
+};
+
+/* Iteration logger that stops a start lagging behind the best one */
+class MultiStartLogger : public IterationLogger {
+  MultiStartState *myState;
+  bool myPruned;
+public:
+  MultiStartLogger( MultiStartState *state ) : myState(state), myPruned(false) {}
+  virtual void reportIteration( int no, const gsl_vector * /* x */,
+                                double fmin, const gsl_vector * /* grad */ ) {
+    bool lags;
+#pragma omp critical(slra_multistart)
+    {
+      if (fmin < myState->best) {
+        myState->best = fmin;
+      }
+      lags = (fmin > (1 + myState->prune) * myState->best);
+    }
+    if (myState->prune > 0 && no > 0 && lags) {
+      myPruned = true;
+    }
+  }
+  virtual bool stopRequested() { return myPruned; }
+  bool isPruned() const { return myPruned; }
+};
+
+size_t SLRAObject::multiStart( OptimizationOptions* opt, gsl_matrix *Rinis,
+           size_t nstarts, double perturb, double prune, gsl_matrix *Psi, 
+           gsl_vector *p_out, gsl_matrix *r_out, gsl_matrix *stats ) {
+  size_t m = myF->getNrow(), d = myF->getD(), 
+         K = (Rinis != NULL ? Rinis->size1 : nstarts), k, best = 0;
+  MultiStartState state = { GSL_POSINF, prune };
+  double old_reg = myF->getReggamma(), old_tol_m = myF->getMissingTol();
+  Timer timer;
+  
+  if (K == 0) {
+    throw new Exception("At least one start is needed.\n");
+  }
+  if (Rinis != NULL && Rinis->size2 != m * d) {
+    throw new Exception("Each row of Rinis should contain m * d elements.\n");
+  }
+  if (stats != NULL && (stats->size1 != K || stats->size2 < 4)) {
+    throw new Exception("stats should be a K x 4 matrix.\n");
+  }
+  Psi = complexPsi(Psi);
+
+  /* Initial approximations: given, or perturbations of the default one */
+  gsl_matrix *Rs = gsl_matrix_alloc(K, m * d);
+  gsl_vector *fmins = gsl_vector_alloc(K);
+  OptimizationOptions *opts = new OptimizationOptions[K];
+  int *status = new int[K];
+  
+  if (Rinis != NULL) {
+    gsl_matrix_memcpy(Rs, Rinis);
+  } else {
+    gsl_vector R0vec = gsl_matrix_row(Rs, 0).vector;
+    gsl_matrix R0 = gsl_matrix_view_vector(&R0vec, m, d).matrix;
+    unsigned long seed = 1;
+    
+    computeDefaultRTheta(&R0);
+    double scale = perturb * gsl_blas_dnrm2(&R0vec) / sqrt((double)(m * d));
+    for (k = 1; k < K; k++) {
+      gsl_vector Rk = gsl_matrix_row(Rs, k).vector;
+      gsl_vector_memcpy(&Rk, &R0vec);
+      for (size_t i = 0; i < Rk.size; i++) { /* Uniform in [-scale, scale] */
+        seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+        *gsl_vector_ptr(&Rk, i) += scale * (2.0 * seed / 2147483648.0 - 1);
+      }
+    }
+  }
+  
+  timer.start();
+
+#pragma omp parallel for schedule(dynamic)
+  for (long kk = 0; kk < (long)K; kk++) {
+    VarproFunction *F = NULL;
+    NLSVarpro *optFun = NULL;
+    gsl_vector *x = NULL;
+    gsl_vector Rkvec = gsl_matrix_row(Rs, kk).vector;
+    gsl_matrix Rk = gsl_matrix_view_vector(&Rkvec, m, d).matrix;
+    Timer start_timer;
+    
+    /* The workers (including the calling thread) should not print */
+    Log::setThreadMaxLevel(Log::LOG_LEVEL_OFF);
+    start_timer.start();
+    opts[kk] = *opt;
+    status[kk] = SLRA_MS_FAILED;
+    gsl_vector_set(fmins, kk, GSL_POSINF);
+    try {
+      F = new VarproFunction(myF->getP(), myS, d, NULL, myF->isGCD());
+      F->setReggamma(opt->reggamma);
+      F->setMissingTol(opt->tol_m);
+      optFun = createNLSVarpro(*F, &opts[kk], Psi);
+      x = gsl_vector_alloc(optFun->getNvar());
+      optFun->RTheta2x(&Rk, x);
+
+      MultiStartLogger itLog(&state);
+      runOptimization(&opts[kk], optFun, x, NULL, &itLog);
+      optFun->x2RTheta(&Rk, x);
+      optFun->normalizeRTheta(&Rk);
+      gsl_vector_set(fmins, kk, opts[kk].fmin);
+      status[kk] = itLog.isPruned() ? SLRA_MS_PRUNED : SLRA_MS_FINISHED;
+    } catch (Exception *e) {
+      if (e != NULL) {
+        delete e;
+      }
+    }
+    opts[kk].time = start_timer.getElapsedTime();
+    if (optFun != NULL) {
+      delete optFun;
+    }
+    if (F != NULL) {
+      delete F;
+    }
+    gsl_vector_free_ifnull(x);
+    Log::resetThreadMaxLevel();
+  }
+  
+  best = gsl_vector_min_index(fmins);
+  
+  if (stats != NULL) {
+    for (k = 0; k < K; k++) {
+      gsl_matrix_set(stats, k, 0, gsl_vector_get(fmins, k));
+      gsl_matrix_set(stats, k, 1, opts[k].iter);
+      gsl_matrix_set(stats, k, 2, opts[k].time);
+      gsl_matrix_set(stats, k, 3, status[k]);
+    }
+  }
+  
+  bool failed = (status[best] == SLRA_MS_FAILED);
+  if (!failed) {
+    gsl_vector Rbvec = gsl_matrix_row(Rs, best).vector;
+    gsl_matrix Rb = gsl_matrix_view_vector(&Rbvec, m, d).matrix;
+  
+    opt->method = opts[best].method;
+    opt->avoid_xi = opts[best].avoid_xi;
+    opt->fmin = opts[best].fmin;
+    opt->iter = opts[best].iter;
+    if (p_out != NULL) {
+      myF->setReggamma(opt->reggamma);
+      myF->setMissingTol(opt->tol_m);
+      myF->computePhat(p_out, &Rb);
+      myF->setReggamma(old_reg);
+      myF->setMissingTol(old_tol_m);
+    }
+    if (r_out != NULL) {
+      gsl_matrix_memcpy(r_out, &Rb);
+    }
+  }
+  opt->time = timer.getElapsedTime();
+  
+  gsl_matrix_free(Rs);
+  gsl_vector_free(fmins);
+  delete [] opts;
+  delete [] status;
+
+  if (failed) {
+    throw new Exception("All the starts have failed.\n");
+  }
+  Log::lprintf(Log::LOG_LEVEL_FINAL, "Multi-start optimization: best of %d "
+               "starts is #%d, f = %15.10e.\n", (int)K, (int)best, opt->fmin);
+  return best;
+}
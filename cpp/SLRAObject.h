@@ -1,19 +1,114 @@
 #include "slra.h"
 
+/** @name Status of a start in SLRAObject::multiStart()
+ * @{ */
+#define SLRA_MS_FINISHED 0 /**< the optimization method terminated normally */
+#define SLRA_MS_PRUNED   1 /**< stopped because its cost lagged behind the best */
+#define SLRA_MS_FAILED   2 /**< an exception occurred */
+/* @} */
+
 class SLRAObject {
   Structure *myS;
   VarproFunction *myF;
+  AsyncOptimization *myAsync;
+  /* Complex data: Psi^T of the realified R and the complex structure 
+   * (NULL for real data) */
+  gsl_matrix *myCPsiT;
+  gsl_vector *myCMl, *myCNk;
+  
+  gsl_matrix *complexPsi( gsl_matrix *Psi );
+  void computeDefaultx( NLSVarpro *optFun, gsl_vector *x );
   static void myErrorH( const char *reason, const char *F, int ln, int gsl_err );
   static gsl_error_handler_t *old_gsl_err_h;
   static size_t myObjCnt;
 public:
+  /** Constructs the object for a mosaic Hankel-like structure 
+   * \f$\Phi \mathscr{H}\f$, see createMosaicStructure(). If
+   * <tt>tk != NULL</tt>, the column blocks marked in tk are layered 
+   * Toeplitz instead of layered Hankel. If <tt>wband != NULL</tt>, 
+   * \f$\mathrm{W}^{-1}\f$ is banded with the band coefficients of 
+   * the layers in the rows of wband (see HLayeredBandWStructure), 
+   * and wk should be empty. */
   SLRAObject( gsl_vector p_in, gsl_vector ml, gsl_vector nk,
               gsl_matrix perm, gsl_vector wk, gsl_vector rvec,
-              bool isgcd = false );
+              bool isgcd = false, gsl_vector *tk = NULL, 
+              gsl_matrix *wband = NULL );
+  /** Constructs the object for a general affine structure 
+   * \f$S(p) = S_0 + p(\mathrm{tts})\f$, see SparseAffineStructure.
+   * The matrices tts and s0 are transposed (\f$n \times m\f$), s0 and wk
+   * can be empty. If <tt>hodlr_tol > 0</tt>, \f$\Gamma\f$ is factorized
+   * by HODLRCholesky with this tolerance. */
+  SLRAObject( gsl_vector p_in, gsl_matrix tts, gsl_matrix s0, 
+              gsl_vector wk, gsl_vector rvec, double hodlr_tol = 0 );
+  /** Constructs the object for a layered 2-D (Hankel-block-Hankel) structure,
+   * see HBHLayeredBlWStructure. The rows of the \f$q \times 2\f$ matrix m2d
+   * are \f$(m^{(l)}_1, m^{(l)}_2)\f$, n2d is \f$(n_1, n_2)\f$, and wk is 
+   * empty or contains the weights of the layers. */
+  SLRAObject( gsl_vector p_in, gsl_matrix m2d, gsl_vector n2d,
+              gsl_vector wk, gsl_vector rvec );
+  /** Constructs the object for a mosaic Hankel structure with complex
+   * parameters \f$p = p_{re} + i p_{im}\f$ and weights wk 
+   * (see createMosaicStructure()); rvec contains the complex rank \f$r\f$.
+   * The problem is solved as a real one for the realified structure 
+   * \f$[\mathrm{Re}\, \mathscr{H}(p); \mathrm{Im}\, \mathscr{H}(p)]\f$, 
+   * i.e. the structure with the layers \f$[{\bf m}; {\bf m}]\f$ and
+   * the parameters \f$[\mathrm{Re}\, p_{\cdot j}; \mathrm{Im}\, p_{\cdot j}]\f$ 
+   * in each column block \f$j\f$ (see realifyP()), with the rank 
+   * reduction \f$2(m-r)\f$ and the complex form 
+   * \f$\begin{bmatrix} R_{re} & -R_{im} \\ R_{im} & R_{re}\end{bmatrix}\f$ 
+   * of \f$R\f$ imposed by \f$\Psi\f$ (see realifyRt()). The cost function 
+   * is \f$\sum_k w_k |p_k - \widehat{p}_k|^2\f$ and \f$\Gamma\f$ 
+   * is the realification of the Hermitian matrix of the complex problem.
+   * getS() and getF() return the realified structure and cost function. */
+  SLRAObject( gsl_vector p_re, gsl_vector p_im, gsl_vector ml, gsl_vector nk,
+              gsl_vector wk, gsl_vector rvec, bool isgcd = false );
+  /** Constructs the object for the approximate GCD of \f$N\f$ polynomials,
+   * see SylvesterStructure. The vector deg contains the degrees of the 
+   * polynomials, d is the degree of the GCD, and wk is empty or contains
+   * the weights of the polynomials. p_in contains the concatenated 
+   * coefficients of the polynomials, or is empty if the data are given 
+   * later to optimizeGCD(). */
+  SLRAObject( gsl_vector p_in, gsl_vector deg, size_t d, gsl_vector wk );
   virtual ~SLRAObject();
     
   Structure *getS() { return myS; }
   VarproFunction *getF() { return myF; }
+
+  /** Returns true if the object is constructed for complex data */
+  bool isComplex() { return myCPsiT != NULL; }
+  /** Converts the complex parameters to the realified ones */
+  void realifyP( const gsl_vector *p_re, const gsl_vector *p_im, 
+                 gsl_vector *p );
+  /** Converts the realified parameters to the complex ones */
+  void complexifyP( const gsl_vector *p, gsl_vector *p_re, gsl_vector *p_im );
+  /** Converts the complex \f$R^{\top}\f$ (\f$m \times d\f$) to the 
+   * realified \f$2m \times 2d\f$ matrix 
+   * \f$\begin{bmatrix} R^{\top}_{re} & R^{\top}_{im} \\ 
+   * -R^{\top}_{im} & R^{\top}_{re}\end{bmatrix}\f$ */
+  void realifyRt( const gsl_matrix *Rt_re, const gsl_matrix *Rt_im, 
+                  gsl_matrix *Rt );
+  /** Converts the realified \f$R^{\top}\f$ to the complex one */
+  void complexifyRt( const gsl_matrix *Rt, gsl_matrix *Rt_re, 
+                     gsl_matrix *Rt_im );
+  /** Computes the default initial approximation 
+   * (see VarproFunction::computeDefaultRTheta()). For complex data, 
+   * \f$R\f$ is computed from the complex SVD of \f$S(p)\f$ 
+   * and is realified. */
+  void computeDefaultRTheta( gsl_matrix *Rt );
+
+  /** Selects the parametrization for the given options and \f$\Psi\f$ 
+   * (opt->avoid_xi and opt->method may be adjusted) */
+  static NLSVarpro *createNLSVarpro( VarproFunction &F, 
+                        OptimizationOptions *opt, gsl_matrix *Psi );
+  /** Runs the optimization method selected in opt.
+   * If <tt>v_out != NULL</tt>, the covariance matrix of x is returned in v_out
+   * by SLRA_OPT_METHOD_LM and its factor \f$W\f$ 
+   * (\f$v = WW^{\top}\f$) by SLRA_OPT_METHOD_LMPINV, see 
+   * OptimizationOptions::lmpinvOptimize(); v_out is not used by the other 
+   * methods. */
+  static void runOptimization( OptimizationOptions *opt, NLSVarpro *optFun, 
+                        gsl_vector *x, gsl_matrix *v_out, 
+                        IterationLogger *itLog, Checkpoint *chk = NULL );
     
   /** Run optimization
    * @param [in]     s             Structure specification
@@ -21,12 +116,18 @@ public:
    * @param [in,out] opt           OptimizationOptions object
    * @param [in]     Rini          Matrix for initial approximation
    * @param [in]     Psi           \f$\Psi\f$ matrix
-   *                               (identity if <tt>Psi == NULL</tt> )
+   *                               (identity if <tt>Psi == NULL</tt>, 
+   *                               should be NULL for complex data)
    * @param [out]    p_out         Approximation \f$\widehat{p}\f$
    *                               (not computed if <tt>p_out == NULL</tt> )
    * @param [out]    R_out         Output parameter vector
    *                               (not computed if <tt>R_out == NULL</tt> )
-   * @param [out]    v_out         Covariance matrix for X
+   * @param [out]    v_out         Covariance matrix for 
+   *                               \f$\mathrm{vec}(X)\f$, where 
+   *                               \f$R^{\top} = \Psi^{\top} [X;-I]\f$ 
+   *                               (only the diagonal if v_out is 
+   *                               a vector, see opt->cov_diag); computed 
+   *                               only by the Levenberg-Marquardt methods
    * @param [out]    Rs            Matrix of vectorized Rs at each iteration
    *                               (not computed if <tt>Rs == NULL</tt> )
    * @param [out]    info          Matrix of info (time, fmin, ...)
@@ -35,6 +136,72 @@ public:
   void optimize( OptimizationOptions* opt, gsl_matrix *Rini, gsl_matrix *Psi,
              gsl_vector *p_out, gsl_matrix *r_out, gsl_matrix *v_out,
              gsl_matrix *Rs = NULL, gsl_matrix *info = NULL );
+
+  /** Computes the approximate GCD for the data p from the initial 
+   * approximation hini of the common divisor (\f$R = h^{\top}\f$ in 
+   * the GCD mode). The object is reused for many problems of the same 
+   * degrees: p replaces the data (see VarproFunction::setP()) unless 
+   * <tt>p == NULL</tt>, and the structure and the workspace are not 
+   * reallocated. The optimization is run by optimize().
+   * @param [in,out] opt    OptimizationOptions object
+   * @param [in]     p      coefficients of the polynomials (or NULL)
+   * @param [in]     hini   initial approximation of \f$h\f$
+   * @param [out]    h      computed \f$h\f$, normalized as R_out in 
+   *                        optimize() (not computed if <tt>h == NULL</tt>)
+   * @param [out]    ph     approximation \f$\widehat{p}\f$
+   *                        (not computed if <tt>ph == NULL</tt>)
+   * @return \f$f(h^{\top})\f$ (also stored in opt->fmin)
+   */
+  double optimizeGCD( OptimizationOptions *opt, const gsl_vector *p,
+                      gsl_vector *hini, gsl_vector *h, gsl_vector *ph );
+
+  /** Run optimization from several initial approximations (multi-start).
+   * The starts are run concurrently (if compiled with OpenMP), 
+   * each with its own VarproFunction (with its own Cholesky and DGamma 
+   * objects and workspace); the structure and the data are shared, 
+   * and are only read by the starts (see Structure).
+   * A start is stopped as soon as its cost exceeds \f$(1 + prune)\f$ times
+   * the best cost reached so far by all the starts.
+   * @param [in,out] opt     OptimizationOptions object (the same for all starts),
+   *                         on exit contains fmin and iter of the best start
+   *                         and the total time
+   * @param [in]     Rinis   \f$K \times md\f$ matrix, each row is 
+   *                         a vectorized initial \f$R^{\top}\f$.
+   *                         If <tt>Rinis == NULL</tt>, the first start is the default
+   *                         initial approximation, and the others are its
+   *                         random perturbations
+   * @param [in]     nstarts Number of starts \f$K\f$ (if <tt>Rinis == NULL</tt>)
+   * @param [in]     perturb Relative size of random perturbations
+   * @param [in]     prune   Relative margin for pruning (no pruning if 
+   *                         <tt>prune <= 0</tt>)
+   * @param [in]     Psi     \f$\Psi\f$ matrix (identity if <tt>Psi == NULL</tt> )
+   * @param [out]    p_out   Approximation \f$\widehat{p}\f$ of the best start
+   *                         (not computed if <tt>p_out == NULL</tt> )
+   * @param [out]    r_out   Output parameter of the best start
+   *                         (not computed if <tt>r_out == NULL</tt> )
+   * @param [out]    stats   \f$K \times 4\f$ matrix with rows 
+   *                         (fmin, iter, time, status), where status is 
+   *                         SLRA_MS_xxx (not computed if <tt>stats == NULL</tt> )
+   * @return the index of the best start
+   */
+  size_t multiStart( OptimizationOptions* opt, gsl_matrix *Rinis, 
+             size_t nstarts, double perturb, double prune, gsl_matrix *Psi,
+             gsl_vector *p_out, gsl_matrix *r_out, gsl_matrix *stats = NULL );
+
+  /** Start optimization on a worker thread and return immediately.
+   * The initial approximation is computed before the return. 
+   * The object keeps at most one asynchronous optimization: a finished one 
+   * is replaced, and an exception is thrown if one is still running.
+   * Checkpointing (opt.chkpt_file) is not used.
+   * @param [in]     opt     OptimizationOptions object (copied)
+   * @param [in]     Rini    Matrix for initial approximation
+   * @param [in]     Psi     \f$\Psi\f$ matrix (identity if <tt>Psi == NULL</tt> )
+   * @return the handle, owned by the SLRAObject (see getAsync())
+   */
+  AsyncOptimization *optimizeAsync( OptimizationOptions* opt, 
+                         gsl_matrix *Rini, gsl_matrix *Psi );
+  /** Returns the last asynchronous optimization (NULL if none) */
+  AsyncOptimization *getAsync() { return myAsync; }
   
 };
 
@@ -0,0 +1,404 @@
+#include <memory.h>
+#include <stdlib.h>
+#include <math.h>
+extern "C" {
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_math.h>
+}
+#include "slra.h"
+
+static int compareSizeT( const void *a, const void *b ) {
+  size_t x = *(const size_t *)a, y = *(const size_t *)b;
+  return (x > y) - (x < y);
+}
+
+SparseAffineStructure::SparseAffineStructure( const gsl_matrix *tts, size_t np,
+    const gsl_matrix *s0, const double *w_vec, bool reorder, double hodlr_tol ) :
+    myM(tts->size2), myN(tts->size1), myNp(np), myMu(1), 
+    myHodlrTol(hodlr_tol), myS0(NULL) {
+  size_t j, a, k, l, l2, nnz = 0;
+
+  for (j = 0; j < myN; j++) {
+    for (a = 0; a < myM; a++) {
+      double t = gsl_matrix_get(tts, j, a);
+      if (!(t >= 0 && t <= np && t == floor(t))) {
+        throw new Exception("Incorrect element of tts: %lf\n", t);
+      }
+    }
+  }
+  if (s0 != NULL && (s0->size1 != myN || s0->size2 != myM)) {
+    throw new Exception("The sizes of S0 and tts do not match\n");
+  }
+  double missing_inv_w = (w_vec != NULL ? missingInvWeight(w_vec, np) : 1);
+
+  myInvWeights = gsl_vector_alloc(np);
+  myInvSqrtWeights = gsl_vector_alloc(np);
+  myMissing = NULL;
+  for (k = 0; k < np; k++) {
+    if (w_vec != NULL && w_vec[k] == 0) {
+      if (myMissing == NULL) {
+        myMissing = new bool[np];
+        memset(myMissing, 0, np * sizeof(bool));
+      }
+      myMissing[k] = true;
+      gsl_vector_set(myInvWeights, k, missing_inv_w);
+    } else {
+      gsl_vector_set(myInvWeights, k, (w_vec != NULL ? 1 / w_vec[k] : 1));
+    }
+    gsl_vector_set(myInvSqrtWeights, k, sqrt(gsl_vector_get(myInvWeights, k)));
+  }
+
+  /* Occurrences (column, row) of the parameters, sorted by the parameter */
+  size_t *tts0 = new size_t[myN * myM], *par_off = new size_t[np + 1];
+  memset(par_off, 0, (np + 1) * sizeof(size_t));
+  for (j = 0; j < myN; j++) {
+    for (a = 0; a < myM; a++) {
+      tts0[j * myM + a] = (size_t)gsl_matrix_get(tts, j, a);
+      if (tts0[j * myM + a] > 0) {
+        par_off[tts0[j * myM + a] - 1]++;
+        nnz++;
+      }
+    }
+  }
+  for (k = 0; k < np; k++) {
+    par_off[k + 1] += par_off[k];
+  }
+  size_t *par_col = new size_t[mymax(nnz, 1)], *par_row = new size_t[mymax(nnz, 1)];
+  for (j = myN; j-- > 0; ) {
+    for (a = myM; a-- > 0; ) {
+      if ((k = tts0[j * myM + a]) > 0) {
+        l = --par_off[k - 1];
+        par_col[l] = j;
+        par_row[l] = a;
+      }
+    }
+  }
+
+  /* Column ordering */
+  size_t *adj_off, *adj, *pos = new size_t[myN];
+  computeAdjacency(myN, myM, tts0, par_off, par_col, &adj_off, &adj);
+  myCol = new size_t[myN];
+  for (j = 0; j < myN; j++) {
+    myCol[j] = pos[j] = j;
+  }
+  myMu = computeBandwidth(myN, adj_off, adj, pos) + 1;
+  if (reorder && myMu > 2) {
+    size_t *order = new size_t[myN], mu;
+    computeRCM(myN, adj_off, adj, order);
+    for (j = 0; j < myN; j++) {
+      pos[order[j]] = j;
+    }
+    if ((mu = computeBandwidth(myN, adj_off, adj, pos) + 1) < myMu) {
+      myMu = mu;
+      memcpy(myCol, order, myN * sizeof(size_t));
+    }
+    delete [] order;
+  }
+  for (j = 0; j < myN; j++) {
+    pos[myCol[j]] = j;
+  }
+
+  /* Possibly nonzero blocks: the diagonal and the adjacent columns */
+  myBOff = new size_t[myN + 1];
+  myBCol = new size_t[myN + adj_off[myN]];
+  for (j = 0, myBOff[0] = 0; j < myN; j++) {
+    size_t c = myCol[j], cnt = myBOff[j];
+    myBCol[cnt++] = j;
+    for (l = adj_off[c]; l < adj_off[c + 1]; l++) {
+      myBCol[cnt++] = pos[adj[l]];
+    }
+    myBOff[j + 1] = cnt;
+    qsort(myBCol + myBOff[j], cnt - myBOff[j], sizeof(size_t), compareSizeT);
+  }
+  delete [] adj_off;
+  delete [] adj;
+
+  myTts = new size_t[myN * myM];
+  for (j = 0; j < myN; j++) {
+    memcpy(myTts + j * myM, tts0 + myCol[j] * myM, myM * sizeof(size_t));
+  }
+  if (s0 != NULL) {
+    myS0 = new double[myN * myM];
+    for (j = 0; j < myN; j++) {
+      for (a = 0; a < myM; a++) {
+        myS0[j * myM + a] = gsl_matrix_get(s0, myCol[j], a);
+      }
+    }
+  }
+  delete [] tts0;
+
+  /* Nonzero elements of V_{ij}: all pairs of occurrences of each parameter */
+  size_t nblocks = myBOff[myN], nv = 0;
+  myVOff = new size_t[nblocks + 1];
+  memset(myVOff, 0, (nblocks + 1) * sizeof(size_t));
+  for (k = 0; k < np; k++) {
+    if (gsl_vector_get(myInvWeights, k) == 0) {
+      continue;
+    }
+    for (l = par_off[k]; l < par_off[k + 1]; l++) {
+      for (l2 = par_off[k]; l2 < par_off[k + 1]; l2++) {
+        myVOff[vBlock(pos[par_col[l]], pos[par_col[l2]]) + 1]++;
+        nv++;
+      }
+    }
+  }
+  for (l = 0; l < nblocks; l++) {
+    myVOff[l + 1] += myVOff[l];
+  }
+  myVRow = new size_t[mymax(nv, 1)];
+  myVCol = new size_t[mymax(nv, 1)];
+  myVVal = new double[mymax(nv, 1)];
+  for (k = 0; k < np; k++) {
+    double invw = gsl_vector_get(myInvWeights, k);
+    if (invw == 0) {
+      continue;
+    }
+    for (l = par_off[k]; l < par_off[k + 1]; l++) {
+      for (l2 = par_off[k]; l2 < par_off[k + 1]; l2++) {
+        size_t ind = myVOff[vBlock(pos[par_col[l]], pos[par_col[l2]])]++;
+        myVRow[ind] = par_row[l];
+        myVCol[ind] = par_row[l2];
+        myVVal[ind] = invw;
+      }
+    }
+  }
+  for (l = nblocks; l > 0; l--) {
+    myVOff[l] = myVOff[l - 1];
+  }
+  myVOff[0] = 0;
+
+  delete [] pos;
+  delete [] par_off;
+  delete [] par_col;
+  delete [] par_row;
+}
+
+SparseAffineStructure::~SparseAffineStructure() {
+  gsl_vector_free(myInvWeights);
+  gsl_vector_free(myInvSqrtWeights);
+  if (myMissing != NULL) {
+    delete [] myMissing;
+  }
+  delete [] myCol;
+  delete [] myTts;
+  if (myS0 != NULL) {
+    delete [] myS0;
+  }
+  delete [] myBOff;
+  delete [] myBCol;
+  delete [] myVOff;
+  delete [] myVRow;
+  delete [] myVCol;
+  delete [] myVVal;
+}
+
+void SparseAffineStructure::computeAdjacency( size_t n, size_t m,
+         const size_t *tts, const size_t *par_off, const size_t *par_col,
+         size_t **adj_off, size_t **adj ) {
+  size_t *mark = new size_t[n], *off = new size_t[n + 1], *ptr = NULL;
+  size_t j, a, l;
+
+  /* The first pass counts the neighbours, the second one stores them */
+  for (int pass = 0; pass < 2; pass++) {
+    for (j = 0; j < n; j++) {
+      mark[j] = n;
+    }
+    for (j = 0, off[0] = 0; j < n; j++) {
+      size_t cnt = 0;
+      mark[j] = j;
+      for (a = 0; a < m; a++) {
+        size_t k = tts[j * m + a];
+        for (l = (k > 0 ? par_off[k - 1] : 0); k > 0 && l < par_off[k]; l++) {
+          if (mark[par_col[l]] != j) {
+            mark[par_col[l]] = j;
+            if (ptr != NULL) {
+              ptr[off[j] + cnt] = par_col[l];
+            }
+            cnt++;
+          }
+        }
+      }
+      off[j + 1] = off[j] + cnt;
+    }
+    if (ptr == NULL) {
+      ptr = new size_t[mymax(off[n], 1)];
+    }
+  }
+  delete [] mark;
+  *adj_off = off;
+  *adj = ptr;
+}
+
+size_t SparseAffineStructure::computeBandwidth( size_t n,
+           const size_t *adj_off, const size_t *adj, const size_t *pos ) {
+  size_t bw = 0;
+  for (size_t j = 0; j < n; j++) {
+    for (size_t l = adj_off[j]; l < adj_off[j + 1]; l++) {
+      size_t diff = (pos[j] > pos[adj[l]] ? pos[j] - pos[adj[l]] :
+                                            pos[adj[l]] - pos[j]);
+      bw = mymax(bw, diff);
+    }
+  }
+  return bw;
+}
+
+void SparseAffineStructure::computeRCM( size_t n, const size_t *adj_off,
+                                        const size_t *adj, size_t *order ) {
+  bool *visited = new bool[n];
+  size_t cnt = 0, head = 0, j, l;
+
+  memset(visited, 0, n * sizeof(bool));
+  while (cnt < n) {
+    /* Start each connected component from a vertex of minimal degree */
+    size_t start = n;
+    for (j = 0; j < n; j++) {
+      if (!visited[j] && (start == n || adj_off[j + 1] - adj_off[j] <
+                                        adj_off[start + 1] - adj_off[start])) {
+        start = j;
+      }
+    }
+    visited[start] = true;
+    order[cnt++] = start;
+
+    /* Breadth-first search, the neighbours are added by increasing degree */
+    for (; head < cnt; head++) {
+      size_t first = cnt;
+      for (l = adj_off[order[head]]; l < adj_off[order[head] + 1]; l++) {
+        if (!visited[adj[l]]) {
+          visited[adj[l]] = true;
+          order[cnt++] = adj[l];
+        }
+      }
+      for (j = first + 1; j < cnt; j++) {
+        size_t v = order[j], deg = adj_off[v + 1] - adj_off[v], i;
+        for (i = j; i > first &&
+                    adj_off[order[i-1] + 1] - adj_off[order[i-1]] > deg; i--) {
+          order[i] = order[i - 1];
+        }
+        order[i] = v;
+      }
+    }
+  }
+  for (j = 0; j < n / 2; j++) {
+    size_t tmp = order[j];
+    order[j] = order[n - 1 - j];
+    order[n - 1 - j] = tmp;
+  }
+  delete [] visited;
+}
+
+void SparseAffineStructure::fillMatrixFromP( gsl_matrix* c, const gsl_vector* p ) {
+  const size_t *tts = myTts;
+  for (size_t j = 0; j < myN; j++, tts += myM) {
+    double *c_row = gsl_matrix_ptr(c, j, 0);
+    for (size_t a = 0; a < myM; a++) {
+      c_row[a] = (myS0 != NULL ? myS0[j * myM + a] : 0) +
+                 (tts[a] > 0 ? gsl_vector_get(p, tts[a] - 1) : 0);
+    }
+  }
+}
+
+void SparseAffineStructure::multByGtUnweighted( gsl_vector* p,
+          const gsl_matrix *Rt, const gsl_vector *y,
+          double alpha, double beta, bool skipFixedBlocks ) {
+  size_t d = Rt->size2;
+  const size_t *tts = myTts;
+  double s;
+
+  gsl_vector_scale(p, beta);
+  for (size_t j = 0; j < myN; j++, tts += myM) {
+    gsl_vector y_j = gsl_vector_const_subvector(y, j * d, d).vector;
+    for (size_t a = 0; a < myM; a++) {
+      if (tts[a] > 0 && !(skipFixedBlocks &&
+                          gsl_vector_get(myInvWeights, tts[a] - 1) == 0.0)) {
+        gsl_vector Rt_row = gsl_matrix_const_row(Rt, a).vector;
+        gsl_blas_ddot(&Rt_row, &y_j, &s);
+        *gsl_vector_ptr(p, tts[a] - 1) += alpha * s;
+      }
+    }
+  }
+}
+
+void SparseAffineStructure::multByWInv( gsl_vector* p, long deg ) const {
+  if (deg == 0) {
+    return;
+  }
+  if (deg == 1) {
+    gsl_vector_mul(p, myInvSqrtWeights);
+  } else if (deg == 2) {
+    gsl_vector_mul(p, myInvWeights);
+  }
+}
+
+size_t SparseAffineStructure::vBlock( size_t i_1, size_t j_1 ) const {
+  if (i_1 >= myN) {
+    return myBOff[myN];
+  }
+  size_t lo = myBOff[i_1], hi = myBOff[i_1 + 1];
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (myBCol[mid] < j_1) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return (lo < myBOff[i_1 + 1] && myBCol[lo] == j_1) ? lo : myBOff[myN];
+}
+
+void SparseAffineStructure::VijB( gsl_matrix *X, long i_1, long j_1,
+         const gsl_matrix *B ) const {
+  gsl_matrix_set_zero(X);
+  size_t b = vBlock(i_1, j_1);
+  if (b == myBOff[myN]) {
+    return;
+  }
+  for (size_t l = myVOff[b]; l < myVOff[b + 1]; l++) {
+    gsl_vector X_row = gsl_matrix_row(X, myVRow[l]).vector;
+    const gsl_vector B_row = gsl_matrix_const_row(B, myVCol[l]).vector;
+    gsl_blas_daxpy(myVVal[l], &B_row, &X_row);
+  }
+}
+
+void SparseAffineStructure::AtVijB( gsl_matrix *X, long i_1, long j_1,
+         const gsl_matrix *A, const gsl_matrix *B, gsl_matrix * /* tmpVijB */,
+         double beta ) const {
+  gsl_matrix_scale(X, beta);
+  size_t b = vBlock(i_1, j_1);
+  if (b == myBOff[myN]) {
+    return;
+  }
+  for (size_t l = myVOff[b]; l < myVOff[b + 1]; l++) {
+    const gsl_vector A_row = gsl_matrix_const_row(A, myVRow[l]).vector;
+    const gsl_vector B_row = gsl_matrix_const_row(B, myVCol[l]).vector;
+    gsl_blas_dger(myVVal[l], &A_row, &B_row, X);
+  }
+}
+
+void SparseAffineStructure::AtVijV( gsl_vector *u, long i_1, long j_1,
+         const gsl_matrix *A, const gsl_vector *v,
+         gsl_vector * /* tmpVijV */, double beta ) const {
+  gsl_vector_scale(u, beta);
+  size_t b = vBlock(i_1, j_1);
+  if (b == myBOff[myN]) {
+    return;
+  }
+  for (size_t l = myVOff[b]; l < myVOff[b + 1]; l++) {
+    const gsl_vector A_row = gsl_matrix_const_row(A, myVRow[l]).vector;
+    gsl_blas_daxpy(myVVal[l] * gsl_vector_get(v, myVCol[l]), &A_row, u);
+  }
+}
+
+Cholesky *SparseAffineStructure::createCholesky( size_t d ) const {
+  if (myHodlrTol > 0) {
+    return new HODLRCholesky(this, d, myHodlrTol);
+  }
+  return new MuDependentCholesky(this, d);
+}
+
+DGamma *SparseAffineStructure::createDGamma( size_t d ) const {
+  return new MuDependentDGamma(this, d);
+}
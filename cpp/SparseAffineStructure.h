@@ -0,0 +1,104 @@
+/** General affine structure with elementwise weights.
+ * The structure is defined by a sparse index map \f$T \in \{0,\ldots,n_p\}^{m \times n}\f$
+ * (the matrix \c tts in \c slra_ext.m) and a constant matrix \f$S_0\f$:
+ * \f[
+ * \mathscr{S}(p)_{ab} = (S_0)_{ab} + \begin{cases} p_{T_{ab}}, & T_{ab} > 0, \\
+ *                                                  0, & T_{ab} = 0, \end{cases}
+ * \f]
+ * with the weights \f$\mathrm{col}(w_1,\ldots,w_{n_p})\f$ (\f$w_k = \infty\f$
+ * corresponds to a fixed parameter).
+ *
+ * For this structure \f$(\mathrm{V}_{\#ij})_{ab} = \sum_k w_k^{-1} [T_{ai} = k] [T_{bj} = k]\f$,
+ * and \f$\mathrm{V}_{\#ij} = 0\f$ if the columns \f$i\f$ and \f$j\f$ have no common
+ * parameters. Hence the structure is \f$\mu\f$-dependent with \f$\mu - 1\f$ equal to
+ * the bandwidth of the column adjacency graph. In order to decrease \f$\mu\f$, the
+ * columns can be reordered by the reverse Cuthill-McKee algorithm \cite cuthill69.
+ * The reordering does not change the cost function and \f$\widehat{p}\f$, since
+ * \f$R \mathscr{S}(p) = 0\f$ if and only if \f$R \mathscr{S}(p) \Pi = 0\f$.
+ * All the matrices of size \f$m \times n\f$ (and vectors \f$y \in \mathbb{R}^{nd}\f$)
+ * are then given in the reordered column order, see getColumn().
+ *
+ * The nonzero elements of \f$\mathrm{V}_{\#ij}\f$ are precomputed for the 
+ * pairs of adjacent columns only, so the memory does not depend on \f$\mu\f$.
+ * If \f$\mu\f$ remains large, the hierarchical factorization HODLRCholesky 
+ * can be used instead of the banded one.
+ */
+class SparseAffineStructure : public MuDependentStructure {
+  size_t myM, myN, myNp, myMu;
+  double myHodlrTol;         /* Tolerance for HODLRCholesky (0 if not used) */
+  size_t *myCol;             /* Original indices of the reordered columns */
+  size_t *myTts;             /* Reordered index map (n x m, 0 or k+1 for p_k) */
+  double *myS0;              /* Reordered constant matrix (n x m), or NULL */
+  gsl_vector *myInvWeights;
+  gsl_vector *myInvSqrtWeights;
+  bool *myMissing;           /* Missing values (NULL if there are none) */
+  /* Possibly nonzero blocks V_{ij}: the columns j (sorted) for the row i
+   * are myBCol[myBOff[i]..myBOff[i+1]-1] */
+  size_t *myBOff, *myBCol;
+  /* Nonzero elements of V_{ij}: (myVRow, myVCol, myVVal), stored for
+   * the block b = vBlock(i,j) from myVOff[b] to myVOff[b+1]-1 */
+  size_t *myVOff, *myVRow, *myVCol;
+  double *myVVal;
+
+  /* Returns the index of the block (i,j), or myBOff[myN] if it is zero */
+  size_t vBlock( size_t i_1, size_t j_1 ) const;
+  /* Computes the column adjacency graph in CSR format: the columns sharing
+   * a parameter with the column j are adj[adj_off[j]..adj_off[j+1]-1] */
+  static void computeAdjacency( size_t n, size_t m, const size_t *tts,
+                                const size_t *par_off, const size_t *par_col,
+                                size_t **adj_off, size_t **adj );
+  static size_t computeBandwidth( size_t n, const size_t *adj_off,
+                                  const size_t *adj, const size_t *pos );
+  static void computeRCM( size_t n, const size_t *adj_off, const size_t *adj,
+                          size_t *order );
+public:
+  /** Constructs SparseAffineStructure object.
+   * @param tts     the transposed index map \f$T^{\top}\f$ (\f$n \times m\f$),
+   *                elements are \f$0\f$ or \f$1\f$-based indices of \f$p\f$
+   * @param np      \f$n_p\f$
+   * @param s0      the transposed matrix \f$S_0^{\top}\f$ (zero if NULL)
+   * @param w_vec   vector of weights \f$\bf w\f$ (all ones if NULL),
+   *                \f$w_k = 0\f$ for the missing values
+   * @param reorder whether to reorder the columns to decrease \f$\mu\f$
+   * @param hodlr_tol if positive, createCholesky() creates HODLRCholesky 
+   *                with this tolerance, otherwise MuDependentCholesky
+   */
+  SparseAffineStructure( const gsl_matrix *tts, size_t np,
+                         const gsl_matrix *s0 = NULL, const double *w_vec = NULL,
+                         bool reorder = true, double hodlr_tol = 0 );
+  virtual ~SparseAffineStructure();
+
+  /** @name Implementing Structure interface */
+  /**@{*/
+  virtual size_t getM() const { return myM; }
+  virtual size_t getN() const { return myN; }
+  virtual size_t getNp() const { return myNp; }
+  virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p );
+  virtual Cholesky *createCholesky( size_t d ) const;
+  virtual DGamma *createDGamma( size_t d ) const;
+  virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
+                                   const gsl_vector *y,
+                                   double alpha = -1, double beta = 1,
+                                   bool skipFixedBlocks = true );
+  virtual void multByWInv( gsl_vector* p, long deg = 2 ) const;
+  virtual bool isMissing( size_t k ) const {
+    return myMissing != NULL && myMissing[k];
+  }
+  /**@}*/
+
+  /** @name Implementing MuDependentStructure interface */
+  /**@{*/
+  virtual size_t getMu() const { return myMu; }
+  virtual void VijB( gsl_matrix *X, long i_1, long j_1,
+                     const gsl_matrix *B ) const;
+  virtual void AtVijB( gsl_matrix *X, long i_1, long j_1,
+                      const gsl_matrix *A, const gsl_matrix *B,
+                      gsl_matrix *tmpVijB, double beta = 0 ) const;
+  virtual void AtVijV( gsl_vector *u, long i_1, long j_1,
+                      const gsl_matrix *A, const gsl_vector *v,
+                      gsl_vector *tmpVijV, double beta = 0 ) const;
+  /**@}*/
+
+  /** Returns the \f$0\f$-based original index of the \f$j_1\f$-th column */
+  size_t getColumn( size_t j_1 ) const { return myCol[j_1]; }
+};
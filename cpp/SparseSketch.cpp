@@ -0,0 +1,53 @@
+#include <math.h>
+#include "slra.h"
+
+#define SLRA_SKETCH_NNZ 8
+
+SparseSketch::SparseSketch( size_t s, size_t n ) : mySize1(s), mySize2(n) {
+  if (s == 0 || s > n) {
+    throw new Exception("SparseSketch: incorrect sketch size.\n");
+  }
+  myNnz = mymin(s, (size_t)SLRA_SKETCH_NNZ);
+  myRows = new size_t[myNnz * n];
+  myVals = new double[myNnz * n];
+
+  /* xorshift64 generator with a fixed seed */
+  unsigned long long state = 88172645463325252ULL;
+  double val = 1 / sqrt((double)myNnz);
+  for (size_t j = 0; j < n; j++) {
+    size_t *rows = myRows + j * myNnz;
+    for (size_t l = 0; l < myNnz; l++) {
+      size_t i, k;
+      do {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        i = (size_t)((state >> 1) % s);
+        for (k = 0; k < l && rows[k] != i; k++) ;
+      } while (k < l);
+      rows[l] = i;
+      myVals[j * myNnz + l] = ((state >> 40) & 1) ? val : -val;
+    }
+  }
+}
+
+SparseSketch::~SparseSketch() {
+  delete [] myRows;
+  delete [] myVals;
+}
+
+void SparseSketch::apply( const gsl_vector *v, gsl_vector *y ) const {
+  const size_t *rows = myRows;
+  const double *vals = myVals;
+
+  gsl_vector_set_zero(y);
+  for (size_t j = 0; j < mySize2; j++, rows += myNnz, vals += myNnz) {
+    double vj = v->data[j * v->stride];
+
+    if (vj != 0) {
+      for (size_t l = 0; l < myNnz; l++) {
+        y->data[rows[l] * y->stride] += vals[l] * vj;
+      }
+    }
+  }
+}
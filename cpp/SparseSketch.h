@@ -0,0 +1,27 @@
+/** Sparse sign embedding (row sketch).
+ * Represents a random matrix \f$S \in \mathbb{R}^{s \times n}\f$ with
+ * \f$k = \min(s, 8)\f$ nonzero elements \f$\pm 1/\sqrt{k}\f$ in each column,
+ * placed in distinct random rows \cite nelson13. For \f$s\f$ sufficiently
+ * larger than the number of columns of \f$J \in \mathbb{R}^{n \times l}\f$,
+ * \f$\|SJx\|_2 \approx \|Jx\|_2\f$ for all \f$x\f$, and \f$Sv\f$ costs
+ * \f$O(kn)\f$ operations.
+ *
+ * The matrix is generated by a fixed pseudo-random sequence, so that
+ * the same \f$S\f$ is applied to the residual and to the Jacobian at all
+ * points.
+ */
+class SparseSketch {
+  size_t mySize1, mySize2, myNnz;
+  size_t *myRows;    /* Row indices of the nonzero elements (myNnz per column) */
+  double *myVals;    /* Values of the nonzero elements */
+public:
+  /** Constructs \f$S \in \mathbb{R}^{s \times n}\f$, \f$0 < s \le n\f$ */
+  SparseSketch( size_t s, size_t n );
+  virtual ~SparseSketch();
+
+  size_t getSize1() const { return mySize1; }
+  size_t getSize2() const { return mySize2; }
+
+  /** Computes \f$y \leftarrow S v\f$ */
+  void apply( const gsl_vector *v, gsl_vector *y ) const;
+};
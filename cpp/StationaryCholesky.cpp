@@ -27,6 +27,13 @@ void StationaryCholesky::computeGammak( const gsl_matrix *Rt, double reg ) {
   gsl_matrix_set_zero(&submat.matrix);
 }
   
+void StationaryCholesky::computeGammaBlock( gsl_matrix *gam, 
+         const gsl_matrix * /* Rt */, size_t i_1, size_t j_1, double /* reg */ ) {
+  gsl_matrix_const_view gam_k = gsl_matrix_const_submatrix(myGammaK, 0, 
+                                    (j_1 - i_1) * getD(), getD(), getD());
+  gsl_matrix_memcpy(gam, &gam_k.matrix);
+}
+  
 void StationaryCholesky::computeGammaUpperTrg( const gsl_matrix *R, double reg ) {
   computeGammak(R, reg);
   
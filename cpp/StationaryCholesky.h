@@ -29,6 +29,14 @@ protected:
   /** Computes all \f$\Gamma_k\f$ and puts them in StationaryCholesky::myGammaK.
    * @copydetails StationaryCholesky::computeGammaUpperTrg */
   virtual void computeGammak( const gsl_matrix *Rt, double reg = 0 );
+
+  /** Computes all \f$\Gamma_k\f$ by computeGammak() */
+  virtual void prepareGammaBlocks( const gsl_matrix *Rt, double reg ) {
+    computeGammak(Rt, reg);
+  }
+  /** Copies \f$\Gamma_{\#ij} = \Gamma_{j-i}\f$ from StationaryCholesky::myGammaK */
+  virtual void computeGammaBlock( gsl_matrix *gam, const gsl_matrix *Rt,
+                                  size_t i_1, size_t j_1, double reg );
 };
 
 
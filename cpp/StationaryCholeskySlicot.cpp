@@ -22,6 +22,7 @@ void StationaryCholeskySlicot::calcGammaCholesky( const gsl_matrix *Rt, double r
   size_t info = 0, d = getD(), n = getN();
   const size_t zero = 0;
 
+  allocPackedCholesky();
   computeGammak(Rt);
   gsl_matrix_vectorize(myGammaVec, myGamma);
     
@@ -50,6 +50,61 @@ void StripedCholesky::multInvCholeskyVector( gsl_vector * y_r, long trans ) {
   }
 }
 
+bool StripedCholesky::calcGammaCholeskyBounded( const gsl_matrix *Rt, 
+         double reg, gsl_vector *y_r, double bound, double *f ) {
+  size_t n_row = 0, k;
+  double f_b;
+  gsl_vector yr_b;
+  /* The factor is shared by several blocks (a single block is bounded 
+   * by its own Cholesky object) */
+  bool isShared = (myNGamma < myStruct->getBlocksN());
+  
+  if (isShared) {
+    myGamma[0]->calcGammaCholesky(Rt, reg);
+  }
+  for (k = 0, *f = 0; k < myStruct->getBlocksN(); 
+                      n_row += myStruct->getBlock(k)->getN(), k++) {
+    yr_b = gsl_vector_subvector(y_r, n_row * myD, 
+                                myStruct->getBlock(k)->getN() * myD).vector;
+    if (isShared) {
+      myGamma[0]->multInvCholeskyVector(&yr_b, 1);
+      gsl_blas_ddot(&yr_b, &yr_b, &f_b);
+    } else if (!myGamma[k]->calcGammaCholeskyBounded(Rt, reg, &yr_b, 
+                                                     bound - *f, &f_b)) {
+      *f += f_b;
+      return false;
+    }
+    if ((*f += f_b) > bound) {
+      return false;
+    }
+  }
+  
+  return true;
+}
+
+bool StripedCholesky::calcFuncStreaming( const gsl_matrix *Rt, double reg,
+         gsl_vector *y_r, double bound, double *f ) {
+  size_t n_row = 0, k;
+  double f_b;
+  gsl_vector yr_b;
+  
+  if (myNGamma < myStruct->getBlocksN()) { 
+    return calcGammaCholeskyBounded(Rt, reg, y_r, bound, f);
+  }
+  for (k = 0, *f = 0; k < myStruct->getBlocksN(); 
+                      n_row += myStruct->getBlock(k)->getN(), k++) {
+    yr_b = gsl_vector_subvector(y_r, n_row * myD, 
+                                myStruct->getBlock(k)->getN() * myD).vector;
+    bool res = myGamma[k]->calcFuncStreaming(Rt, reg, &yr_b, bound - *f, &f_b);
+    *f += f_b;
+    if (!res) {
+      return false;
+    }
+  }
+  
+  return true;
+}
+
 void StripedCholesky::multInvGammaVector( gsl_vector * y_r ) {
   size_t n_row = 0, k;
   gsl_vector yr_b;
@@ -20,6 +20,15 @@ public:
   virtual void calcGammaCholesky( const gsl_matrix *Rt, double reg );
   virtual void multInvCholeskyVector( gsl_vector * yr, long trans );  
   virtual void multInvGammaVector( gsl_vector * yr );                
+  /** Processes the blocks of the stripe one by one, and stops after 
+   * the block at which the partial sum exceeds `bound`. */
+  virtual bool calcGammaCholeskyBounded( const gsl_matrix *Rt, double reg,
+                                         gsl_vector *yr, double bound, 
+                                         double *f );
+  /** Streams the blocks of the stripe one by one. If several blocks share
+   * one factor, it is computed once and stored instead. */
+  virtual bool calcFuncStreaming( const gsl_matrix *Rt, double reg,
+                                  gsl_vector *yr, double bound, double *f );
   /**@}*/
 };
 
@@ -2,8 +2,9 @@
 
 /* Structure striped classes */
 StripedStructure::StripedStructure( size_t blocksN, Structure **stripe, 
-                                    bool isSameGamma  ) :
-    myBlocksN(blocksN), myStripe(stripe), myIsSameGamma(isSameGamma) {
+                                    bool isSameGamma, bool isOwner ) :
+    myBlocksN(blocksN), myStripe(stripe), myIsSameGamma(isSameGamma),
+    myIsOwner(isOwner) {
   size_t l;  
   
   for (l = 0, myN = 0, myNp = 0, myMaxNlInd = 0; l < myBlocksN; 
@@ -17,7 +18,7 @@ StripedStructure::StripedStructure( size_t blocksN, Structure **stripe,
 
 StripedStructure::~StripedStructure()  {
   if (myStripe != NULL) {
-    for (size_t l = 0; l < myBlocksN; l++) {
+    for (size_t l = 0; l < myBlocksN && myIsOwner; l++) {
       if (myStripe[l] != NULL) {
         delete myStripe[l];
       }
@@ -63,6 +64,15 @@ void StripedStructure::multByWInv( gsl_vector* p, long deg ) const {
   }                         
 }
 
+bool StripedStructure::isMissing( size_t k ) const {
+  size_t l;
+
+  for (l = 0; l < getBlocksN() && k >= myStripe[l]->getNp(); l++) {
+    k -= myStripe[l]->getNp();
+  }
+  return l < getBlocksN() && myStripe[l]->isMissing(k);
+}
+
 Cholesky *StripedStructure::createCholesky( size_t d ) const {
   return new StripedCholesky(this, d);
 }
@@ -71,6 +81,29 @@ DGamma *StripedStructure::createDGamma( size_t d ) const {
   return new StripedDGamma(this, d);
 }
 
+Structure *StripedStructure::createBlockSubset( const size_t *blocks, 
+                                               size_t n ) const {
+  Structure **stripe = new Structure*[n];
 
+  for (size_t k = 0; k < n; k++) {
+    stripe[k] = myStripe[blocks[k]];
+  }
+  return new StripedStructure(n, stripe, myIsSameGamma, false);
+}
 
-
+void StripedStructure::getBlockSubsetP( const size_t *blocks, size_t n, 
+         const gsl_vector *p, gsl_vector *p_sub ) const {
+  size_t sum_np = 0, sub_np = 0, l = 0;
+  
+  for (size_t k = 0; k < n; k++) {
+    for (; l < blocks[k]; l++) {
+      sum_np += myStripe[l]->getNp();
+    }
+    gsl_vector_const_view src = gsl_vector_const_subvector(p, sum_np, 
+                                    myStripe[l]->getNp());
+    gsl_vector_view dst = gsl_vector_subvector(p_sub, sub_np, 
+                                    myStripe[l]->getNp());
+    gsl_vector_memcpy(&dst.vector, &src.vector);
+    sub_np += myStripe[l]->getNp();
+  }
+}
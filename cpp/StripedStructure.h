@@ -22,6 +22,7 @@ class StripedStructure : public Structure {
   size_t myNp;
   size_t myMaxNlInd;
   bool myIsSameGamma;
+  bool myIsOwner;
 public:
   /** Constructs StripedStructure from array of Structure  objects.
    * @param blocksN     \f$N\f$ --- number of blocks
@@ -32,9 +33,11 @@ public:
    *     \f$\Gamma_{\mathscr{S}^{(l_{max})}}(R)\f$ (where \f$l_{max}\f$ is defined  
    *     in StripedStructure::getMaxBlock). In this case, memory is saved in 
    *     StripedCholesky and StripedDGamma objects.
+   * @param isOwner     if `isOwner == false`, the Structure objects are
+   *     not destroyed (the array `stripe` is destroyed in any case)
    */
   StripedStructure( size_t blocksN, Structure *stripe[], 
-                    bool isSameGamma = false );
+                    bool isSameGamma = false, bool isOwner = true );
   virtual ~StripedStructure();
 
   /** @name Implementing Structure interface */
@@ -49,8 +52,13 @@ public:
                                    double alpha = -1, double beta = 1,
                                    bool skipFixedBlocks = true ); 
   virtual void multByWInv( gsl_vector* p, long deg = 2 ) const;
+  virtual bool isMissing( size_t k ) const;
   virtual Cholesky *createCholesky( size_t d ) const;
   virtual DGamma *createDGamma( size_t d ) const;
+  virtual size_t getNBlocks() const { return myBlocksN; }
+  virtual Structure *createBlockSubset( const size_t *blocks, size_t n ) const;
+  virtual void getBlockSubsetP( const size_t *blocks, size_t n, 
+                   const gsl_vector *p, gsl_vector *p_sub ) const;
   /**@}*/
   
   /** @name StripedStructure-specific methods */
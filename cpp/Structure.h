@@ -4,9 +4,23 @@
  *    (eq. \f$(\mathscr{S})\f$) in  \cite slra-efficient );
  *  - weight matrix \f$\mathrm{W}: \mathbb{R}^{n_p \times n_p}\f$, 
  *     (eq. \f$(\|\cdot\|^2_{\mathrm{W}})\f$ in \cite slra-efficient ).
+ *
+ * A Structure object can be shared by several VarproFunction objects 
+ * running on different threads (see SLRAObject::multiStart() and
+ * SLRAObject::optimizeAsync()), therefore the methods of the 
+ * implementations should not modify the object: the workspace is 
+ * allocated by the caller (see createWorkspace()), in the Cholesky and 
+ * DGamma objects, or per call.
  */
 class Structure {
 public:
+  /** Workspace of fillMatrixFromP() and multByGtUnweighted() owned by 
+   * one caller, see createWorkspace() */
+  class Workspace {
+  public:
+    virtual ~Workspace() {}
+  };
+
   virtual ~Structure() {}
   virtual size_t getNp() const = 0;     ///< Returns \f$n_p\f$
   virtual size_t getM() const = 0;      ///< Returns \f$m\f$
@@ -37,6 +51,26 @@ public:
                                    double beta = 0,
                                    bool skipFixedBlocks = true ) = 0; 
 
+  /** Creates the workspace of fillMatrixFromP() and multByGtUnweighted(),
+   * which is owned (and deleted) by the caller, e.g. by VarproFunction.
+   * \param[in]      d   rank reduction \f$d = m-r\f$
+   * \return  the workspace, or `NULL` if the structure does not need it
+   */
+  virtual Workspace *createWorkspace( size_t /* d */ ) const { return NULL; }
+  /** fillMatrixFromP() with the workspace created by createWorkspace() */
+  virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p, 
+                                Workspace * /* ws */ ) {
+    fillMatrixFromP(c, p);
+  }
+  /** multByGtUnweighted() with the workspace created by createWorkspace(),
+   * \f$R^{\top}\f$ should have at most \f$d\f$ columns */
+  virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt, 
+                                   const gsl_vector *y, double alpha,
+                                   double beta, bool skipFixedBlocks, 
+                                   Workspace * /* ws */ ) {
+    multByGtUnweighted(p, Rt, y, alpha, beta, skipFixedBlocks);
+  }
+
   /** Multiplies a vector by \f$\mathrm{W}^{-1}\f$ or \f$\mathrm{L}_{\mathrm{W}}^{-\top}\f$.
    * \param[out,in]  p   parameter vector \f$p\in\mathbb{R}^{n_p}\f$
    * \param[in]    deg   `0`, `1`, or  `2`
@@ -50,6 +84,15 @@ public:
    */
   virtual void multByWInv( gsl_vector* p, long deg = 2 ) const = 0;
 
+  /** Checks whether \f$p_k\f$ is a missing value (\f$w_k = 0\f$).
+   * In \f$\mathrm{W}^{-1}\f$, the weight of the missing values is 
+   * replaced by a positive weight (see missingInvWeight()), and 
+   * VarproFunction replaces \f$p_k\f$ by the imputed values, for which 
+   * the cost function is the same as for \f$w_k = 0\f$.
+   * \param[in] k  \f$0\f$-based index of the parameter, \f$0 \le k < n_p\f$
+   */
+  virtual bool isMissing( size_t /* k */ ) const { return false; }
+
   /** Creates Cholesky object for this structure.
    * \param[in]      d   rank reduction \f$d = m-r\f$,
    */
@@ -59,5 +102,29 @@ public:
    * \param[in]      d   rank reduction \f$d = m-r\f$,
    */
   virtual DGamma *createDGamma( size_t d ) const = 0;
+
+  /** Returns the number of independent blocks \f$N\f$.
+   * For a block-separable structure (see StripedStructure), the cost 
+   * function is a sum of \f$N\f$ terms, one per block. */
+  virtual size_t getNBlocks() const { return 1; }
+
+  /** Creates a Structure object for a subset of the blocks.
+   * The created object refers to this structure, and should be destroyed
+   * before it.
+   * \param[in]  blocks  increasing \f$0\f$-based indices of the blocks
+   * \param[in]  n       number of the blocks in the subset
+   * \return  the structure of the subset (`NULL` if not supported)
+   */
+  virtual Structure *createBlockSubset( const size_t * /* blocks */, 
+                                        size_t /* n */ ) const { return NULL; }
+
+  /** Extracts the parameter vector of a subset of the blocks.
+   * \param[in]  blocks  the subset (see createBlockSubset())
+   * \param[in]  n       number of the blocks in the subset
+   * \param[in]  p       parameter vector \f$p\in\mathbb{R}^{n_p}\f$
+   * \param[out] p_sub   parameter vector of the subset
+   */
+  virtual void getBlockSubsetP( const size_t * /* blocks */, size_t /* n */, 
+                   const gsl_vector * /* p */, gsl_vector * /* p_sub */ ) const {}
 };
 
@@ -0,0 +1,285 @@
+#include <memory.h>
+#include "slra.h"
+
+SylvesterStructure::SylvesterStructure( size_t m, const double *n_vec,
+    size_t N, const double *w_vec ) : myBlocksN(N), myM(m), myN(0),
+    myNp(0), myMaxNInd(0), myIsSameW(true) {
+  if (myM < 1 || myBlocksN < 1) {
+    throw new Exception("Incorrect Sylvester structure specification\n");
+  }
+  for (size_t j = 0; j < myBlocksN; j++) {
+    if (n_vec[j] < 1) {
+      throw new Exception("Incorrect Sylvester structure specification\n");
+    }
+    if (w_vec != NULL && !(w_vec[j] > 0 && w_vec[j] < GSL_POSINF)) {
+      throw new Exception("Value of weight not supported: %lf\n", w_vec[j]);
+    }
+  }
+  myNk = new size_t[myBlocksN];
+  myInvW = new double[myBlocksN];
+  for (size_t j = 0; j < myBlocksN; j++) {
+    myNk[j] = n_vec[j];
+    myInvW[j] = (w_vec == NULL ? 1.0 : 1 / w_vec[j]);
+    myN += myNk[j];
+    myNp += myNk[j] + myM - 1;
+    if (myNk[j] > myNk[myMaxNInd]) {
+      myMaxNInd = j;
+    }
+    if (myInvW[j] != myInvW[0]) {
+      myIsSameW = false;
+    }
+  }
+}
+
+SylvesterStructure::~SylvesterStructure() {
+  delete [] myNk;
+  delete [] myInvW;
+}
+
+void SylvesterStructure::autocorr( double *gamma, const double *h,
+                                   const double *g ) const {
+  for (size_t k = 0; k < myM; k++) {
+    gamma[k] = 0;
+    for (size_t a = 0; a + k < myM; a++) {
+      gamma[k] += h[a] * g[a + k];
+    }
+  }
+}
+
+void SylvesterStructure::fillMatrixFromP( gsl_matrix* c, const gsl_vector* p ) {
+  size_t sum_np = 0, sum_n = 0, j, a;
+  gsl_vector psub;
+  gsl_matrix csub;
+
+  for (j = 0; j < myBlocksN; sum_np += myNk[j] + myM - 1, sum_n += myNk[j], j++) {
+    csub = gsl_matrix_submatrix(c, sum_n, 0, myNk[j], myM).matrix;
+    for (a = 0; a < myM; a++) {
+      psub = gsl_vector_const_subvector(p, sum_np + a, myNk[j]).vector;
+      gsl_matrix_set_col(&csub, a, &psub);
+    }
+  }
+}
+
+void SylvesterStructure::multByGtUnweighted( gsl_vector* p,
+         const gsl_matrix *Rt, const gsl_vector *y, double alpha, double beta,
+         bool /* skipFixedBlocks */ ) {
+  size_t sum_np = 0, sum_n = 0, D = Rt->size2, j, i, a, b;
+  double y_ib;
+
+  if (beta == 0) {
+    gsl_vector_set_zero(p);
+  } else if (beta != 1) {
+    gsl_vector_scale(p, beta);
+  }
+  /* p^{(j)}_{i+a} += alpha * sum_b R_{b,a} y_{i,b}: convolution with h */
+  for (j = 0; j < myBlocksN; sum_np += myNk[j] + myM - 1, sum_n += myNk[j], j++) {
+    for (i = 0; i < myNk[j]; i++) {
+      for (b = 0; b < D; b++) {
+        y_ib = alpha * gsl_vector_get(y, (sum_n + i) * D + b);
+        for (a = 0; a < myM; a++) {
+          *gsl_vector_ptr(p, sum_np + i + a) += y_ib * gsl_matrix_get(Rt, a, b);
+        }
+      }
+    }
+  }
+}
+
+void SylvesterStructure::multByWInv( gsl_vector* p, long deg ) const {
+  size_t sum_np = 0, j;
+  gsl_vector psub;
+
+  if (deg == 0 || (myIsSameW && myInvW[0] == 1.0)) {
+    return;
+  }
+  for (j = 0; j < myBlocksN; sum_np += myNk[j] + myM - 1, j++) {
+    psub = gsl_vector_subvector(p, sum_np, myNk[j] + myM - 1).vector;
+    gsl_vector_scale(&psub, (deg == 2) ? myInvW[j] : sqrt(myInvW[j]));
+  }
+}
+
+Cholesky *SylvesterStructure::createCholesky( size_t d ) const {
+  if (d != 1) {
+    throw new Exception("The Sylvester structure supports only rank "
+                        "reduction 1.\n");
+  }
+  return new SylvesterCholesky(this);
+}
+
+DGamma *SylvesterStructure::createDGamma( size_t d ) const {
+  if (d != 1) {
+    throw new Exception("The Sylvester structure supports only rank "
+                        "reduction 1.\n");
+  }
+  return new SylvesterDGamma(this);
+}
+
+SylvesterStructure::SylvesterCholesky::SylvesterCholesky(
+    const SylvesterStructure *s ) : myStruct(s) {
+  myGamma = new double[myStruct->getM()];
+  myH = new double[myStruct->getM()];
+  myBand = new double[myStruct->getM() * myStruct->getN()];
+  myFactorOff = new size_t[myStruct->getBlocksN()];
+  myScale = new double[myStruct->getBlocksN()];
+}
+
+SylvesterStructure::SylvesterCholesky::~SylvesterCholesky() {
+  delete [] myGamma;
+  delete [] myH;
+  delete [] myBand;
+  delete [] myFactorOff;
+  delete [] myScale;
+}
+
+size_t SylvesterStructure::SylvesterCholesky::factorBlock( size_t j,
+           size_t off, double c, double reg ) {
+  size_t m = myStruct->getM(), n = myStruct->getBlockN(j), kd = m - 1,
+         info = 0, i, k;
+
+  /* Upper banded storage of T_n(gamma): column k is (.., gamma_1, gamma_0) */
+  double *ab = myBand + off * m;
+  for (k = 0; k < n; k++) {
+    for (i = 0; i < m; i++) {
+      ab[k * m + kd - i] = (i <= k ? c * myGamma[i] : 0);
+    }
+    ab[k * m + kd] += reg;
+  }
+  dpbtrf_("U", &n, &kd, ab, &m, &info);
+  return info;
+}
+
+size_t SylvesterStructure::SylvesterCholesky::factor( double reg ) {
+  size_t j, info = 0, sum_n = 0;
+
+  if (reg == 0 || myStruct->isSameWeight()) {
+    /* Gamma_j = w_j^{-1} T_{n_j}, a leading submatrix of the largest block */
+    double c = myStruct->isSameWeight() ? myStruct->getInvWeight(0) : 1;
+    info = factorBlock(myStruct->getMaxBlockInd(), 0, c, reg);
+    for (j = 0; j < myStruct->getBlocksN(); j++) {
+      myFactorOff[j] = 0;
+      myScale[j] = sqrt(myStruct->getInvWeight(j) / c);
+    }
+  } else {
+    for (j = 0; j < myStruct->getBlocksN() && !info; 
+         sum_n += myStruct->getBlockN(j), j++) {
+      info = factorBlock(j, sum_n, myStruct->getInvWeight(j), reg);
+      myFactorOff[j] = sum_n;
+      myScale[j] = 1;
+    }
+  }
+  return info;
+}
+
+void SylvesterStructure::SylvesterCholesky::calcGammaCholesky(
+         const gsl_matrix *Rt, double reg ) {
+  if (Rt->size2 != 1) {
+    throw new Exception("The Sylvester structure supports only rank "
+                        "reduction 1.\n");
+  }
+  for (size_t a = 0; a < myStruct->getM(); a++) {
+    myH[a] = gsl_matrix_get(Rt, a, 0);
+  }
+  myStruct->autocorr(myGamma, myH, myH);
+
+  size_t info = factor(0);
+  if (info && reg > 0) {
+    Log::lprintf(Log::LOG_LEVEL_NOTIFY, "Gamma is singular (DPBTRF info = %d), "
+        "adding regularization, reg = %f.\n", info, reg);
+    info = factor(reg);
+  }
+  if (info) {
+    throw new Exception("Gamma is singular (DPBTRF info = %d).\n", info);
+  }
+}
+
+void SylvesterStructure::SylvesterCholesky::multInvCholeskyVector(
+         gsl_vector * y_r, long trans ) {
+  if (y_r->stride != 1) {
+    throw new Exception("Cannot multiply vectors with stride != 1\n");
+  }
+  size_t m = myStruct->getM(), kd = m - 1, one = 1, info, sum_n = 0, j, n;
+
+  for (j = 0; j < myStruct->getBlocksN() && sum_n < y_r->size;
+       sum_n += myStruct->getBlockN(j), j++) {
+    n = mymin(myStruct->getBlockN(j), y_r->size - sum_n);
+    dtbtrs_("U", (trans ? "T" : "N"), "N", &n, &kd, &one, 
+            myBand + myFactorOff[j] * m, &m, y_r->data + sum_n, &n, &info);
+    gsl_vector yr_b = gsl_vector_subvector(y_r, sum_n, n).vector;
+    gsl_vector_scale(&yr_b, 1 / myScale[j]);
+  }
+}
+
+void SylvesterStructure::SylvesterCholesky::multInvGammaVector(
+         gsl_vector * y_r ) {
+  multInvCholeskyVector(y_r, 1);
+  multInvCholeskyVector(y_r, 0);
+}
+
+SylvesterStructure::SylvesterDGamma::SylvesterDGamma(
+    const SylvesterStructure *s ) : myStruct(s) {
+  myCorr = new double[myStruct->getM()];
+  myPhiRow = new double[myStruct->getM()];
+  myH = new double[myStruct->getM()];
+}
+
+SylvesterStructure::SylvesterDGamma::~SylvesterDGamma() {
+  delete [] myCorr;
+  delete [] myPhiRow;
+  delete [] myH;
+}
+
+void SylvesterStructure::SylvesterDGamma::calcYtDgammaY( gsl_matrix *At,
+         const gsl_matrix *Rt, const gsl_matrix *Yt ) {
+  size_t m = myStruct->getM(), sum_n = 0, j, i, t, a;
+  double c_jt;
+
+  /* c_t = sum_j w_j^{-1} sum_i y_i y_{i+t} */
+  memset(myCorr, 0, m * sizeof(double));
+  for (j = 0; j < myStruct->getBlocksN(); sum_n += myStruct->getBlockN(j), j++) {
+    for (t = 0; t < m; t++) {
+      for (i = 0, c_jt = 0; i + t < myStruct->getBlockN(j); i++) {
+        c_jt += gsl_matrix_get(Yt, sum_n + i, 0) *
+                gsl_matrix_get(Yt, sum_n + i + t, 0);
+      }
+      myCorr[t] += myStruct->getInvWeight(j) * c_jt;
+    }
+  }
+  /* A_a = 2 (c_0 h_a + sum_t c_t (h_{a+t} + h_{a-t})) */
+  for (a = 0; a < m; a++) {
+    double A_a = myCorr[0] * gsl_matrix_get(Rt, a, 0);
+    for (t = 1; t < m; t++) {
+      A_a += myCorr[t] * ((a + t < m ? gsl_matrix_get(Rt, a + t, 0) : 0) +
+                          (a >= t ? gsl_matrix_get(Rt, a - t, 0) : 0));
+    }
+    gsl_matrix_set(At, a, 0, 2 * A_a);
+  }
+}
+
+void SylvesterStructure::SylvesterDGamma::calcDijGammaYr( gsl_vector *z,
+         const gsl_matrix *Rt, size_t j_1, size_t /* i_1 */, const gsl_vector *y,
+         const gsl_matrix *Phi ) {
+  size_t m = myStruct->getM(), sum_n = 0, j, n, i, l, a;
+
+  for (a = 0; a < m; a++) {
+    myH[a] = gsl_matrix_get(Rt, a, 0);
+    myPhiRow[a] = (Phi != NULL ? gsl_matrix_get(Phi, j_1, a) : (a == j_1));
+  }
+  /* Derivative of gamma in the direction phi */
+  myStruct->autocorr(myCorr, myH, myPhiRow);
+  for (l = 0; l < m; l++) {
+    for (a = 0; a + l < m; a++) {
+      myCorr[l] += myPhiRow[a] * myH[a + l];
+    }
+  }
+
+  /* z^{(j)} = w_j^{-1} T_{n_j}(dgamma) y^{(j)} */
+  for (j = 0; j < myStruct->getBlocksN(); sum_n += myStruct->getBlockN(j), j++) {
+    n = myStruct->getBlockN(j);
+    for (i = 0; i < n; i++) {
+      double z_i = 0;
+      for (l = (i + 1 > m ? i + 1 - m : 0); l < n && l < i + m; l++) {
+        z_i += myCorr[i > l ? i - l : l - i] * gsl_vector_get(y, sum_n + l);
+      }
+      gsl_vector_set(z, sum_n + i, myStruct->getInvWeight(j) * z_i);
+    }
+  }
+}
@@ -0,0 +1,128 @@
+/** Multiplication-matrix (Sylvester) structure of the approximate GCD problem.
+ * The structure is a mosaic Hankel structure with one layer
+ * \f[
+ *    \mathscr{S}(p) =
+ * \begin{bmatrix}
+ *   \mathscr{H}_{m,n_1} (p^{(1)}) & \cdots & \mathscr{H}_{m,n_N} (p^{(N)})
+ * \end{bmatrix},
+ * \f]
+ * where \f$p^{(j)} \in \mathbb{R}^{m+n_j-1}\f$ are the coefficients of
+ * the polynomials of degrees \f$m+n_j-2\f$, and \f$m = d+1\f$ for the
+ * GCD of degree \f$d\f$. For \f$R = h^{\top} \in \mathbb{R}^{1 \times m}\f$
+ * the blocks \f$R \mathscr{H}_{m,n_j} (p^{(j)})\f$ are the coefficients of
+ * the products of the polynomials by \f$h\f$, and the weights
+ * \f$w_j\f$ are blockwise (one weight per polynomial).
+ *
+ * For the rank reduction \f$1\f$, \f$\Gamma(R)\f$ is block-diagonal
+ * with the blocks \f$w_j^{-1} T_{n_j}(\gamma)\f$, where \f$T_{n_j}(\gamma)\f$
+ * is the \f$n_j \times n_j\f$ banded symmetric Toeplitz matrix with
+ * the first row \f$(\gamma_0,\ldots,\gamma_{m-1},0,\ldots,0)\f$,
+ * \f$\gamma_k = \sum_{a} h_a h_{a+k}\f$. The specialized Cholesky and DGamma
+ * classes compute \f$\gamma\f$ in \f$O(m^2)\f$ and use the fact that
+ * all the blocks are leading submatrices of the largest block, so that
+ * a single banded factorization is needed.
+ */
+class SylvesterStructure : public Structure {
+  size_t myBlocksN;      /* N, number of polynomials */
+  size_t myM;            /* m = d + 1 */
+  size_t *myNk;          /* n_j */
+  size_t myN;            /* n = sum n_j */
+  size_t myNp;
+  size_t myMaxNInd;      /* Index of the block with maximal n_j */
+  double *myInvW;        /* w_j^{-1} */
+  bool myIsSameW;
+
+  /** Computes \f$\gamma_k = \sum_{a} h_a h_{a+k}\f$ (or the same sum for
+   * two different vectors) for \f$k = 0,\ldots,m-1\f$ */
+  void autocorr( double *gamma, const double *h, const double *g ) const;
+public:
+  /** Cholesky class for SylvesterStructure */
+  class SylvesterCholesky : public Cholesky {
+    friend class SylvesterStructure;
+    const SylvesterStructure *myStruct;
+    double *myH;           /* h = R^T */
+    double *myGamma;       /* gamma_0, ..., gamma_{m-1} */
+    double *myBand;        /* Upper banded factors, LDAB = m */
+    size_t *myFactorOff;   /* Column of myBand of the factor used by block j */
+    double *myScale;       /* Factor of block j = myScale[j] * used factor */
+
+    /** Factorizes \f$c T_{n_j}(\gamma) + \mathrm{reg} I\f$
+     * in myBand starting from the column `off` */
+    size_t factorBlock( size_t j, size_t off, double c, double reg );
+    /** Factorizes either the largest block (shared by all the blocks), or
+     * each of the blocks if the weights differ and \f$\mathrm{reg} > 0\f$ */
+    size_t factor( double reg );
+  protected:
+    /** Constructs a Cholesky object for SylvesterStructure.
+     * @param[in] s    Pointer to the corresponding SylvesterStructure. */
+    SylvesterCholesky( const SylvesterStructure *s );
+  public:
+    virtual ~SylvesterCholesky();
+    virtual void calcGammaCholesky( const gsl_matrix *Rt, double reg = 0 );
+    virtual void multInvCholeskyVector( gsl_vector * yr, long trans );
+    virtual void multInvGammaVector( gsl_vector * yr );
+  };
+
+  /** DGamma class for SylvesterStructure */
+  class SylvesterDGamma : public DGamma {
+    friend class SylvesterStructure;
+    const SylvesterStructure *myStruct;
+    double *myCorr;        /* Autocorrelations of y or of dgamma */
+    double *myPhiRow;      /* Row of Phi */
+    double *myH;           /* h = R^T */
+  protected:
+    /** Constructs a DGamma object for SylvesterStructure.
+     * @param[in] s    Pointer to the corresponding SylvesterStructure. */
+    SylvesterDGamma( const SylvesterStructure *s );
+  public:
+    virtual ~SylvesterDGamma();
+    virtual void calcYtDgammaY( gsl_matrix *At, const gsl_matrix *Rt,
+                               const gsl_matrix *Yt );
+    virtual void calcDijGammaYr( gsl_vector *z, const gsl_matrix *Rt,
+                                size_t j_1, size_t i_1, const gsl_vector *y,
+                                const gsl_matrix *Phi = NULL );
+  };
+
+  /** Constructs the SylvesterStructure object.
+   * @param[in] m     number of rows \f$m = d+1\f$
+   * @param[in] n_vec \f$(n_1,\ldots,n_N)\f$, where \f$m+n_j-2\f$ is
+   *                  the degree of the \f$j\f$th polynomial
+   * @param[in] N     number of polynomials \f$N\f$
+   * @param[in] w_vec weights \f$(w_1,\ldots,w_N)\f$,
+   *                  \f$0 < w_j < \infty\f$ (all ones if `w_vec == NULL`)
+   */
+  SylvesterStructure( size_t m, const double *n_vec, size_t N,
+                      const double *w_vec = NULL );
+  virtual ~SylvesterStructure();
+
+  /** @name Implementing Structure interface */
+  /**@{*/
+  virtual size_t getM() const { return myM; }
+  virtual size_t getN() const { return myN; }
+  virtual size_t getNp() const { return myNp; }
+  virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p );
+  virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
+                                   const gsl_vector *y,
+                                   double alpha = -1, double beta = 1,
+                                   bool skipFixedBlocks = true );
+  virtual void multByWInv( gsl_vector* p, long deg = 2 ) const;
+  /** Supports only \f$d = 1\f$ */
+  virtual Cholesky *createCholesky( size_t d ) const;
+  /** Supports only \f$d = 1\f$ */
+  virtual DGamma *createDGamma( size_t d ) const;
+  /**@}*/
+
+  /** @name SylvesterStructure-specific methods */
+  /**@{*/
+  size_t getBlocksN() const { return myBlocksN; } /**< Returns \f$N\f$ */
+  /** Returns \f$n_j\f$
+   * @param[in] j_1 \f$0\f$-based index of the polynomial */
+  size_t getBlockN( size_t j_1 ) const { return myNk[j_1]; }
+  /** Returns \f$w_j^{-1}\f$ @copydetails SylvesterStructure::getBlockN */
+  double getInvWeight( size_t j_1 ) const { return myInvW[j_1]; }
+  /** Returns the index of the block with maximal \f$n_j\f$ */
+  size_t getMaxBlockInd() const { return myMaxNInd; }
+  /** Checks whether all the weights are equal */
+  bool isSameWeight() const { return myIsSameW; }
+  /**@}*/
+};
@@ -0,0 +1,66 @@
+#include <limits>
+#include <memory.h>
+#include <cstdarg>
+#include "slra.h"
+
+TLayeredBlWStructure::TLayeredBlWStructure( const double *m_vec,
+    size_t q, size_t n, const double *w_vec ) : myBase(m_vec, q, n, w_vec) {
+}
+
+void TLayeredBlWStructure::fillMatrixFromP( gsl_matrix* c,
+                                            const gsl_vector* p ) {
+  size_t sum_np = 0, sum_nl = 0, l_1, j;
+  gsl_vector psub;
+
+  for (l_1 = 0; l_1 < getQ(); sum_np += getLayerNp(l_1),
+                              sum_nl += getLayerLag(l_1), ++l_1) {
+    for (j = 0; j < getLayerLag(l_1); ++j) {
+      psub = gsl_vector_const_subvector(p,
+                 sum_np + getLayerLag(l_1) - 1 - j, getN()).vector;
+      gsl_matrix_set_col(c, j + sum_nl, &psub);
+    }
+  }
+}
+
+void TLayeredBlWStructure::multByGtUnweighted( gsl_vector* p,
+          const gsl_matrix *Rt, const gsl_vector *y,
+          double alpha, double beta, bool skipFixedBlocks ) {
+  size_t l_1, j, k, sum_np = 0, sum_nl = 0, D = Rt->size2;
+  gsl_matrix Y = gsl_matrix_const_view_vector(y, getN(), D).matrix;
+  gsl_vector Y_row, Rt_row, psub;
+  double s;
+
+  /* G(R) for the Toeplitz layer equals G(JR) for the Hankel layer:
+   * p_{k + m_l - 1 - j} += alpha * R_{j,:} y_k, without a reversed copy of R
+   * (the structure is shared by the threads of multiStart) */
+  for (l_1 = 0; l_1 < getQ(); sum_np += getLayerNp(l_1),
+                              sum_nl += getLayerLag(l_1), ++l_1) {
+    if (skipFixedBlocks && isLayerExact(l_1)) {
+      continue;
+    }
+    psub = gsl_vector_subvector(p, sum_np, getLayerNp(l_1)).vector;
+    if (beta != 1) {
+      gsl_vector_scale(&psub, beta);
+    }
+    for (k = 0; k < getN(); k++) {
+      Y_row = gsl_matrix_row(&Y, k).vector;
+      for (j = 0; j < getLayerLag(l_1); ++j) {
+        Rt_row = gsl_matrix_const_row(Rt, sum_nl + j).vector;
+        gsl_blas_ddot(&Rt_row, &Y_row, &s);
+        *gsl_vector_ptr(&psub, k + getLayerLag(l_1) - 1 - j) += alpha * s;
+      }
+    }
+  }
+}
+
+Cholesky *TLayeredBlWStructure::createCholesky( size_t d ) const {
+#ifdef USE_SLICOT
+  return new StationaryCholeskySlicot(this, d);
+#else  /* USE_SLICOT */
+  return new StationaryCholesky(this, d);
+#endif /* USE_SLICOT */
+}
+
+DGamma *TLayeredBlWStructure::createDGamma( size_t d ) const {
+  return new StationaryDGamma(this, d);
+}
@@ -0,0 +1,83 @@
+/** Layered Toeplitz structure with blockwise weights.
+ * The layered Toeplitz structure is a layered structure with \f$q\f$
+ * Toeplitz blocks:
+ * \f[ \mathscr{T}_{{\bf m}, n} :=
+ * \begin{bmatrix}
+ * \mathscr{T}_{m_1,n} (p^{(1)}) \\  \vdots \\ \mathscr{T}_{m_q,n} (p^{(q)})
+ * \end{bmatrix}, \quad
+ * \left(\mathscr{T}_{m_l,n} (p^{(l)})\right)_{ij} = p^{(l)}_{j-i+m_l},
+ * \f]
+ * i.e. \f$\mathscr{T}_{m_l,n} (p^{(l)}) = J \mathscr{H}_{m_l,n} (p^{(l)})\f$,
+ * where \f$J\f$ is the \f$m_l \times m_l\f$ exchange matrix. This is the
+ * structure obtained from HLayeredBlWStructure by a permutation \f$\Phi\f$
+ * that reverses the rows of each layer, but no \f$\Phi\f$ is needed.
+ *
+ * The matrices \f$\mathrm{V}_{k}\f$ of the layered Toeplitz structure are
+ * the transposed matrices \f$\mathrm{V}_{k}\f$ of the layered Hankel
+ * structure with the same \f${\bf m}\f$ and blockwise weights,
+ * \f$\mathrm{V}_{k}(\mathscr{T}_{{\bf m}, n}) =
+ *    \mathrm{V}_{-k}(\mathscr{H}_{{\bf m}, n})\f$.
+ */
+class TLayeredBlWStructure : public StationaryStructure {
+  HLayeredBlWStructure myBase;
+public:
+  /** Constructs the TLayeredBlWStructure object.
+   * @copydetails HLayeredBlWStructure::HLayeredBlWStructure */
+  TLayeredBlWStructure( const double *m_vec, size_t q, size_t n,
+                        const double *w_vec = NULL );
+  /** @name Implementing Structure interface */
+  /**@{*/
+  virtual size_t getM() const { return myBase.getM(); }
+  virtual size_t getN() const { return myBase.getN(); }
+  virtual size_t getNp() const { return myBase.getNp(); }
+  virtual Cholesky *createCholesky( size_t d ) const;
+  virtual DGamma *createDGamma( size_t d ) const;
+  virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p );
+  virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
+                                   const gsl_vector *y,
+                                   double alpha = -1, double beta = 1,
+                                   bool skipFixedBlocks = true );
+  virtual void multByWInv( gsl_vector* p, long deg = 2 ) const {
+    myBase.multByWInv(p, deg);
+  }
+  virtual bool isMissing( size_t k ) const { return myBase.isMissing(k); }
+  /**@}*/
+
+  /** @name Implementing StationaryStructure interface */
+  /**@{*/
+  virtual size_t getMu() const { return myBase.getMu(); }
+  virtual void VkB( gsl_matrix *X, long k, const gsl_matrix *B ) const {
+    myBase.VkB(X, -k, B);
+  }
+  virtual void AtVkB( gsl_matrix *X, long k,
+                      const gsl_matrix *A, const gsl_matrix *B,
+                      gsl_matrix *tmpVkB, double beta = 0 ) const {
+    myBase.AtVkB(X, -k, A, B, tmpVkB, beta);
+  }
+  virtual void AtVkV( gsl_vector *u, long k,
+                      const gsl_matrix *A, const gsl_vector *v,
+                      gsl_vector *tmpVkV, double beta = 0 ) const {
+    myBase.AtVkV(u, -k, A, v, tmpVkV, beta);
+  }
+  /**@}*/
+
+  /** @name TLayeredBlWStructure-specific methods */
+  /**@{*/
+  /** @brief @copybrief HLayeredBlWStructure::getQ() */
+  size_t getQ() const { return myBase.getQ(); }
+  /** @brief @copybrief HLayeredBlWStructure::getLayerLag()
+   * @copydetails HLayeredBlWStructure::getLayerLag */
+  size_t getLayerLag( size_t l_1 ) const { return myBase.getLayerLag(l_1); }
+  /** @brief @copybrief HLayeredBlWStructure::getLayerNp()
+   * @copydetails HLayeredBlWStructure::getLayerLag */
+  size_t getLayerNp( size_t l_1 ) const { return myBase.getLayerNp(l_1); }
+  /** @brief @copybrief HLayeredBlWStructure::isLayerExact()
+   * @copydetails HLayeredBlWStructure::getLayerLag */
+  bool isLayerExact( size_t l_1 ) const { return myBase.isLayerExact(l_1); }
+  /** Returns the HLayeredBlWStructure with the same \f${\bf m}\f$,
+   * \f$n\f$ and weights */
+  const HLayeredBlWStructure *getHankel() const { return &myBase; }
+  /**@}*/
+};
+
+
@@ -0,0 +1,116 @@
+#include <limits>
+#include <memory.h>
+#include <math.h>
+extern "C" {
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_math.h>
+}
+#include "slra.h"
+
+TLayeredElWStructure::TLayeredElWStructure( const double *m_vec, size_t q,
+    size_t n, const double *w_vec ) : myBase(m_vec, q, n, NULL) {
+  double missing_inv_w = missingInvWeight(w_vec, myBase.getNp());
+
+  myInvWeights = gsl_vector_alloc(myBase.getNp());
+  myInvSqrtWeights = gsl_vector_alloc(myBase.getNp());
+  myMissing = NULL;
+  for (size_t l = 0; l < myInvWeights->size; l++) {
+    if (w_vec[l] == 0) {
+      if (myMissing == NULL) {
+        myMissing = new bool[myInvWeights->size];
+        memset(myMissing, 0, myInvWeights->size * sizeof(bool));
+      }
+      myMissing[l] = true;
+      gsl_vector_set(myInvWeights, l, missing_inv_w);
+    } else {
+      gsl_vector_set(myInvWeights, l, (1 / w_vec[l]));
+    }
+    gsl_vector_set(myInvSqrtWeights, l, sqrt(gsl_vector_get(myInvWeights, l)));
+  }
+}
+
+TLayeredElWStructure::~TLayeredElWStructure() {
+  gsl_vector_free(myInvWeights);
+  gsl_vector_free(myInvSqrtWeights);
+  if (myMissing != NULL) {
+    delete [] myMissing;
+  }
+}
+
+void TLayeredElWStructure::multByWInv( gsl_vector* p, long deg ) const {
+  if (deg == 0) {
+    return;
+  }
+  if (deg == 1) {
+    gsl_vector_mul(p, myInvSqrtWeights);
+  } else if (deg == 2) {
+    gsl_vector_mul(p, myInvWeights);
+  }
+}
+
+void TLayeredElWStructure::VijB( gsl_matrix *X, long i_1, long j_1,
+         const gsl_matrix *B ) const {
+  size_t sum_np, sum_ml, l, k, mn = mymin(i_1, j_1);
+  size_t diff = (j_1 >= i_1 ? j_1 - i_1 : i_1 - j_1);
+
+  gsl_matrix_set_zero(X);
+  for (l = 0, sum_np = 0, sum_ml = 0; l < getQ();
+       sum_np += getLayerNp(l), sum_ml += getLayerLag(l), ++l) {
+    for (k = 0; k + diff < getLayerLag(l); ++k) {
+      gsl_vector X_row = gsl_matrix_row(X, sum_ml + i_1 - mn + k).vector;
+      const gsl_vector B_row =
+          gsl_matrix_const_row(B, sum_ml + j_1 - mn + k).vector;
+      gsl_blas_daxpy(getInvWeight(sum_np + mn + getLayerLag(l) - 1 - k),
+                     &B_row, &X_row);
+    }
+  }
+}
+
+void TLayeredElWStructure::AtVijB( gsl_matrix *X, long i_1, long j_1,
+         const gsl_matrix *A, const gsl_matrix *B, gsl_matrix * /* tmpVijB */,
+         double beta ) const {
+  size_t sum_np, sum_ml, l, k, mn = mymin(i_1, j_1);
+  size_t diff = (j_1 >= i_1 ? j_1 - i_1 : i_1 - j_1);
+
+  gsl_matrix_scale(X, beta);
+  for (l = 0, sum_np = 0, sum_ml = 0; l < getQ();
+       sum_np += getLayerNp(l), sum_ml += getLayerLag(l), ++l) {
+    for (k = 0; k + diff < getLayerLag(l); ++k) {
+      const gsl_vector A_row =
+          gsl_matrix_const_row(A, sum_ml + i_1 - mn + k).vector;
+      const gsl_vector B_row =
+          gsl_matrix_const_row(B, sum_ml + j_1 - mn + k).vector;
+      gsl_blas_dger(getInvWeight(sum_np + mn + getLayerLag(l) - 1 - k),
+                    &A_row, &B_row, X);
+    }
+  }
+}
+
+void TLayeredElWStructure::AtVijV( gsl_vector *u, long i_1, long j_1,
+         const gsl_matrix *A, const gsl_vector *v,
+         gsl_vector * /* tmpVijV */, double beta ) const {
+  size_t sum_np, sum_ml, l, k, mn = mymin(i_1, j_1);
+  size_t diff = (j_1 >= i_1 ? j_1 - i_1 : i_1 - j_1);
+
+  gsl_vector_scale(u, beta);
+  for (l = 0, sum_np = 0, sum_ml = 0; l < getQ();
+       sum_np += getLayerNp(l), sum_ml += getLayerLag(l), ++l) {
+    for (k = 0; k + diff < getLayerLag(l); ++k) {
+      const gsl_vector A_row =
+          gsl_matrix_const_row(A, sum_ml + i_1 - mn + k).vector;
+      gsl_blas_daxpy(getInvWeight(sum_np + mn + getLayerLag(l) - 1 - k) *
+                     gsl_vector_get(v, sum_ml + j_1 - mn + k), &A_row, u);
+    }
+  }
+}
+
+Cholesky *TLayeredElWStructure::createCholesky( size_t d ) const {
+  return new MuDependentCholesky(this, d);
+}
+
+DGamma *TLayeredElWStructure::createDGamma( size_t d ) const {
+  return new MuDependentDGamma(this, d);
+}
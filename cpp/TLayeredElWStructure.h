@@ -0,0 +1,81 @@
+/** Layered Toeplitz structure with elementwise weights.
+ * The layered Toeplitz structure \f$\mathscr{T}_{{\bf m}, n}\f$
+ * is defined in description of TLayeredBlWStructure, the elementwise
+ * weights are as in HLayeredElWStructure.
+ *
+ * For the \f$l\f$-th layer, the nonzero elements of
+ * \f$\mathrm{V}_{\#ij}\f$ are
+ * \f$(\mathrm{V}_{\#ij})_{a+i-\min(i,j),\,a+j-\min(i,j)} =
+ *    w^{-1}_{\min(i,j)+m_l-a}\f$, \f$1 \le a \le m_l - |i-j|\f$
+ * (the indices are local for the layer).
+ */
+class TLayeredElWStructure : public MuDependentStructure {
+  TLayeredBlWStructure myBase;
+  gsl_vector *myInvWeights;
+  gsl_vector *myInvSqrtWeights;
+  bool *myMissing;        /* Missing values (NULL if there are none) */
+public:
+  /** Constructs TLayeredElWStructure object.
+   * @param m_vec \f${\bf m} = \begin{bmatrix}m_1 & \cdots & m_q\end{bmatrix}^{\top}\f$
+   * @param w_vec vector of weights
+   * \f${\bf w} =\begin{bmatrix} w_1 & \cdots & w_{n_p} \end{bmatrix}^{\top}\f$,
+   * \f$w_k = 0\f$ for the missing values (see Structure::isMissing()).
+   */
+  TLayeredElWStructure( const double *m_vec, size_t q, size_t n,
+                        const double *w_vec );
+  virtual ~TLayeredElWStructure();
+
+  /** @name Implementing Structure interface */
+  /**@{*/
+  virtual size_t getM() const { return myBase.getM(); }
+  virtual size_t getN() const { return myBase.getN(); }
+  virtual size_t getNp() const { return myBase.getNp(); }
+  virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p ) {
+    myBase.fillMatrixFromP(c, p);
+  }
+  virtual Cholesky *createCholesky( size_t d ) const;
+  virtual DGamma *createDGamma( size_t d ) const;
+  virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt,
+                                   const gsl_vector *y,
+                                   double alpha = -1, double beta = 1,
+                                   bool skipFixedBlocks = true ) {
+    myBase.multByGtUnweighted(p, Rt, y, alpha, beta, skipFixedBlocks);
+  }
+  virtual void multByWInv( gsl_vector* p, long deg = 2 ) const;
+  virtual bool isMissing( size_t k ) const {
+    return myMissing != NULL && myMissing[k];
+  }
+  /**@}*/
+
+  /** @name Implementing MuDependentStructure interface */
+  /**@{*/
+  virtual size_t getMu() const { return myBase.getMu(); }
+  virtual void VijB( gsl_matrix *X, long i_1, long j_1,
+                     const gsl_matrix *B ) const;
+  virtual void AtVijB( gsl_matrix *X, long i_1, long j_1,
+                      const gsl_matrix *A, const gsl_matrix *B,
+                      gsl_matrix *tmpVijB, double beta = 0 ) const;
+  virtual void AtVijV( gsl_vector *u, long i_1, long j_1,
+                      const gsl_matrix *A, const gsl_vector *v,
+                      gsl_vector *tmpVijV, double beta = 0 ) const;
+  /**@}*/
+
+  /** @name TLayeredElWStructure-specific methods */
+  /**@{*/
+  /** @brief @copybrief HLayeredBlWStructure::getQ() */
+  size_t getQ() const { return myBase.getQ(); }
+  /** @brief @copybrief HLayeredBlWStructure::getLayerLag()
+   * @copydetails HLayeredBlWStructure::getLayerLag */
+  size_t getLayerLag( size_t l_1 ) const { return myBase.getLayerLag(l_1); }
+  /** @brief @copybrief HLayeredBlWStructure::getLayerNp()
+   * @copydetails HLayeredBlWStructure::getLayerLag */
+  size_t getLayerNp( size_t l_1 ) const { return myBase.getLayerNp(l_1); }
+  /** @brief @copybrief HLayeredElWStructure::getInvWeight()
+   * @copydetails HLayeredElWStructure::getInvWeight */
+  double getInvWeight( size_t i_1 ) const {
+    return gsl_vector_get(myInvWeights, i_1);
+  }
+  /**@}*/
+};
+
+
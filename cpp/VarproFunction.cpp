@@ -4,8 +4,18 @@
 #include "slra.h"
 
 VarproFunction::VarproFunction( const gsl_vector *p, Structure *s, size_t d, 
-                    gsl_matrix *Phi, bool isGCD ) : myP(NULL), myD(d), myStruct(s), 
-                         myReggamma(SLRA_DEF_reggamma), myIsGCD(isGCD) {
+                    gsl_matrix *Phi, bool isGCD ) : myStruct(s), myD(d),
+                         myStructWs(NULL),
+                         myReggamma(SLRA_DEF_reggamma), myIsGCD(isGCD),
+                         myGamRt(NULL), myGamReg(0), myGamValid(false),
+                         myP(NULL), mySketch(NULL), mySample(NULL),
+                         mySampleS(NULL), mySampleScale(1), myMissing(NULL),
+                         myNMissing(0), myMissingTol(SLRA_DEF_tol_m),
+                         myPImp(NULL), myGm(NULL), myGmTau(NULL), 
+                         myGmWork(NULL), myGmPerm(NULL),
+                         myFree(NULL), myNFree(0),
+                         myGcdA(NULL), myGcdB(NULL), myGcdH(NULL), myGcdMatr(NULL),
+                         myGcdLambda(NULL), myGcdGrad(NULL), myGcdWork(NULL) {
   if (myStruct->getNp() > p->size) {
     throw new Exception("Inconsistent parameter vector\n");
   }
@@ -30,9 +40,45 @@ VarproFunction::VarproFunction( const gsl_vector *p, Structure *s, size_t d,
 
   myP = gsl_vector_alloc(p->size);
   gsl_vector_memcpy(myP, p);
+  for (size_t k = 0; k < myStruct->getNp(); k++) {
+    if (myStruct->isMissing(k)) {
+      myNMissing++;
+    }
+  }
+  if (myNMissing > 0) {
+    if (myIsGCD) {
+      gsl_vector_free(myP);
+      throw new Exception("Missing values are not supported in the GCD mode\n");
+    }
+    /* The missing values are not used */
+    myMissing = new size_t[myNMissing];
+    for (size_t k = 0, l = 0; k < myStruct->getNp(); k++) {
+      if (myStruct->isMissing(k)) {
+        myMissing[l++] = k;
+        gsl_vector_set(myP, k, 0);
+      }
+    }
+    size_t minus1 = -1, info = 0, one = 1;
+    double tmp, tmp2;
+
+    myPImp = gsl_vector_alloc(p->size);
+    gsl_vector_memcpy(myPImp, myP);
+    myGm = gsl_matrix_alloc(myNMissing, myStruct->getN() * getD());
+    myGmTau = gsl_vector_alloc(mymin(myGm->size1, myGm->size2));
+    myGmPerm = new size_t[myNMissing];
+    /* Determine optimal work */
+    dgeqp3_(&myGm->size2, &myGm->size1, myGm->data, &myGm->tda, myGmPerm,
+            myGmTau->data, &tmp, &minus1, &info);
+    dormqr_("L", "T", &myGm->size2, &one, &myGmTau->size, myGm->data,
+            &myGm->tda, myGmTau->data, myGm->data, &myGm->size2, &tmp2,
+            &minus1, &info);
+    myGmWork = gsl_vector_alloc(mymax(tmp, tmp2));
+  }
   myPhiPermCol = gsl_vector_alloc(getM());
+  myStructWs = myStruct->createWorkspace(getD());
   myGam = myStruct->createCholesky(getD());
   myDeriv = myStruct->createDGamma(getD());
+  myGamRt = gsl_matrix_alloc(getM(), getD());
   myMatr = gsl_matrix_alloc(myStruct->getN(), myStruct->getM());
   myTmpGradR = gsl_matrix_alloc(getM(), getD());
   myTmpGradR2 = gsl_matrix_alloc(getNrow(), getD());
@@ -44,19 +90,66 @@ VarproFunction::VarproFunction( const gsl_vector *p, Structure *s, size_t d,
   myTmpEye = gsl_matrix_alloc(getNrow(), getNrow());
   gsl_matrix_set_identity(myTmpEye);
   myTmpCorr = gsl_vector_alloc(myStruct->getNp());
+
+  /* The correction is zero for the fixed parameters, which are excluded */
+  gsl_vector_set_all(myTmpCorr, 1);
+  myStruct->multByWInv(myTmpCorr, 2);
+  for (size_t k = 0; k < myStruct->getNp(); k++) {
+    if (gsl_vector_get(myTmpCorr, k) != 0.0) {
+      myNFree++;
+    }
+  }
+  if (myNFree < myStruct->getNp()) {
+    myFree = new size_t[myNFree];
+    for (size_t k = 0, l = 0; k < myStruct->getNp(); k++) {
+      if (gsl_vector_get(myTmpCorr, k) != 0.0) {
+        myFree[l++] = k;
+      }
+    }
+  }
+  if (myIsGCD) {
+    myGcdA = gsl_matrix_alloc(myStruct->getNp(), getNrow() * getD());
+    myGcdB = gsl_matrix_alloc(myStruct->getN() * getD(), getNrow() * getD());
+    myGcdH = gsl_matrix_alloc(getNrow() * getD(), getNrow() * getD());
+    myGcdMatr = gsl_matrix_alloc(myStruct->getN(), myStruct->getM());
+    myGcdLambda = gsl_vector_alloc(getNrow() * getD());
+    myGcdGrad = gsl_vector_alloc(getNrow() * getD());
+    myGcdWork = new double[(myGcdLwork = 3 * getNrow() * getD())];
+  }
+  fillMatr();
+}
+
+void VarproFunction::fillMatr() {
   if (myIsGCD) {
     gsl_vector_memcpy(myTmpCorr, getP());
     myStruct->multByWInv(myTmpCorr, 1);
-    myStruct->fillMatrixFromP(myMatr, myTmpCorr);
+    myStruct->fillMatrixFromP(myMatr, myTmpCorr, myStructWs);
     gsl_blas_ddot(myTmpCorr, myTmpCorr, &myPWnorm2);
   } else {
-    myStruct->fillMatrixFromP(myMatr, getP());
+    myStruct->fillMatrixFromP(myMatr, getP(), myStructWs);
+  }
+}
+
+void VarproFunction::setP( const gsl_vector *p ) {
+  if (p->size != myP->size) {
+    throw new Exception("Inconsistent parameter vector\n");
+  }
+  gsl_vector_memcpy(myP, p);
+  for (size_t l = 0; l < myNMissing; l++) {
+    gsl_vector_set(myP, myMissing[l], 0);
   }
+  fillMatr();
+  setBlockSample(NULL, 0);
+  myGamValid = false;
 }
   
 VarproFunction::~VarproFunction() {
   delete myGam;
   delete myDeriv;
+  if (myStructWs != NULL) {
+    delete myStructWs;
+  }
+  gsl_matrix_free(myGamRt);
   gsl_vector_free(myP);
   gsl_vector_free(myPhiPermCol);
   gsl_matrix_free(myMatr);
@@ -69,15 +162,127 @@ VarproFunction::~VarproFunction() {
   gsl_matrix_free(myTmpEye);
   gsl_vector_free(myTmpJacobianCol);
   gsl_vector_free(myTmpCorr);
+  gsl_matrix_free_ifnull(myGcdA);
+  gsl_matrix_free_ifnull(myGcdB);
+  gsl_matrix_free_ifnull(myGcdH);
+  gsl_matrix_free_ifnull(myGcdMatr);
+  gsl_vector_free_ifnull(myGcdLambda);
+  gsl_vector_free_ifnull(myGcdGrad);
+  if (myGcdWork != NULL) {
+    delete [] myGcdWork;
+  }
+  if (mySketch != NULL) {
+    delete mySketch;
+  }
+  if (myMissing != NULL) {
+    delete [] myMissing;
+    delete [] myGmPerm;
+  }
+  gsl_vector_free_ifnull(myPImp);
+  gsl_matrix_free_ifnull(myGm);
+  gsl_vector_free_ifnull(myGmTau);
+  gsl_vector_free_ifnull(myGmWork);
+  if (myFree != NULL) {
+    delete [] myFree;
+  }
+  setBlockSample(NULL, 0);
+}
+
+static bool isEqual( const gsl_matrix *A, const gsl_matrix *B ) {
+  if (A->size1 != B->size1 || A->size2 != B->size2) {
+    return false;
+  }
+  for (size_t i = 0; i < A->size1; i++) {
+    if (memcmp(gsl_matrix_const_ptr(A, i, 0), gsl_matrix_const_ptr(B, i, 0),
+               A->size2 * sizeof(double))) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void VarproFunction::computeGammaSr( const gsl_matrix *Rt,
                                     gsl_vector *Sr, bool regularize_gamma ) {
-  myGam->calcGammaCholesky(Rt, regularize_gamma ? myReggamma : 0);
+  double reg = regularize_gamma ? myReggamma : 0;
   gsl_matrix SrMat = gsl_matrix_view_vector(Sr, getN(), getD()).matrix;
+  if (!(myGamValid && myGamReg == reg && isEqual(myGamRt, Rt))) {
+    myGamValid = false;
+    myGam->calcGammaCholesky(Rt, reg);
+    gsl_matrix_memcpy(myGamRt, Rt);
+    myGamReg = reg;
+    if (myNMissing > 0) {
+      imputeMissing(Rt);
+    }
+    myGamValid = true;
+  }
   gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myMatr, Rt, 0, &SrMat);
 } 
 
+void VarproFunction::setMissingTol( double tol_m ) {
+  if (myNMissing > 0 && tol_m != myMissingTol) {
+    myGamValid = false; /* The imputed values depend on the tolerance */
+  }
+  myMissingTol = tol_m;
+}
+
+void VarproFunction::imputeMissing( const gsl_matrix *Rt ) {
+  size_t nd = getN() * getD(), one = 1, info = 0, rank, l;
+  gsl_matrix SrMat = gsl_matrix_view_vector(myTmpJacobianCol, 
+                                            getN(), getD()).matrix;
+  gsl_matrix S0Mat = gsl_matrix_view_vector(myTmpYr, getN(), getD()).matrix;
+  double threshold;
+
+  /* b = L^{-1} s_0 for p_m = 0 */
+  myStruct->fillMatrixFromP(myMatr, myP, myStructWs);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myMatr, Rt, 0, &SrMat);
+  myGam->multInvCholeskyVector(myTmpJacobianCol, 1);
+
+  /* Rows of myGm: L^{-1} G e_k = L^{-1} (S(e_k) - S(0)) R, k missing */
+  gsl_vector_set_zero(myPImp);
+  myStruct->fillMatrixFromP(myMatr, myPImp, myStructWs);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myMatr, Rt, 0, &S0Mat);
+  for (l = 0; l < myNMissing; l++) {
+    gsl_vector gm_row = gsl_matrix_row(myGm, l).vector;
+    gsl_matrix GmMat = gsl_matrix_view_vector(&gm_row, getN(), getD()).matrix;
+
+    gsl_vector_set(myPImp, myMissing[l], 1);
+    myStruct->fillMatrixFromP(myMatr, myPImp, myStructWs);
+    gsl_vector_set(myPImp, myMissing[l], 0);
+    gsl_matrix_memcpy(&GmMat, &S0Mat);
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myMatr, Rt, -1, &GmMat);
+    myGam->multInvCholeskyVector(&gm_row, 1);
+  }
+
+  /* min ||b + A p_m||: A P = Q R, the rows of myGm are the columns of A */
+  for (l = 0; l < myNMissing; l++) {
+    myGmPerm[l] = 0; /* All columns are free */
+  }
+  dgeqp3_(&myGm->size2, &myGm->size1, myGm->data, &myGm->tda, myGmPerm,
+          myGmTau->data, myGmWork->data, &myGmWork->size, &info);
+  dormqr_("L", "T", &myGm->size2, &one, &myGmTau->size, myGm->data, 
+          &myGm->tda, myGmTau->data, myTmpJacobianCol->data, &nd,
+          myGmWork->data, &myGmWork->size, &info);
+  if (info != 0) {
+    throw new Exception("Error in the elimination of the missing values.\n");
+  }
+  threshold = fabs(gsl_matrix_get(myGm, 0, 0)) * myMissingTol;
+  for (rank = 0; rank < myGmTau->size && 
+                 fabs(gsl_matrix_get(myGm, rank, rank)) > threshold; rank++) {
+  }
+  if (rank > 0) {
+    dtrtrs_("U", "N", "N", &rank, &one, myGm->data, &myGm->tda, 
+            myTmpJacobianCol->data, &nd, &info);
+  }
+
+  /* The basic solution: zero for the columns beyond the rank */
+  gsl_vector_memcpy(myPImp, myP);
+  for (l = 0; l < rank; l++) {
+    gsl_vector_set(myPImp, myMissing[myGmPerm[l] - 1], 
+                   -gsl_vector_get(myTmpJacobianCol, l));
+  }
+  myStruct->fillMatrixFromP(myMatr, myPImp, myStructWs);
+}
+
 void VarproFunction::fillZmatTmpJac( gsl_matrix *Zmatr, const gsl_vector* y,
                                      const gsl_matrix *Rt, double factor,
                                      int mult_gam ) {
@@ -114,6 +319,14 @@ void VarproFunction::setPhiPermCol( size_t i, const gsl_matrix *perm,
   }  
 }
 
+void VarproFunction::setTmpGradRFromPsiCol( const gsl_vector *PsiCol ) {
+  for (size_t i = 0; i < getNrow(); i++) {
+    for (size_t j = 0; j < getD(); j++) {
+      gsl_matrix_set(myTmpGradR, i, j, gsl_vector_get(PsiCol, i * getD() + j));
+    }
+  }
+}
+
 void VarproFunction::mulZmatPerm( gsl_vector* res, const gsl_matrix *Zmatr,
          const gsl_matrix *PsiT, size_t j_1, size_t i_1 ) {
   gsl_matrix subJ =
@@ -156,18 +369,20 @@ void VarproFunction::computeJacobianOfCorrection( const gsl_vector* yr,
         /* Compute first term (correction of Gam^{-1} z_{ij}) */
         gsl_vector_set_zero(myTmpCorr);
         mulZmatPerm(myTmpJacobianCol, myTmpJac, PsiT, j_1, i_1);
-        myStruct->multByGtUnweighted(myTmpCorr, Rt, myTmpJacobianCol, -1, 1);
+        myStruct->multByGtUnweighted(myTmpCorr, Rt, myTmpJacobianCol, -1, 1,
+                                     true, myStructWs);
 
         /* Compute second term (gamma * dG_{ij} * yr) */
         gsl_matrix_set_zero(myTmpGradR);
         setPhiPermCol(j_1, PsiT, myPhiPermCol);
         gsl_matrix_set_col(myTmpGradR, i_1, myPhiPermCol);
-        myStruct->multByGtUnweighted(myTmpCorr, myTmpGradR, yr, -1, 1);
+        myStruct->multByGtUnweighted(myTmpCorr, myTmpGradR, yr, -1, 1,
+                                     true, myStructWs);
 
         myStruct->multByWInv(myTmpCorr, 1);
 
         gsl_vector jac_col = gsl_matrix_column(jac, j_1 * getD() + i_1).vector;
-        gsl_vector_memcpy(&jac_col, myTmpCorr);
+        compressCorrection(myTmpCorr, &jac_col);
       }
     }
   } else {
@@ -177,23 +392,111 @@ void VarproFunction::computeJacobianOfCorrection( const gsl_vector* yr,
       /* Compute first term (correction of Gam^{-1} z_{ij}) */
       gsl_vector_set_zero(myTmpCorr);
       gsl_blas_dgemv(CblasTrans, 1.0, myTmpJac, &PsiRow, 0.0, myTmpJacobianCol);
-      myStruct->multByGtUnweighted(myTmpCorr, Rt, myTmpJacobianCol, -1, 1);
+      myStruct->multByGtUnweighted(myTmpCorr, Rt, myTmpJacobianCol, -1, 1,
+                                   true, myStructWs);
 
       /* Compute second term (gamma * dG_{ij} * yr) */
-      //TODO: relies on the fact that tda = size2
-      gsl_vector GradVec = gsl_vector_view_array(myTmpGradR->data,
-                                myTmpGradR->size1 * myTmpGradR->tda).vector;
-      gsl_vector_memcpy(&GradVec, &PsiRow);
-      myStruct->multByGtUnweighted(myTmpCorr, myTmpGradR, yr, -1, 1);
+      setTmpGradRFromPsiCol(&PsiRow);
+      myStruct->multByGtUnweighted(myTmpCorr, myTmpGradR, yr, -1, 1,
+                                   true, myStructWs);
       
       myStruct->multByWInv(myTmpCorr, 1);
       
       gsl_vector jac_col = gsl_matrix_column(jac, i).vector;
-      gsl_vector_memcpy(&jac_col, myTmpCorr);
+      compressCorrection(myTmpCorr, &jac_col);
     }
   }
 }
 
+void VarproFunction::computePseudoJacobianLsGCD( const gsl_vector* yr, 
+         const gsl_matrix *Rt, const gsl_matrix *PsiT, double f,
+         gsl_vector *res, gsl_matrix *jac ) {
+  bool smallPsi = (PsiT == NULL || PsiT->size1 == getNrow());
+  size_t nrow = PsiT != NULL ? PsiT->size2 : getNrow();
+  size_t nvar = smallPsi ? nrow * getD() : PsiT->size2, info = 0;
+  gsl_matrix A = gsl_matrix_submatrix(myGcdA, 0, 0, getNp(), nvar).matrix;
+  gsl_matrix B = gsl_matrix_submatrix(myGcdB, 0, 0, getN() * getD(), nvar).matrix;
+  gsl_matrix H = gsl_matrix_submatrix(myGcdH, 0, 0, nvar, nvar).matrix;
+  gsl_matrix SrMat = gsl_matrix_view_vector(myTmpJacobianCol, getN(), getD()).matrix;
+
+  for (size_t k = 0; k < nvar; k++) {
+    /* Fill dR / dx_k */
+    if (smallPsi) {
+      gsl_matrix_set_zero(myTmpGradR);
+      setPhiPermCol(k / getD(), PsiT, myPhiPermCol);
+      gsl_matrix_set_col(myTmpGradR, k % getD(), myPhiPermCol);
+    } else {
+      gsl_vector PsiRow = gsl_matrix_const_column(PsiT, k).vector;
+      setTmpGradRFromPsiCol(&PsiRow);
+    }
+    /* A_k = L_W^{-T} dG_k^T y */
+    gsl_vector_set_zero(myTmpCorr);
+    myStruct->multByGtUnweighted(myTmpCorr, myTmpGradR, yr, 1, 1,
+                                 true, myStructWs);
+    myStruct->multByWInv(myTmpCorr, 1);
+    gsl_matrix_set_col(&A, k, myTmpCorr);
+    /* B_k = L_Gamma^{-T} G W^{-1/2} A_k */
+    myStruct->multByWInv(myTmpCorr, 1);
+    myStruct->fillMatrixFromP(myGcdMatr, myTmpCorr, myStructWs);
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myGcdMatr, Rt, 0, &SrMat);
+    myGam->multInvCholeskyVector(myTmpJacobianCol, 1);
+    gsl_matrix_set_col(&B, k, myTmpJacobianCol);
+    /* H_{k,0:k} = A_k^T A_{0:k} - B_k^T B_{0:k} (the lower triangle of H,
+     * i.e., the upper one for the column-major DSYEV) */
+    gsl_matrix A_0k = gsl_matrix_submatrix(&A, 0, 0, A.size1, k + 1).matrix;
+    gsl_matrix B_0k = gsl_matrix_submatrix(&B, 0, 0, B.size1, k + 1).matrix;
+    gsl_vector A_k = gsl_matrix_column(&A, k).vector;
+    gsl_vector H_k = gsl_vector_view_array(gsl_matrix_ptr(&H, k, 0), 
+                                           k + 1).vector;
+    gsl_blas_dgemv(CblasTrans, 1, &A_0k, &A_k, 0, &H_k);
+    gsl_blas_dgemv(CblasTrans, -1, &B_0k, myTmpJacobianCol, 1, &H_k);
+  }
+
+  /* H = V Lambda V^T, the eigenvectors are stored in the rows of H */
+  dsyev_("V", "U", &nvar, H.data, &H.tda, myGcdLambda->data, myGcdWork, 
+         &myGcdLwork, &info);
+  if (info) {
+    throw new Exception("Error computing the GCD pseudo-Jacobian: "
+                        "DSYEV didn't converge\n");
+  }
+  
+  gsl_vector grad = gsl_vector_subvector(myGcdGrad, 0, nvar).vector;
+  if (res != NULL) {
+    gsl_matrix gradR = smallPsi ? 
+        gsl_matrix_view_vector(&grad, nrow, getD()).matrix :
+        gsl_matrix_view_vector(&grad, 1, nvar).matrix;
+    computeGradFromYr(yr, Rt, PsiT, &gradR);
+    gsl_vector_set_zero(res);
+  }
+  if (jac != NULL) {
+    gsl_matrix_set_zero(jac);
+  }
+
+  double tol = gsl_vector_get(myGcdLambda, nvar - 1) * nvar * DBL_EPSILON;
+  double rnorm2 = 0, lambda, ri;
+  for (size_t k = 0; k < nvar; k++) {
+    if ((lambda = gsl_vector_get(myGcdLambda, k)) <= tol) {
+      continue;
+    }
+    gsl_vector v = gsl_matrix_row(&H, k).vector;
+    if (jac != NULL) {
+      gsl_vector jac_row = gsl_matrix_row(jac, k).vector;
+      gsl_vector_memcpy(&jac_row, &v);
+      gsl_vector_scale(&jac_row, sqrt(lambda));
+    }
+    if (res != NULL) {
+      /* The gradient of f = ||p||^2 - s^T Gamma^{-1} s is -grad */
+      gsl_blas_ddot(&v, &grad, &ri);
+      ri *= -0.5 / sqrt(lambda);
+      gsl_vector_set(res, k, ri);
+      rnorm2 += ri * ri;
+    }
+  }
+  if (res != NULL) {
+    gsl_vector_set(res, nvar, sqrt(mymax(f - rnorm2, 0)));
+  }
+}
+
 void VarproFunction::computeGradFromYr( const gsl_vector* yr, 
          const gsl_matrix *Rt, const gsl_matrix *perm, gsl_matrix *gradR ) {
   gsl_matrix_const_view yr_matr = gsl_matrix_const_view_vector(yr, getN(), getD());
@@ -219,6 +522,28 @@ void VarproFunction::computeGradFromYr( const gsl_vector* yr,
 
 void VarproFunction::computeFuncAndGrad( const gsl_matrix* Rt, double * f,
                                        const gsl_matrix *perm, gsl_matrix *gradR ) {
+  if (mySample != NULL) {
+    mySample->computeFuncAndGrad(Rt, f, perm, gradR);
+    if (f != NULL) {
+      *f *= mySampleScale;
+    }
+    if (gradR != NULL) {
+      gsl_matrix_scale(gradR, mySampleScale);
+    }
+    return;
+  }
+  if (gradR == NULL && f != NULL && myNMissing == 0 &&
+      !(myGamValid && myGamReg == myReggamma && isEqual(myGamRt, Rt))) {
+    /* Function-only evaluation: do not store the factor */
+    myGamValid = false;
+    gsl_matrix SrMat = gsl_matrix_view_vector(myTmpYr, getN(), getD()).matrix;
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myMatr, Rt, 0, &SrMat);
+    myGam->calcFuncStreaming(Rt, myReggamma, myTmpYr, GSL_POSINF, f);
+    if (myIsGCD) {
+      *f =  myPWnorm2 - *f;
+    }
+    return;
+  }
   computeGammaSr(Rt, myTmpYr, true);
 
   if (f != NULL) {
@@ -241,25 +566,112 @@ void VarproFunction::computeFuncAndGrad( const gsl_matrix* Rt, double * f,
   }
 }
 
+bool VarproFunction::computeFuncBounded( const gsl_matrix* Rt, double bound,
+                                        double *f ) {
+  if (mySample != NULL) {
+    bool res = mySample->computeFuncBounded(Rt, bound / mySampleScale, f);
+    *f *= mySampleScale;
+    return res;
+  }
+  if (myIsGCD || myNMissing > 0 || 
+      (myGamValid && myGamReg == myReggamma && 
+                  isEqual(myGamRt, Rt))) {
+    computeFuncAndGrad(Rt, f, NULL, NULL);
+    return *f <= bound;
+  }
+
+  myGamValid = false;
+  gsl_matrix SrMat = gsl_matrix_view_vector(myTmpYr, getN(), getD()).matrix;
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, myMatr, Rt, 0, &SrMat);
+  if (!myGam->calcGammaCholeskyBounded(Rt, myReggamma, myTmpYr, bound, f)) {
+    return false;
+  }
+  gsl_matrix_memcpy(myGamRt, Rt);
+  myGamReg = myReggamma;
+  myGamValid = true;
+  return true;
+}
+
 void VarproFunction::computeCorrectionAndJacobian( const gsl_matrix *Rt,
          const gsl_matrix *perm, gsl_vector *res, gsl_matrix *jac ) {
   computeGammaSr(Rt, myTmpYr, true);
   myGam->multInvGammaVector(myTmpYr);
   if (res != NULL) {
+    gsl_vector *corr = (mySketch != NULL || myFree != NULL) ? myTmpCorr : res;
     if (myIsGCD) {
-      gsl_vector_memcpy(res, getP());
-      myStruct->multByGtUnweighted(res, Rt, myTmpYr, -1, 1);
+      gsl_vector_memcpy(corr, getP());
+      myStruct->multByGtUnweighted(corr, Rt, myTmpYr, -1, 1,
+                                   true, myStructWs);
     } else {
-      gsl_vector_set_zero(res);
-      myStruct->multByGtUnweighted(res, Rt, myTmpYr, -1, 1);
+      gsl_vector_set_zero(corr);
+      myStruct->multByGtUnweighted(corr, Rt, myTmpYr, -1, 1,
+                                   true, myStructWs);
+    }
+    myStruct->multByWInv(corr, 1);
+    if (corr != res) {
+      compressCorrection(corr, res);
     }
-    myStruct->multByWInv(res, 1);
   }
   if (jac != NULL) {  
     computeJacobianOfCorrection(myTmpYr, Rt, perm, jac);
   } 
 }
 
+void VarproFunction::compressCorrection( gsl_vector *corr, gsl_vector *res ) {
+  if (myFree != NULL) {
+    for (size_t l = 0; l < myNFree; l++) {
+      gsl_vector_set(corr, l, gsl_vector_get(corr, myFree[l]));
+    }
+  }
+  gsl_vector corr_free = gsl_vector_subvector(corr, 0, myNFree).vector;
+  if (mySketch != NULL) {
+    mySketch->apply(&corr_free, res);
+  } else {
+    gsl_vector_memcpy(res, &corr_free);
+  }
+}
+
+void VarproFunction::setCorrectionSketch( size_t s ) {
+  if (mySketch != NULL) {
+    delete mySketch;
+    mySketch = NULL;
+  }
+  if (s > 0) {
+    mySketch = new SparseSketch(s, myNFree);
+  }
+}
+
+void VarproFunction::setBlockSample( const size_t *blocks, size_t n ) {
+  if (mySample != NULL) {
+    delete mySample;
+    delete mySampleS;
+    mySample = NULL;
+    mySampleS = NULL;
+    mySampleScale = 1;
+  }
+  if (blocks == NULL || myIsGCD) {
+    return;
+  }
+  mySampleS = myStruct->createBlockSubset(blocks, n);
+  if (mySampleS == NULL) {
+    return;
+  }
+  gsl_vector *p_sub = gsl_vector_alloc(mySampleS->getNp());
+  myStruct->getBlockSubsetP(blocks, n, getP(), p_sub);
+  try {
+    mySample = new VarproFunction(p_sub, mySampleS, getD(), NULL);
+  } catch (Exception *e) {
+    gsl_vector_free(p_sub);
+    delete mySampleS;
+    mySampleS = NULL;
+    throw e;
+  }
+  gsl_vector_free(p_sub);
+  mySample->setReggamma(myReggamma);
+  mySample->setMissingTol(myMissingTol);
+  mySampleScale = (double)getNp() / mySampleS->getNp();
+}
+
 void VarproFunction::computePhat( gsl_vector* p, const gsl_matrix *Rt ) {
   try  {
     computeGammaSr(Rt, myTmpYr, true);
@@ -275,20 +687,27 @@ void VarproFunction::computePhat( gsl_vector* p, const gsl_matrix *Rt ) {
   
   gsl_vector_set_zero(p);
   if (myIsGCD) {
-    myStruct->multByGtUnweighted(p, Rt, myTmpYr, 1, 1, false);
+    myStruct->multByGtUnweighted(p, Rt, myTmpYr, 1, 1,
+                                 false, myStructWs);
   } else {
-    myStruct->multByGtUnweighted(p, Rt, myTmpYr, -1, 1);
+    myStruct->multByGtUnweighted(p, Rt, myTmpYr, -1, 1,
+                                 true, myStructWs);
     myStruct->multByWInv(p, 2);
-    gsl_vector_add(p, getP());
+    gsl_vector_add(p, (myNMissing > 0 ? myPImp : getP()));
   }
 }
 
 void VarproFunction::computeFuncAndPseudoJacobianLs( const gsl_matrix *Rt,
          gsl_matrix *perm, gsl_vector *res, gsl_matrix *jac, double factor ) {
+  computeGammaSr(Rt, myTmpYr, true);
   if (myIsGCD)  {
-    throw new Exception("Pseudojacobian not allowed for GCD computations\n");
+    double f;
+    myGam->multInvCholeskyVector(myTmpYr, 1);
+    gsl_blas_ddot(myTmpYr, myTmpYr, &f);
+    myGam->multInvCholeskyVector(myTmpYr, 0);
+    computePseudoJacobianLsGCD(myTmpYr, Rt, perm, myPWnorm2 - f, res, jac);
+    return;
   }
-  computeGammaSr(Rt, myTmpYr, true);
   if (res != NULL) {
     myGam->multInvCholeskyVector(myTmpYr, 1);
     gsl_vector_memcpy(res, myTmpYr);
@@ -309,6 +728,11 @@ void VarproFunction::computeDefaultRTheta( gsl_matrix *RTheta ) {
   size_t minus1 = -1;
   double tmp;
 
+  if (myNMissing > 0) {
+    /* Start from p_m = 0, independently of the previous calls */
+    myGamValid = false;
+    fillMatr();
+  }
   gsl_matrix * tempc = gsl_matrix_alloc(c_size1, c_size2);
   gsl_matrix_memcpy(tempc, myMatr);
   
@@ -320,24 +744,41 @@ void VarproFunction::computeDefaultRTheta( gsl_matrix *RTheta ) {
   dgesvd_("A", "N", &tempc->size2, &tempc->size1, tempc->data, &tempc->tda, s,
      tempu->data, &tempu->size2, NULL, &tempc->size1, &tmp, &minus1, &status);
   double *work = new double[(lwork = tmp)];
-  /* Compute low-rank approximation */ 
-  dgesvd_("A", "N", &tempc->size2, &tempc->size1, tempc->data, &tempc->tda, s,
-     tempu->data, &tempu->size2, NULL, &tempc->size1, work, &lwork, &status);
-
-  if (status) {
-    delete [] s;  
-    delete [] work;  
-    gsl_matrix_free(tempc);
-    gsl_matrix_free(tempu);
-    throw new Exception("Error computing initial approximation: "
-                        "DGESVD didn't converge\n");
-  }
-
-  gsl_matrix_transpose(tempu);
-  gsl_matrix_view RlraT;
-  RlraT = gsl_matrix_submatrix(tempu, 0, tempu->size2 - RTheta->size2, 
-                               tempu->size1, RTheta->size2);
-  gsl_matrix_memcpy(RTheta, &(RlraT.matrix));
+
+  /* With missing values, the low-rank approximation and the imputation
+   * of the missing values for its R are alternated */
+  for (size_t iter = 0; ; iter++) {
+    gsl_matrix_memcpy(tempc, myMatr);
+    /* Compute low-rank approximation */ 
+    dgesvd_("A", "N", &tempc->size2, &tempc->size1, tempc->data, &tempc->tda, 
+       s, tempu->data, &tempu->size2, NULL, &tempc->size1, work, &lwork, 
+       &status);
+
+    if (status) {
+      delete [] s;  
+      delete [] work;  
+      gsl_matrix_free(tempc);
+      gsl_matrix_free(tempu);
+      throw new Exception("Error computing initial approximation: "
+                          "DGESVD didn't converge\n");
+    }
+
+    gsl_matrix_transpose(tempu);
+    gsl_matrix_view RlraT;
+    RlraT = gsl_matrix_submatrix(tempu, 0, tempu->size2 - RTheta->size2, 
+                                 tempu->size1, RTheta->size2);
+    gsl_matrix_memcpy(RTheta, &(RlraT.matrix));
+    
+    if (myNMissing == 0 || iter >= SLRA_MISSING_INIT_ITER) {
+      break;
+    }
+    try {
+      computeGammaSr(RTheta, myTmpYr, true);
+    } catch (Exception *e) {
+      delete e;
+      break;
+    }
+  }
     
   delete [] s;  
   delete [] work;  
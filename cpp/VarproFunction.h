@@ -7,11 +7,17 @@
 class VarproFunction  {
   Structure *myStruct;
   size_t myD;
+  Structure::Workspace *myStructWs;
   Cholesky *myGam;
   DGamma *myDeriv;
   double myReggamma;
   bool myIsGCD;
 
+  /* R and the regularization for which myGam is factorized */
+  gsl_matrix *myGamRt;
+  double myGamReg;
+  bool myGamValid;
+
   gsl_matrix *myMatr;
   gsl_matrix *myTmpGradR, *myTmpGradR2;
   gsl_matrix *myTmpJac, *myTmpJac2, *myTmpJtJ, *myTmpEye;
@@ -22,8 +28,39 @@ class VarproFunction  {
 
   gsl_vector *myPhiPermCol;  
   gsl_vector *myTmpJacobianCol;  
+
+  /* Row sketch of the correction and its Jacobian (NULL if not used) */
+  SparseSketch *mySketch;
+
+  /* Cost function on a sample of the blocks (NULL if not used) */
+  VarproFunction *mySample;
+  Structure *mySampleS;
+  double mySampleScale;
+
+  /* Indices of the missing values (NULL if there are none) */
+  size_t *myMissing, myNMissing;
+  double myMissingTol;
+  /* p with the imputed values for myGamRt, and the workspace of 
+   * the imputation (allocated only if there are missing values) */
+  gsl_vector *myPImp;
+  gsl_matrix *myGm;
+  gsl_vector *myGmTau, *myGmWork;
+  size_t *myGmPerm;
+  /* Indices of the free parameters (NULL if none is fixed) */
+  size_t *myFree, myNFree;
+
+  /* Workspace of the GCD pseudo-Jacobian (allocated only if myIsGCD) */
+  gsl_matrix *myGcdA, *myGcdB, *myGcdH, *myGcdMatr;
+  gsl_vector *myGcdLambda, *myGcdGrad;
+  double *myGcdWork;
+  size_t myGcdLwork;
 protected:  
   void setPhiPermCol( size_t i, const gsl_matrix *perm, gsl_vector *phiPermCol );
+  /* Sets myTmpGradR to the m x d matrix R with vec(R^T) = PsiCol */
+  void setTmpGradRFromPsiCol( const gsl_vector *PsiCol );
+  /** Fills \f$\mathscr{S}^{\top}(p)\f$ (and \f$\|p\|^2_{\mathrm{W}}\f$ in 
+   * the GCD mode) for the current \f$p\f$ */
+  void fillMatr();
   virtual void fillZmatTmpJac( gsl_matrix *Zmatr, const gsl_vector* yr,
                                const gsl_matrix *PhiTRt, double factor = 0.5,
                                int mult_gam = 0 );
@@ -31,17 +68,58 @@ protected:
                             const gsl_matrix *perm, size_t j_1, size_t i_1 );
   size_t getM() { return myStruct->getM(); }
   
+  /** Computes \f$s(R)\f$ and the Cholesky factor of \f$\Gamma(R)\f$.
+   * The factor is memoized: it is not recomputed if \f$R\f$ and 
+   * the regularization are the same as in the previous call (e.g., when
+   * the Jacobian is computed at the point accepted by a line search). */
   virtual void computeGammaSr( const gsl_matrix *Rt,
                                gsl_vector *Sr, bool regularize_gamma );
+  /** Computes the imputed values of the missing values for \f$R\f$.
+   * With \f$p_m\f$ fixed, the cost function is computed for a positive 
+   * weight of the missing values (see Structure::isMissing()), 
+   * and its minimum over \f$p_m\f$ is the cost function for 
+   * the zero weight. With \f$p_m = 0\f$ and 
+   * \f$s(p) = s_0 + G_m p_m\f$, the minimum is attained for
+   * \f$p_m = -A^{+} b\f$, where \f$A = \mathrm{L}^{-1} G_m\f$,
+   * \f$b = \mathrm{L}^{-1} s_0\f$ and \f$\Gamma = \mathrm{L}\mathrm{L}^{\top}\f$.
+   * The least squares problem is solved by the pivoted QR factorization 
+   * of \f$A\f$, the rank being determined by the relative tolerance 
+   * (see setMissingTol()). The imputed \f$p\f$ is stored in `myPImp`, 
+   * and \f$\mathscr{S}(p)\f$ in `myMatr`, so that \f$f(R)\f$ does not
+   * depend on the previous calls. \f$A\f$ is dense, which costs 
+   * \f$O(n_m n m d)\f$ flops per \f$R\f$ for \f$n_m\f$ missing values. */
+  void imputeMissing( const gsl_matrix *Rt );
+  /** Copies the entries of the correction \f$\mathrm{corr}\f$ 
+   * for the free parameters to \f$\mathrm{res}\f$, multiplied by the 
+   * sketch if it is set. The correction is zero for the fixed parameters
+   * (\f$w_k = \infty\f$). Overwrites \f$\mathrm{corr}\f$. */
+  void compressCorrection( gsl_vector *corr, gsl_vector *res );
   virtual void computePseudoJacobianLsFromYr( const gsl_vector* yr, 
                    const gsl_matrix *Rorig, const gsl_matrix *PsiT,
                    gsl_matrix *pjac, double factor = 0.5 );
 
+  /** Computes the compact pseudo-Jacobian in the GCD mode.
+   * In the GCD mode \f$f(R) = \|e\|^2\f$, where 
+   * \f$e = (I - \Pi) \mathrm{L}_{\mathrm{W}}^{-\top} p\f$ and
+   * \f$\Pi\f$ is the projector on the range of \f$G^{\top}(R)\f$.
+   * The Gauss-Newton matrix \f$J^{\top} J = A^{\top} A - B^{\top} B\f$, with 
+   * \f$A = [\mathrm{L}_{\mathrm{W}}^{-\top} dG^{\top}_{ij} y]\f$ and 
+   * \f$B = \mathrm{L}_{\Gamma}^{-\top} G \mathrm{W}^{-1/2} A\f$,
+   * is factored as \f$C^{\top} C\f$ by a symmetric eigendecomposition.
+   * The returned residual \f$[r;\rho]\f$ and Jacobian \f$[C;0]\f$ have
+   * \f$n_{var}+1\f$ rows (the rest of `res` and `jac` is zeroed), 
+   * \f$C^{\top} r = \nabla f/2\f$ and \f$\|r\|^2 + \rho^2 = f\f$.
+   * @param[in]  yr   vector \f$y = \Gamma^{-1}(R) s\f$
+   * @param[in]  f    value of the cost function
+   */
+  virtual void computePseudoJacobianLsGCD( const gsl_vector* yr, 
+                   const gsl_matrix *Rorig, const gsl_matrix *PsiT, double f,
+                   gsl_vector *res, gsl_matrix *jac );
+
   virtual void computeJacobianOfCorrection( const gsl_vector* yr, 
                    const gsl_matrix *Rorig, const gsl_matrix *PsiT, gsl_matrix *jac );
   virtual void computeGradFromYr( const gsl_vector* yr, const gsl_matrix *Rorig, 
                                   const gsl_matrix *perm, gsl_matrix *grad );
-  const gsl_vector *getP() { return myP; }
   virtual const gsl_matrix * getOrigSMatr() { return myMatr; }
 public:
   
@@ -51,6 +129,12 @@ public:
   virtual ~VarproFunction();
   
   bool isGCD() { return myIsGCD; }
+  const gsl_vector *getP() { return myP; }
+  /** Replaces the data vector \f$p\f$ by a vector of the same size.
+   * The structure and the workspace are reused, which is cheaper than
+   * constructing a new object for many problems of the same sizes.
+   * The block sample (see setBlockSample()) is removed. */
+  void setP( const gsl_vector *p );
 
   size_t getD() { return myD; }
   size_t getN() { return myStruct->getN(); }
@@ -58,13 +142,55 @@ public:
   size_t getNp() { return myStruct->getNp(); }
   double getReggamma() { return myReggamma; }
   void setReggamma( double reg_gamma ) { myReggamma = reg_gamma; }
+  double getMissingTol() { return myMissingTol; }
+  /** Sets the relative tolerance of the rank in the elimination of 
+   * the missing values (see OptimizationOptions::tol_m) */
+  void setMissingTol( double tol_m );
 
 
+  /** Computes \f$f(R)\f$ and/or the gradient.
+   * If only \f$f\f$ is requested, \f$\Gamma(R)\f$ is factorized by 
+   * Cholesky::calcFuncStreaming() without storing the factor
+   * (unless the memoized factor for \f$R\f$ is available). */
   virtual void computeFuncAndGrad( const gsl_matrix* R, double* f, 
                                    const gsl_matrix *perm, gsl_matrix *gradR );
+  /** Computes \f$f(R)\f$ with an early abort if \f$f(R) > \mathrm{bound}\f$.
+   * The factorization of \f$\Gamma(R)\f$ and the forward substitution stop
+   * as soon as the partial sum of squares exceeds the bound 
+   * (see Cholesky::calcGammaCholeskyBounded()). In the GCD mode, \f$f\f$ 
+   * is not a growing sum, and the full evaluation is performed.
+   * @return `true` if \f$f \le \mathrm{bound}\f$, otherwise `*f` 
+   * is only a lower bound of \f$f(R)\f$ */
+  virtual bool computeFuncBounded( const gsl_matrix* R, double bound, 
+                                   double *f );
   virtual void computePhat( gsl_vector* p, const gsl_matrix* R );
   virtual void computeCorrectionAndJacobian( const gsl_matrix* R, 
                    const gsl_matrix *perm, gsl_vector *res, gsl_matrix *jac  );
+  /** Sets the row sketch for computeCorrectionAndJacobian().
+   * If \f$s > 0\f$, the correction and the columns of its Jacobian are
+   * multiplied by a SparseSketch \f$S\f$ with \f$s\f$ rows
+   * as they are computed, so that the returned residual and Jacobian 
+   * have \f$s\f$ rows. The sketch is removed if \f$s = 0\f$. */
+  void setCorrectionSketch( size_t s );
+  /** Returns the number of blocks that can be sampled by setBlockSample()
+   * (see Structure::getNBlocks(); 1 in the GCD mode) */
+  size_t getNBlocks() { return myIsGCD ? 1 : myStruct->getNBlocks(); }
+  /** Restricts computeFuncAndGrad() and computeFuncBounded() to a sample
+   * of the blocks of the structure.
+   * The cost function is the sum of the terms for the blocks
+   * (see Structure::getNBlocks()). The terms and the gradient on the sample 
+   * are scaled by \f$n_p / n_p^{\mathrm{sample}}\f$ and estimate 
+   * the cost function and the gradient on the whole data.
+   * @param[in] blocks  increasing \f$0\f$-based indices of the blocks 
+   *                    (the sample is removed if `blocks == NULL`)
+   * @param[in] n       number of the blocks in the sample
+   */
+  void setBlockSample( const size_t *blocks, size_t n );
+  /** Returns the number of rows of the correction (sketched or not),
+   * which has no rows for the fixed parameters */
+  size_t getNCorrection() { 
+    return mySketch != NULL ? mySketch->getSize1() : myNFree; 
+  }
 
   void computeDefaultRTheta( gsl_matrix *RTheta ); 
   virtual void computeFuncAndPseudoJacobianLs( const gsl_matrix* R, gsl_matrix *perm,
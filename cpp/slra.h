@@ -28,13 +28,24 @@ extern "C" {
 #include "StripedDGamma.h"
 #include "HLayeredBlWStructure.h"
 #include "HLayeredElWStructure.h"
+#include "HLayeredBandWStructure.h"
+#include "TLayeredBlWStructure.h"
+#include "TLayeredElWStructure.h"
+#include "HBHLayeredBlWStructure.h"
+#include "SparseAffineStructure.h"
 #include "MuDependentCholesky.h"
+#include "HODLRCholesky.h"
+#include "HBHCholesky.h"
 #include "StationaryCholesky.h"
 #include "StationaryCholeskySlicot.h"
 #include "MuDependentDGamma.h"
 #include "StationaryDGamma.h"
+#include "HBHDGamma.h"
 #include "PhiStructure.h"
+#include "SylvesterStructure.h"
 
+#include "KronOperator.h"
+#include "SparseSketch.h"
 #include "VarproFunction.h"
 #include "NLSFunction.h"
 #include "NLSVarpro.h"
@@ -42,6 +53,8 @@ extern "C" {
 #include "NLSVarproVecR.h"
 #include "NLSVarproPsiVecR.h"
 
+#include "LMStepSolver.h"
+#include "Checkpoint.h"
 #include "OptimizationOptions.h"
 
 #include "slra_common.h"
@@ -49,6 +62,7 @@ extern "C" {
 #include "slralapack.h"
 
 #include "MyIterationLogger.h"
+#include "AsyncOptimization.h"
 #include "SLRAObject.h"
 
 
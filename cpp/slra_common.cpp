@@ -8,10 +8,16 @@
 typedef Structure* pStructure;
 
 Structure *createMosaicStructure( gsl_vector * ml, gsl_vector *nk,
-               gsl_vector * wk, gsl_matrix *phi ) {
-  enum { ROW_BLW_MOSAIC = 1, BLW_MOSAIC, ELW_MOSAIC } stype;
+               gsl_vector * wk, gsl_matrix *phi, gsl_vector *tk,
+               gsl_matrix *wband ) {
+  enum { ROW_BLW_MOSAIC = 1, BLW_MOSAIC, ELW_MOSAIC, BANDW_MOSAIC } stype;
   
-  if (wk == NULL || wk->size == ml->size) {
+  if (wband != NULL) {
+    if (wk != NULL) {
+      throw new Exception("Banded weights cannot be combined with s.w\n");   
+    }
+    stype = BANDW_MOSAIC;
+  } else if (wk == NULL || wk->size == ml->size) {
     stype = ROW_BLW_MOSAIC;
   } else if (wk->size == ml->size * nk->size ) {
     stype = BLW_MOSAIC;
@@ -20,29 +26,69 @@ Structure *createMosaicStructure( gsl_vector * ml, gsl_vector *nk,
   } else {
     throw new Exception("Incorrect weight specification\n");   
   }
+  if (tk != NULL && tk->size != 1 && tk->size != nk->size) {
+    throw new Exception("Incorrect Toeplitz block specification\n");   
+  }
   
   pStructure *res = new pStructure[nk->size];
   double *pw = (wk == NULL ? NULL : wk->data);
+  bool is_same_type = true;
   for (size_t k = 0; k < nk->size; k++) {
-    if (stype == ELW_MOSAIC) {
-      res[k] = new HLayeredElWStructure(ml->data, ml->size, nk->data[k], pw);
+    bool toeplitz = (tk != NULL && 
+                     gsl_vector_get(tk, (tk->size == 1 ? 0 : k)) != 0);
+    if (tk != NULL && toeplitz != (gsl_vector_get(tk, 0) != 0)) {
+      is_same_type = false;
+    }
+    if (stype == BANDW_MOSAIC) {
+      if (toeplitz) {
+        throw new Exception("Banded weights are not supported for "
+                            "the Toeplitz blocks\n");   
+      }
+      res[k] = new HLayeredBandWStructure(ml->data, ml->size, nk->data[k], 
+                                          wband);
+    } else if (stype == ELW_MOSAIC) {
+      if (toeplitz) {
+        res[k] = new TLayeredElWStructure(ml->data, ml->size, nk->data[k], pw);
+      } else {
+        res[k] = new HLayeredElWStructure(ml->data, ml->size, nk->data[k], pw);
+      }
       if (pw != NULL) {
         pw += res[k]->getNp();
       }
     } else {
-      res[k] = new HLayeredBlWStructure(ml->data, ml->size, nk->data[k], pw);
+      if (toeplitz) {
+        res[k] = new TLayeredBlWStructure(ml->data, ml->size, nk->data[k], pw);
+      } else {
+        res[k] = new HLayeredBlWStructure(ml->data, ml->size, nk->data[k], pw);
+      }
       if (stype == BLW_MOSAIC) {
         pw += ml->size;
       }
     } 
   }
-  Structure *res1 =new StripedStructure(nk->size, res,  stype == ROW_BLW_MOSAIC);
+  Structure *res1 =new StripedStructure(nk->size, res,  
+                           (stype == ROW_BLW_MOSAIC || 
+                            stype == BANDW_MOSAIC) && is_same_type);
   if (phi != NULL) {
     res1 = new PhiStructure(phi, res1);
   }
   return res1;
 }
 
+double missingInvWeight( const double *w_vec, size_t n ) {
+  double w_min = GSL_POSINF;
+
+  for (size_t k = 0; k < n; k++) {
+    if (!(w_vec[k] >= 0)) {
+      throw new Exception("Value of weight not supported: %lf\n", w_vec[k]);
+    }
+    if (w_vec[k] > 0 && w_vec[k] < w_min) {
+      w_min = w_vec[k];
+    }
+  }
+  return 1 / (SLRA_MISSING_REL_W * (w_min < GSL_POSINF ? w_min : 1));
+}
+
 size_t compute_np( gsl_vector* ml, gsl_vector *nk ) {
   size_t np = 0;
   size_t i;
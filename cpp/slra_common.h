@@ -29,12 +29,20 @@
 #define NK_STR "n"
 #define PERM_STR "phi"
 #define WK_STR "w"
+#define WBAND_STR "wband"
 #define GCD_STR "gcd"
+#define TTS_STR "tts"
+#define S0_STR "S0"
+#define HODLR_TOL_STR "hodlr_tol"
+#define TOEPLITZ_STR "toeplitz"
+#define M2D_STR "m2d"
+#define N2D_STR "n2d"
 
 /* field names for opt */
 #define RINI_STR "Rini"
 #define DISP_STR "disp"
 #define METHOD_STR "method"
+#define CHKPT_FILE_STR "chkpt_file"
 
 /* names for output */
 #define PH_STR "ph"
@@ -48,11 +56,19 @@
 #define TIME_STR      "time"
 #define RS_STR        "RhK"
 #define INF_ITER_STR  "iterinfo"
+#define BEST_STR      "best"
+#define MSTATS_STR    "mstats"
+#define RUNNING_STR   "running"
+#define GRADNORM_STR  "gradnorm"
 #define PSI_STR       "psi"
           
 #define mymax(a, b) ((a) > (b) ? (a) : (b)) 
 #define mymin(a, b) ((a) < (b) ? (a) : (b))
          
+/* missing values (zero weights) */
+#define SLRA_MISSING_REL_W    1     /* weight of the missing values w.r.t. min w */
+#define SLRA_MISSING_INIT_ITER 10   /* imputation steps for the initial R */
+
 #define gsl_matrix_free_ifnull(M)    if (M != NULL) gsl_matrix_free(M)
 #define gsl_vector_free_ifnull(V)    if (V != NULL) gsl_vector_free(V)
      
@@ -64,10 +80,33 @@
  * @param [in]     wk      Vector of weights. If NULL, or of sizes \f$q\f$, \f$qN\f$ - 
  *                         MosaicHStructure is constructed, otherwise - WMosaicHStructure
  * @param [in]     d       Rank reduction  (\f$m-r\f$) 
+ * @param [in]     tk      Flags of the Toeplitz column blocks (a scalar for all
+ *                         blocks, or of size \f$N\f$). If NULL or zero, the
+ *                         block is layered Hankel, otherwise layered Toeplitz
+ *                         \sa TLayeredBlWStructure
+ * @param [in]     wband   Band coefficients of \f$\mathrm{W}^{-1}\f$ 
+ *                         for each layer (\f$q \times (b+1)\f$), used
+ *                         instead of wk \sa HLayeredBandWStructure
  */                
 Structure *createMosaicStructure( gsl_vector * ml,  gsl_vector *nk, 
-               gsl_vector * wk, gsl_matrix *phi = NULL );
+               gsl_vector * wk, gsl_matrix *phi = NULL, gsl_vector *tk = NULL,
+               gsl_matrix *wband = NULL );
          
+/** Returns the inverse weight of the missing values (\f$w_k = 0\f$).
+ * The weight of the missing values is replaced by 
+ * \f$\varepsilon_m \min \{w_k : 0 < w_k < \infty\}\f$, where
+ * \f$\varepsilon_m\f$ is `SLRA_MISSING_REL_W`, which keeps the problem
+ * invariant to the scaling of the weights. The missing values are 
+ * eliminated (VarproFunction::imputeMissing()), so the weight affects 
+ * only the conditioning of \f$\Gamma\f$, a small weight making 
+ * \f$\Gamma\f$ ill-conditioned. Also checks that
+ * \f$w_k \ge 0\f$.
+ * @ingroup MainFunctions 
+ * @param [in]     w_vec   Vector of weights
+ * @param [in]     n       Number of weights
+ */
+double missingInvWeight( const double *w_vec, size_t n );
+
 /*
  * tmv_prod_new: block-Toeplitz banded matrix p =  T * v
  * T - storage for [t_s-1' ... t_1' t_0 t_1 ... t_s-1].
@@ -76,39 +76,7 @@ void shiftLowerTrg( gsl_matrix * dest, const gsl_matrix *src  ) {
   }
 }
 
-void id_kron_a( const gsl_matrix *A, size_t d,  gsl_matrix *IkronA ) {
-  gsl_matrix_set_zero(IkronA);
-  for (size_t  k = 0; k < d; k++) {
-    gsl_matrix subA = gsl_matrix_submatrix(IkronA, k * A->size1, k * A->size2, 
-                           A->size1, A->size2).matrix;
-    gsl_matrix_memcpy(&subA, A);
-  }
-}
-
 void ls_solve( const gsl_matrix *A, const gsl_matrix *B, gsl_matrix *X ) {
-  size_t d = B->size2, i, j, one = 1, lwork = -1, info;
-  gsl_matrix *IkronA = gsl_matrix_alloc(A->size1 * d, A->size2 * d);
-  size_t vecBsize = B->size2 * B->size1; 
-  double tmp;
-  
-  double *vecIkronA = new double[IkronA->size1 * IkronA->size2],
-         *vecB = new double[B->size1 * B->size2]; 
-                          
-  id_kron_a(A, d, IkronA);                                      
-  gsl_matrix_vectorize(vecIkronA, IkronA);
-  gsl_matrix_vectorize(vecB, B);
-  
-  dgels_("N", &IkronA->size1, &IkronA->size2, &one, vecIkronA,
-         &IkronA->size1, vecB, &vecBsize, &tmp, &lwork, &info);
-  double *work = new double[lwork = tmp];
-  dgels_("N", &IkronA->size1, &IkronA->size2, &one, vecIkronA,
-         &IkronA->size1, vecB, &vecBsize, work, &lwork, &info);
-
-  delete [] work;
-  
-  gsl_matrix_free(IkronA);
-  gsl_matrix_vec_inv(X, vecB);
-  
-  delete [] vecB;
-  delete [] vecIkronA;
+  KronOperator IkronA(A, B->size2);
+  IkronA.lsSolve(B, X);
 }
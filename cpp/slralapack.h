@@ -9,8 +9,17 @@ extern "C" {
 #define dpbtrs_ dpbtrs
 #define dpbtrf_ dpbtrf
 #define dgesvd_ dgesvd
+#define zgesvd_ zgesvd
 #define dgesv_ dgesv
 #define dgels_ dgels
+#define dsyev_ dsyev
+#define dgeqrf_ dgeqrf
+#define dormqr_ dormqr
+#define dtrtrs_ dtrtrs
+#define dgeqp3_ dgeqp3
+#define dorglq_ dorglq
+#define dpotrf_ dpotrf
+#define dpotrs_ dpotrs
 
 #endif /* BUILD_MEX_WINDOWS */
 
@@ -36,6 +45,13 @@ void dpbtrs_(const char* uplo, const size_t* n, const size_t* kd,
 void dpbtrf_(const char* uplo, const size_t* n, const size_t* kd, 
              double* ab, const size_t* ldab, size_t* info); 
 
+void dpotrf_(const char* uplo, const size_t* n, double* a, const size_t* lda,
+             size_t* info); 
+
+void dpotrs_(const char* uplo, const size_t* n, const size_t* nrhs, 
+             const double* a, const size_t* lda, double* b, 
+             const size_t* ldb, size_t* info); 
+
 void dgelqf_(const size_t *m, const size_t *n, double *a, const  size_t *lda, 
              double *tau, double *work, const size_t *ldwork, size_t *info);
               
@@ -44,6 +60,10 @@ void dormlq_(const char *side, const char *trans, const size_t *m,
              double *tau, double *c, const size_t *ldc, 
              double *work, const size_t *lwork, size_t *info);
 
+void dorglq_(const size_t *m, const size_t *n, const size_t *k, double *a, 
+             const size_t *lda, const double *tau, double *work, 
+             const size_t *lwork, size_t *info);
+
 void dgesv_(const size_t* n, const size_t* nrhs, double* a, const size_t* lda, 
             const size_t* ipiv, double* b, const size_t* ldb, size_t* info);
             
@@ -53,11 +73,38 @@ void dgesvd_(const char* jobu, const char* jobvt, const size_t* m,
              const double* vt, const size_t* ldvt, 
              double* work, const size_t* lwork, size_t * info);              
 
+/* Complex arrays are passed as interleaved (real, imaginary) pairs */
+void zgesvd_(const char* jobu, const char* jobvt, const size_t* m, 
+             const size_t* n, double* a, const size_t* lda, double* s, 
+             double* u, const size_t* ldu, double* vt, const size_t* ldvt, 
+             double* work, const size_t* lwork, double* rwork, size_t * info);
+
 void dgels_(const char * trans, const size_t* m, const size_t* n,
             const size_t* nrhs, double* a, const size_t* lda, 
             double* b, const size_t* ldb, 
             double* work, const size_t* lwork, size_t* info);
 
+void dgeqrf_(const size_t *m, const size_t *n, double *a, const size_t *lda,
+             double *tau, double *work, const size_t *lwork, size_t *info);
+
+void dgeqp3_(const size_t *m, const size_t *n, double *a, const size_t *lda,
+             size_t *jpvt, double *tau, double *work, const size_t *lwork, 
+             size_t *info);
+
+void dormqr_(const char *side, const char *trans, const size_t *m, 
+             const size_t *n, const size_t *k, const double *a, 
+             const size_t *lda, const double *tau, double *c, 
+             const size_t *ldc, double *work, const size_t *lwork, 
+             size_t *info);
+
+void dtrtrs_(const char* uplo, const char* trans, const char* diag, 
+             const size_t* n, const size_t* nrhs, const double* a, 
+             const size_t* lda, double* b, const size_t* ldb, size_t* info); 
+
+void dsyev_(const char* jobz, const char* uplo, const size_t* n, double* a,
+            const size_t* lda, double* w, double* work, const size_t* lwork,
+            size_t* info);
+
 #ifndef BUILD_R_PACKAGE 
 void dtrsm_(const char* side, const char *uplo, const char *transa,
             const char *diag, const size_t *m, const size_t *n, 
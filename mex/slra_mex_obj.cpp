@@ -3,6 +3,52 @@
 using namespace std;
 #include "class_handle.hpp"
 
+/* Realified R^T from the complex opt.Rini (NULL if opt.Rini is not complex) */
+static gsl_matrix *complexRini( const mxArray *Mopt, SLRAObject *obj ) {
+  const mxArray *rini = mxIsStruct(Mopt) ? mxGetField(Mopt, 0, RINI_STR) : NULL;
+  if (rini == NULL || !mxIsComplex(rini)) {
+    return NULL;
+  }
+  size_t m = obj->getF()->getNrow(), d = obj->getF()->getD();
+  gsl_matrix Rt_re = M2trmat(rini), Rt_im = M2trmatIm(rini);
+  if (!obj->isComplex() || Rt_re.size1 != m / 2 || Rt_re.size2 != d / 2) {
+    throw new Exception("Incorrect Rini\n");   
+  }
+  gsl_matrix *Rt = gsl_matrix_alloc(m, d);
+  obj->realifyRt(&Rt_re, &Rt_im, Rt);
+  return Rt;
+}
+
+/* Complex p from the realified one */
+static mxArray *complexP2M( SLRAObject *obj, const mxArray *p ) {
+  gsl_vector p_r = M2vec(p);
+  mxArray *res = mxCreateDoubleMatrix(p_r.size / 2, 1, mxCOMPLEX);
+  gsl_vector p_re = M2vec(res), p_im = M2vecIm(res);
+  obj->complexifyP(&p_r, &p_re, &p_im);
+  return res;
+}
+
+/* Complex R (d x m) from the realified R (2d x 2m) */
+static mxArray *complexR2M( SLRAObject *obj, const mxArray *R ) {
+  gsl_matrix Rt = M2trmat(R);
+  mxArray *res = mxCreateDoubleMatrix(Rt.size2 / 2, Rt.size1 / 2, mxCOMPLEX);
+  gsl_matrix Rt_re = M2trmat(res), Rt_im = M2trmatIm(res);
+  obj->complexifyRt(&Rt, &Rt_re, &Rt_im);
+  return res;
+}
+
+/* Replaces the realified p and R by the complex ones */
+static void complexOutput( SLRAObject *obj, mxArray **p, mxArray **R ) {
+  mxArray *tmp = *p;
+  *p = complexP2M(obj, tmp);
+  mxDestroyArray(tmp);
+  if (R != NULL) {
+    tmp = *R;
+    *R = complexR2M(obj, tmp);
+    mxDestroyArray(tmp);
+  }
+}
+
 void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
 {
   char str_buf[STR_MAX_LEN];
@@ -18,10 +64,46 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
       }
       const mxArray *as = prhs[2];
       gsl_vector isgcd = M2vec(mxGetField(as, 0, GCD_STR));
-      SLRAObject *slraObj = new SLRAObject(M2vec(prhs[1]), 
-         M2vec(mxGetField(as, 0, ML_STR)), M2vec(mxGetField(as, 0, NK_STR)),
-         M2trmat(mxGetField(as, 0, PERM_STR)), M2vec(mxGetField(as, 0, WK_STR)), 
-         M2vec(prhs[3]), (isgcd.data != NULL) && (*isgcd.data));
+      const mxArray *tts = mxGetField(as, 0, TTS_STR);
+      const mxArray *m2d = mxGetField(as, 0, M2D_STR);
+      SLRAObject *slraObj;
+      
+      if (mxIsComplex(prhs[1]) && (m2d != NULL || tts != NULL)) {
+        throw new Exception("Complex data is supported only for the mosaic "
+                            "Hankel structure.");
+      }
+      if (m2d != NULL) { /* 2-D Hankel-block-Hankel structure */
+        slraObj = new SLRAObject(M2vec(prhs[1]), M2trmat(m2d), 
+           M2vec(mxGetField(as, 0, N2D_STR)), M2vec(mxGetField(as, 0, WK_STR)),
+           M2vec(prhs[3]));
+      } else if (tts != NULL) { /* General affine structure */
+        gsl_vector hodlr_tol = M2vec(mxGetField(as, 0, HODLR_TOL_STR));
+        if (!mxIsDouble(tts)) {
+          throw new Exception("s.tts should be a double matrix.");
+        }
+        slraObj = new SLRAObject(M2vec(prhs[1]), M2trmat(tts), 
+           M2trmat(mxGetField(as, 0, S0_STR)), M2vec(mxGetField(as, 0, WK_STR)),
+           M2vec(prhs[3]), (hodlr_tol.data != NULL ? *hodlr_tol.data : 0));
+      } else if (mxIsComplex(prhs[1])) { /* Complex mosaic Hankel structure */
+        if (mxGetField(as, 0, PERM_STR) != NULL || 
+            mxGetField(as, 0, TOEPLITZ_STR) != NULL ||
+            mxGetField(as, 0, WBAND_STR) != NULL) {
+          throw new Exception("s.phi, s.toeplitz and s.wband are not "
+                              "supported for complex data.");
+        }
+        slraObj = new SLRAObject(M2vec(prhs[1]), M2vecIm(prhs[1]),
+           M2vec(mxGetField(as, 0, ML_STR)), M2vec(mxGetField(as, 0, NK_STR)),
+           M2vec(mxGetField(as, 0, WK_STR)), M2vec(prhs[3]), 
+           (isgcd.data != NULL) && (*isgcd.data));
+      } else {
+        gsl_vector tk = M2vec(mxGetField(as, 0, TOEPLITZ_STR));
+        gsl_matrix wband = M2trmat(mxGetField(as, 0, WBAND_STR));
+        slraObj = new SLRAObject(M2vec(prhs[1]), 
+           M2vec(mxGetField(as, 0, ML_STR)), M2vec(mxGetField(as, 0, NK_STR)),
+           M2trmat(mxGetField(as, 0, PERM_STR)), M2vec(mxGetField(as, 0, WK_STR)), 
+           M2vec(prhs[3]), (isgcd.data != NULL) && (*isgcd.data), 
+           vecChkNIL(tk), matChkNIL(wband));
+      }
                                
       plhs[0] = convertPtr2Mat<SLRAObject>(slraObj);                             
       return;
@@ -45,8 +127,10 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
       gsl_matrix rini = { 0, 0, 0, 0, 0, 0 }, psi = { 0, 0, 0, 0, 0, 0 }, 
                  rhm = { 0, 0, 0, 0, 0, 0 }, vhm =  { 0, 0, 0, 0, 0, 0 },
                  rsm = { 0, 0, 0, 0, 0, 0 }, infitm =  { 0, 0, 0, 0, 0, 0 };
+      gsl_matrix *crini = NULL;
       if (nrhs > 2) {
         mexFillOpt(prhs[2], opt, rini, psi, m, m-d); 
+        crini = complexRini(prhs[2], slraObj);
       }  
       mwSize rs_dims[] = { d, m, opt.maxiter + 1 };
       /* Prepare output info */
@@ -59,9 +143,10 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
                                 RS_STR, INF_ITER_STR };
         plhs[1] = mxCreateStructArray(1, &l, sizeof(names) / sizeof(names[0]), names);
         rhm = M2trmat(rh = mxCreateDoubleMatrix(d, m, mxREAL));
-        if (psi.data == NULL || psi.size1 == m) {
+        if (!slraObj->isComplex() && (psi.data == NULL || psi.size1 == m)) {
           int nxvar = psi.data != NULL ? d*(psi.size2-d) :  d*(m-d);
-          vhm = M2trmat(vh = mxCreateDoubleMatrix(nxvar, nxvar, mxREAL));
+          vhm = M2trmat(vh = mxCreateDoubleMatrix(nxvar, 
+                                    opt.cov_diag ? 1 : nxvar, mxREAL));
           mxSetField(plhs[1], 0, VH_STR, vh);
         }
         infitm = M2trmat(infit = mxCreateDoubleMatrix(3, rs_dims[2], mxREAL));
@@ -75,9 +160,21 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
       }
       
       /* Call slra solver and output info */
-      slraObj->optimize(&opt, matChkNIL(rini), matChkNIL(psi), 
-           vecChkNIL(p_out), matChkNIL(rhm), matChkNIL(vhm),
-           matChkNIL(rsm), matChkNIL(infitm));
+      try {
+        slraObj->optimize(&opt, crini != NULL ? crini : matChkNIL(rini), 
+             matChkNIL(psi), vecChkNIL(p_out), matChkNIL(rhm), 
+             matChkNIL(vhm), matChkNIL(rsm), matChkNIL(infitm));
+      } catch (Exception *e) {
+        gsl_matrix_free_ifnull(crini);
+        throw;
+      }
+      gsl_matrix_free_ifnull(crini);
+      if (slraObj->isComplex()) {
+        complexOutput(slraObj, &plhs[0], nlhs > 0 ? &rh : NULL);
+        if (nlhs > 0) {
+          mxSetField(plhs[1], 0, RH_STR, rh);
+        }
+      }
 
       if (nlhs > 1) {
         mxSetField(plhs[1], 0, FMIN_STR, mxCreateDoubleScalar(opt.fmin));
@@ -90,13 +187,137 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
       return;
     }
 
+    if (!strcmp("multistart", str_buf)) {
+      OptimizationOptions opt;
+      mxArray *rh, *mstats;
+      gsl_matrix rini = { 0, 0, 0, 0, 0, 0 }, psi = { 0, 0, 0, 0, 0, 0 }, 
+                 rinis = { 0, 0, 0, 0, 0, 0 }, rhm = { 0, 0, 0, 0, 0, 0 };
+      size_t nstarts = 1, best;
+      double perturb = 0.1, prune = 0;
+      
+      if (nrhs > 2) {
+        mexFillOpt(prhs[2], opt, rini, psi, m, m-d); 
+      }  
+      if (nrhs > 3) {
+        rinis = M2trmat(prhs[3]);
+      }
+      if (nrhs > 4 && !mxIsEmpty(prhs[4])) {
+        nstarts = mxGetScalar(prhs[4]);
+      }
+      if (nrhs > 5 && !mxIsEmpty(prhs[5])) {
+        perturb = mxGetScalar(prhs[5]);
+      }
+      if (nrhs > 6 && !mxIsEmpty(prhs[6])) {
+        prune = mxGetScalar(prhs[6]);
+      }
+      if (rinis.data != NULL) {
+        nstarts = rinis.size1;
+      }
+      
+      plhs[0] = mxCreateDoubleMatrix(slraObj->getF()->getNp(), 1, mxREAL);
+      gsl_vector p_out = M2vec(plhs[0]);
+      rhm = M2trmat(rh = mxCreateDoubleMatrix(d, m, mxREAL));
+      gsl_matrix stm = M2trmat(mstats = mxCreateDoubleMatrix(4, nstarts, mxREAL));
+
+      best = slraObj->multiStart(&opt, matChkNIL(rinis), nstarts, perturb, 
+                 prune, matChkNIL(psi), &p_out, &rhm, &stm);
+      if (slraObj->isComplex()) {
+        complexOutput(slraObj, &plhs[0], &rh);
+      }
+      
+      if (nlhs > 1) {
+        mwSize l = 1;
+        const char *names[] = { RH_STR, FMIN_STR, ITER_STR, TIME_STR,
+                                BEST_STR, MSTATS_STR };
+        plhs[1] = mxCreateStructArray(1, &l, sizeof(names) / sizeof(names[0]), names);
+        mxSetField(plhs[1], 0, RH_STR, rh);
+        mxSetField(plhs[1], 0, FMIN_STR, mxCreateDoubleScalar(opt.fmin));
+        mxSetField(plhs[1], 0, ITER_STR, mxCreateDoubleScalar(opt.iter));
+        mxSetField(plhs[1], 0, TIME_STR, mxCreateDoubleScalar(opt.time));
+        mxSetField(plhs[1], 0, BEST_STR, mxCreateDoubleScalar(best + 1));
+        mxSetField(plhs[1], 0, MSTATS_STR, mstats);
+      } else {
+        mxDestroyArray(rh);
+        mxDestroyArray(mstats);
+      }
+      return;
+    }
+
+    if (!strcmp("start", str_buf)) { /* Start asynchronous optimization */
+      OptimizationOptions opt;
+      gsl_matrix rini = { 0, 0, 0, 0, 0, 0 }, psi = { 0, 0, 0, 0, 0, 0 };
+      gsl_matrix *crini = NULL;
+      if (nrhs > 2) {
+        mexFillOpt(prhs[2], opt, rini, psi, m, m-d); 
+        crini = complexRini(prhs[2], slraObj);
+      }  
+      try {
+        slraObj->optimizeAsync(&opt, crini != NULL ? crini : matChkNIL(rini),
+                               matChkNIL(psi));
+      } catch (Exception *e) {
+        gsl_matrix_free_ifnull(crini);
+        throw;
+      }
+      gsl_matrix_free_ifnull(crini);
+      return;
+    }
+    
+    if (!strcmp("poll", str_buf) || !strcmp("cancel", str_buf) ||
+        !strcmp("result", str_buf)) {
+      AsyncOptimization *async = slraObj->getAsync();
+      if (async == NULL) {
+        throw new Exception("No asynchronous optimization was started.");
+      }
+      if (!strcmp("cancel", str_buf)) {
+        async->cancel();
+        return;
+      } 
+      if (!strcmp("poll", str_buf)) {
+        AsyncProgress progress;
+        mwSize l = 1;
+        const char *names[] = { RUNNING_STR, ITER_STR, FMIN_STR, GRADNORM_STR,
+                                TIME_STR };
+        async->poll(&progress);
+        plhs[0] = mxCreateStructArray(1, &l, sizeof(names) / sizeof(names[0]), names);
+        mxSetField(plhs[0], 0, RUNNING_STR, mxCreateLogicalScalar(progress.running));
+        mxSetField(plhs[0], 0, ITER_STR, mxCreateDoubleScalar(progress.iter));
+        mxSetField(plhs[0], 0, FMIN_STR, mxCreateDoubleScalar(progress.fmin));
+        mxSetField(plhs[0], 0, GRADNORM_STR, mxCreateDoubleScalar(progress.gradNorm));
+        mxSetField(plhs[0], 0, TIME_STR, mxCreateDoubleScalar(progress.time));
+        return;
+      }
+      /* result: wait for the worker */
+      OptimizationOptions opt;
+      mxArray *rh;
+      plhs[0] = mxCreateDoubleMatrix(slraObj->getF()->getNp(), 1, mxREAL);
+      gsl_vector p_out = M2vec(plhs[0]);
+      gsl_matrix rhm = M2trmat(rh = mxCreateDoubleMatrix(d, m, mxREAL));
+      
+      async->getResult(&opt, &p_out, &rhm);
+      if (slraObj->isComplex()) {
+        complexOutput(slraObj, &plhs[0], &rh);
+      }
+      if (nlhs > 1) {
+        mwSize l = 1;
+        const char *names[] = { RH_STR, FMIN_STR, ITER_STR, TIME_STR };
+        plhs[1] = mxCreateStructArray(1, &l, sizeof(names) / sizeof(names[0]), names);
+        mxSetField(plhs[1], 0, RH_STR, rh);
+        mxSetField(plhs[1], 0, FMIN_STR, mxCreateDoubleScalar(opt.fmin));
+        mxSetField(plhs[1], 0, ITER_STR, mxCreateDoubleScalar(opt.iter));
+        mxSetField(plhs[1], 0, TIME_STR, mxCreateDoubleScalar(opt.time));
+      } else {
+        mxDestroyArray(rh);
+      }
+      return;
+    }
+
     if (nlhs <= 0) {
       throw new Exception("Output arguments should be provided.");        
     }
 
     if (!strcmp("getRini", str_buf)) {
       gsl_matrix rini = M2trmat(plhs[0] = mxCreateDoubleMatrix(d, m, mxREAL));
-      slraObj->getF()->computeDefaultRTheta(&rini);
+      slraObj->computeDefaultRTheta(&rini);
       return;
     }
     if (!strcmp("getM", str_buf)) {
@@ -110,9 +331,31 @@ void mexFunction( int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[] )
     gsl_matrix R = M2trmat(prhs[2]);
     
     if (!strcmp("func", str_buf)) {
-      double res;
-      slraObj->getF()->computeFuncAndGrad(&R, &res, NULL, NULL);      
-      plhs[0] = mxCreateDoubleScalar(res);
+      if (R.size2 == (size_t)d) {
+        double res;
+        slraObj->getF()->computeFuncAndGrad(&R, &res, NULL, NULL);
+        plhs[0] = mxCreateDoubleScalar(res);
+        return;
+      }
+      /* k stacked d x m blocks: one call for k candidates */
+      if (R.size1 != (size_t)m || R.size2 % d != 0) {
+        throw new Exception("R should be a (k*(m-r)) x m matrix.");
+      }
+      size_t k = R.size2 / d;
+      gsl_vector res = M2vec(plhs[0] = mxCreateDoubleMatrix(1, k, mxREAL));
+      gsl_matrix *Rt_i = gsl_matrix_alloc(m, d);
+      try {
+        for (size_t i = 0; i < k; i++) {
+          gsl_matrix R_i = gsl_matrix_submatrix(&R, 0, i * d, m, d).matrix;
+          gsl_matrix_memcpy(Rt_i, &R_i);
+          slraObj->getF()->computeFuncAndGrad(Rt_i, gsl_vector_ptr(&res, i),
+                                              NULL, NULL);
+        }
+      } catch (Exception *e) {
+        gsl_matrix_free(Rt_i);
+        throw;
+      }
+      gsl_matrix_free(Rt_i);
       return;
     }
     if (!strcmp("grad", str_buf)) {
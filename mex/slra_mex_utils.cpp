@@ -17,6 +17,23 @@ gsl_vector M2vec( const mxArray * mat ) {
   return res;
 }
 
+gsl_matrix M2trmatIm( const mxArray * mat ) {
+  gsl_matrix res = { 0, 0, 0, 0, 0, 0 };
+  if (mat != NULL && mxGetN(mat) != 0 && mxGetM(mat) != 0 && mxIsComplex(mat)) {
+    res = gsl_matrix_const_view_array(mxGetPi(mat),mxGetN(mat),mxGetM(mat)).matrix;
+  }
+  return res;
+}
+
+gsl_vector M2vecIm( const mxArray * mat ) {
+  gsl_vector res = { 0, 0, 0, 0, 0 };
+  if (mat != NULL && mxGetN(mat) != 0 && mxGetM(mat) != 0 && mxIsComplex(mat)) {
+    res = gsl_vector_const_view_array(mxGetPi(mat), 
+                                      mxGetN(mat) * mxGetM(mat)).vector;
+  }
+  return res;
+}
+
 char *M2Str( mxArray *myMat, char *str, size_t max_len ) {
   if (myMat == NULL) {
     *str = 0;
@@ -36,6 +53,10 @@ void mexFillOpt( const mxArray *Mopt, OptimizationOptions &opt,
     Log::str2DispLevel(M2Str(mxGetField(Mopt, 0, DISP_STR), str_buf, 
                              STR_MAX_LEN));
     Rini = M2trmat(mxGetField(Mopt, 0, RINI_STR));
+    if (mxGetField(Mopt, 0, RINI_STR) != NULL && 
+        mxIsComplex(mxGetField(Mopt, 0, RINI_STR))) { /* Realified by the caller */
+      Rini.data = NULL; 
+    }
     if (Rini.data != NULL && (Rini.size2 != (m-r) || Rini.size1 != m)) {
       throw new Exception("Incorrect Rini\n");   
     }
@@ -58,11 +79,26 @@ void mexFillOpt( const mxArray *Mopt, OptimizationOptions &opt,
     MATStoreOption(Mopt, opt, epsgrad, 0, 1);
     MATStoreOption(Mopt, opt, epsx, 0, 1);
     MATStoreOption(Mopt, opt, maxx, 0, numeric_limits<double>::max());
+    MATStoreOption(Mopt, opt, maxtime, 0, numeric_limits<double>::max());
     MATStoreOption(Mopt, opt, step, 0, 1);
     MATStoreOption(Mopt, opt, tol, 0, 1);
+    MATStoreOption(Mopt, opt, epscov, 0, 1);
+    MATStoreOption(Mopt, opt, cov_diag, 0, 1);
+    MATStoreOption(Mopt, opt, lbfgs_mem, 1, 1000);
+    MATStoreOption(Mopt, opt, lm_solver, 0, 3);
+    MATStoreOption(Mopt, opt, sketch_size, 0, numeric_limits<int>::max());
+    MATStoreOption(Mopt, opt, sample_init, 0, numeric_limits<int>::max());
+    MATStoreOption(Mopt, opt, sample_growth, 1, numeric_limits<double>::max());
     MATStoreOption(Mopt, opt, reggamma, 0, numeric_limits<double>::max());
+    MATStoreOption(Mopt, opt, tol_m, 0, 1);
     MATStoreOption(Mopt, opt, ls_correction, 0, 1);
     MATStoreOption(Mopt, opt, avoid_xi, 0, 1);
+    MATStoreOption(Mopt, opt, xi_maxabs, 0, numeric_limits<double>::max());
+    M2Str(mxGetField(Mopt, 0, CHKPT_FILE_STR), opt.chkpt_file, 
+          SLRA_CHKPT_FILE_LEN);
+    MATStoreOption(Mopt, opt, chkpt_iter, 0, numeric_limits<int>::max());
+    MATStoreOption(Mopt, opt, chkpt_time, 0, numeric_limits<double>::max());
+    MATStoreOption(Mopt, opt, resume, 0, 1);
   }
 }
 
@@ -19,6 +19,10 @@ gsl_matrix M2trmat(  const mxArray * mat );
 
 gsl_vector M2vec( const mxArray * mat );
 
+/* Imaginary parts (empty if mat is real) */
+gsl_matrix M2trmatIm( const mxArray * mat );
+gsl_vector M2vecIm( const mxArray * mat );
+
 char *M2Str( mxArray *myMat, char *str, size_t max_len );
 
 #define MATStoreOption(MAT, opt, name, lvalue, uvalue)  \
@@ -40,6 +40,9 @@
 %          'c' --- efficient C++ solver       (calls SLRA_MEX_OBJ)
 %          'm' --- general solver             (calls SLRA_EXT)
 %          'r' --- factorization-based solver (calls REG_SLRA)
+%      opt.tol_m - relative tolerance of the rank in the elimination of 
+%                  the missing values (NaN elements of p) by the solver 'c'
+%                  (default 1e-10)
 %
 %      ... (additional fields, e.g. opt.psi, depend on the solver being used,
 %            see the description of the opt parameter in the solver files help)
@@ -63,8 +66,11 @@ function [ph, info] = slra(p, s, r, opt)
 if ~exist('opt'), opt = struct; end
 if ~isfield(opt, 'solver'), opt.solver = 'c'; end 
 if ~isfield(opt, 'disp'), opt.disp = 'off'; end 
-if ~isfield(opt, 'tol_m'), opt.tol_m = 1e-6; end 
 Im = find(isnan(p));
+if ~isempty(Im) && isfield(s, 'tts')
+  if ~isfield(s, 'w'), s.w = ones(size(p)); end 
+  p(Im) = 0; s.w(Im) = 0; Im = [];
+end
 if ~isempty(Im)
   if ~isfield(s, 'w'), s.w = ones(size(p)); end 
   q = length(s.m); if exist('p'), 
@@ -89,8 +95,9 @@ if ~isempty(Im)
   p(Im) = 0; s.w(Im) = 0;
 end
 if opt.solver == 'c'
-  if isfield(s, 'w'), s.w(find(s.w == 0)) = opt.tol_m; end
   opt = rmfield(opt, 'solver');
+  if isfield(s, 'tts'), s.tts = double(s.tts); end
+  if isfield(s, 'S0'), s.S0 = double(s.S0); end
   obj = slra_mex_obj('new', p, s, r);
   [ph, info] = slra_mex_obj('optimize', obj, opt);
   slra_mex_obj('delete', obj);
@@ -4,7 +4,39 @@
 % 
 %  obj = SLRA_MEX_OBJ('new', p, s, r) - creates an SLRA object, based on the 
 %  parameters p, s, r described in the documentation of the slra function. 
-%  Only mosaic-Hankel-like structure Phi * H and non-zero weights are allowed.
+%  Only mosaic-Hankel-like structure Phi * H, or a general affine structure
+%  S0 + ph(tts) with elementwise weights, is allowed. Zero weights (missing 
+%  values) are supported, the missing values being imputed for each R.
+%  For the affine structure, the columns of S(ph) are internally reordered
+%  to decrease the bandwidth of the Gamma matrix. If the bandwidth remains
+%  large, s.hodlr_tol (e.g., 1e-10) selects a hierarchical factorization of 
+%  Gamma with low-rank off-diagonal blocks, computed with this tolerance.
+%  For the mosaic structure, s.toeplitz (a scalar or a vector of length N)
+%  marks the block columns that are layered Toeplitz instead of Hankel,
+%  with the blocks toeplitz(ph_ij(m_i:-1:1), ph_ij(m_i:(m_i + n_j - 1))).
+%  This replaces the row-reversing permutation s.phi for Toeplitz data.
+%  A layered 2-D (Hankel-block-Hankel) structure is selected by the fields
+%  s.m2d = [m1; m2] (a 2 x q matrix of block sizes of the layers) and
+%  s.n2d = [n1 n2]. The l-th layer is a block-Hankel matrix with
+%  m1(l) x n1 Hankel blocks of size m2(l) x n2, and its parameter vector
+%  is the vectorized (m2(l) + n2 - 1) x (m1(l) + n1 - 1) array (2-D signal).
+%  In this case, s.w is the vector of q layer weights (Inf for fixed
+%  layers). The computational cost is the smallest when n2 <= n1.
+%  For the mosaic Hankel structure, s.wband (instead of s.w) specifies 
+%  correlated (moving average) noise: the inverse weight matrix of the l-th
+%  layer in each block column is the banded symmetric Toeplitz matrix with
+%  the first column [s.wband(:, l); 0; ...; 0], which should be positive 
+%  definite. The bandwidth of Gamma grows by the bandwidth of s.wband. 
+%  s.wband is not supported in the GCD mode and with s.toeplitz.
+%  If p is complex (only for the mosaic Hankel structure without s.phi and
+%  s.toeplitz), the weights are applied to |p - ph|.^2, and the problem is
+%  solved for the realified structure [real(S(p)); imag(S(p))], with R 
+%  constrained to the complex form [real(R) -imag(R); imag(R) real(R)]
+%  (opt.psi cannot be given). In the GCD mode (s.gcd), R = h' for the
+%  common divisor h (as for real data). 'optimize', 
+%  'multistart' and 'result' return complex ph and info.Rh, and opt.Rini 
+%  can be complex. The other commands (and opt.Rini if it is real, Rinis,
+%  info.RhK) use the realified problem and the realified R.
 %
 %  The created object allows evaluation of the VARPRO cost function f(R),  
 %   
@@ -18,6 +50,8 @@
 %
 %  f = SLRA_MEX_OBJ('func', obj, R) - for a given SLRA object obj,
 %  evaluates the VARPRO cost  function at a given (m-r) x m argument R.
+%  If R is a (k(m-r)) x m matrix (k stacked arguments), returns a 1 x k
+%  vector of the cost function values in a single call.
 %
 %  g = SLRA_MEX_OBJ('grad', obj, R) - for a given SLRA object obj,
 %  computes the VARPRO cost function matrix gradient at a given  R. 
@@ -35,16 +69,50 @@
 %              'n' - GSL Nelder-Mead derivative-free optimization method
 %              'p' - own implementation of Levenberg-Marquardt based 
 %                    on computing pseudoinverse
+%              'pa' - 'p' with geodesic acceleration
+%              'g' - own implementation of the Riemannian trust-region
+%                    method on the Grassmann manifold
+%              'b' - own implementation of the limited-memory BFGS method
+%                    (stops by opt.epsgrad or opt.maxiter only)
 %              a complete description of opt.method possible values is
 %              contained in the documentation of OptimizationOptions::str2Method
 % 
 %        * other optimization options:
 %          - advanced options
 %              opt.avoid_xi,  opt.ls_correction, opt.reggamma
+%              opt.xi_maxabs - if nonzero, the pivot rows of [X -I] are
+%                  switched when max(abs(X(:))) exceeds opt.xi_maxabs
+%                  (default 0 - the pivot rows are fixed)
+%          - missing values (zero weights, or NaN in p in SLRA)
+%              opt.tol_m - relative tolerance of the rank in the 
+%                  elimination of the missing values (default 1e-10)
 %          - stopping criteria 
-%              opt.epsabs, opt.epsrel, opt.epsgrad, opt.epsx, opt.maxx
+%              opt.epsabs, opt.epsrel, opt.epsgrad, opt.epsx, opt.maxx, opt.maxtime
 %          - method-specific minor parameters
-%              opt.step, opt.tol, opt.epscov
+%              opt.step, opt.tol, opt.epscov, opt.lbfgs_mem
+%              opt.lm_solver - step solver of the method 'p': 1 - SVD 
+%                  (default), 2 - pivoted QR, 3 - normal equations, 
+%                  0 - automatic choice between them
+%          - sketched Levenberg-Marquardt (only for the method 'p' with
+%            opt.ls_correction = 1)
+%              opt.sketch_size - if nonzero, the steps are computed from a
+%                  random sketch of the Jacobian with sketch_size rows, 
+%                  followed by full steps near convergence
+%          - stochastic warm start for mosaic structures with many blocks
+%              opt.sample_init - if nonzero, the optimization starts with 
+%                  steepest descent steps on random samples of opt.sample_init
+%                  blocks (elements of nk), growing by the factor
+%                  opt.sample_growth (default 1.2) until all the blocks are 
+%                  used, and is finished by opt.method on the full data
+%          - covariance info.vh of vec(X), where R' = Psi' [X; -I]
+%            (only for the methods 'l' and 'p')
+%              opt.cov_diag - if 1, only the variances (a column vector)
+%          - checkpointing
+%              opt.chkpt_file - file for saving the state of the optimization
+%              opt.chkpt_iter, opt.chkpt_time - save every chkpt_iter 
+%                  iterations (default 10) and/or every chkpt_time seconds
+%              opt.resume - if 1 and opt.chkpt_file exists, continue the
+%                  optimization from the saved state
 %          the complete description and default values are contained in 
 %          the documentation of the OptimizationOptions class.
 %
@@ -54,5 +122,42 @@
 %        * the options described in the documentation in slra.m
 %        * info.iterinfo - a structure which contains information on each iteration
 %  
+%% Multi-start optimization:
+%  [ph, info] = SLRA_MEX_OBJ('multistart', obj, opt, Rinis, K, perturb, prune)
+%   - runs optimization (with options opt) from several initial approximations,
+%     concurrently if the MEX object is compiled with OpenMP.
+%
+%  Input: 
+%      Rinis   - matrix with columns Rini(:) for each start; if empty, 
+%                the default initial approximation and K-1 its random 
+%                perturbations of relative size perturb (default 0.1) are used
+%      prune   - a start is stopped when its cost exceeds (1 + prune) times
+%                the best cost found so far (default 0, no pruning)
+%   Output:
+%      ph   - the approximation for the best start
+%      info - info.Rh, info.fmin, info.iter for the best start, 
+%             info.time (total), info.best (index of the best start), and
+%             info.mstats - 4 x K matrix with columns (fmin, iter, time, status),
+%                    status: 0 - finished, 1 - pruned, 2 - failed
+%
+%% Asynchronous optimization:
+%  SLRA_MEX_OBJ('start', obj, opt) - starts the optimization (with options opt)
+%  on a worker thread and returns immediately. The display is turned off
+%  until the result is obtained.
+%
+%  progress = SLRA_MEX_OBJ('poll', obj) - returns the progress:
+%      progress.running - true while the optimization is running,
+%      progress.iter, progress.fmin, progress.gradnorm - the last iteration,
+%      progress.time - elapsed time
+%
+%  SLRA_MEX_OBJ('cancel', obj) - requests the optimization to stop 
+%  (at the end of the current iteration).
+%
+%  [ph, info] = SLRA_MEX_OBJ('result', obj) - waits for the optimization
+%  to finish and returns the results (info.Rh, info.fmin, info.iter, info.time).
+%
+%  The option opt.maxtime (also for 'optimize') limits the wall-clock time, 
+%  the last iterate being returned.
+%
 %% See also
 %   slra, OptimizationOptions, OptimizationOptions::str2Method(), SLRAObject
\ No newline at end of file
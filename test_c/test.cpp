@@ -46,6 +46,1500 @@ void meas_time( VarproFunction &costFun,
   gsl_vector_free(grad);
 }
 
+/* Multi-start from MS_STARTS perturbations of the default R (concurrent if
+ * compiled with OpenMP) vs. the same starts run one after another:
+ *   fmin  - f of the best start (multi-start)
+ *   fmin2 - f of the best start (serial runs)
+ *   diff  - max. relative difference of f over the starts, 
+ *           1 if the numbers of iterations differ */
+#define MS_STARTS 4
+void run_multistart( SLRAObject *so, OptimizationOptions *opt, double &time,
+                     double &fmin, double &fmin2, int &iter, double &diff ) {
+  size_t m = so->getF()->getNrow(), d = so->getF()->getD(), k, i;
+  gsl_matrix *Rinis = gsl_matrix_alloc(MS_STARTS, m * d);
+  gsl_matrix *stats = gsl_matrix_alloc(MS_STARTS, 4);
+  gsl_matrix *R = gsl_matrix_alloc(m, d);
+  OptimizationOptions opt0 = *opt, opt_k;
+
+  so->computeDefaultRTheta(R);
+  for (k = 0; k < MS_STARTS; k++) {
+    for (i = 0; i < m * d; i++) {
+      gsl_matrix_set(Rinis, k, i, gsl_matrix_get(R, i / d, i % d) + 
+                                  0.1 * k * sin((double)(i + k)));
+    }
+  }
+  so->multiStart(opt, Rinis, MS_STARTS, 0, 0, NULL, NULL, NULL, stats);
+  time = opt->time;
+  iter = opt->iter;
+  fmin = opt->fmin;
+  fmin2 = GSL_POSINF;
+  diff = 0;
+  for (k = 0; k < MS_STARTS; k++) {
+    gsl_vector Rkvec = gsl_matrix_row(Rinis, k).vector;
+    gsl_matrix Rk = gsl_matrix_view_vector(&Rkvec, m, d).matrix;
+
+    opt_k = opt0;
+    so->optimize(&opt_k, &Rk, NULL, NULL, R, NULL);
+    fmin2 = mymin(fmin2, opt_k.fmin);
+    diff = mymax(diff, fabs(opt_k.fmin - gsl_matrix_get(stats, k, 0)) /
+                       mymax(opt_k.fmin, 1));
+    if (opt_k.iter != gsl_matrix_get(stats, k, 1)) {
+      diff = 1;
+    }
+  }
+  gsl_matrix_free(Rinis);
+  gsl_matrix_free(stats);
+  gsl_matrix_free(R);
+}
+
+/* Iteration logger that requests to stop at the k-th check */
+class StopLogger : public IterationLogger {
+  size_t myK, myChecks;
+public:
+  StopLogger( size_t k ) : myK(k), myChecks(0) {}
+  virtual void reportIteration( int /* no */, const gsl_vector * /* x */, 
+                   double /* fmin */, const gsl_vector * /* grad */ ) {}
+  virtual bool stopRequested() { return ++myChecks >= myK; }
+  bool stopped() const { return myChecks >= myK; }
+};
+
+/* Asynchronous optimization vs. the synchronous one, and stopping:
+ *   fmin  - f of the asynchronous run (started, polled and waited for)
+ *   fmin2 - f of the synchronous run
+ *   iter  - number of the runs stopped at the k-th check of 
+ *           IterationLogger::stopRequested(), k = 1, ..., ASYNC_STOPS
+ *   diff  - max. of the relative difference of fmin and fmin2, 1 if 
+ *           the numbers of iterations or the polled progress differ,
+ *           and, for the run with a zero time budget (opt.maxtime), 
+ *           the run cancelled right after the start and the stopped runs,
+ *           the relative error of the reported f w.r.t. f at the 
+ *           returned point, its increase w.r.t. f at the initial point 
+ *           (returned with the zero time budget), and 1 if the stopped 
+ *           run makes more iterations (or any for the zero budget) */
+#define ASYNC_STOPS 12
+void run_async( SLRAObject *so, OptimizationOptions *opt, double &time,
+                double &fmin, double &fmin2, int &iter, double &diff ) {
+  VarproFunction *F = so->getF();
+  size_t m = F->getNrow(), d = F->getD(), k;
+  gsl_matrix *Rini = gsl_matrix_alloc(m, d), *R = gsl_matrix_alloc(m, d);
+  OptimizationOptions opt0 = *opt, opt_a = *opt, opt_k;
+  AsyncProgress progress;
+  double f_ini = GSL_POSINF, f;
+
+  so->computeDefaultRTheta(Rini);
+  so->optimize(opt, NULL, NULL, NULL, R, NULL);
+  time = opt->time;
+  fmin2 = opt->fmin;
+
+  /* Start, poll and wait */
+  AsyncOptimization *async = so->optimizeAsync(&opt_a, NULL, NULL);
+  async->poll(&progress);
+  async->getResult(&opt_a, NULL, R);
+  fmin = opt_a.fmin;
+  diff = fabs(fmin - fmin2) / mymax(fmin2, 1);
+  async->poll(&progress);
+  if (opt_a.iter != opt->iter || progress.running || 
+      progress.iter != (size_t)opt_a.iter || progress.fmin != opt_a.fmin) {
+    diff = 1;
+  }
+
+  /* A zero time budget (f_ini is f at the initial point), and cancelling 
+   * right after the start */
+  for (k = 0; k < 2; k++) {
+    opt_k = opt0;
+    opt_k.maxtime = (k == 0 ? 1e-12 : 0);
+    async = so->optimizeAsync(&opt_k, NULL, NULL);
+    if (k == 1) {
+      async->cancel();
+    }
+    async->getResult(&opt_k, NULL, R);
+    F->computeFuncAndGrad(R, &f, NULL, NULL);
+    f_ini = (k == 0 ? opt_k.fmin : f_ini);
+    diff = mymax(diff, fabs(opt_k.fmin - f) / mymax(f, 1));
+    diff = mymax(diff, (f - f_ini) / mymax(f_ini, 1));
+    if (opt_k.iter > opt->iter || (k == 0 && opt_k.iter != 0)) {
+      diff = 1;
+    }
+  }
+
+  /* Stop at the k-th check (in the iterations, line searches and 
+   * the trial steps) */
+  for (k = 1, iter = 0; k <= ASYNC_STOPS; k++) {
+    StopLogger stopLog(k);
+    opt_k = opt0;
+    NLSVarpro *optFun = SLRAObject::createNLSVarpro(*F, &opt_k, NULL);
+    gsl_vector *x = gsl_vector_alloc(optFun->getNvar());
+    optFun->RTheta2x(Rini, x);
+    SLRAObject::runOptimization(&opt_k, optFun, x, NULL, &stopLog);
+    optFun->computeFuncAndGrad(x, &f, NULL);
+    diff = mymax(diff, fabs(opt_k.fmin - f) / mymax(f, 1));
+    diff = mymax(diff, (f - f_ini) / mymax(f_ini, 1));
+    if (opt_k.iter > opt->iter) {
+      diff = 1;
+    }
+    iter += stopLog.stopped();
+    gsl_vector_free(x);
+    delete optFun;
+  }
+  gsl_matrix_free(Rini);
+  gsl_matrix_free(R);
+}
+
+/* Dense reference of the cost function: f(R) = s^T y, where
+ *   [Gamma_o  G_m] [y  ]   [s]
+ *   [G_m^T    0  ] [p_m] = [0]
+ * is the KKT system of min ||p - \hat{p}||_W s.t. S(\hat{p}) R = 0,
+ * s = vec(S(p) R), G = ds/dp, Gamma_o = G_o W_o^{-1} G_o^T, W^{-1} e_k is 
+ * computed by Structure::multByWInv(), and the subscripts o and m select 
+ * the observed and the missing values (p_m = 0) */
+double dense_cost( Structure *S, const gsl_matrix *R, const gsl_vector *p ) {
+  size_t n = S->getN(), d = R->size2, np = S->getNp(), nd = n * d, nm = 0, 
+         k, l, one = 1, info = 0, nk;
+  gsl_matrix *c = gsl_matrix_alloc(n, S->getM());
+  gsl_matrix *G = gsl_matrix_alloc(np, nd), *WG = gsl_matrix_alloc(np, nd);
+  gsl_matrix *Winv = gsl_matrix_alloc(np, np);
+  gsl_vector *e = gsl_vector_calloc(np), *p0 = gsl_vector_alloc(np),
+             *s = gsl_vector_alloc(nd);
+  gsl_matrix sMat = gsl_matrix_view_vector(s, n, d).matrix;
+  double f;
+
+  /* Rows of G: G e_k = vec((S(e_k) - S(0)) R), rows of W^{-1} */
+  S->fillMatrixFromP(c, e);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c, R, 0, &sMat);
+  for (k = 0; k < np; k++) {
+    gsl_vector G_k = gsl_matrix_row(G, k).vector;
+    gsl_matrix GkMat = gsl_matrix_view_vector(&G_k, n, d).matrix;
+    gsl_vector_set_basis(e, k);
+    S->fillMatrixFromP(c, e);
+    gsl_matrix_memcpy(&GkMat, &sMat);
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c, R, -1, &GkMat);
+    S->multByWInv(e, 2);
+    gsl_matrix_set_row(Winv, k, e);
+  }
+  gsl_vector_memcpy(p0, p);
+  for (k = 0; k < np; k++) {
+    if (S->isMissing(k)) {
+      gsl_vector_set(p0, k, 0);
+      gsl_vector Winv_row = gsl_matrix_row(Winv, k).vector,
+                 Winv_col = gsl_matrix_column(Winv, k).vector;
+      gsl_vector_set_zero(&Winv_row);
+      gsl_vector_set_zero(&Winv_col);
+      nm++;
+    }
+  }
+  S->fillMatrixFromP(c, p0);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c, R, 0, &sMat);
+
+  nk = nd + nm;
+  gsl_matrix *K = gsl_matrix_calloc(nk, nk);
+  gsl_vector *y = gsl_vector_calloc(nk);
+  size_t *ipiv = new size_t[nk];
+  gsl_matrix Gam = gsl_matrix_submatrix(K, 0, 0, nd, nd).matrix;
+  gsl_vector y_s = gsl_vector_subvector(y, 0, nd).vector;
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, Winv, G, 0, WG);
+  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, G, WG, 0, &Gam);
+  for (k = 0, l = nd; k < np; k++) {
+    if (S->isMissing(k)) {
+      gsl_vector G_k = gsl_matrix_row(G, k).vector;
+      for (size_t i = 0; i < nd; i++) {
+        gsl_matrix_set(K, l, i, gsl_vector_get(&G_k, i));
+        gsl_matrix_set(K, i, l, gsl_vector_get(&G_k, i));
+      }
+      l++;
+    }
+  }
+  gsl_vector_memcpy(&y_s, s);
+  dgesv_(&nk, &one, K->data, &K->tda, ipiv, y->data, &nk, &info);
+  gsl_blas_ddot(s, &y_s, &f);
+  if (info != 0) {
+    f = GSL_NAN;
+  }
+  delete [] ipiv;
+  gsl_matrix_free(K);
+  gsl_vector_free(y);
+  gsl_matrix_free(c);
+  gsl_matrix_free(G);
+  gsl_matrix_free(WG);
+  gsl_matrix_free(Winv);
+  gsl_vector_free(e);
+  gsl_vector_free(p0);
+  gsl_vector_free(s);
+  return f;
+}
+
+/* Missing values (every 7th parameter is NaN with zero weight): 
+ *   fmin  - f at the computed R
+ *   fmin2 - dense_cost at the computed R
+ *   iter  - number of the missing values
+ *   diff  - max. of the error of f relative to f at the initial R,
+ *           the change of f after an evaluation at another R, and 
+ *           the relative error of the gradient at the initial R 
+ *           (central differences) */
+#define MISSING_STEP 7
+#define FD_H 1e-6
+/* Relative error of the gradient at R w.r.t. central differences */
+double grad_error( VarproFunction *F, gsl_matrix *R ) {
+  gsl_matrix *grad = gsl_matrix_alloc(R->size1, R->size2);
+  double f, f_p, f_m, g_err = 0, g_norm = 0;
+
+  F->computeFuncAndGrad(R, &f, NULL, grad);
+  for (size_t i = 0; i < R->size1 * R->size2; i++) {
+    double r = R->data[i];
+    R->data[i] = r + FD_H;
+    F->computeFuncAndGrad(R, &f_p, NULL, NULL);
+    R->data[i] = r - FD_H;
+    F->computeFuncAndGrad(R, &f_m, NULL, NULL);
+    R->data[i] = r;
+    f_p = (f_p - f_m) / (2 * FD_H) - grad->data[i];
+    g_err += f_p * f_p;
+    g_norm += grad->data[i] * grad->data[i];
+  }
+  gsl_matrix_free(grad);
+  return sqrt(g_err / g_norm);
+}
+
+void run_missing( SLRAObject *so, OptimizationOptions *opt, double &time,
+                  double &fmin, double &fmin2, int &iter, double &diff ) {
+  VarproFunction *F = so->getF();
+  size_t m = F->getNrow(), d = F->getD(), i;
+  gsl_matrix *Rini = gsl_matrix_alloc(m, d), *R = gsl_matrix_alloc(m, d);
+  double f_ini, f, f_again, g_err;
+
+  so->computeDefaultRTheta(Rini);
+  F->computeFuncAndGrad(Rini, &f_ini, NULL, NULL);
+  g_err = grad_error(F, Rini);
+
+  so->optimize(opt, Rini, NULL, NULL, R, NULL);
+  time = opt->time;
+  F->computeFuncAndGrad(R, &fmin, NULL, NULL);
+  F->computeFuncAndGrad(Rini, &f, NULL, NULL);
+  F->computeFuncAndGrad(R, &f_again, NULL, NULL);
+  fmin2 = dense_cost(so->getS(), R, F->getP());
+  for (i = 0, iter = 0; i < F->getNp(); i++) {
+    iter += so->getS()->isMissing(i);
+  }
+  diff = mymax(fabs(fmin - fmin2) / f_ini, fabs(f_again - fmin));
+  diff = mymax(diff, g_err);
+  gsl_matrix_free(Rini);
+  gsl_matrix_free(R);
+}
+
+/* Checkpointing (with the missing values of the test type 'n'): the run 
+ * is stopped after half of the iterations of the uninterrupted run (rounded
+ * down, since the convergence status is not saved), saving a checkpoint 
+ * at each iteration, and resumed from the checkpoint file:
+ *   fmin  - f of the resumed run
+ *   fmin2 - f of the uninterrupted run
+ *   iter  - total number of iterations of the resumed run
+ *   diff  - relative difference of f plus max. difference of R, 
+ *           1 if the numbers of iterations differ */
+#define CHKPT_TEST_FILE "chkpt_test.bin"
+void run_resume( SLRAObject *so, OptimizationOptions *opt, double &time,
+                 double &fmin, double &fmin2, int &iter, double &diff ) {
+  size_t m = so->getF()->getNrow(), d = so->getF()->getD();
+  gsl_matrix *Rini = gsl_matrix_alloc(m, d), *R = gsl_matrix_alloc(m, d),
+             *R2 = gsl_matrix_alloc(m, d);
+  OptimizationOptions opt0 = *opt, opt_k;
+
+  so->computeDefaultRTheta(Rini);
+  so->optimize(opt, Rini, NULL, NULL, R, NULL);
+  fmin2 = opt->fmin;
+
+  remove(CHKPT_TEST_FILE);
+  opt_k = opt0;
+  strcpy(opt_k.chkpt_file, CHKPT_TEST_FILE);
+  opt_k.chkpt_iter = 1;
+  opt_k.maxiter = opt->iter / 2;
+  so->optimize(&opt_k, Rini, NULL, NULL, R2, NULL);
+  opt_k = opt0;
+  strcpy(opt_k.chkpt_file, CHKPT_TEST_FILE);
+  opt_k.chkpt_iter = 1;
+  opt_k.resume = 1;
+  so->optimize(&opt_k, Rini, NULL, NULL, R2, NULL);
+  remove(CHKPT_TEST_FILE);
+
+  time = opt_k.time;
+  iter = opt_k.iter;
+  fmin = opt_k.fmin;
+  gsl_matrix_sub(R2, R);
+  diff = fabs(fmin - fmin2) / fmin2 + 
+         mymax(gsl_matrix_max(R2), -gsl_matrix_min(R2));
+  if (opt_k.iter != opt->iter) {
+    diff = 1;
+  }
+  gsl_matrix_free(Rini);
+  gsl_matrix_free(R);
+  gsl_matrix_free(R2);
+}
+
+/* Covariance of X (method 'p') computed by the QR and the normal equations
+ * step solvers vs. the SVD solver at the same R (opt.maxiter = 0 after the
+ * SVD run), for opt.epscov and for a threshold COV_EPS_TRUNC that makes
+ * J rank deficient for all but the well-conditioned Jacobians:
+ *   fmin  - f of the SVD run
+ *   fmin2 - f at the same R (QR solver)
+ *   iter  - number of iterations of the SVD run
+ *   diff  - max. difference of the covariances relative to the max.
+ *           element of the SVD covariance */
+#define COV_EPS_TRUNC 0.5
+void run_cov( SLRAObject *so, OptimizationOptions *opt, double &time,
+              double &fmin, double &fmin2, int &iter, double &diff ) {
+  size_t m = so->getF()->getNrow(), d = so->getF()->getD(), 
+         nv = (m - d) * d, e, k;
+  gsl_matrix *R = gsl_matrix_alloc(m, d), *v_svd = gsl_matrix_alloc(nv, nv),
+             *v = gsl_matrix_alloc(nv, nv);
+  int solvers[] = { SLRA_OPT_LM_SOLVER_QR, SLRA_OPT_LM_SOLVER_CHOL };
+  double epscovs[] = { opt->epscov, COV_EPS_TRUNC }, v_max;
+  OptimizationOptions opt0 = *opt, opt_k;
+
+  opt->lm_solver = SLRA_OPT_LM_SOLVER_SVD;
+  so->optimize(opt, NULL, NULL, NULL, R, NULL);
+  time = opt->time;
+  iter = opt->iter;
+  fmin = opt->fmin;
+  diff = 0;
+  for (e = 0; e < 2; e++) {
+    opt_k = opt0;
+    opt_k.maxiter = 0;
+    opt_k.epscov = epscovs[e];
+    opt_k.lm_solver = SLRA_OPT_LM_SOLVER_SVD;
+    so->optimize(&opt_k, R, NULL, NULL, NULL, v_svd);
+    v_max = mymax(gsl_matrix_max(v_svd), -gsl_matrix_min(v_svd));
+    for (k = 0; k < 2; k++) {
+      opt_k.lm_solver = solvers[k];
+      so->optimize(&opt_k, R, NULL, NULL, NULL, v);
+      if (e == 0 && k == 0) {
+        fmin2 = opt_k.fmin;
+      }
+      gsl_matrix_sub(v, v_svd);
+      diff = mymax(diff, fabs(mymax(gsl_matrix_max(v), -gsl_matrix_min(v))) /
+                         v_max);
+    }
+  }
+  gsl_matrix_free(R);
+  gsl_matrix_free(v_svd);
+  gsl_matrix_free(v);
+}
+
+/* Adaptation of the pivot rows of [X; -I] (opt.xi_maxabs = XI_MAXABS, 
+ * method 'p') vs. the fixed pivot rows (opt.xi_maxabs = 0). The 
+ * covariance of X is compared at the R returned by the run with the 
+ * adaptation (opt.maxiter = 0, RTheta2x() switches the pivot rows if 
+ * max|X| > XI_MAXABS) with the Jacobian of the correction 
+ * (ls_correction = 1) and opt.epscov = XI_EPSCOV: the Gauss-Newton 
+ * covariance of the compact pseudo-Jacobian depends on the normalization
+ * of R if f > 0, and so does the truncation of the ill-conditioned J.
+ *   fmin  - f of the run with the adaptation
+ *   fmin2 - f of the run with the fixed pivot rows
+ *   iter  - number of iterations of the run with the adaptation
+ *   diff  - relative excess of fmin over fmin2 (the adaptation may reach 
+ *           a lower local minimum, e.g. in test 8), plus the max. 
+ *           difference of the covariances relative to the max. element 
+ *           of the fixed one, plus the max. difference of the returned R
+ *           (normalizeRTheta()) and the given one */
+#define XI_MAXABS 10
+#define XI_EPSCOV 1e-15
+void run_xi( SLRAObject *so, OptimizationOptions *opt, double &time,
+             double &fmin, double &fmin2, int &iter, double &diff ) {
+  size_t m = so->getF()->getNrow(), d = so->getF()->getD(), 
+         nv = (m - d) * d;
+  gsl_matrix *R = gsl_matrix_alloc(m, d), *R2 = gsl_matrix_alloc(m, d),
+             *v = gsl_matrix_alloc(nv, nv), *v_fix = gsl_matrix_alloc(nv, nv);
+  OptimizationOptions opt_k = *opt;
+  double v_max;
+
+  opt->xi_maxabs = 0;
+  so->optimize(opt, NULL, NULL, NULL, NULL, NULL);
+  fmin2 = opt->fmin;
+
+  opt_k.xi_maxabs = XI_MAXABS;
+  so->optimize(&opt_k, NULL, NULL, NULL, R, NULL);
+  time = opt_k.time;
+  iter = opt_k.iter;
+  fmin = opt_k.fmin;
+
+  opt_k.maxiter = 0;
+  opt_k.ls_correction = 1;
+  opt_k.epscov = XI_EPSCOV;
+  so->optimize(&opt_k, R, NULL, NULL, R2, v);
+  opt_k.xi_maxabs = 0;
+  so->optimize(&opt_k, R, NULL, NULL, NULL, v_fix);
+  v_max = mymax(gsl_matrix_max(v_fix), -gsl_matrix_min(v_fix));
+  gsl_matrix_sub(v, v_fix);
+  gsl_matrix_sub(R2, R);
+  diff = mymax(0, (fmin - fmin2) / fmin2) + 
+         mymax(gsl_matrix_max(v), -gsl_matrix_min(v)) / v_max +
+         mymax(gsl_matrix_max(R2), -gsl_matrix_min(R2));
+  gsl_matrix_free(R);
+  gsl_matrix_free(R2);
+  gsl_matrix_free(v);
+  gsl_matrix_free(v_fix);
+}
+
+/* Sketched LM (method 'p' with ls_correction = 1 and opt.sketch_size = 
+ * SKETCH_FACTOR times the number of variables) vs. the full LM. The sketch
+ * is not used if it is not smaller than the Jacobian of the correction.
+ * The sketched run continues with the full Jacobian near convergence, 
+ * therefore it should reach the same minimum as the full run, and return
+ * the same f if started at the minimum point of the full run:
+ *   fmin  - f of the sketched run from the default initial approximation
+ *   fmin2 - f of the full run from the same point
+ *   iter  - number of iterations of the sketched run
+ *   diff  - relative excess of fmin over fmin2, plus the relative excess 
+ *           of f of the sketched run started at the minimum point of the 
+ *           full run over fmin2 (the full run may stop by the dx test 
+ *           before the convergence, so the restart may decrease f).
+ *           In test 8, the sketched run reaches another local minimum
+ *           (f = 2462.95, with R growing without bound): diff = 0.12 */
+#define SKETCH_FACTOR 4
+void run_sketch( SLRAObject *so, OptimizationOptions *opt, double &time,
+                 double &fmin, double &fmin2, int &iter, double &diff ) {
+  size_t m = so->getF()->getNrow(), d = so->getF()->getD();
+  gsl_matrix *R = gsl_matrix_alloc(m, d);
+  OptimizationOptions opt_k;
+
+  opt->ls_correction = 1;
+  opt_k = *opt;
+  so->optimize(opt, NULL, NULL, NULL, R, NULL);
+  fmin2 = opt->fmin;
+
+  opt_k.sketch_size = SKETCH_FACTOR * (m - d) * d;
+  so->optimize(&opt_k, NULL, NULL, NULL, NULL, NULL);
+  time = opt_k.time;
+  iter = opt_k.iter;
+  fmin = opt_k.fmin;
+  so->optimize(&opt_k, R, NULL, NULL, NULL, NULL);
+  diff = mymax(0, (fmin - fmin2) / mymax(fmin2, 1)) + 
+         mymax(0, (opt_k.fmin - fmin2) / mymax(fmin2, 1));
+  gsl_matrix_free(R);
+}
+
+/* Warm start on samples of the blocks (opt.sample_init = 1 and 
+ * opt.sample_growth = SAMPLE_GROWTH, see sampledOptimize()) followed 
+ * by the given method vs. the run without it. The sampled terms are 
+ * checked at the default R (the check and the warm start are skipped if
+ * the structure has one block, e.g., with Phi): 
+ * f and the gradient on the single-block samples, divided by the scaling
+ * n_p / n_p^sample, add up to f and the gradient on the whole data:
+ *   fmin  - f of the run with the warm start
+ *   fmin2 - f of the run without it
+ *   iter  - number of iterations of the run with the warm start 
+ *           (without the sampled iterations)
+ *   diff  - relative excess of fmin over fmin2, plus the relative errors
+ *           of the sums of f and of the gradient */
+#define SAMPLE_GROWTH 1.5
+void run_sampled( SLRAObject *so, OptimizationOptions *opt, double &time,
+                  double &fmin, double &fmin2, int &iter, double &diff ) {
+  VarproFunction *F = so->getF();
+  size_t m = F->getNrow(), d = F->getD(), N = F->getNBlocks(), l;
+  gsl_matrix *R = gsl_matrix_alloc(m, d), *g = gsl_matrix_alloc(m, d),
+             *g_l = gsl_matrix_alloc(m, d), *g_sum = gsl_matrix_calloc(m, d);
+  OptimizationOptions opt_k = *opt;
+  double f, f_l, f_sum = 0, scale;
+
+  so->computeDefaultRTheta(R);
+  F->computeFuncAndGrad(R, &f, NULL, g);
+  diff = 0;
+  for (l = 0; N > 1 && l < N; l++) {
+    Structure *S_l = so->getS()->createBlockSubset(&l, 1);
+    scale = (double)S_l->getNp() / F->getNp();
+    delete S_l;
+    F->setBlockSample(&l, 1);
+    F->computeFuncAndGrad(R, &f_l, NULL, g_l);
+    f_sum += scale * f_l;
+    gsl_matrix_scale(g_l, scale);
+    gsl_matrix_add(g_sum, g_l);
+  }
+  if (N > 1) {
+    F->setBlockSample(NULL, 0);
+    gsl_matrix_sub(g_sum, g);
+    diff = fabs(f_sum - f) / mymax(f, 1) + 
+           mymax(gsl_matrix_max(g_sum), -gsl_matrix_min(g_sum)) / 
+           mymax(mymax(gsl_matrix_max(g), -gsl_matrix_min(g)), 1);
+  }
+
+  so->optimize(opt, NULL, NULL, NULL, NULL, NULL);
+  fmin2 = opt->fmin;
+  opt_k.sample_init = 1;
+  opt_k.sample_growth = SAMPLE_GROWTH;
+  so->optimize(&opt_k, NULL, NULL, NULL, NULL, NULL);
+  time = opt_k.time;
+  iter = opt_k.iter;
+  fmin = opt_k.fmin;
+  diff += mymax(0, (fmin - fmin2) / mymax(fmin2, 1));
+  gsl_matrix_free(R);
+  gsl_matrix_free(g);
+  gsl_matrix_free(g_l);
+  gsl_matrix_free(g_sum);
+}
+
+/* GCD mode, the Sylvester structure of GCD_N(t) polynomials of degrees
+ * 3 + t + j (t - test number) with the coefficients taken from p and 
+ * a common divisor of degree 1 + t % 3: the compact pseudo-Jacobian 
+ * (ls_correction = 0) vs. the Jacobian of the correction 
+ * (ls_correction = 1) at the initial R and at the minimum point found
+ * with the compact one (the runs with the two Jacobians may converge 
+ * to different local minima):
+ *   fmin  - f of the run with the compact pseudo-Jacobian
+ *   fmin2 - ||res||^2 of the correction at the minimum point
+ *   iter  - number of iterations of the run
+ *   diff  - max. of the relative errors of f = ||res||^2 and 
+ *           grad f = 2 J^T res w.r.t. computeFuncAndGrad() */
+#define GCD_N(t) (2 + (t) % 2)
+void gcd_func_and_grad( NLSFunction *fun, const gsl_vector *x, double &f, 
+                        gsl_vector *grad ) {
+  gsl_vector *res = gsl_vector_alloc(fun->getNsq());
+  gsl_matrix *jac = gsl_matrix_alloc(fun->getNsq(), fun->getNvar());
+  
+  fun->computeFuncAndJac(x, res, jac);
+  gsl_blas_ddot(res, res, &f);
+  gsl_blas_dgemv(CblasTrans, 2, jac, res, 0, grad);
+  gsl_vector_free(res);
+  gsl_matrix_free(jac);
+}
+
+void run_gcd( const char *testname, const gsl_vector *p, 
+              OptimizationOptions *opt, double &time, double &fmin, 
+              double &fmin2, int &iter, double &diff ) {
+  int t = atoi(testname);
+  size_t N = GCD_N(t), d = 1 + t % 3, np = 0, j;
+  double deg_v[3];
+  for (j = 0; j < N; j++) {
+    deg_v[j] = 3 + t + j;
+    np += deg_v[j] + 1;
+  }
+  if (np > p->size) {
+    throw new Exception("Not enough data for the GCD test\n");
+  }
+  gsl_vector deg = gsl_vector_view_array(deg_v, N).vector, 
+             p_gcd = gsl_vector_const_subvector(p, 0, np).vector,
+             nullv = { 0, 0, 0, 0, 0 };
+  SLRAObject so(p_gcd, deg, d, nullv);
+  VarproFunction *F = so.getF();
+  NLSVarproVecRCholesky compact(*F);
+  NLSVarproVecRCorrection correction(*F);
+  gsl_matrix *Rini = gsl_matrix_alloc(d + 1, 1), *R = gsl_matrix_alloc(d + 1, 1);
+  gsl_vector x = gsl_vector_view_array(Rini->data, d + 1).vector;
+  gsl_vector *g = gsl_vector_alloc(d + 1), *g_ls = gsl_vector_alloc(d + 1);
+  gsl_matrix g_mat = gsl_matrix_view_vector(g, d + 1, 1).matrix;
+  NLSFunction *funs[] = { &compact, &correction };
+  double f, f_ls;
+  int pt;
+
+  F->computeDefaultRTheta(Rini);
+  diff = 0;
+  for (pt = 0; pt < 2; pt++) {
+    if (pt == 1) {
+      opt->ls_correction = 0;
+      so.optimize(opt, Rini, NULL, NULL, R, NULL);
+      gsl_matrix_memcpy(Rini, R);
+    }
+    F->computeFuncAndGrad(Rini, &f, NULL, &g_mat);
+    for (j = 0; j < 2; j++) {
+      gcd_func_and_grad(funs[j], &x, f_ls, g_ls);
+      gsl_vector_sub(g_ls, g);
+      diff = mymax(diff, fabs(f_ls - f) / f);
+      diff = mymax(diff, gsl_blas_dnrm2(g_ls) / gsl_blas_dnrm2(g));
+    }
+  }
+  time = opt->time;
+  iter = opt->iter;
+  fmin = opt->fmin;
+  fmin2 = f_ls;
+  
+  gsl_matrix_free(Rini);
+  gsl_matrix_free(R);
+  gsl_vector_free(g);
+  gsl_vector_free(g_ls);
+}
+
+/* Cholesky and Structure wrappers counting the factorizations of Gamma */
+class CountingCholesky : public Cholesky {
+  Cholesky *myChol;
+  size_t *myCount;
+public:
+  CountingCholesky( Cholesky *chol, size_t *count ) : 
+      myChol(chol), myCount(count) {}
+  virtual ~CountingCholesky() { delete myChol; }
+  virtual void calcGammaCholesky( const gsl_matrix *Rt, double reg = 0 ) {
+    (*myCount)++;
+    myChol->calcGammaCholesky(Rt, reg);
+  }
+  virtual void multInvCholeskyVector( gsl_vector * y_r, long trans ) {
+    myChol->multInvCholeskyVector(y_r, trans);
+  }
+  virtual void multInvGammaVector( gsl_vector * y_r ) {
+    myChol->multInvGammaVector(y_r);
+  }
+  virtual bool calcGammaCholeskyBounded( const gsl_matrix *Rt, double reg,
+                   gsl_vector *yr, double bound, double *f ) {
+    (*myCount)++;
+    return myChol->calcGammaCholeskyBounded(Rt, reg, yr, bound, f);
+  }
+  virtual bool calcFuncStreaming( const gsl_matrix *Rt, double reg,
+                   gsl_vector *yr, double bound, double *f ) {
+    return myChol->calcFuncStreaming(Rt, reg, yr, bound, f);
+  }
+};
+
+class CountingStructure : public Structure {
+  Structure *myS;
+  size_t *myCount;
+public:
+  CountingStructure( Structure *s, size_t *count ) : myS(s), myCount(count) {}
+  virtual size_t getNp() const { return myS->getNp(); }
+  virtual size_t getM() const { return myS->getM(); }
+  virtual size_t getN() const { return myS->getN(); }
+  virtual void fillMatrixFromP( gsl_matrix* c, const gsl_vector* p ) {
+    myS->fillMatrixFromP(c, p);
+  }
+  virtual void multByGtUnweighted( gsl_vector* p, const gsl_matrix *Rt, 
+                   const gsl_vector *y, double alpha = -1, double beta = 0,
+                   bool skipFixedBlocks = true ) {
+    myS->multByGtUnweighted(p, Rt, y, alpha, beta, skipFixedBlocks);
+  }
+  virtual void multByWInv( gsl_vector* p, long deg = 2 ) const {
+    myS->multByWInv(p, deg);
+  }
+  virtual bool isMissing( size_t k ) const { return myS->isMissing(k); }
+  virtual Cholesky *createCholesky( size_t d ) const {
+    return new CountingCholesky(myS->createCholesky(d), myCount);
+  }
+  virtual DGamma *createDGamma( size_t d ) const {
+    return myS->createDGamma(d);
+  }
+};
+
+/* Memoization of the factor of Gamma(R) in VarproFunction: a sequence of
+ * evaluations (with the gradient or f only, at R_1, R_2 and with another
+ * opt.reggamma) is compared with the evaluations without reuse, and 
+ * the numbers of the factorizations are checked:
+ *   fmin  - f at the initial R_1
+ *   fmin2 - f at R_1 at the end of the sequence
+ *   iter  - number of the factorizations
+ *   diff  - max. relative difference of f and of the gradient,
+ *           1 if the numbers of the factorizations are not as expected */
+#define MEMO_EVALS 8
+void memo_eval( VarproFunction *F, const gsl_matrix *R, double reg, 
+                bool withGrad, double *f, gsl_matrix *grad ) {
+  F->setReggamma(reg);
+  F->computeFuncAndGrad(R, f, NULL, withGrad ? grad : NULL);
+}
+
+void run_memo( SLRAObject *so, double &fmin, double &fmin2, int &iter,
+               double &diff ) {
+  size_t m = so->getF()->getNrow(), d = so->getF()->getD(), cnt = 0, 
+         cnt_ref = 0, i, k;
+  CountingStructure S(so->getS(), &cnt), S_ref(so->getS(), &cnt_ref);
+  VarproFunction F(so->getF()->getP(), &S, d, NULL), 
+                 F_ref(so->getF()->getP(), &S_ref, d, NULL);
+  gsl_matrix *R[2] = { gsl_matrix_alloc(m, d), gsl_matrix_alloc(m, d) }, 
+             *g = gsl_matrix_alloc(m, d), *g_ref = gsl_matrix_alloc(m, d);
+  double reg0 = so->getF()->getReggamma(), reg1 = reg0 * 10 + 1e-3, f, f_ref;
+  /* R index, regularization, gradient or f only, expected count */
+  const int seq_R[] = { 0, 0, 0, 1, 0, 0, 1, 0 }, 
+            seq_reg[] = { 0, 0, 0, 0, 0, 1, 1, 1 },
+            seq_grad[] = { 1, 1, 0, 1, 1, 1, 0, 1 };
+  const size_t seq_cnt[] = { 1, 1, 1, 2, 3, 4, 4, 5 };
+
+  so->computeDefaultRTheta(R[0]);
+  for (i = 0; i < m * d; i++) {
+    R[1]->data[i] = R[0]->data[i] + 0.1 * sin((double)i);
+  }
+  diff = 0;
+  for (k = 0; k < MEMO_EVALS; k++) {
+    double reg = seq_reg[k] ? reg1 : reg0;
+    memo_eval(&F, R[seq_R[k]], reg, seq_grad[k], &f, g);
+    /* The reference evaluation at another R first */
+    memo_eval(&F_ref, R[1 - seq_R[k]], reg, true, &f_ref, g_ref);
+    memo_eval(&F_ref, R[seq_R[k]], reg, true, &f_ref, g_ref);
+    diff = mymax(diff, fabs(f - f_ref) / f_ref);
+    if (seq_grad[k]) {
+      gsl_matrix_sub(g, g_ref);
+      diff = mymax(diff, fabs(mymax(gsl_matrix_max(g), -gsl_matrix_min(g))) /
+                         mymax(gsl_matrix_max(g_ref), -gsl_matrix_min(g_ref)));
+    }
+    if (cnt != seq_cnt[k]) {
+      diff = 1;
+    }
+    if (k == 0) {
+      fmin = f;
+    }
+  }
+  fmin2 = f;
+  iter = cnt;
+  gsl_matrix_free(R[0]);
+  gsl_matrix_free(R[1]);
+  gsl_matrix_free(g);
+  gsl_matrix_free(g_ref);
+}
+
+/* R_p = R + 0.1 sin(i) elementwise, a point where the gradient is nonzero */
+void perturb_R( const gsl_matrix *R, gsl_matrix *R_p ) {
+  for (size_t i = 0; i < R->size1 * R->size2; i++) {
+    R_p->data[i] = R->data[i] + 0.1 * sin((double)i);
+  }
+}
+
+/* Optimization from the default R vs. the dense reference:
+ *   fmin  - f at the computed R
+ *   fmin2 - dense_cost at the computed R
+ *   diff  - max. of the errors of f w.r.t. dense_cost at the initial and 
+ *           the computed R relative to f at the initial R, and
+ *           the relative error of the gradient (central differences) at 
+ *           a perturbation of the initial R (which may be optimal) */
+void run_dense( SLRAObject *so, OptimizationOptions *opt, double &time,
+                double &fmin, double &fmin2, int &iter, double &diff ) {
+  VarproFunction *F = so->getF();
+  size_t m = F->getNrow(), d = F->getD();
+  gsl_matrix *Rini = gsl_matrix_alloc(m, d), *R = gsl_matrix_alloc(m, d);
+  double f_ini;
+
+  so->computeDefaultRTheta(Rini);
+  F->computeFuncAndGrad(Rini, &f_ini, NULL, NULL);
+  diff = fabs(f_ini - dense_cost(so->getS(), Rini, F->getP())) / f_ini;
+  perturb_R(Rini, R);
+  diff = mymax(diff, grad_error(F, R));
+
+  so->optimize(opt, Rini, NULL, NULL, R, NULL);
+  time = opt->time;
+  iter = opt->iter;
+  F->computeFuncAndGrad(R, &fmin, NULL, NULL);
+  fmin2 = dense_cost(so->getS(), R, F->getP());
+  diff = mymax(diff, fabs(fmin - fmin2) / f_ini);
+  gsl_matrix_free(Rini);
+  gsl_matrix_free(R);
+}
+
+/* Fixed parameters: the elementwise weight of the entry k of the block 
+ * of the layer k (of length m_k + n_l - 1) in each column block is Inf, 
+ * so that no row of S(p) is fixed, as long as more than 
+ * n d + INF_MARGIN parameters remain free (Gamma is singular if less than
+ * n d are free), see run_dense() for fmin, fmin2, iter and diff, and 
+ * additionally:
+ *   diff  - also the relative error of ||res||^2 w.r.t. f and of 
+ *           the Jacobian of the correction (central differences) at 
+ *           a perturbation of the default R, the max. change of the fixed
+ *           entries of \hat{p} relative to max|p|, and 1 if the number 
+ *           of the rows of the correction is not the number of the free 
+ *           parameters */
+#define INF_MARGIN 1
+void run_infw( SLRAObject *so, const gsl_vector *w, 
+               OptimizationOptions *opt, double &time, double &fmin, 
+               double &fmin2, int &iter, double &diff ) {
+  VarproFunction *F = so->getF();
+  size_t m = F->getNrow(), d = F->getD(), np = F->getNp(), nfree = 0, i, k;
+  gsl_matrix *R = gsl_matrix_alloc(m, d);
+  double f, j_err = 0, j_norm = 0, p_max, p_err = 0;
+
+  for (k = 0; k < np; k++) {
+    nfree += (gsl_vector_get(w, k) != GSL_POSINF);
+  }
+  size_t nc = F->getNCorrection();
+  gsl_vector *res = gsl_vector_alloc(nc), *res_p = gsl_vector_alloc(nc),
+             *res_m = gsl_vector_alloc(nc), *p_hat = gsl_vector_alloc(np);
+  gsl_matrix *jac = gsl_matrix_alloc(nc, m * d);
+
+  run_dense(so, opt, time, fmin, fmin2, iter, diff);
+  so->computeDefaultRTheta(R);
+  perturb_R(R, R);
+  F->computeFuncAndGrad(R, &f, NULL, NULL);
+  F->computeCorrectionAndJacobian(R, NULL, res, jac);
+  diff = mymax(diff, fabs(gsl_blas_dnrm2(res) * gsl_blas_dnrm2(res) - f) / f);
+  for (i = 0; i < m * d; i++) {
+    double r = R->data[i];
+    R->data[i] = r + FD_H;
+    F->computeCorrectionAndJacobian(R, NULL, res_p, NULL);
+    R->data[i] = r - FD_H;
+    F->computeCorrectionAndJacobian(R, NULL, res_m, NULL);
+    R->data[i] = r;
+    for (k = 0; k < nc; k++) {
+      double e = (gsl_vector_get(res_p, k) - gsl_vector_get(res_m, k)) / 
+                 (2 * FD_H) - gsl_matrix_get(jac, k, i);
+      j_err += e * e;
+      j_norm += gsl_matrix_get(jac, k, i) * gsl_matrix_get(jac, k, i);
+    }
+  }
+  diff = mymax(diff, sqrt(j_err / j_norm));
+  F->computePhat(p_hat, R);
+  p_max = mymax(gsl_vector_max(F->getP()), -gsl_vector_min(F->getP()));
+  for (k = 0; k < np; k++) {
+    if (gsl_vector_get(w, k) == GSL_POSINF) {
+      p_err = mymax(p_err, fabs(gsl_vector_get(p_hat, k) - 
+                                gsl_vector_get(F->getP(), k)));
+    }
+  }
+  diff = mymax(diff, p_err / p_max);
+  if (nc != nfree) {
+    diff = 1;
+  }
+  gsl_matrix_free(R);
+  gsl_matrix_free(jac);
+  gsl_vector_free(res);
+  gsl_vector_free(res_p);
+  gsl_vector_free(res_m);
+  gsl_vector_free(p_hat);
+}
+
+/* Streaming and bounded evaluations of f (Cholesky::calcFuncStreaming(), 
+ * Cholesky::calcGammaCholeskyBounded() and VarproFunction) vs. the full
+ * factorization, at the default R, its perturbation and the computed R, 
+ * for the bounds f (1 + BOUNDED_EPS), Inf (not exceeded) and 
+ * f BOUNDED_FRAC_k (exceeded):
+ *   fmin  - f at the computed R (full factorization)
+ *   fmin2 - f at the computed R (streaming)
+ *   iter  - number of iterations
+ *   diff  - max. relative difference of f, and of Gamma^{-1} S(p) R after
+ *           a bounded factorization that is not aborted (the chunked 
+ *           factorization rounds differently, e.g. about 1e-7 for 
+ *           the ill-conditioned Gamma of test 8); 1 if a bounded 
+ *           evaluation does not return `true` and f below the bound, or 
+ *           `false` and a partial sum above the bound otherwise */
+#define BOUNDED_EPS 1e-6
+#define BOUNDED_NFRAC 4
+void bounded_check( bool res, double f_b, double bound, double f, 
+                    double &diff ) {
+  if (bound >= f) {
+    diff = mymax(diff, res ? fabs(f_b - f) / f : 1);
+  } else if (res || !(f_b > bound)) {
+    diff = 1;
+  }
+}
+
+void run_bounded( SLRAObject *so, OptimizationOptions *opt, double &time,
+                  double &fmin, double &fmin2, int &iter, double &diff ) {
+  VarproFunction *F = so->getF();
+  Structure *S = so->getS();
+  size_t m = F->getNrow(), d = F->getD(), n = S->getN(), t, b;
+  const double fracs[BOUNDED_NFRAC] = { 0.01, 0.3, 0.9, 0.999 };
+  gsl_matrix *R[3] = { gsl_matrix_alloc(m, d), gsl_matrix_alloc(m, d), 
+                       gsl_matrix_alloc(m, d) }, 
+             *c = gsl_matrix_alloc(n, m), *grad = gsl_matrix_alloc(m, d);
+  gsl_vector *sr = gsl_vector_alloc(n * d), *y = gsl_vector_alloc(n * d),
+             *y_b = gsl_vector_alloc(n * d);
+  gsl_matrix srMat = gsl_matrix_view_vector(sr, n, d).matrix;
+  Cholesky *chol = S->createCholesky(d), *chol_b = S->createCholesky(d);
+  double reg = F->getReggamma(), f, f_s, f_b, bound, y_norm;
+  bool res;
+
+  so->computeDefaultRTheta(R[0]);
+  perturb_R(R[0], R[1]);
+  so->optimize(opt, R[0], NULL, NULL, R[2], NULL);
+  time = opt->time;
+  iter = opt->iter;
+  S->fillMatrixFromP(c, F->getP());
+  diff = 0;
+  for (t = 0; t < 3; t++) {
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c, R[t], 0, &srMat);
+    gsl_vector_memcpy(y, sr);
+    chol->calcGammaCholesky(R[t], reg);
+    chol->multInvCholeskyVector(y, 1);
+    gsl_blas_ddot(y, y, &f);
+    chol->multInvCholeskyVector(y, 0);
+    y_norm = gsl_blas_dnrm2(y);
+
+    for (b = 0; b < BOUNDED_NFRAC + 2; b++) {
+      bound = (b == 0 ? f * (1 + BOUNDED_EPS) : 
+               (b == 1 ? GSL_POSINF : f * fracs[b - 2]));
+      gsl_vector_memcpy(y_b, sr);
+      res = chol_b->calcGammaCholeskyBounded(R[t], reg, y_b, bound, &f_b);
+      bounded_check(res, f_b, bound, f, diff);
+      if (res) {
+        chol_b->multInvCholeskyVector(y_b, 0);
+        gsl_vector_sub(y_b, y);
+        diff = mymax(diff, gsl_blas_dnrm2(y_b) / y_norm);
+      }
+      gsl_vector_memcpy(y_b, sr);
+      res = chol_b->calcFuncStreaming(R[t], reg, y_b, bound, &f_b);
+      bounded_check(res, f_b, bound, f, diff);
+      /* VarproFunction, with the memoized factor at another R */
+      F->computeFuncAndGrad(R[(t + 1) % 3], NULL, NULL, grad);
+      res = F->computeFuncBounded(R[t], bound, &f_b);
+      bounded_check(res, f_b, bound, f, diff);
+    }
+    F->computeFuncAndGrad(R[(t + 1) % 3], NULL, NULL, grad);
+    F->computeFuncAndGrad(R[t], &f_s, NULL, NULL);
+    diff = mymax(diff, fabs(f_s - f) / f);
+  }
+  fmin = f;
+  fmin2 = f_s;
+  delete chol;
+  delete chol_b;
+  for (t = 0; t < 3; t++) {
+    gsl_matrix_free(R[t]);
+  }
+  gsl_matrix_free(c);
+  gsl_matrix_free(grad);
+  gsl_vector_free(sr);
+  gsl_vector_free(y);
+  gsl_vector_free(y_b);
+}
+
+/* Creates the SLRAObject for SparseAffineStructure with the index map of 
+ * the mosaic Hankel structure (without Phi) and the elementwise weights w */
+SLRAObject *affine_object( const gsl_vector *m_k, const gsl_vector *n_l,
+                const gsl_vector *w, const gsl_vector *p, size_t d, 
+                double hodlr_tol = 0 ) {
+  size_t m = 0, n = 0, k, l, i, j, row, col, off = 0;
+  for (k = 0; k < m_k->size; k++) {
+    m += gsl_vector_get(m_k, k);
+  }
+  for (l = 0; l < n_l->size; l++) {
+    n += gsl_vector_get(n_l, l);
+  }
+  gsl_matrix *tts = gsl_matrix_alloc(n, m);
+  gsl_matrix nullm = { 0, 0, 0, 0, 0, 0 };
+  double r = m - d;
+  gsl_vector rvec = gsl_vector_view_array(&r, 1).vector;
+
+  for (l = 0, col = 0; l < n_l->size; col += gsl_vector_get(n_l, l++)) {
+    size_t nl = gsl_vector_get(n_l, l);
+    for (k = 0, row = 0; k < m_k->size; row += gsl_vector_get(m_k, k++)) {
+      size_t mk = gsl_vector_get(m_k, k);
+      for (i = 0; i < mk; i++) {
+        for (j = 0; j < nl; j++) {
+          gsl_matrix_set(tts, col + j, row + i, off + i + j + 1);
+        }
+      }
+      off += mk + nl - 1;
+    }
+  }
+  SLRAObject *so = new SLRAObject(*p, *tts, nullm, *w, rvec, hodlr_tol);
+  gsl_matrix_free(tts);
+  return so;
+}
+
+/* General affine structure (SparseAffineStructure) with the index map of 
+ * the mosaic Hankel structure of the test and elementwise weights,
+ * see run_dense() for fmin, fmin2 and diff, and additionally:
+ *   iter  - mu found from the sparsity pattern (after the reordering)
+ *   diff  - also the relative errors of f and the gradient at the 
+ *           perturbed initial R w.r.t. the mosaic Hankel structure 
+ *           (if there is no Phi), 
+ *           1 if mu exceeds mu of the mosaic Hankel structure */
+void run_affine( SLRAObject *so, const gsl_vector *m_k, const gsl_vector *n_l,
+                 const gsl_vector *w, bool hasPhi, OptimizationOptions *opt, 
+                 double &time, double &fmin, double &fmin2, int &iter, 
+                 double &diff ) {
+  VarproFunction *F = so->getF();
+  size_t m = F->getNrow(), d = F->getD(), mu = 0;
+  SLRAObject *so_a = affine_object(m_k, n_l, w, F->getP(), d);
+  VarproFunction *F_a = so_a->getF();
+  double f, f_a;
+
+  run_dense(so_a, opt, time, fmin, fmin2, iter, diff);
+  for (size_t k = 0; k < m_k->size; k++) {
+    mu = mymax(mu, (size_t)gsl_vector_get(m_k, k));
+  }
+  iter = ((SparseAffineStructure *)so_a->getS())->getMu();
+  if ((size_t)iter > mu) {
+    diff = 1;
+  }
+  if (!hasPhi) {
+    gsl_matrix *Rini = gsl_matrix_alloc(m, d), *R = gsl_matrix_alloc(m, d),
+               *g = gsl_matrix_alloc(m, d), *g_a = gsl_matrix_alloc(m, d);
+    so->computeDefaultRTheta(Rini);
+    perturb_R(Rini, R);
+    F->computeFuncAndGrad(R, &f, NULL, g);
+    F_a->computeFuncAndGrad(R, &f_a, NULL, g_a);
+    gsl_matrix_sub(g_a, g);
+    diff = mymax(diff, fabs(f_a - f) / f);
+    diff = mymax(diff, mymax(gsl_matrix_max(g_a), -gsl_matrix_min(g_a)) /
+                       mymax(gsl_matrix_max(g), -gsl_matrix_min(g)));
+    gsl_matrix_free(Rini);
+    gsl_matrix_free(R);
+    gsl_matrix_free(g);
+    gsl_matrix_free(g_a);
+  }
+  delete so_a;
+}
+
+/* HODLRCholesky vs. MuDependentCholesky for the general affine structure 
+ * of the test type 'a': the solves with Gamma and L_Gamma with leaves of 
+ * HODLR_TEST_LEAF blocks (several levels even for small n) at the perturbed
+ * initial R and at the R computed with the banded factorization, f and 
+ * the gradient (default leaves) at the perturbed initial R, and f at 
+ * the computed R (where the gradient vanishes):
+ *   fmin  - f at the computed R (banded)
+ *   fmin2 - f at the computed R (HODLR)
+ *   iter  - maximal rank of the off-diagonal blocks (HODLR_TEST_LEAF)
+ *           at the two points
+ *   diff  - max. relative difference of the solves, f and the gradient */
+#define HODLR_TEST_TOL  1e-12
+#define HODLR_TEST_LEAF 4
+double rel_diff( const gsl_vector *x, const gsl_vector *x_ref ) {
+  double nrm = 0, nrm_ref = 0, t;
+  for (size_t i = 0; i < x->size; i++) {
+    t = gsl_vector_get(x, i) - gsl_vector_get(x_ref, i);
+    nrm += t * t;
+    nrm_ref += gsl_vector_get(x_ref, i) * gsl_vector_get(x_ref, i);
+  }
+  return sqrt(nrm / nrm_ref);
+}
+
+void run_hodlr( const gsl_vector *m_k, const gsl_vector *n_l, 
+                const gsl_vector *w, const gsl_vector *p, size_t d, 
+                OptimizationOptions *opt, double &time, double &fmin, 
+                double &fmin2, int &iter, double &diff ) {
+  SLRAObject *so = affine_object(m_k, n_l, w, p, d), 
+             *so_h = affine_object(m_k, n_l, w, p, d, HODLR_TEST_TOL);
+  VarproFunction *F = so->getF(), *F_h = so_h->getF();
+  const MuDependentStructure *S = (SparseAffineStructure *)so->getS();
+  size_t m = F->getNrow(), nd = F->getN() * d, i, k, pt;
+  gsl_matrix *Rini = gsl_matrix_alloc(m, d), *R = gsl_matrix_alloc(m, d), 
+             *g = gsl_matrix_alloc(m, d), *g_h = gsl_matrix_alloc(m, d);
+  gsl_vector *y = gsl_vector_alloc(nd), *y_h = gsl_vector_alloc(nd);
+  gsl_vector g_vec = gsl_vector_view_array(g->data, m * d).vector, 
+             g_h_vec = gsl_vector_view_array(g_h->data, m * d).vector;
+  MuDependentCholesky chol(S, d);
+  HODLRCholesky chol_h(S, d, HODLR_TEST_TOL, HODLR_TEST_LEAF);
+
+  so->computeDefaultRTheta(Rini);
+  perturb_R(Rini, R);
+  diff = 0;
+  iter = 0;
+  for (pt = 0; pt < 2; pt++) {
+    if (pt == 1) {
+      so->optimize(opt, Rini, NULL, NULL, R, NULL);
+      time = opt->time;
+    }
+    chol.calcGammaCholesky(R);
+    chol_h.calcGammaCholesky(R);
+    for (k = 0; k < 3; k++) {
+      for (i = 0; i < nd; i++) {
+        gsl_vector_set(y, i, cos(0.3 * i));
+      }
+      gsl_vector_memcpy(y_h, y);
+      if (k < 2) {
+        chol.multInvCholeskyVector(y, k);
+        chol_h.multInvCholeskyVector(y_h, k);
+      } else {
+        chol.multInvGammaVector(y);
+        chol_h.multInvGammaVector(y_h);
+      }
+      diff = mymax(diff, rel_diff(y_h, y));
+    }
+    iter = mymax(iter, (int)chol_h.getMaxRank());
+
+    F->computeFuncAndGrad(R, &fmin, NULL, (pt == 0 ? g : NULL));
+    F_h->computeFuncAndGrad(R, &fmin2, NULL, (pt == 0 ? g_h : NULL));
+    diff = mymax(diff, fabs(fmin2 - fmin) / fmin);
+    if (pt == 0) {
+      diff = mymax(diff, rel_diff(&g_h_vec, &g_vec));
+    }
+  }
+
+  gsl_matrix_free(Rini);
+  gsl_matrix_free(R);
+  gsl_matrix_free(g);
+  gsl_matrix_free(g_h);
+  gsl_vector_free(y);
+  gsl_vector_free(y_h);
+  delete so;
+  delete so_h;
+}
+
+/* Two-dimensional (Hankel-block-Hankel) structure of HBH_Q(t) layers 
+ * (t - test number) of sizes m^(l) = (2 + (l + t) % 2, 2 + l % 2), 
+ * n = (3 + t, 4 + t % 3), weights 1, 2, ..., rank reduction 1 + t % 2 
+ * and the 2-D data taken from p, see run_dense() for the output */
+#define HBH_Q(t) (1 + (t) % 2)
+void run_hbh( const char *testname, const gsl_vector *p, 
+              OptimizationOptions *opt, double &time, double &fmin, 
+              double &fmin2, int &iter, double &diff ) {
+  int t = atoi(testname);
+  size_t q = HBH_Q(t), d = 1 + t % 2, np = 0, m = 0, l;
+  double m2d_v[4], n2d_v[2] = { 3.0 + t, 4.0 + t % 3 }, w_v[2], r;
+
+  for (l = 0; l < q; l++) {
+    m2d_v[2 * l] = 2 + (l + t) % 2;
+    m2d_v[2 * l + 1] = 2 + l % 2;
+    w_v[l] = l + 1;
+    m += m2d_v[2 * l] * m2d_v[2 * l + 1];
+    np += (m2d_v[2 * l] + n2d_v[0] - 1) * (m2d_v[2 * l + 1] + n2d_v[1] - 1);
+  }
+  if (np > p->size) {
+    throw new Exception("Not enough data for the 2-D test\n");
+  }
+  r = m - d;
+  gsl_matrix m2d = gsl_matrix_view_array(m2d_v, q, 2).matrix;
+  gsl_vector n2d = gsl_vector_view_array(n2d_v, 2).vector,
+             wk = gsl_vector_view_array(w_v, q).vector,
+             rvec = gsl_vector_view_array(&r, 1).vector,
+             p_2d = gsl_vector_const_subvector(p, 0, np).vector;
+  SLRAObject so(p_2d, m2d, n2d, wk, rvec);
+  run_dense(&so, opt, time, fmin, fmin2, iter, diff);
+}
+
+/* Dense reference of the cost function for complex data: 
+ * f(R) = s^H Gamma^{-1} s, where s = vec(S(p) R) for the complex
+ * p = p_re + i p_im and R = R_re + i R_im, Gamma = G^T W^{-1} conj(G), 
+ * the rows of G are g_k = vec(S(e_k) R), and the real structure S 
+ * (S(0) = 0) defines the weights. The complex system Gamma y = s is solved 
+ * in the real form [Gamma_re -Gamma_im; Gamma_im Gamma_re] */
+double complex_cost( Structure *S, const gsl_matrix *R_re, 
+                     const gsl_matrix *R_im, const gsl_vector *p_re, 
+                     const gsl_vector *p_im ) {
+  size_t n = S->getN(), d = R_re->size2, np = S->getNp(), nd = n * d, 
+         nk = 2 * nd, k, one = 1, info = 0;
+  gsl_matrix *c = gsl_matrix_alloc(n, S->getM());
+  gsl_matrix *G_re = gsl_matrix_alloc(np, nd), *G_im = gsl_matrix_alloc(np, nd),
+             *WG = gsl_matrix_alloc(np, nd), *Winv = gsl_matrix_alloc(np, np);
+  gsl_matrix *K = gsl_matrix_alloc(nk, nk);
+  gsl_vector *e = gsl_vector_calloc(np), *s = gsl_vector_alloc(nk), 
+             *y = gsl_vector_alloc(nk);
+  gsl_matrix s_re = gsl_matrix_view_vector(s, n, d).matrix,
+             s_im = gsl_matrix_view_array(s->data + nd, n, d).matrix;
+  gsl_matrix K_11 = gsl_matrix_submatrix(K, 0, 0, nd, nd).matrix,
+             K_12 = gsl_matrix_submatrix(K, 0, nd, nd, nd).matrix,
+             K_21 = gsl_matrix_submatrix(K, nd, 0, nd, nd).matrix,
+             K_22 = gsl_matrix_submatrix(K, nd, nd, nd, nd).matrix;
+  size_t *ipiv = new size_t[nk];
+  double f;
+
+  for (k = 0; k < np; k++) {
+    gsl_vector G_k = gsl_matrix_row(G_re, k).vector;
+    gsl_matrix GkMat = gsl_matrix_view_vector(&G_k, n, d).matrix;
+    gsl_vector_set_basis(e, k);
+    S->fillMatrixFromP(c, e);
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c, R_re, 0, &GkMat);
+    G_k = gsl_matrix_row(G_im, k).vector;
+    GkMat = gsl_matrix_view_vector(&G_k, n, d).matrix;
+    gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c, R_im, 0, &GkMat);
+    S->multByWInv(e, 2);
+    gsl_matrix_set_row(Winv, k, e);
+  }
+  /* Gamma_re = G_re^T W^{-1} G_re + G_im^T W^{-1} G_im,
+   * Gamma_im = G_im^T W^{-1} G_re - G_re^T W^{-1} G_im */
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, Winv, G_re, 0, WG);
+  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, G_re, WG, 0, &K_11);
+  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, G_im, WG, 0, &K_21);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, Winv, G_im, 0, WG);
+  gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1, G_im, WG, 1, &K_11);
+  gsl_blas_dgemm(CblasTrans, CblasNoTrans, -1, G_re, WG, 1, &K_21);
+  gsl_matrix_memcpy(&K_22, &K_11);
+  gsl_matrix_transpose_memcpy(&K_12, &K_21);
+
+  /* s_re = S(p_re) R_re - S(p_im) R_im, s_im = S(p_re) R_im + S(p_im) R_re */
+  S->fillMatrixFromP(c, p_re);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c, R_re, 0, &s_re);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c, R_im, 0, &s_im);
+  S->fillMatrixFromP(c, p_im);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, -1, c, R_im, 1, &s_re);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c, R_re, 1, &s_im);
+
+  /* K is stored transposed, K^T = [Gamma_re Gamma_im; -Gamma_im Gamma_re] */
+  gsl_matrix_transpose(K);
+  gsl_vector_memcpy(y, s);
+  dgesv_(&nk, &one, K->data, &K->tda, ipiv, y->data, &nk, &info);
+  gsl_blas_ddot(s, y, &f);
+  if (info != 0) {
+    f = GSL_NAN;
+  }
+  delete [] ipiv;
+  gsl_matrix_free(c);
+  gsl_matrix_free(G_re);
+  gsl_matrix_free(G_im);
+  gsl_matrix_free(WG);
+  gsl_matrix_free(Winv);
+  gsl_matrix_free(K);
+  gsl_vector_free(e);
+  gsl_vector_free(s);
+  gsl_vector_free(y);
+  return f;
+}
+
+/* Complex data p_re + i p_im (p_re = p, p_im - the reversed p scaled by 
+ * 0.5) with the mosaic Hankel structure of the test (without Phi) and 
+ * the rank reduction d vs. the complex dense reference:
+ *   fmin  - f at the computed R
+ *   fmin2 - complex_cost at the computed R
+ *   iter  - number of iterations
+ *   diff  - max. of the errors of f w.r.t. complex_cost at the initial,
+ *           a perturbed initial (complex) and the computed R relative 
+ *           to f at the initial R, and the relative error of the 
+ *           gradient (central differences) at the perturbed R */
+void run_complex( const gsl_vector *m_k, const gsl_vector *n_l, 
+                  const gsl_vector *w, const gsl_vector *p, size_t d,
+                  OptimizationOptions *opt, double &time, double &fmin, 
+                  double &fmin2, int &iter, double &diff ) {
+  size_t np = p->size, m = 0, k;
+  for (k = 0; k < m_k->size; k++) {
+    m += gsl_vector_get(m_k, k);
+  }
+  gsl_vector *p_im = gsl_vector_alloc(np);
+  gsl_matrix nullm = { 0, 0, 0, 0, 0, 0 };
+  double r = m - d;
+  gsl_vector rvec = gsl_vector_view_array(&r, 1).vector;
+
+  for (k = 0; k < np; k++) {
+    gsl_vector_set(p_im, k, 0.5 * gsl_vector_get(p, np - 1 - k));
+  }
+  SLRAObject so(*p, *p_im, *m_k, *n_l, *w, rvec), 
+             so_r(*p, *m_k, *n_l, nullm, *w, rvec);
+  VarproFunction *F = so.getF();
+  gsl_matrix *Rini = gsl_matrix_alloc(2 * m, 2 * d), 
+             *R = gsl_matrix_alloc(2 * m, 2 * d),
+             *R_re = gsl_matrix_alloc(m, d), *R_im = gsl_matrix_alloc(m, d),
+             *Rp_re = gsl_matrix_alloc(m, d), *Rp_im = gsl_matrix_alloc(m, d);
+  double f_ini, f;
+
+  so.computeDefaultRTheta(Rini);
+  F->computeFuncAndGrad(Rini, &f_ini, NULL, NULL);
+  so.complexifyRt(Rini, R_re, R_im);
+  diff = fabs(f_ini - complex_cost(so_r.getS(), R_re, R_im, p, p_im)) / f_ini;
+  perturb_R(R_re, Rp_re);
+  perturb_R(R_im, Rp_im);
+  so.realifyRt(Rp_re, Rp_im, R);
+  F->computeFuncAndGrad(R, &f, NULL, NULL);
+  diff = mymax(diff, 
+           fabs(f - complex_cost(so_r.getS(), Rp_re, Rp_im, p, p_im)) / f_ini);
+  diff = mymax(diff, grad_error(F, R));
+
+  so.optimize(opt, Rini, NULL, NULL, R, NULL);
+  time = opt->time;
+  iter = opt->iter;
+  F->computeFuncAndGrad(R, &fmin, NULL, NULL);
+  so.complexifyRt(R, R_re, R_im);
+  fmin2 = complex_cost(so_r.getS(), R_re, R_im, p, p_im);
+  diff = mymax(diff, fabs(fmin - fmin2) / f_ini);
+  gsl_matrix_free(Rini);
+  gsl_matrix_free(R);
+  gsl_matrix_free(R_re);
+  gsl_matrix_free(R_im);
+  gsl_matrix_free(Rp_re);
+  gsl_matrix_free(Rp_im);
+  gsl_vector_free(p_im);
+}
+
+/* Banded inverse weights (HLayeredBandWStructure) with the mosaic Hankel 
+ * structure of the test: (W_l^{-1})_{st} = c^{(l)}_{|s-t|}, 
+ * c^{(l)} = (1 + 0.5 l) (1, 0.3 (-1)^l, 0.1), see run_dense() for fmin, 
+ * fmin2, iter and diff, and additionally:
+ *   diff  - also the max. error of W^{-1} e_k (multByWInv()) w.r.t. 
+ *           the Toeplitz blocks built directly from the bands */
+#define BANDW_B 2
+void run_bandw( const gsl_vector *m_k, const gsl_vector *n_l, 
+                gsl_matrix phi, const gsl_vector *p, size_t d, 
+                OptimizationOptions *opt, double &time, double &fmin, 
+                double &fmin2, int &iter, double &diff ) {
+  size_t q = m_k->size, np = p->size, m = (phi.data == NULL ? 0 : phi.size2),
+         k, l, i, j, off = 0;
+  gsl_matrix *bands = gsl_matrix_alloc(q, BANDW_B + 1);
+  gsl_vector nullv = { 0, 0, 0, 0, 0 };
+  double r, err = 0;
+
+  for (k = 0; k < q; k++) {
+    gsl_matrix_set(bands, k, 0, 1 + 0.5 * k);
+    gsl_matrix_set(bands, k, 1, (k % 2 ? -0.3 : 0.3) * (1 + 0.5 * k));
+    gsl_matrix_set(bands, k, 2, 0.1 * (1 + 0.5 * k));
+    m += (phi.data == NULL ? gsl_vector_get(m_k, k) : 0);
+  }
+  r = m - d;
+  gsl_vector rvec = gsl_vector_view_array(&r, 1).vector;
+  SLRAObject so(*p, *m_k, *n_l, phi, nullv, rvec, false, NULL, bands);
+  gsl_vector *e = gsl_vector_alloc(np);
+
+  /* Blocks of length m_k + n_l - 1, for l in N, for k in q */
+  for (l = 0; l < n_l->size; l++) {
+    for (k = 0; k < q; off += gsl_vector_get(m_k, k) + 
+                             gsl_vector_get(n_l, l) - 1, k++) {
+      size_t T = gsl_vector_get(m_k, k) + gsl_vector_get(n_l, l) - 1;
+      for (j = 0; j < T; j++) {
+        gsl_vector_set_basis(e, off + j);
+        so.getS()->multByWInv(e, 2);
+        for (i = 0; i < np; i++) {
+          double w_ij = 0;
+          if (i >= off && i < off + T && 
+              labs((long)i - (long)(off + j)) <= BANDW_B) {
+            w_ij = gsl_matrix_get(bands, k, labs((long)i - (long)(off + j)));
+          }
+          err = mymax(err, fabs(gsl_vector_get(e, i) - w_ij));
+        }
+      }
+    }
+  }
+  run_dense(&so, opt, time, fmin, fmin2, iter, diff);
+  diff = mymax(diff, err);
+  gsl_vector_free(e);
+  gsl_matrix_free(bands);
+}
+
+/* Sparse Phi (PhiStructure with Phi^T in the CSC format): Phi of the test,
+ * or Phi_{i,(i+1) mod m} = 1 + 0.1 i if the test has no Phi. The gathering 
+ * products are compared with dgemm and the structure without Phi, 
+ * see run_dense() for fmin, fmin2 and iter, and 
+ *   diff  - max. of the diff of run_dense(), the relative errors of 
+ *           S^T(p) and of S^T (I_n x R^T) y (with and without 
+ *           the workspace of the structure) at the perturbed default R,
+ *           1 if Phi is not stored in the sparse format */
+void run_phi( const gsl_vector *m_k, const gsl_vector *n_l, 
+              const gsl_vector *w, const gsl_vector *p, gsl_matrix *PhiT, 
+              size_t d, OptimizationOptions *opt, double &time, double &fmin,
+              double &fmin2, int &iter, double &diff ) {
+  size_t m_s = 0, m, n, i;
+  double diff_dense;
+  for (i = 0; i < m_k->size; i++) {
+    m_s += gsl_vector_get(m_k, i);
+  }
+  gsl_matrix *PhiT_c = gsl_matrix_calloc(m_s, 
+                                         (PhiT != NULL ? PhiT->size2 : m_s));
+  if (PhiT != NULL) {
+    gsl_matrix_memcpy(PhiT_c, PhiT);
+  } else {
+    for (i = 0; i < m_s; i++) {
+      gsl_matrix_set(PhiT_c, (i + 1) % m_s, i, 1 + 0.1 * i);
+    }
+  }
+  m = PhiT_c->size2;
+  gsl_matrix nullm = { 0, 0, 0, 0, 0, 0 };
+  double r = m - d, r_s = m_s - 1;
+  gsl_vector rvec = gsl_vector_view_array(&r, 1).vector, 
+             rvec_s = gsl_vector_view_array(&r_s, 1).vector;
+  SLRAObject so(*p, *m_k, *n_l, *PhiT_c, *w, rvec), 
+             so_s(*p, *m_k, *n_l, nullm, *w, rvec_s);
+  Structure *S = so.getS(), *S_s = so_s.getS();
+  Structure::Workspace *ws = S->createWorkspace(d);
+  n = S->getN();
+  gsl_matrix *c = gsl_matrix_alloc(n, m), *c_s = gsl_matrix_alloc(n, m_s), 
+             *c_ref = gsl_matrix_alloc(n, m), *Rini = gsl_matrix_alloc(m, d), 
+             *Rt = gsl_matrix_alloc(m, d), *PhiTRt = gsl_matrix_alloc(m_s, d);
+  gsl_vector *y = gsl_vector_alloc(n * d), *g = gsl_vector_calloc(p->size),
+             *g_ws = gsl_vector_calloc(p->size), 
+             *g_ref = gsl_vector_calloc(p->size);
+
+  /* S^T(p) = S_s^T(p) Phi^T */
+  S->fillMatrixFromP(c, p, ws);
+  S_s->fillMatrixFromP(c_s, p);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, c_s, PhiT_c, 0, c_ref);
+  gsl_vector c_v = gsl_vector_view_array(c->data, n * m).vector,
+             c_ref_v = gsl_vector_view_array(c_ref->data, n * m).vector;
+  diff = rel_diff(&c_v, &c_ref_v);
+  /* S^T (I_n x R^T) y = S_s^T (I_n x (Phi^T R^T)) y */
+  so.computeDefaultRTheta(Rini);
+  perturb_R(Rini, Rt);
+  for (i = 0; i < y->size; i++) {
+    gsl_vector_set(y, i, sin(0.3 * i + 1));
+  }
+  S->multByGtUnweighted(g, Rt, y, 1, 1);
+  S->multByGtUnweighted(g_ws, Rt, y, 1, 1, true, ws);
+  gsl_blas_dgemm(CblasNoTrans, CblasNoTrans, 1, PhiT_c, Rt, 0, PhiTRt);
+  S_s->multByGtUnweighted(g_ref, PhiTRt, y, 1, 1);
+  diff = mymax(diff, rel_diff(g, g_ref));
+  diff = mymax(diff, rel_diff(g_ws, g_ref));
+
+  run_dense(&so, opt, time, fmin, fmin2, iter, diff_dense);
+  diff = mymax(diff, diff_dense);
+  if (!((PhiStructure *)S)->isPhiSparse()) {
+    diff = 1;
+  }
+  if (ws != NULL) {
+    delete ws;
+  }
+  gsl_matrix_free(PhiT_c);
+  gsl_matrix_free(c);
+  gsl_matrix_free(c_s);
+  gsl_matrix_free(c_ref);
+  gsl_matrix_free(Rini);
+  gsl_matrix_free(Rt);
+  gsl_matrix_free(PhiTRt);
+  gsl_vector_free(y);
+  gsl_vector_free(g);
+  gsl_vector_free(g_ws);
+  gsl_vector_free(g_ref);
+}
+
+/* Layered Toeplitz column blocks (TLayeredBlWStructure and 
+ * TLayeredElWStructure) with the layers and the data of the test, 
+ * for the Toeplitz marks tk = 1 (all blocks) and tk_l = (l + 1) % 2 
+ * (Toeplitz and Hankel blocks mixed if N > 1), and the weights w of 
+ * the test (block) and w_k (1 + 0.1 (i mod 3)) (elementwise): 
+ *   fmin, fmin2, iter - see run_dense(), the run with tk = 1 and w
+ *   diff  - max. of the diffs of run_dense() for all the runs, and the
+ *           relative differences of f at the default R of the block and
+ *           the equal elementwise weights, and (without Phi) of f at R
+ *           and f of the layered Hankel structure at JR, where J reverses
+ *           the rows of each layer (a Toeplitz layer is J H(p)) */
+void run_toeplitz( const gsl_vector *m_k, const gsl_vector *n_l, 
+                   const gsl_vector *w_k, gsl_matrix phi, 
+                   const gsl_vector *p, size_t d, OptimizationOptions *opt,
+                   double &time, double &fmin, double &fmin2, int &iter, 
+                   double &diff ) {
+  size_t q = m_k->size, N = n_l->size, np = p->size, m = 0, k, l, i, 
+         off = 0, t, e;
+  gsl_vector *tk[2] = { gsl_vector_alloc(1), gsl_vector_alloc(N) }, 
+             *w_el = gsl_vector_alloc(np), *w_eq = gsl_vector_alloc(np);
+  gsl_matrix *R = NULL, *JR = NULL;
+  double r, f_bl, f_eq, f_h, diff_k;
+
+  gsl_vector_set(tk[0], 0, 1);
+  for (l = 0; l < N; l++) {
+    gsl_vector_set(tk[1], l, (l + 1) % 2);
+  }
+  for (l = 0; l < N; l++) {
+    for (k = 0; k < q; k++) {
+      size_t T = gsl_vector_get(m_k, k) + gsl_vector_get(n_l, l) - 1;
+      for (i = 0; i < T; i++, off++) {
+        gsl_vector_set(w_eq, off, gsl_vector_get(w_k, k));
+        gsl_vector_set(w_el, off, gsl_vector_get(w_k, k) * (1 + 0.1 * (i % 3)));
+      }
+    }
+  }
+  for (k = 0; k < q; k++) {
+    m += gsl_vector_get(m_k, k);
+  }
+  m = (phi.data == NULL ? m : phi.size2);
+  r = m - d;
+  gsl_vector rvec = gsl_vector_view_array(&r, 1).vector;
+  R = gsl_matrix_alloc(m, d);
+  JR = gsl_matrix_alloc(m, d);
+
+  diff = 0;
+  for (t = 0; t < 2; t++) {
+    for (e = 0; e < 2; e++) {
+      SLRAObject so(*p, *m_k, *n_l, phi, *(e ? w_el : w_k), rvec, false, 
+                    tk[t]);
+      OptimizationOptions opt_k = *opt;
+      double time_k, fmin_k, fmin2_k;
+      int iter_k;
+
+      if (t == 0 && e == 0) {
+        SLRAObject so_eq(*p, *m_k, *n_l, phi, *w_eq, rvec, false, tk[t]);
+        so.computeDefaultRTheta(R);
+        so.getF()->computeFuncAndGrad(R, &f_bl, NULL, NULL);
+        so_eq.getF()->computeFuncAndGrad(R, &f_eq, NULL, NULL);
+        diff = fabs(f_bl - f_eq) / f_bl;
+        if (phi.data == NULL) {
+          SLRAObject so_h(*p, *m_k, *n_l, phi, *w_k, rvec);
+          for (k = 0, off = 0; k < q; off += gsl_vector_get(m_k, k++)) {
+            size_t m_l = gsl_vector_get(m_k, k);
+            for (i = 0; i < m_l; i++) {
+              gsl_vector R_row = gsl_matrix_row(R, off + i).vector;
+              gsl_matrix_set_row(JR, off + m_l - 1 - i, &R_row);
+            }
+          }
+          so_h.getF()->computeFuncAndGrad(JR, &f_h, NULL, NULL);
+          diff = mymax(diff, fabs(f_bl - f_h) / f_bl);
+        }
+      }
+      run_dense(&so, &opt_k, time_k, fmin_k, fmin2_k, iter_k, diff_k);
+      diff = mymax(diff, diff_k);
+      if (t == 0 && e == 0) {
+        time = time_k;
+        fmin = fmin_k;
+        fmin2 = fmin2_k;
+        iter = iter_k;
+      }
+    }
+  }
+  gsl_matrix_free(R);
+  gsl_matrix_free(JR);
+  gsl_vector_free(tk[0]);
+  gsl_vector_free(tk[1]);
+  gsl_vector_free(w_el);
+  gsl_vector_free(w_eq);
+}
+
 #define MAX_FN  60
 void run_test( const char * testname, double & time, double& fmin, 
          double &fmin2, int& iter, double& diff, 
@@ -102,7 +1596,7 @@ void run_test( const char * testname, double & time, double& fmin,
       gsl_vector_set_all(w_k, 1);
     }  
      
-    if (elementwise_w) {
+    if (elementwise_w || strchr("nkahi", test_type[0]) != NULL) {
       gsl_vector *el_wk = gsl_vector_alloc(compute_np(m_k, n_l));
       int i = 0;
       size_t T;
@@ -128,6 +1622,31 @@ void run_test( const char * testname, double & time, double& fmin,
     
     /* Compute invariants and read everything else */ 
     read_vec(p = gsl_vector_alloc(np), fpname);
+    if (strchr("nk", test_type[0]) != NULL) {
+      for (size_t k = MISSING_STEP / 2; k < np; k += MISSING_STEP) {
+        gsl_vector_set(p, k, GSL_NAN);
+        gsl_vector_set(w_k, k, 0);
+      }
+    }
+    if (test_type[0] == 'i') {
+      size_t nfree = 0, nd = 0, i = 0, T;
+      for (size_t k = 0; k < np; k++) {
+        nfree += (gsl_vector_get(w_k, k) != GSL_POSINF);
+      }
+      for (size_t l = 0; l < s_N; l++) {
+        nd += gsl_vector_get(n_l, l) * (m - rk);
+      }
+      for (size_t l = 0; l < s_N; l++) {
+        for (size_t k = 0; k < s_q; k++, i += T) {
+          T = gsl_vector_get(m_k, k) + gsl_vector_get(n_l, l) - 1;
+          if (nfree > nd + INF_MARGIN && 
+              gsl_vector_get(w_k, i + k % T) != GSL_POSINF) {
+            gsl_vector_set(w_k, i + k % T, GSL_POSINF);
+            nfree--;
+          }
+        }
+      }
+    }
     p2 = gsl_vector_alloc(np);
     hasR = read_mat(R = gsl_matrix_calloc(m, m - rk), fnR);
     hasPhi = read_mat(Phi = gsl_matrix_alloc(mh_m, m), fnPhi);
@@ -154,6 +1673,49 @@ void run_test( const char * testname, double & time, double& fmin,
       diff = gsl_blas_dnrm2(&Rvec);
       fmin = opt.fmin;
       fmin2 = dp_norm * dp_norm;
+    } else if (test_type[0] == 'm') {
+      run_multistart(so, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'n') {
+      run_missing(so, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'i') {
+      run_infw(so, w_k, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'k') {
+      run_resume(so, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'c') {
+      run_cov(so, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 't') {
+      run_toeplitz(m_k, n_l, w_k, (hasPhi ? *Phi : nullPhi), p, m - rk, &opt, 
+                   time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'x') {
+      run_xi(so, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'j') {
+      run_sketch(so, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'u') {
+      run_sampled(so, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'g') {
+      run_gcd(testname, p, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'r') {
+      run_memo(so, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'e') {
+      run_bounded(so, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'a') {
+      run_affine(so, m_k, n_l, w_k, hasPhi, &opt, time, fmin, fmin2, iter, 
+                 diff);
+    } else if (test_type[0] == 'h') {
+      run_hodlr(m_k, n_l, w_k, p, m - rk, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'b') {
+      run_hbh(testname, p, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'z') {
+      run_complex(m_k, n_l, w_k, p, m - rk, &opt, time, fmin, fmin2, iter, 
+                  diff);
+    } else if (test_type[0] == 'w') {
+      run_bandw(m_k, n_l, (hasPhi ? *Phi : nullPhi), p, m - rk, &opt, time, 
+                fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'y') {
+      run_async(so, &opt, time, fmin, fmin2, iter, diff);
+    } else if (test_type[0] == 'f') {
+      run_phi(m_k, n_l, w_k, p, (hasPhi ? Phi : NULL), m - rk, &opt, time, 
+              fmin, fmin2, iter, diff);
     } else {
       meas_time(*so->getF(),  fmin, fmin2, diff);
     }          
@@ -197,7 +1759,37 @@ int main(int argc, char *argv[])
                             "<elementwise_w> <ls_correction>]\n"
       "start_no      - starting test #, in [0;%d]\n"
       "end_no        - end test #, in [start_no--%d] (default start_no)\n"           
-      "test_type     - 'd' for differences (default), 's' for speed\n"           
+      "test_type     - 'd' for differences (default), 's' for speed,\n"
+      "                'm' for multi-start vs. serial starts,\n"           
+      "                'n' for missing values vs. dense reference,\n"           
+      "                'i' for fixed values (Inf weights) vs. dense\n"           
+      "                reference,\n"           
+      "                'k' for resuming from a checkpoint (with missing\n"           
+      "                values) vs. an uninterrupted run,\n"           
+      "                'c' for covariance of the QR and Cholesky LM solvers\n"           
+      "                vs. the SVD solver (method 'p'),\n"           
+      "                'x' for the adaptive pivot rows of [X; -I] vs. the\n"           
+      "                fixed ones (method 'p'),\n"           
+      "                'j' for the sketched Jacobian of the correction vs.\n"           
+      "                the full one (method 'p'),\n"           
+      "                'u' for the warm start on samples of the blocks\n"           
+      "                vs. the run without it,\n"           
+      "                'g' for the compact pseudo-Jacobian vs. the\n"           
+      "                correction in the GCD mode,\n"           
+      "                'r' for reuse of the factorization of Gamma,\n"           
+      "                'e' for the streaming and the bounded evaluation\n"           
+      "                of f vs. the full factorization,\n"           
+      "                'a' for the general affine structure vs. the dense\n"           
+      "                reference and the mosaic Hankel structure,\n"           
+      "                'h' for the HODLR factorization of Gamma vs. the\n"           
+      "                banded one (general affine structure),\n"           
+      "                'b' for the 2-D (Hankel-block-Hankel) structure\n"           
+      "                vs. dense reference,\n"           
+      "                'z' for complex data vs. dense reference,\n"           
+      "                'w' for banded weights vs. dense reference,\n"           
+      "                't' for layered Toeplitz blocks vs. dense reference,\n"           
+      "                'f' for sparse Phi vs. dgemm and dense reference,\n"           
+      "                'y' for asynchronous optimization and stopping\n"           
       "maxiter       - opt.maxiter (default 500)\n"           
       "method        - opt.method (default \"l\")\n"           
       "elementwise_w - 0 for MosaicHStructure (default), 1 for WMosaic...\n"           
@@ -218,7 +1810,8 @@ int main(int argc, char *argv[])
     printf("Error: incorrect end_no\n");
     return -1;
   }
-  const char *test_type = (argc > 3 && argv[3][0] == 's' ? "s" : "d");
+  const char *test_type = (argc > 3 && strchr("smnikcxjugreahbzwtfy", argv[3][0]) != NULL ? 
+                           argv[3] : "d");
   int maxiter = argc > 4 ? atoi(argv[4]) : 500;
   const char *method = (argc > 5 ? argv[5] : "l");
   bool elementwise_w = argc > 6 ? (bool)atoi(argv[6]) : false;
@@ -248,9 +1841,9 @@ int main(int argc, char *argv[])
     print_hr(72);
   }
   printf("  no         Time   Iter   %s   %s   %s  \n",
-         (test_type[0] == 'd' ? "    Minimum" : "     t_func"), 
-         (test_type[0] == 'd' ? "  Minimum_2" : "     t_grad"), 
-         (test_type[0] == 'd' ? "         Diff_R" : "         t_pjac"));
+         (test_type[0] != 's' ? "    Minimum" : "     t_func"), 
+         (test_type[0] != 's' ? "  Minimum_2" : "     t_grad"), 
+         (test_type[0] != 's' ? "         Diff_R" : "         t_pjac"));
  
   for( i = start_no; i <= end_no; i++ ) {
     printf("  %2d   %10.6f   %4d   %11.7f   %11.7f   %15.10f  \n", 